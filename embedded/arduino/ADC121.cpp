@@ -6,7 +6,7 @@
 ADC121::ADC121() {}
 
 int ADC121::getData() {
-  unsigned int data[2];
+  unsigned int data[2] = {0, 0};
   // Start I2C Transmission
   Wire.beginTransmission(ADC121_ADDR);
   // Calling conversion result register, 0x00(0)
@@ -24,7 +24,6 @@ int ADC121::getData() {
       data[0] = Wire.read();
       data[1] = Wire.read();
     }
-  delay(300);
   // Convert the data to 12 bits
   return ((data[0] & 0x0F) * 256) + data[1];
 }
@@ -0,0 +1,159 @@
+#include "Frame.h"
+#include <string.h>
+
+int8_t frameLength(uint8_t type) {
+  switch (type) {
+  case FRAME_THRUSTER:
+    return 16;
+  case FRAME_DEPTH:
+  case FRAME_TEMP:
+  case FRAME_STARTUP:
+    return 0;
+  case FRAME_TELEMETRY_RATE:
+  case FRAME_TELEMETRY_RATE_REPLY:
+    return 1;
+  case FRAME_THRUSTER_REPLY:
+    return 3;
+  case FRAME_DEPTH_REPLY:
+  case FRAME_TEMP_REPLY:
+    return 4;
+  case FRAME_STARTUP_REPLY:
+    return 2;
+  case FRAME_ERROR:
+    return 1;
+  case FRAME_TELEMETRY:
+    return FRAME_TELEMETRY_LENGTH;
+  default:
+    return -1;
+  }
+}
+
+// CRC-16/CCITT, bitwise to stay out of the Uno's RAM
+uint16_t frameCRC(const uint8_t *data, size_t size) {
+  uint16_t crc = 0xFFFF;
+
+  for (size_t i = 0; i < size; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      if (crc & 0x8000) {
+        crc = (crc << 1) ^ 0x1021;
+      }
+      else {
+        crc <<= 1;
+      }
+    }
+  }
+  return crc;
+}
+
+size_t frameEncode(uint8_t type, uint8_t seq, const uint8_t *payload, uint8_t *out) {
+  int8_t length = frameLength(type);
+  if (length < 0) {
+    return 0;
+  }
+
+  out[0] = FRAME_SYNC;
+  out[1] = type;
+  if (length > 0) {
+    memcpy(&out[2], payload, length);
+  }
+  out[2 + length] = seq;
+  framePutU16(&out[3 + length], frameCRC(&out[1], length + 2));
+
+  return length + FRAME_OVERHEAD;
+}
+
+void framePutU16(uint8_t *out, uint16_t value) {
+  out[0] = value & 0xFF;
+  out[1] = value >> 8;
+}
+
+uint16_t frameGetU16(const uint8_t *in) {
+  return in[0] | ((uint16_t)in[1] << 8);
+}
+
+void framePutU32(uint8_t *out, uint32_t value) {
+  framePutU16(out, value & 0xFFFF);
+  framePutU16(&out[2], value >> 16);
+}
+
+uint32_t frameGetU32(const uint8_t *in) {
+  return frameGetU16(in) | ((uint32_t)frameGetU16(&in[2]) << 16);
+}
+
+void framePutFloat(uint8_t *out, float value) {
+  memcpy(out, &value, sizeof(value));
+}
+
+float frameGetFloat(const uint8_t *in) {
+  float value;
+  memcpy(&value, in, sizeof(value));
+  return value;
+}
+
+FrameDecoder::FrameDecoder() {
+  pos = 0;
+  length = 0;
+  synced = false;
+  lastError = FRAME_ERROR_NONE;
+}
+
+bool FrameDecoder::push(uint8_t byte) {
+  if (!synced) {
+    synced = (byte == FRAME_SYNC);
+    pos = 0;
+    return false;
+  }
+
+  buffer[pos++] = byte;
+  return scan();
+}
+
+bool FrameDecoder::scan() {
+  while (synced && pos > 0) {
+    length = frameLength(buffer[0]);
+    if (length < 0) {
+      lastError = FRAME_ERROR_TYPE;
+      resync(0);
+      continue;
+    }
+
+    // type, payload, seq and the CRC
+    uint8_t size = length + FRAME_OVERHEAD - 1;
+    if (pos < size) {
+      return false;
+    }
+
+    if (frameCRC(buffer, length + 2) != frameGetU16(&buffer[length + 2])) {
+      lastError = FRAME_ERROR_CRC;
+      resync(0);
+      continue;
+    }
+
+    type = buffer[0];
+    memcpy(payload, &buffer[1], length);
+    seq = buffer[length + 1];
+    resync(size);
+    return true;
+  }
+  return false;
+}
+
+void FrameDecoder::resync(uint8_t start) {
+  synced = false;
+  for (uint8_t i = start; i < pos; i++) {
+    if (buffer[i] == FRAME_SYNC) {
+      pos -= i + 1;
+      memmove(buffer, &buffer[i + 1], pos);
+      synced = true;
+      return;
+    }
+  }
+  pos = 0;
+}
+
+uint8_t FrameDecoder::error() {
+  uint8_t e = lastError;
+  lastError = FRAME_ERROR_NONE;
+  return e;
+}
@@ -0,0 +1,126 @@
+#ifndef _FRAME_H_
+#define _FRAME_H_
+
+/*
+ * Binary frames between the Jetson and the Arduino, in both directions:
+ *
+ *   sync | type | payload | seq | crc (2 bytes)
+ *
+ * The payload length is fixed by the type, so there's no length byte. The CRC
+ * is CRC-16/CCITT over type, payload and seq. Multi byte fields are little
+ * endian, which the AVR and the Jetson both are. Replies carry the sequence
+ * number of the request they answer.
+ *
+ * Plain C++ with no Arduino headers, so test/test_frame.cpp can build it on
+ * the host. src/vl_qubo/src/arduino_node.py has the Python side.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FRAME_SYNC 0xA5
+
+#define FRAME_MAX_PAYLOAD FRAME_TELEMETRY_LENGTH
+// sync, type, seq and the CRC
+#define FRAME_OVERHEAD 5
+#define FRAME_MAX_SIZE (FRAME_MAX_PAYLOAD + FRAME_OVERHEAD)
+
+// Requests, the same letters as the ASCII commands they replace
+#define FRAME_THRUSTER 't'        // 8 x uint16 pulse widths in us
+#define FRAME_DEPTH 'd'           // empty
+#define FRAME_TEMP 'c'            // empty
+#define FRAME_STARTUP 's'         // empty
+#define FRAME_TELEMETRY_RATE 'r'  // uint8 telemetry frames per second, 0 to stop them
+
+// Replies
+#define FRAME_THRUSTER_REPLY 'T'  // uint16 last pulse width, FRAME_THRUSTER_INVALID if rejected, uint8 status
+#define FRAME_DEPTH_REPLY 'D'     // float depth in m
+#define FRAME_TEMP_REPLY 'C'      // float temperature in C
+#define FRAME_STARTUP_REPLY 'S'   // uint16 raw ADC reading
+#define FRAME_TELEMETRY_RATE_REPLY 'R' // uint8 rate now in use
+#define FRAME_ERROR 'E'           // uint8 one of the FRAME_ERROR_ codes
+
+// Sent unasked at the telemetry rate, seq counts telemetry frames. Offsets
+// into the payload:
+#define FRAME_TELEMETRY 'M'
+#define FRAME_TELEMETRY_TIME 0      // uint32 millis() when it was sampled
+#define FRAME_TELEMETRY_DEPTH 4     // float depth in m
+#define FRAME_TELEMETRY_TEMP 8      // float electronics temperature in C
+#define FRAME_TELEMETRY_VOLTAGE 12  // float INA219 bus voltage in V
+#define FRAME_TELEMETRY_CURRENT 16  // float INA219 current in mA
+#define FRAME_TELEMETRY_STATUS 20   // uint8 status
+#define FRAME_TELEMETRY_PULSES 21   // 8 x uint16 last pulse widths written to the thrusters
+#define FRAME_TELEMETRY_LENGTH 37
+
+#define FRAME_THRUSTER_INVALID 0xFFFF
+
+#define FRAME_ERROR_NONE 0
+#define FRAME_ERROR_CRC 1
+#define FRAME_ERROR_TYPE 2
+
+/**
+ * Payload length of type, or -1 if it isn't one
+ */
+int8_t frameLength(uint8_t type);
+
+uint16_t frameCRC(const uint8_t *data, size_t size);
+
+/**
+ * Writes a whole frame into out, which needs room for FRAME_MAX_SIZE bytes.
+ * payload must hold frameLength(type) bytes. Returns the size of the frame,
+ * or 0 if type isn't one.
+ */
+size_t frameEncode(uint8_t type, uint8_t seq, const uint8_t *payload, uint8_t *out);
+
+void framePutU16(uint8_t *out, uint16_t value);
+uint16_t frameGetU16(const uint8_t *in);
+void framePutU32(uint8_t *out, uint32_t value);
+uint32_t frameGetU32(const uint8_t *in);
+void framePutFloat(uint8_t *out, float value);
+float frameGetFloat(const uint8_t *in);
+
+/**
+ * Reassembles frames from a byte stream. Anything before a sync byte is
+ * skipped, so it finds its way back after noise or a dropped byte. When a
+ * sync byte turns out to be noise, the bytes already taken after it are
+ * searched for the next one, so a real frame that started among them isn't
+ * lost with it.
+ */
+class FrameDecoder {
+ public:
+
+  FrameDecoder();
+
+  /**
+   * Feeds in the next byte. Returns true when it completes a frame with a
+   * good CRC, which is then in type, seq and payload until the next call.
+   */
+  bool push(uint8_t byte);
+
+  /**
+   * The FRAME_ERROR_ code of the last frame thrown away, cleared by reading it
+   */
+  uint8_t error();
+
+  uint8_t type;
+  uint8_t seq;
+  uint8_t payload[FRAME_MAX_PAYLOAD];
+
+ private:
+
+  // Checks what's buffered, returning true if it holds a good frame
+  bool scan();
+
+  // Drops buffer up to start and carries on from the next sync byte after it
+  void resync(uint8_t start);
+
+  // Everything after the sync byte
+  uint8_t buffer[FRAME_MAX_SIZE - 1];
+  uint8_t pos;
+  int8_t length;
+  bool synced;
+  uint8_t lastError;
+
+};
+
+#endif
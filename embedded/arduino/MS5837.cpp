@@ -8,6 +8,14 @@
 #define MS5837_CONVERT_D1_8192    0x4A
 #define MS5837_CONVERT_D2_8192    0x5A
 
+// Max conversion time at OSR 8192 per datasheet, in ms
+#define MS5837_CONVERSION_TIME    20
+
+// update() states
+#define MS5837_IDLE               0
+#define MS5837_CONVERTING_D1      1
+#define MS5837_CONVERTING_D2      2
+
 const float MS5837::Pa = 100.0f;
 const float MS5837::bar = 0.001f;
 const float MS5837::mbar = 1.0f;
@@ -17,6 +25,8 @@ const uint8_t MS5837::MS5837_02BA = 1;
 
 MS5837::MS5837() {
 	fluidDensity = 1029;
+	state = MS5837_IDLE;
+	hasReading = false;
 }
 
 bool MS5837::init() {
@@ -59,40 +69,75 @@ void MS5837::setFluidDensity(float density) {
 
 void MS5837::read() {
 	// Request D1 conversion
-	Wire.beginTransmission(MS5837_ADDR);
-	Wire.write(MS5837_CONVERT_D1_8192);
-	Wire.endTransmission();
-
-	delay(20); // Max conversion time per datasheet
-	
-	Wire.beginTransmission(MS5837_ADDR);
-	Wire.write(MS5837_ADC_READ);
-	Wire.endTransmission();
+	startConversion(MS5837_CONVERT_D1_8192);
+	delay(MS5837_CONVERSION_TIME);
+	D1 = readConversion();
 
- 	Wire.requestFrom(MS5837_ADDR,3);
-	D1 = 0;
-	D1 = Wire.read();
-	D1 = (D1 << 8) | Wire.read();
-	D1 = (D1 << 8) | Wire.read();
-	
 	// Request D2 conversion
+	startConversion(MS5837_CONVERT_D2_8192);
+	delay(MS5837_CONVERSION_TIME);
+	D2 = readConversion();
+
+	calculate();
+	hasReading = true;
+
+	// Anything update() had started has been overwritten
+	state = MS5837_IDLE;
+}
+
+bool MS5837::update() {
+	// Unsigned subtraction, so this is right across millis() wrapping
+	if ( state != MS5837_IDLE && millis() - conversionStart < MS5837_CONVERSION_TIME ) {
+		return false;
+	}
+
+	switch ( state ) {
+	case MS5837_IDLE:
+		startConversion(MS5837_CONVERT_D1_8192);
+		state = MS5837_CONVERTING_D1;
+		return false;
+	case MS5837_CONVERTING_D1:
+		D1 = readConversion();
+		startConversion(MS5837_CONVERT_D2_8192);
+		state = MS5837_CONVERTING_D2;
+		return false;
+	default:
+		D2 = readConversion();
+		calculate();
+		hasReading = true;
+		// Straight on to the next one
+		startConversion(MS5837_CONVERT_D1_8192);
+		state = MS5837_CONVERTING_D1;
+		return true;
+	}
+}
+
+bool MS5837::ready() {
+	return hasReading;
+}
+
+void MS5837::startConversion(uint8_t command) {
 	Wire.beginTransmission(MS5837_ADDR);
-	Wire.write(MS5837_CONVERT_D2_8192);
+	Wire.write(command);
 	Wire.endTransmission();
 
-	delay(20); // Max conversion time per datasheet
-	
+	conversionStart = millis();
+}
+
+uint32_t MS5837::readConversion() {
+	uint32_t D;
+
 	Wire.beginTransmission(MS5837_ADDR);
 	Wire.write(MS5837_ADC_READ);
 	Wire.endTransmission();
 
 	Wire.requestFrom(MS5837_ADDR,3);
-	D2 = 0;
-	D2 = Wire.read();
-	D2 = (D2 << 8) | Wire.read();
-	D2 = (D2 << 8) | Wire.read();
+	D = 0;
+	D = Wire.read();
+	D = (D << 8) | Wire.read();
+	D = (D << 8) | Wire.read();
 
-	calculate();
+	return D;
 }
 
 void MS5837::calculate() {
@@ -126,7 +171,6 @@ void MS5837::calculate() {
 	//Second order compensation
 	if ( _model == MS5837_02BA ) {
 		if((TEMP/100)<20){         //Low temp
-			Serial.println("here");
 			Ti = (11*int64_t(dT)*int64_t(dT))/(34359738368LL);
 			OFFi = (31*(TEMP-2000)*(TEMP-2000))/8;
 			SENSi = (63*(TEMP-2000)*(TEMP-2000))/32;
@@ -65,9 +65,21 @@ public:
 	void setFluidDensity(float density);
 
 	/** The read from I2C takes up to 40 ms, so use sparingly is possible.
+	 *  In loop() use update() instead.
 	 */
 	void read();
 
+	/** Non-blocking version of read(). Starts the next conversion or
+	 *  collects the one in progress, and returns straight away. Call it every
+	 *  loop(). Returns true when it has just worked out a new reading, which
+	 *  is then what pressure(), temperature() and depth() return.
+	 */
+	bool update();
+
+	/** True once update() or read() has produced a reading.
+	 */
+	bool ready();
+
 	/** Pressure returned in mbar or mbar*conversion rate.
 	 */
 	float pressure(float conversion = 1.0f);
@@ -94,6 +106,14 @@ private:
 
 	float fluidDensity;
 
+	// Where update() is in the D1, D2 conversion sequence
+	uint8_t state;
+	unsigned long conversionStart;
+	bool hasReading;
+
+	void startConversion(uint8_t command);
+	uint32_t readConversion();
+
 	/** Performs calculations per the sensor data sheet for conversion and
 	 *  second order compensation.
 	 */
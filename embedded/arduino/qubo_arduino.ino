@@ -1,6 +1,7 @@
 /* sgillen - this will be all the arduino code for qubo */
 
 #include "debug.h"
+#include "Frame.h"
 
 #include <Wire.h>
 #include "MS5837.h"
@@ -9,7 +10,6 @@
 #include "Adafruit_INA219.h"
 #include <Servo.h>
 
-#define BUFFER_SIZE 64 //may need to change
 #define NUM_THRUSTERS 8
 
 #define THRUSTER_NEUTRAL 1520
@@ -35,6 +35,9 @@
 // how many loops to skip before checking temp again
 #define TEMP_UPDATE_RATE 10
 
+// Telemetry frames sent per second until the jetson asks for something else
+#define TELEMETRY_RATE 50
+
 // __________________________________________________________________________________________
 
 #define STARTUP_PIN 0
@@ -42,10 +45,9 @@
 #define LED_PIN 13
 #define LED_BLINK_LEN 500
 
-char buffer[BUFFER_SIZE]; //this is the buffer where we store incoming text from the computer
+FrameDecoder decoder; // reassembles frames from the jetson, see Frame.h
 uint8_t counter;
 uint8_t status;
-uint16_t serialBufferPos;
 unsigned long alive; // keeps the current time
 boolean timedout = false; // if the arduino has timed out
 /* PCA9685 pca; */
@@ -54,12 +56,15 @@ ADC121 adc121;
 Adafruit_INA219 ina;
 Servo esc[NUM_THRUSTERS];
 uint8_t esc_pins[] = {3,4,5,6,23,22,21,20};
+uint16_t pulses[NUM_THRUSTERS]; // last thing written to each esc, for telemetry
 int led_state = LOW;
 unsigned long led_time;
+uint8_t telemetry_rate = TELEMETRY_RATE;
+unsigned long telemetry_time;
+uint8_t telemetry_seq = 0;
 
 void setup() {
     Serial.begin(115200);
-    serialBufferPos = 0;
 
     counter = 0;
     status = STATUS_OK;
@@ -81,10 +86,14 @@ void setup() {
 
     sensor.setFluidDensity(997); // kg/m^3 (997 freshwater, 1029 for seawater)
 
+    // Have a depth ready before the first request, update() keeps it fresh after
+    sensor.read();
+
     // for lm35 https://playground.arduino.cc/Main/LM35HigherResolution
     //analogReference(INTERNAL);
 
     led_time = millis() + LED_BLINK_LEN;
+    telemetry_time = millis();
     pinMode(LED_PIN, OUTPUT); 
     /* digitalWrite(LED_PIN, HIGH); */
     // Done setup, so send connected command
@@ -93,54 +102,54 @@ void setup() {
     delay(1);
 }
 
-//processes and sends thrusters commands to the PCA
-void thrusterCmd() {
-
-  char* thrusterCommands[NUM_THRUSTERS];
-
-  for (int i = 0; i < NUM_THRUSTERS; i++) {
-
-    thrusterCommands[i] = strtok(NULL, ",!"); //remember buffer is global, strok still remembers that we are reading from it
-    #ifdef DEBUG
-    Serial.println(thrusterCommands[i]);
-    #endif
+// Sends a reply frame, seq is the one from the request it answers
+void sendFrame(uint8_t type, uint8_t seq, const uint8_t *payload) {
+  uint8_t frame[FRAME_MAX_SIZE];
+  size_t size = frameEncode(type, seq, payload, frame);
+  Serial.write(frame, size);
+}
 
-  }
-  //thrusterCommands[NUM_THRUSTERS] = strtok(NULL, "!"); //last token is the ! not the ,
+//sets the thrusters from the pulse widths in a thruster frame
+void thrusterCmd(const uint8_t *payload, uint8_t seq) {
 
   uint16_t off;
 
   for (int i = 0; i < NUM_THRUSTERS; i++) {
 
+    off = frameGetU16(&payload[2 * i]);
+    #ifdef DEBUG
+    Serial.println(off);
+    #endif
 
-    off = atoi(thrusterCommands[i]);
-
-    // If the msg isn't above or below acceptable, set it. otherwise send -1 back
+    // If the msg isn't above or below acceptable, set it. otherwise send invalid back
     if ( off > THRUSTER_MIN && off < THRUSTER_MAX ) {
         esc[i].writeMicroseconds(off);
+        pulses[i] = off;
     }
     else {
-        off = -1;
+        off = FRAME_THRUSTER_INVALID;
     }
   }
 
-  //Serial.println(THRUSTER_MIN);
-  // Send back the first command
-  Serial.print("t");
-  Serial.println(off);
+  // Send back the last command and the status
+  uint8_t reply[3];
+  framePutU16(reply, off);
+  reply[2] = status;
+  sendFrame(FRAME_THRUSTER_REPLY, seq, reply);
 
 }
 
-void getStartupVoltage() {
-  int val = analogRead(STARTUP_PIN);
-  Serial.print("s");
-  Serial.println(val);
+void getStartupVoltage(uint8_t seq) {
+  uint8_t reply[2];
+  framePutU16(reply, analogRead(STARTUP_PIN));
+  sendFrame(FRAME_STARTUP_REPLY, seq, reply);
 }
 
 void thrustersNeutral() {
   for ( int i = 0; i < NUM_THRUSTERS; i++ ) {
       /* pca.thrusterSet(i, THRUSTER_NEUTRAL); */
       esc[i].writeMicroseconds(THRUSTER_NEUTRAL);
+      pulses[i] = THRUSTER_NEUTRAL;
   }
 }
 
@@ -148,15 +157,15 @@ void thrustersOff() {
     for ( int i = 0; i < NUM_THRUSTERS; i++ ) {
         /* pca.thrusterSet(i, THRUSTER_NEUTRAL); */
         esc[i].writeMicroseconds(0);
+        pulses[i] = 0;
     }
 }
 
-// Placeholder, needs to get depth from I2C, then println it to serial
-void getDepth() {
-  sensor.read();
-  float depth = sensor.depth();
-  Serial.print("d");
-  Serial.println(depth);
+// Replies with the last depth from sensor.update(), so it doesn't wait on the conversions
+void getDepth(uint8_t seq) {
+  uint8_t reply[4];
+  framePutFloat(reply, sensor.depth());
+  sendFrame(FRAME_DEPTH_REPLY, seq, reply);
 }
 
 void getCurrent() {
@@ -164,9 +173,12 @@ void getCurrent() {
   Serial.println(data);
 }
 
-void getTemp() {
-  int val = analogRead(LM35_PIN);
-  float temp = val / 9.31;
+float readTemp() {
+  return analogRead(LM35_PIN) / 9.31;
+}
+
+void getTemp(uint8_t seq) {
+  float temp = readTemp();
   if ( temp >= TEMP_THRES ) {
     status = STATUS_OVERHEAT;
   }
@@ -176,13 +188,36 @@ void getTemp() {
   else {
     status = STATUS_OK;
   }
-  Serial.print("c");
-  Serial.println(temp);
+  uint8_t reply[4];
+  framePutFloat(reply, temp);
+  sendFrame(FRAME_TEMP_REPLY, seq, reply);
+}
+
+void setTelemetryRate(const uint8_t *payload, uint8_t seq) {
+  telemetry_rate = payload[0];
+  telemetry_time = millis();
+  sendFrame(FRAME_TELEMETRY_RATE_REPLY, seq, &telemetry_rate);
+}
+
+// Everything the jetson would otherwise have to poll for, in one frame
+void sendTelemetry() {
+  uint8_t payload[FRAME_TELEMETRY_LENGTH];
+
+  framePutU32(&payload[FRAME_TELEMETRY_TIME], millis());
+  framePutFloat(&payload[FRAME_TELEMETRY_DEPTH], sensor.depth());
+  framePutFloat(&payload[FRAME_TELEMETRY_TEMP], readTemp());
+  framePutFloat(&payload[FRAME_TELEMETRY_VOLTAGE], ina.getBusVoltage_V());
+  framePutFloat(&payload[FRAME_TELEMETRY_CURRENT], ina.getCurrent_mA());
+  payload[FRAME_TELEMETRY_STATUS] = status;
+  for (int i = 0; i < NUM_THRUSTERS; i++) {
+    framePutU16(&payload[FRAME_TELEMETRY_PULSES + 2 * i], pulses[i]);
+  }
+
+  sendFrame(FRAME_TELEMETRY, telemetry_seq++, payload);
 }
 
 void checkTemp() {
-    int val = analogRead(LM35_PIN);
-    float temp = val / 9.31;
+    float temp = readTemp();
     if ( temp >= TEMP_THRES ) {
         status = STATUS_OVERHEAT;
     }
@@ -210,70 +245,39 @@ void loop() {
       status = STATUS_OK;
     }
 
-    // Read next byte from serial into buffer
-    buffer[serialBufferPos] = Serial.read();
-
-    #ifdef DEBUG
-     Serial.print("buffer is: ");
-     Serial.println(buffer);
-    #endif
-
-    // Check if we've reached exclamation
-    if (buffer[serialBufferPos] == '!') {
-
-      //prot tells us what to do
-      char* prot = strtok(buffer, ",");
-
-      //check if something about the packet is malformed enough that strok fails
-      if ( !prot[0] ) {
-        Serial.println("B1");
-      }
-      // Handle specific commands
-      else if ( prot[0] == 't' ) {
-        #ifdef DEBUG
-        //Serial.println("Thrusters on");
-        #endif
-        thrusterCmd();
-        // print status after every loop
-        Serial.print("s");
-        Serial.println(status);
-      }
-      else if ( prot[0] == 'd' ) {
-        #ifdef DEBUG
-        //Serial.println("Get depth");
-        #endif
-        getDepth();
-      }
-      else if ( prot[0] == 'c' ) {
-        #ifdef DEBUG
-        Serial.println("Get temp");
-        #endif
-        getTemp();
-      }
-      // Start up voltage on INA
-      else if ( prot[0] == 's') {
-        getStartupVoltage();
+    // Take everything that's arrived, a whole frame is handled as soon as its last byte is in
+    while (Serial.available() > 0) {
+      if ( decoder.push(Serial.read()) ) {
+        // Handle specific commands
+        if ( decoder.type == FRAME_THRUSTER ) {
+          thrusterCmd(decoder.payload, decoder.seq);
+        }
+        else if ( decoder.type == FRAME_DEPTH ) {
+          getDepth(decoder.seq);
+        }
+        else if ( decoder.type == FRAME_TEMP ) {
+          getTemp(decoder.seq);
+        }
+        // Start up voltage on INA
+        else if ( decoder.type == FRAME_STARTUP ) {
+          getStartupVoltage(decoder.seq);
+        }
+        else if ( decoder.type == FRAME_TELEMETRY_RATE ) {
+          setTelemetryRate(decoder.payload, decoder.seq);
+        }
+        else {
+          // A reply type, the jetson shouldn't be sending these
+          uint8_t error = FRAME_ERROR_TYPE;
+          sendFrame(FRAME_ERROR, decoder.seq, &error);
+        }
       }
       else {
-          Serial.println("B2");
-          Serial.println(prot[0]);
+        // Malformed frames get no sequence number, there's no telling what it was
+        uint8_t error = decoder.error();
+        if ( error != FRAME_ERROR_NONE ) {
+          sendFrame(FRAME_ERROR, 0, &error);
+        }
       }
-
-      // Reset buffer position
-      serialBufferPos = 0;
-      buffer[0] = 0;
-
-    }
-
-    else {
-      #ifdef DEBUG
-
-      Serial.print("Buffer pos ");
-      Serial.println(serialBufferPos);
-      Serial.println(buffer[serialBufferPos]);
-
-      #endif
-      serialBufferPos++;
     }
 
     // update the timer
@@ -317,6 +321,23 @@ void loop() {
   }
 
 
+  // Depth conversions run in the background, this only talks to the sensor
+  // when one is done
+  sensor.update();
+
+  // Fixed rate, whether or not the jetson is talking to us
+  if ( telemetry_rate > 0 ) {
+    unsigned long period = 1000 / telemetry_rate;
+    if ( millis() - telemetry_time >= period ) {
+      sendTelemetry();
+      telemetry_time += period;
+      // If loop() fell behind, start again from now instead of sending a burst
+      if ( millis() - telemetry_time >= period ) {
+        telemetry_time = millis();
+      }
+    }
+  }
+
   /*
   if ( counter % TEMP_UPDATE_RATE == 0 ) {
     checkTemp();
@@ -0,0 +1,145 @@
+/*
+ * Checks the Arduino's frame encoder and decoder in ../Frame.cpp on the host.
+ */
+
+#include "../Frame.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static int check(const char *name, bool ok) {
+  printf("%-40s %s\n", name, ok ? "OK" : "FAIL");
+  return ok;
+}
+
+// Feeds a stream through the decoder, returning how many frames came out
+static int decode(FrameDecoder &decoder, const uint8_t *data, size_t size) {
+  int frames = 0;
+  for (size_t i = 0; i < size; i++) {
+    if (decoder.push(data[i])) {
+      frames++;
+    }
+  }
+  return frames;
+}
+
+int main() {
+  int success = 1;
+  uint8_t frame[FRAME_MAX_SIZE];
+  uint8_t payload[FRAME_MAX_PAYLOAD];
+  uint16_t pulses[8] = {1000, 1100, 1200, 1300, 1520, 1700, 1900, 2000};
+  size_t size;
+
+  // The usual check value for CRC-16/CCITT-FALSE
+  success &= check("CRC of \"123456789\"", frameCRC((const uint8_t *)"123456789", 9) == 0x29B1);
+
+  for (int i = 0; i < 8; i++) {
+    framePutU16(&payload[2 * i], pulses[i]);
+  }
+  size = frameEncode(FRAME_THRUSTER, 42, payload, frame);
+  success &= check("Thruster frame is 21 bytes", size == 21);
+  success &= check("Unknown type isn't encoded", frameEncode('x', 0, payload, frame) == 0);
+
+  {
+    FrameDecoder decoder;
+    bool ok = decode(decoder, frame, size) == 1 && decoder.type == FRAME_THRUSTER && decoder.seq == 42;
+    for (int i = 0; i < 8; i++) {
+      ok &= frameGetU16(&decoder.payload[2 * i]) == pulses[i];
+    }
+    success &= check("Thruster frame round trip", ok && decoder.error() == FRAME_ERROR_NONE);
+  }
+
+  {
+    // Garbage, including a stray sync byte, then two frames back to back
+    uint8_t stream[64] = {0x00, 0x13, FRAME_SYNC, 'x', 0x37};
+    size_t n = 5;
+    uint8_t reply[3];
+    FrameDecoder decoder;
+
+    memcpy(&stream[n], frame, size);
+    n += size;
+    framePutU16(reply, FRAME_THRUSTER_INVALID);
+    reply[2] = 1;
+    n += frameEncode(FRAME_THRUSTER_REPLY, 43, reply, &stream[n]);
+
+    success &= check("Resyncs after garbage", decode(decoder, stream, n) == 2 && decoder.seq == 43 &&
+                     frameGetU16(decoder.payload) == FRAME_THRUSTER_INVALID && decoder.payload[2] == 1);
+    success &= check("Reports the unknown type", decoder.error() == FRAME_ERROR_TYPE &&
+                     decoder.error() == FRAME_ERROR_NONE);
+  }
+
+  {
+    FrameDecoder decoder;
+    uint8_t corrupt[FRAME_MAX_SIZE];
+    bool ok = true;
+
+    // Every single bit flip after the sync byte is caught
+    for (size_t i = 1; i < size; i++) {
+      for (int bit = 0; bit < 8; bit++) {
+        memcpy(corrupt, frame, size);
+        corrupt[i] ^= 1 << bit;
+        ok &= decode(decoder, corrupt, size) == 0;
+        decoder.error();
+      }
+    }
+    success &= check("Single bit errors are rejected", ok);
+
+    memcpy(corrupt, frame, size);
+    corrupt[5] ^= 0xFF;
+    decode(decoder, corrupt, size);
+    success &= check("Reports the bad CRC", decoder.error() == FRAME_ERROR_CRC);
+    success &= check("Decodes again after a bad frame", decode(decoder, frame, size) == 1);
+  }
+
+  {
+    FrameDecoder decoder;
+    uint8_t value[4];
+
+    framePutFloat(value, -1.25f);
+    size = frameEncode(FRAME_DEPTH_REPLY, 7, value, frame);
+    success &= check("Depth reply round trip", size == 9 && decode(decoder, frame, size) == 1 &&
+                     decoder.type == FRAME_DEPTH_REPLY && frameGetFloat(decoder.payload) == -1.25f);
+
+    size = frameEncode(FRAME_DEPTH, 8, NULL, frame);
+    success &= check("Empty request round trip", size == FRAME_OVERHEAD && decode(decoder, frame, size) == 1 &&
+                     decoder.type == FRAME_DEPTH && decoder.seq == 8);
+  }
+
+  {
+    // A stray sync and thruster type swallow the start of three depth
+    // replies, the first of them whole, before the CRC shows it up
+    uint8_t stream[64] = {FRAME_SYNC, FRAME_THRUSTER};
+    size_t n = 2;
+    uint8_t value[4];
+    FrameDecoder decoder;
+
+    for (uint8_t seq = 1; seq <= 3; seq++) {
+      framePutFloat(value, seq * 0.5f);
+      n += frameEncode(FRAME_DEPTH_REPLY, seq, value, &stream[n]);
+    }
+    success &= check("Rescans after a false sync", decode(decoder, stream, n) == 3 && decoder.seq == 3 &&
+                     frameGetFloat(decoder.payload) == 1.5f);
+    success &= check("Reports the false sync", decoder.error() == FRAME_ERROR_CRC);
+  }
+
+  {
+    FrameDecoder decoder;
+    uint8_t telemetry[FRAME_TELEMETRY_LENGTH];
+    uint8_t stream[2 * FRAME_MAX_SIZE];
+
+    memset(telemetry, 0, sizeof(telemetry));
+    framePutU32(&telemetry[FRAME_TELEMETRY_TIME], 0xDEADBEEF);
+    framePutFloat(&telemetry[FRAME_TELEMETRY_DEPTH], 2.5f);
+    framePutU16(&telemetry[FRAME_TELEMETRY_PULSES + 14], 1520);
+    size = frameEncode(FRAME_TELEMETRY, 255, telemetry, stream);
+    size += frameEncode(FRAME_TELEMETRY, 0, telemetry, &stream[size]);
+
+    success &= check("Telemetry frame is 42 bytes", size == 2 * 42);
+    success &= check("Telemetry round trip", decode(decoder, stream, size) == 2 && decoder.seq == 0 &&
+                     frameGetU32(&decoder.payload[FRAME_TELEMETRY_TIME]) == 0xDEADBEEF &&
+                     frameGetFloat(&decoder.payload[FRAME_TELEMETRY_DEPTH]) == 2.5f &&
+                     frameGetU16(&decoder.payload[FRAME_TELEMETRY_PULSES + 14]) == 1520);
+  }
+
+  return success ? 0 : 1;
+}
@@ -0,0 +1,271 @@
+/*
+ * R@M 2017
+ *
+ * Plays the part of the host computer. Connects to tiqu over UART0 the same
+ * way qscu does, times round trips of the common requests, then times a bare
+ * queue hand off between two tasks to show how much of that is the RTOS.
+ */
+
+#ifdef SIM_BENCHMARK
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <inc/hw_memmap.h>
+
+#include "sim.h"
+#include <queue.h>
+#include "lib/include/trace.h"
+#include "tasks/include/thruster_task.h"
+
+#include "qubobus.h"
+#include "io.h"
+
+// Round trips timed for each request
+#define BENCH_ITERATIONS 200
+
+// qubobus_test blinks the led for half a second before it answers a status
+// request, so fewer of those
+#define BENCH_STATUS_ITERATIONS 10
+
+// Same as the host side gives the Tiva
+#define BENCH_READ_TIMEOUT pdMS_TO_TICKS(READ_TIMEOUT_MSEC)
+
+#define BENCH_PRIORITY (tskIDLE_PRIORITY + 2)
+
+struct Bench_Host {
+	struct Sim_Wire *to_device;
+	struct Sim_Wire *from_device;
+	uint32_t bytes;
+};
+
+struct Bench_Result {
+	uint32_t min;
+	uint32_t max;
+	uint64_t total;
+	uint32_t count;
+	uint32_t bytes;
+};
+
+static struct Bench_Host host;
+
+static QueueHandle_t ping_queue;
+static QueueHandle_t pong_queue;
+
+static ssize_t bench_read(void *io_host, void *buffer, size_t size) {
+	struct Bench_Host *bench = io_host;
+	size_t n;
+
+	while ((n = sim_wire_read(bench->from_device, buffer, size)) == 0) {
+		if (ulTaskNotifyTake(pdTRUE, BENCH_READ_TIMEOUT) == 0 && bench->from_device->count == 0) {
+			return -1;
+		}
+	}
+	bench->bytes += n;
+	return n;
+}
+
+static ssize_t bench_write(void *io_host, void *buffer, size_t size) {
+	struct Bench_Host *bench = io_host;
+	size_t n;
+
+	while ((n = sim_wire_write(bench->to_device, buffer, size)) == 0) {
+		vTaskDelay(1);
+	}
+	bench->bytes += n;
+	return n;
+}
+
+static void record(struct Bench_Result *result, uint32_t start) {
+	uint32_t elapsed = sim_time_us() - start;
+
+	if (result->count == 0 || elapsed < result->min) {
+		result->min = elapsed;
+	}
+	if (elapsed > result->max) {
+		result->max = elapsed;
+	}
+	result->total += elapsed;
+	result->count++;
+}
+
+static void report(const char *name, struct Bench_Result *result, uint32_t wall_us) {
+	if (result->count == 0) {
+		printf("%-16s failed\n", name);
+		return;
+	}
+	printf("%-16s %8u %8u %8u %10.1f %10.1f\n", name,
+		   result->min, (uint32_t)(result->total / result->count), result->max,
+		   result->count * 1e6 / wall_us, result->bytes * 1e6 / wall_us);
+}
+
+// Sends one request and waits for its response, false if anything went wrong
+static bool round_trip(IO_State *state, const Transaction *transaction, void *payload, void *buffer) {
+	Message request = create_request(transaction, payload);
+	Message response;
+
+	if (write_message(state, &request) || read_message(state, &response, buffer)) {
+		return false;
+	}
+	return response.header.message_type == MT_RESPONSE &&
+		response.header.message_id == transaction->id;
+}
+
+static bool keep_alive(IO_State *state, void *buffer) {
+	Message message = create_keep_alive();
+
+	if (write_message(state, &message) || read_message(state, &message, buffer)) {
+		return false;
+	}
+	return message.header.message_type == MT_KEEPALIVE;
+}
+
+static void bench_qubobus(IO_State *state) {
+	static char buffer[QUBOBUS_MAX_PAYLOAD_LENGTH];
+	struct Bench_Result results[4] = {{0}};
+	const char *names[4] = {"keepalive", "embedded status", "thruster set x8", "runtime stats"};
+	uint32_t wall[4];
+	uint8_t test;
+	int i;
+
+	printf("\n%-16s %8s %8s %8s %10s %10s\n", "request", "min us", "avg us", "max us", "msg/s", "bytes/s");
+
+	for (test = 0; test < 4; test++) {
+		uint32_t start_bytes = host.bytes;
+		uint32_t wall_start = sim_time_us();
+		int iterations = (test == 1) ? BENCH_STATUS_ITERATIONS : BENCH_ITERATIONS;
+
+		for (i = 0; i < iterations; i++) {
+			uint32_t start = sim_time_us();
+			bool ok = true;
+
+			switch (test) {
+			case 0:
+				ok = keep_alive(state, buffer);
+				break;
+			case 1:
+				ok = round_trip(state, &tEmbeddedStatus, NULL, buffer);
+				break;
+			case 2: {
+				struct Thruster_Set t_s;
+				for (t_s.thruster_id = 0; ok && t_s.thruster_id < THRUSTER_COUNT; t_s.thruster_id++) {
+					t_s.throttle = (i % 2) ? 0.5f : -0.5f;
+					ok = round_trip(state, &tThrusterSet, &t_s, buffer);
+				}
+				break;
+			}
+			case 3:
+				ok = round_trip(state, &tDebugRuntimeStats, NULL, buffer);
+				break;
+			}
+
+			if (!ok) {
+				printf("sim: %s failed on iteration %d\n", names[test], i);
+				break;
+			}
+			record(&results[test], start);
+		}
+
+		wall[test] = sim_time_us() - wall_start;
+		results[test].bytes = host.bytes - start_bytes;
+		report(names[test], &results[test], wall[test] ? wall[test] : 1);
+	}
+}
+
+static void pong_task(void *params) {
+	uint32_t stamp;
+
+	for (;;) {
+		xQueueReceive(ping_queue, &stamp, portMAX_DELAY);
+		xQueueSend(pong_queue, &stamp, portMAX_DELAY);
+	}
+}
+
+// Time for a message to go to another task and back, with nothing else to do
+static void bench_queue(void) {
+	struct Bench_Result result = {0};
+	uint32_t stamp;
+	int i;
+
+	for (i = 0; i < BENCH_ITERATIONS * 10; i++) {
+		stamp = sim_time_us();
+		xQueueSend(ping_queue, &stamp, portMAX_DELAY);
+		xQueueReceive(pong_queue, &stamp, portMAX_DELAY);
+		record(&result, stamp);
+	}
+
+	printf("\n%-16s %8u %8u %8u\n", "queue ping pong",
+		   result.min, (uint32_t)(result.total / result.count), result.max);
+}
+
+static void print_stats(void) {
+	static struct Runtime_Stats stats;
+	uint8_t *pca9685 = sim_i2c_registers(THRUSTER_I2C_DEVICE, THRUSTER_PCA9685_ADDRESS);
+	uint8_t i;
+
+	trace_runtime_stats(&stats);
+
+	printf("\n%-12s %8s %6s\n", "task", "cpu %", "stack");
+	for (i = 0; i < stats.num_tasks; i++) {
+		printf("%-12.*s %7.2f%% %6u\n", DEBUG_TASK_NAME_LENGTH, stats.tasks[i].name,
+			   stats.total_run_time ? 100.0 * stats.tasks[i].run_time / stats.total_run_time : 0.0,
+			   stats.tasks[i].stack_high_water);
+	}
+
+	printf("\n%-8s %10s\n", "queue", "high water");
+	for (i = 1; i < DEBUG_MAX_QUEUES; i++) {
+		if (stats.queue_high_water[i]) {
+			printf("%-8d %10u\n", i, stats.queue_high_water[i]);
+		}
+	}
+
+	// LEDn_OFF_L/H of each thruster channel, four registers per channel from 0x06
+	printf("\nthruster pwm off ticks:");
+	for (i = 0; i < THRUSTER_COUNT; i++) {
+		uint8_t *off = &pca9685[0x06 + 4 * (THRUSTER_FIRST_CHANNEL + i) + 2];
+		printf(" %u", off[0] | ((off[1] & 0x0F) << 8));
+	}
+	printf("\n");
+}
+
+static void bench_task(void *params) {
+	static char buffer[QUBOBUS_MAX_PAYLOAD_LENGTH];
+	IO_State state;
+
+	host.from_device->reader = xTaskGetCurrentTaskHandle();
+
+	// Let the firmware tasks get going first
+	vTaskDelay(pdMS_TO_TICKS(100));
+
+	state = initialize(&host, bench_read, bench_write, 10);
+	if (init_connect(&state, buffer)) {
+		printf("sim: unable to connect to tiqu\n");
+		exit(1);
+	}
+
+	bench_qubobus(&state);
+	bench_queue();
+	print_stats();
+
+	fflush(stdout);
+	exit(0);
+}
+
+void bench_init(struct Sim_Wire *to_device, struct Sim_Wire *from_device) {
+	host.to_device = to_device;
+	host.from_device = from_device;
+
+	ping_queue = xQueueCreate(1, sizeof(uint32_t));
+	pong_queue = xQueueCreate(1, sizeof(uint32_t));
+
+	if (ping_queue == NULL || pong_queue == NULL ||
+		xTaskCreate(bench_task, (const portCHAR *) "Bench", configMINIMAL_STACK_SIZE * 4, NULL,
+					BENCH_PRIORITY, NULL) != pdTRUE ||
+		xTaskCreate(pong_task, (const portCHAR *) "Pong", configMINIMAL_STACK_SIZE, NULL,
+					BENCH_PRIORITY, NULL) != pdTRUE) {
+		fprintf(stderr, "sim: unable to create the benchmark tasks\n");
+		exit(1);
+	}
+}
+
+#endif
@@ -0,0 +1,68 @@
+/*
+ * R@M 2017
+ *
+ * Stands in for TivaWare's driverlib/rom.h in the simulator build. Every ROM_
+ * call the firmware makes goes to the driverlib function of the same name,
+ * which sim/ implements against the simulated peripherals instead of the
+ * TivaWare sources.
+ */
+
+#ifndef _SIM_ROM_H_
+#define _SIM_ROM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <driverlib/fpu.h>
+#include <driverlib/gpio.h>
+#include <driverlib/i2c.h>
+#include <driverlib/interrupt.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/timer.h>
+#include <driverlib/uart.h>
+
+#define ROM_FPUEnable                    FPUEnable
+#define ROM_FPULazyStackingEnable        FPULazyStackingEnable
+#define ROM_GPIOPinConfigure             GPIOPinConfigure
+#define ROM_GPIOPinTypeGPIOOutput        GPIOPinTypeGPIOOutput
+#define ROM_GPIOPinTypeI2C               GPIOPinTypeI2C
+#define ROM_GPIOPinTypeI2CSCL            GPIOPinTypeI2CSCL
+#define ROM_GPIOPinTypeUART              GPIOPinTypeUART
+#define ROM_GPIOPinWrite                 GPIOPinWrite
+#define ROM_I2CMasterBusy                I2CMasterBusy
+#define ROM_I2CMasterControl             I2CMasterControl
+#define ROM_I2CMasterDataGet             I2CMasterDataGet
+#define ROM_I2CMasterDataPut             I2CMasterDataPut
+#define ROM_I2CMasterInitExpClk          I2CMasterInitExpClk
+#define ROM_I2CMasterIntClear            I2CMasterIntClear
+#define ROM_I2CMasterIntEnableEx         I2CMasterIntEnableEx
+#define ROM_I2CMasterSlaveAddrSet        I2CMasterSlaveAddrSet
+#define ROM_IntDisable                   IntDisable
+#define ROM_IntEnable                    IntEnable
+#define ROM_IntMasterEnable              IntMasterEnable
+#define ROM_IntPrioritySet               IntPrioritySet
+#define ROM_SysCtlClockGet               SysCtlClockGet
+#define ROM_SysCtlClockSet               SysCtlClockSet
+#define ROM_SysCtlDelay                  SysCtlDelay
+#define ROM_SysCtlPeripheralEnable       SysCtlPeripheralEnable
+#define ROM_SysCtlPeripheralReady        SysCtlPeripheralReady
+#define ROM_TimerConfigure               TimerConfigure
+#define ROM_TimerEnable                  TimerEnable
+#define ROM_TimerIntClear                TimerIntClear
+#define ROM_TimerIntEnable               TimerIntEnable
+#define ROM_TimerLoadSet                 TimerLoadSet
+#define ROM_TimerPrescaleSet             TimerPrescaleSet
+#define ROM_UARTCharGetNonBlocking       UARTCharGetNonBlocking
+#define ROM_UARTCharPutNonBlocking       UARTCharPutNonBlocking
+#define ROM_UARTCharsAvail               UARTCharsAvail
+#define ROM_UARTClockSourceSet           UARTClockSourceSet
+#define ROM_UARTConfigSetExpClk          UARTConfigSetExpClk
+#define ROM_UARTEnable                   UARTEnable
+#define ROM_UARTFIFOEnable               UARTFIFOEnable
+#define ROM_UARTFIFOLevelSet             UARTFIFOLevelSet
+#define ROM_UARTIntClear                 UARTIntClear
+#define ROM_UARTIntDisable               UARTIntDisable
+#define ROM_UARTIntEnable                UARTIntEnable
+#define ROM_UARTIntStatus                UARTIntStatus
+#define ROM_UARTSpaceAvail               UARTSpaceAvail
+
+#endif
@@ -0,0 +1,87 @@
+/*
+ * R@M 2017
+ *
+ * Simulated TM4C123 peripherals for running the firmware tasks on Linux
+ * against the FreeRTOS POSIX port.
+ *
+ * A single highest priority task stands in for the hardware. Every tick it
+ * moves bytes between the UART FIFOs and whatever is on the other end of the
+ * wire, finishes I2C transfers, advances the timers, and calls the firmware's
+ * own interrupt handlers for anything that would have raised an interrupt.
+ * Byte rates follow the configured baud rate and I2C speed, so queue depths
+ * and protocol timing look like they do on the board.
+ */
+
+#ifndef _SIM_H_
+#define _SIM_H_
+
+// FreeRTOS
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SIM_HARDWARE_PRIORITY (configMAX_PRIORITIES - 1)
+
+// Bytes that can be in flight on a simulated wire in each direction
+#define SIM_WIRE_LENGTH 4096
+
+/*
+ * One direction of a serial line between a simulated UART and whatever it is
+ * connected to.
+ */
+struct Sim_Wire {
+	uint8_t data[SIM_WIRE_LENGTH];
+	uint32_t head;
+	uint32_t count;
+
+	// Woken whenever bytes are added, if set
+	TaskHandle_t reader;
+};
+
+size_t sim_wire_write(struct Sim_Wire *wire, const uint8_t *data, size_t size);
+size_t sim_wire_read(struct Sim_Wire *wire, uint8_t *data, size_t size);
+
+/**
+ * @return microseconds since the simulator started, wraps like the trace timer
+ */
+uint32_t sim_time_us(void);
+
+/**
+ * Creates the hardware task and connects UART0 to a pty, or to the benchmark
+ * when built with SIM_BENCHMARK. Called by main just before the scheduler starts.
+ */
+void sim_init(void);
+
+/**
+ * Runs the handler for interrupt if it is enabled, as if it had fired
+ */
+void sim_raise_interrupt(uint32_t interrupt);
+
+// Called by the hardware task once a tick
+void sim_uart_tick(void);
+void sim_i2c_tick(void);
+void sim_timer_tick(void);
+
+/**
+ * Connects the far end of a UART. to_device carries bytes into the UART's
+ * receive FIFO, from_device takes what it transmits.
+ */
+void sim_uart_connect(uint32_t base, struct Sim_Wire *to_device, struct Sim_Wire *from_device);
+
+/**
+ * @return the register file of the simulated device at address on an I2C bus
+ */
+uint8_t *sim_i2c_registers(uint32_t base, uint8_t address);
+
+#ifdef SIM_BENCHMARK
+/**
+ * Creates the benchmark tasks, which drive tiqu over UART0 and report
+ * throughput and latency
+ */
+void bench_init(struct Sim_Wire *to_device, struct Sim_Wire *from_device);
+#endif
+
+#endif
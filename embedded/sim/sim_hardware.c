@@ -0,0 +1,221 @@
+/*
+ * R@M 2017
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <inc/hw_ints.h>
+#include <inc/hw_memmap.h>
+#include <driverlib/rom.h>
+
+#include "sim.h"
+
+#include "interrupts/include/uart0_interrupt.h"
+#include "interrupts/include/uart1_interrupt.h"
+#include "interrupts/include/i2c0_interrupt.h"
+#include "interrupts/include/timer1_interrupt.h"
+
+// The interrupts the firmware has handlers for, same as the vector table in
+// startup_gcc.c
+static const struct {
+	uint32_t interrupt;
+	void (*handler)(void);
+} vectors[] = {
+	{INT_UART0, UART0IntHandler},
+	{INT_UART1, UART1IntHandler},
+	{INT_I2C0, I2C0IntHandler},
+	{INT_TIMER1A, Timer1AIntHandler},
+};
+
+static bool enabled[NUM_INTERRUPTS];
+static bool master_enabled = false;
+
+static struct timespec start;
+
+// UART0 is bridged to a pty unless the benchmark is driving it
+static struct Sim_Wire uart0_in;
+static struct Sim_Wire uart0_out;
+static int pty = -1;
+
+size_t sim_wire_write(struct Sim_Wire *wire, const uint8_t *data, size_t size) {
+	size_t i;
+
+	taskENTER_CRITICAL();
+	for (i = 0; i < size && wire->count < SIM_WIRE_LENGTH; i++) {
+		wire->data[(wire->head + wire->count) % SIM_WIRE_LENGTH] = data[i];
+		wire->count++;
+	}
+	taskEXIT_CRITICAL();
+
+	if (i > 0 && wire->reader != NULL) {
+		xTaskNotifyGive(wire->reader);
+	}
+	return i;
+}
+
+size_t sim_wire_read(struct Sim_Wire *wire, uint8_t *data, size_t size) {
+	size_t i;
+
+	taskENTER_CRITICAL();
+	for (i = 0; i < size && wire->count > 0; i++) {
+		data[i] = wire->data[wire->head];
+		wire->head = (wire->head + 1) % SIM_WIRE_LENGTH;
+		wire->count--;
+	}
+	taskEXIT_CRITICAL();
+
+	return i;
+}
+
+uint32_t sim_time_us(void) {
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint32_t)((now.tv_sec - start.tv_sec) * 1000000 + (now.tv_nsec - start.tv_nsec) / 1000);
+}
+
+void sim_raise_interrupt(uint32_t interrupt) {
+	uint8_t i;
+
+	if (!master_enabled || interrupt >= NUM_INTERRUPTS || !enabled[interrupt]) {
+		return;
+	}
+	for (i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+		if (vectors[i].interrupt == interrupt) {
+			vectors[i].handler();
+			return;
+		}
+	}
+}
+
+// Moves bytes between the pty and UART0's wires
+static void pty_tick(void) {
+	uint8_t buffer[256];
+	ssize_t n;
+
+	n = read(pty, buffer, sizeof(buffer));
+	if (n > 0) {
+		sim_wire_write(&uart0_in, buffer, n);
+	}
+
+	// Peek rather than read so nothing is lost if the pty is full
+	while (uart0_out.count > 0) {
+		uint32_t contiguous = SIM_WIRE_LENGTH - uart0_out.head;
+		if (contiguous > uart0_out.count) {
+			contiguous = uart0_out.count;
+		}
+		n = write(pty, &uart0_out.data[uart0_out.head], contiguous);
+		if (n <= 0) {
+			break;
+		}
+		taskENTER_CRITICAL();
+		uart0_out.head = (uart0_out.head + n) % SIM_WIRE_LENGTH;
+		uart0_out.count -= n;
+		taskEXIT_CRITICAL();
+	}
+}
+
+static void open_pty(void) {
+	pty = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+	if (pty < 0 || grantpt(pty) || unlockpt(pty)) {
+		perror("sim: unable to open a pty for UART0");
+		exit(1);
+	}
+	printf("sim: UART0 is on %s\n", ptsname(pty));
+	fflush(stdout);
+}
+
+static void sim_hardware_task(void *params) {
+	TickType_t last = xTaskGetTickCount();
+
+	for (;;) {
+		vTaskDelayUntil(&last, 1);
+
+		if (pty >= 0) {
+			pty_tick();
+		}
+		sim_uart_tick();
+		sim_i2c_tick();
+		sim_timer_tick();
+	}
+}
+
+void sim_init(void) {
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	sim_uart_connect(UART0_BASE, &uart0_in, &uart0_out);
+
+#ifdef SIM_BENCHMARK
+	bench_init(&uart0_in, &uart0_out);
+#else
+	open_pty();
+#endif
+
+	if (xTaskCreate(sim_hardware_task, (const portCHAR *) "Sim Hardware", configMINIMAL_STACK_SIZE, NULL,
+					SIM_HARDWARE_PRIORITY, NULL) != pdTRUE) {
+		fprintf(stderr, "sim: unable to create the hardware task\n");
+		exit(1);
+	}
+}
+
+// ***************************************************************************
+// Core peripherals. Clocks, pin muxing and the FPU need no simulation.
+// ***************************************************************************
+
+void FPUEnable(void) {}
+
+void FPULazyStackingEnable(void) {}
+
+bool IntMasterEnable(void) {
+	bool was_disabled = !master_enabled;
+	master_enabled = true;
+	return was_disabled;
+}
+
+void IntEnable(uint32_t ui32Interrupt) {
+	if (ui32Interrupt < NUM_INTERRUPTS) {
+		enabled[ui32Interrupt] = true;
+	}
+}
+
+void IntDisable(uint32_t ui32Interrupt) {
+	if (ui32Interrupt < NUM_INTERRUPTS) {
+		enabled[ui32Interrupt] = false;
+	}
+}
+
+// Handlers run one at a time from the hardware task, so priorities don't matter
+void IntPrioritySet(uint32_t ui32Interrupt, uint8_t ui8Priority) {}
+
+void SysCtlClockSet(uint32_t ui32Config) {}
+
+uint32_t SysCtlClockGet(void) {
+	return configCPU_CLOCK_HZ;
+}
+
+void SysCtlDelay(uint32_t ui32Count) {}
+
+void SysCtlPeripheralEnable(uint32_t ui32Peripheral) {}
+
+bool SysCtlPeripheralReady(uint32_t ui32Peripheral) {
+	return true;
+}
+
+void GPIOPinConfigure(uint32_t ui32PinConfig) {}
+
+void GPIOPinTypeGPIOOutput(uint32_t ui32Port, uint8_t ui8Pins) {}
+
+void GPIOPinTypeI2C(uint32_t ui32Port, uint8_t ui8Pins) {}
+
+void GPIOPinTypeI2CSCL(uint32_t ui32Port, uint8_t ui8Pins) {}
+
+void GPIOPinTypeUART(uint32_t ui32Port, uint8_t ui8Pins) {}
+
+// The only outputs are the RGB led, which nothing needs to see
+void GPIOPinWrite(uint32_t ui32Port, uint8_t ui8Pins, uint8_t ui8Val) {}
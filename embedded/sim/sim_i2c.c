@@ -0,0 +1,136 @@
+/*
+ * R@M 2017
+ */
+
+#include <inc/hw_ints.h>
+#include <inc/hw_memmap.h>
+#include <driverlib/rom.h>
+
+#include "sim.h"
+
+// Bits of the I2C_MASTER_CMD_ values
+#define CMD_RUN   0x01
+#define CMD_START 0x02
+#define CMD_STOP  0x04
+
+// Every address on the bus answers as a 256 byte register file. The first
+// byte written after a start sets the register pointer, which then advances
+// with each byte read or written. That's how the PCA9685, BME280 and the
+// rest of the parts the firmware talks to behave.
+struct Sim_I2C {
+	uint32_t base;
+	uint32_t interrupt;
+
+	uint8_t registers[128][256];
+	uint8_t pointer[128];
+
+	uint8_t address;
+	bool receive;
+	bool pointer_written;
+
+	uint8_t data;
+	bool int_enabled;
+	// A transfer finished and the interrupt hasn't been raised for it yet
+	bool int_pending;
+
+	// Bytes the bus can carry in one tick at the configured speed
+	uint32_t bytes_per_tick;
+};
+
+static struct Sim_I2C buses[] = {
+	{.base = I2C0_BASE, .interrupt = INT_I2C0},
+	{.base = I2C3_BASE, .interrupt = INT_I2C3},
+};
+
+static struct Sim_I2C *find_bus(uint32_t base) {
+	uint8_t i;
+
+	for (i = 0; i < sizeof(buses) / sizeof(buses[0]); i++) {
+		if (buses[i].base == base) {
+			return &buses[i];
+		}
+	}
+	return NULL;
+}
+
+uint8_t *sim_i2c_registers(uint32_t base, uint8_t address) {
+	return find_bus(base)->registers[address & 0x7F];
+}
+
+void sim_i2c_tick(void) {
+	uint8_t i;
+
+	for (i = 0; i < sizeof(buses) / sizeof(buses[0]); i++) {
+		struct Sim_I2C *bus = &buses[i];
+		uint32_t budget = bus->bytes_per_tick;
+
+		// The handler usually starts the next byte, so keep going until the
+		// bus has carried as much as it could have
+		while (budget > 0 && bus->int_pending) {
+			bus->int_pending = false;
+			budget--;
+			if (bus->int_enabled) {
+				sim_raise_interrupt(bus->interrupt);
+			}
+		}
+	}
+}
+
+// ***************************************************************************
+// driverlib/i2c.h
+// ***************************************************************************
+
+void I2CMasterInitExpClk(uint32_t ui32Base, uint32_t ui32I2CClk, bool bFast) {
+	// 9 clocks per byte with the ack
+	find_bus(ui32Base)->bytes_per_tick = (bFast ? 400000 : 100000) / 9 / configTICK_RATE_HZ;
+}
+
+void I2CMasterIntEnableEx(uint32_t ui32Base, uint32_t ui32IntFlags) {
+	find_bus(ui32Base)->int_enabled = true;
+}
+
+void I2CMasterIntClear(uint32_t ui32Base) {}
+
+void I2CMasterSlaveAddrSet(uint32_t ui32Base, uint8_t ui8SlaveAddr, bool bReceive) {
+	struct Sim_I2C *bus = find_bus(ui32Base);
+
+	bus->address = ui8SlaveAddr & 0x7F;
+	bus->receive = bReceive;
+}
+
+void I2CMasterDataPut(uint32_t ui32Base, uint8_t ui8Data) {
+	find_bus(ui32Base)->data = ui8Data;
+}
+
+uint32_t I2CMasterDataGet(uint32_t ui32Base) {
+	return find_bus(ui32Base)->data;
+}
+
+// Transfers finish as soon as they're started, the tick decides when the
+// firmware hears about it
+bool I2CMasterBusy(uint32_t ui32Base) {
+	return false;
+}
+
+void I2CMasterControl(uint32_t ui32Base, uint32_t ui32Cmd) {
+	struct Sim_I2C *bus = find_bus(ui32Base);
+	uint8_t *pointer = &bus->pointer[bus->address];
+
+	if (ui32Cmd & CMD_START) {
+		bus->pointer_written = false;
+	}
+
+	if (ui32Cmd & CMD_RUN) {
+		if (bus->receive) {
+			bus->data = bus->registers[bus->address][*pointer];
+			(*pointer)++;
+		} else if (!bus->pointer_written) {
+			*pointer = bus->data;
+			bus->pointer_written = true;
+		} else {
+			bus->registers[bus->address][*pointer] = bus->data;
+			(*pointer)++;
+		}
+		bus->int_pending = true;
+	}
+}
@@ -0,0 +1,90 @@
+/*
+ * R@M 2017
+ */
+
+#include <inc/hw_ints.h>
+#include <inc/hw_memmap.h>
+#include <driverlib/rom.h>
+
+#include "sim.h"
+
+// Only timer A of each timer is modelled, which is all the firmware uses
+struct Sim_Timer {
+	uint32_t base;
+	uint32_t interrupt;
+
+	uint32_t load;
+	uint32_t prescale;
+	uint32_t int_mask;
+	bool enabled;
+
+	// Clock cycles since the timer last timed out
+	uint64_t cycles;
+};
+
+static struct Sim_Timer timers[] = {
+	{.base = TIMER1_BASE, .interrupt = INT_TIMER1A},
+	// Free running for trace.c, which reads sim_time_us() instead
+	{.base = WTIMER5_BASE, .interrupt = INT_WTIMER5A},
+};
+
+static struct Sim_Timer *find_timer(uint32_t base) {
+	uint8_t i;
+
+	for (i = 0; i < sizeof(timers) / sizeof(timers[0]); i++) {
+		if (timers[i].base == base) {
+			return &timers[i];
+		}
+	}
+	return NULL;
+}
+
+void sim_timer_tick(void) {
+	uint8_t i;
+
+	for (i = 0; i < sizeof(timers) / sizeof(timers[0]); i++) {
+		struct Sim_Timer *timer = &timers[i];
+		uint64_t period = ((uint64_t)timer->load + 1) * ((uint64_t)timer->prescale + 1);
+
+		if (!timer->enabled) {
+			continue;
+		}
+
+		timer->cycles += configCPU_CLOCK_HZ / configTICK_RATE_HZ;
+		while (timer->cycles >= period) {
+			timer->cycles -= period;
+			if (timer->int_mask & TIMER_TIMA_TIMEOUT) {
+				sim_raise_interrupt(timer->interrupt);
+			}
+		}
+	}
+}
+
+// ***************************************************************************
+// driverlib/timer.h
+// ***************************************************************************
+
+void TimerConfigure(uint32_t ui32Base, uint32_t ui32Config) {
+	struct Sim_Timer *timer = find_timer(ui32Base);
+
+	timer->enabled = false;
+	timer->cycles = 0;
+}
+
+void TimerLoadSet(uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Value) {
+	find_timer(ui32Base)->load = ui32Value;
+}
+
+void TimerPrescaleSet(uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Value) {
+	find_timer(ui32Base)->prescale = ui32Value;
+}
+
+void TimerIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags) {
+	find_timer(ui32Base)->int_mask |= ui32IntFlags;
+}
+
+void TimerIntClear(uint32_t ui32Base, uint32_t ui32IntFlags) {}
+
+void TimerEnable(uint32_t ui32Base, uint32_t ui32Timer) {
+	find_timer(ui32Base)->enabled = true;
+}
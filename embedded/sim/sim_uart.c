@@ -0,0 +1,181 @@
+/*
+ * R@M 2017
+ */
+
+#include <inc/hw_ints.h>
+#include <inc/hw_memmap.h>
+#include <driverlib/rom.h>
+
+#include "sim.h"
+
+// Depth of the hardware FIFOs on the TM4C123
+#define FIFO_LENGTH 16
+
+struct Sim_UART {
+	uint32_t base;
+	uint32_t interrupt;
+
+	uint8_t rx[FIFO_LENGTH];
+	uint8_t rx_head;
+	uint8_t rx_count;
+
+	uint8_t tx[FIFO_LENGTH];
+	uint8_t tx_head;
+	uint8_t tx_count;
+
+	uint32_t int_mask;
+	uint32_t baud;
+
+	struct Sim_Wire *to_device;
+	struct Sim_Wire *from_device;
+};
+
+static struct Sim_UART uarts[] = {
+	{.base = UART0_BASE, .interrupt = INT_UART0},
+	{.base = UART1_BASE, .interrupt = INT_UART1},
+};
+
+static struct Sim_UART *find_uart(uint32_t base) {
+	uint8_t i;
+
+	for (i = 0; i < sizeof(uarts) / sizeof(uarts[0]); i++) {
+		if (uarts[i].base == base) {
+			return &uarts[i];
+		}
+	}
+	return NULL;
+}
+
+void sim_uart_connect(uint32_t base, struct Sim_Wire *to_device, struct Sim_Wire *from_device) {
+	struct Sim_UART *uart = find_uart(base);
+
+	uart->to_device = to_device;
+	uart->from_device = from_device;
+}
+
+static void uart_tick(struct Sim_UART *uart) {
+	// 10 bits on the line for each 8N1 byte
+	uint32_t budget = uart->baud / 10 / configTICK_RATE_HZ;
+	uint32_t rx_budget = budget;
+	uint32_t tx_budget = budget;
+
+	if (uart->to_device == NULL || uart->from_device == NULL || uart->baud == 0) {
+		return;
+	}
+
+	// Receive: fill the FIFO and let the handler empty it, as many times as
+	// the baud rate allows this tick
+	while (rx_budget > 0 && uart->to_device->count > 0) {
+		while (rx_budget > 0 && uart->rx_count < FIFO_LENGTH &&
+			   sim_wire_read(uart->to_device, &uart->rx[(uart->rx_head + uart->rx_count) % FIFO_LENGTH], 1)) {
+			uart->rx_count++;
+			rx_budget--;
+		}
+		if (!(uart->int_mask & (UART_INT_RX | UART_INT_RT))) {
+			break;
+		}
+		sim_raise_interrupt(uart->interrupt);
+		if (uart->rx_count == FIFO_LENGTH) {
+			// Nobody emptied it, the next bytes would overrun
+			break;
+		}
+	}
+
+	// Transmit: drain the FIFO onto the wire, asking for more while there's room
+	while (tx_budget > 0) {
+		while (tx_budget > 0 && uart->tx_count > 0) {
+			sim_wire_write(uart->from_device, &uart->tx[uart->tx_head], 1);
+			uart->tx_head = (uart->tx_head + 1) % FIFO_LENGTH;
+			uart->tx_count--;
+			tx_budget--;
+		}
+		if (!(uart->int_mask & UART_INT_TX)) {
+			break;
+		}
+		sim_raise_interrupt(uart->interrupt);
+		if (uart->tx_count == 0) {
+			break;
+		}
+	}
+}
+
+void sim_uart_tick(void) {
+	uint8_t i;
+
+	for (i = 0; i < sizeof(uarts) / sizeof(uarts[0]); i++) {
+		uart_tick(&uarts[i]);
+	}
+}
+
+// ***************************************************************************
+// driverlib/uart.h
+// ***************************************************************************
+
+void UARTClockSourceSet(uint32_t ui32Base, uint32_t ui32Source) {}
+
+void UARTConfigSetExpClk(uint32_t ui32Base, uint32_t ui32UARTClk,
+						 uint32_t ui32Baud, uint32_t ui32Config) {
+	find_uart(ui32Base)->baud = ui32Baud;
+}
+
+void UARTFIFOEnable(uint32_t ui32Base) {}
+
+void UARTFIFOLevelSet(uint32_t ui32Base, uint32_t ui32TxLevel, uint32_t ui32RxLevel) {}
+
+void UARTEnable(uint32_t ui32Base) {}
+
+void UARTIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags) {
+	find_uart(ui32Base)->int_mask |= ui32IntFlags;
+}
+
+void UARTIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags) {
+	find_uart(ui32Base)->int_mask &= ~ui32IntFlags;
+}
+
+uint32_t UARTIntStatus(uint32_t ui32Base, bool bMasked) {
+	struct Sim_UART *uart = find_uart(ui32Base);
+	uint32_t status = 0;
+
+	if (uart->rx_count > 0) {
+		status |= UART_INT_RX | UART_INT_RT;
+	}
+	if (uart->tx_count < FIFO_LENGTH) {
+		status |= UART_INT_TX;
+	}
+	return bMasked ? (status & uart->int_mask) : status;
+}
+
+// Status is worked out from the FIFOs, there's nothing latched to clear
+void UARTIntClear(uint32_t ui32Base, uint32_t ui32IntFlags) {}
+
+bool UARTCharsAvail(uint32_t ui32Base) {
+	return find_uart(ui32Base)->rx_count > 0;
+}
+
+int32_t UARTCharGetNonBlocking(uint32_t ui32Base) {
+	struct Sim_UART *uart = find_uart(ui32Base);
+	uint8_t c;
+
+	if (uart->rx_count == 0) {
+		return -1;
+	}
+	c = uart->rx[uart->rx_head];
+	uart->rx_head = (uart->rx_head + 1) % FIFO_LENGTH;
+	uart->rx_count--;
+	return c;
+}
+
+bool UARTSpaceAvail(uint32_t ui32Base) {
+	return find_uart(ui32Base)->tx_count < FIFO_LENGTH;
+}
+
+bool UARTCharPutNonBlocking(uint32_t ui32Base, unsigned char ucData) {
+	struct Sim_UART *uart = find_uart(ui32Base);
+
+	if (uart->tx_count == FIFO_LENGTH) {
+		return false;
+	}
+	uart->tx[(uart->tx_head + uart->tx_count) % FIFO_LENGTH] = ucData;
+	uart->tx_count++;
+	return true;
+}
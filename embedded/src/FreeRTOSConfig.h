@@ -73,9 +73,17 @@
 #define configCPU_CLOCK_HZ                  ( ( unsigned long ) 50000000 )
 #define configTICK_RATE_HZ                  ( ( uint32_t ) 1000 )
 #define configMINIMAL_STACK_SIZE            ( ( unsigned short ) 200 )
-#define configTOTAL_HEAP_SIZE               ( ( size_t ) ( 10240 ) )
+/* Everything main() creates comes out of this, about 12.3 KB on the Tiva:
+ * task stacks and TCBs (tiqu 4.2 KB, qubobus test 2.2 KB, thrusters and
+ * BME280 1.1 KB each, idle 0.9 KB), the UART queues (1.4 KB), the mutexes and
+ * task queues (1 KB) and the I2C globals (0.4 KB). The rest is for the
+ * qubobus payloads tiqu allocates per message. Recheck this when adding a
+ * task, main() hangs if one can't be created.
+ */
+#define configTOTAL_HEAP_SIZE               ( ( size_t ) ( 16384 ) )
 #define configMAX_TASK_NAME_LEN             ( 12 )
-#define configUSE_TRACE_FACILITY            0
+#define configUSE_TRACE_FACILITY            1
+#define configGENERATE_RUN_TIME_STATS       1
 #define configUSE_16_BIT_TICKS              0
 #define configIDLE_SHOULD_YIELD             1
 #define configUSE_CO_ROUTINES               0
@@ -87,6 +95,17 @@
 #define configMAX_CO_ROUTINE_PRIORITIES     ( 2 )
 #define configQUEUE_REGISTRY_SIZE           10
 
+/* The simulator (make sim) runs the tasks as pthreads. Stacks come out of the
+ * FreeRTOS heap and are counted in longs, and libc wants far more of them than
+ * anything on the Tiva does.
+ */
+#ifdef SIMULATOR
+#undef configMINIMAL_STACK_SIZE
+#undef configTOTAL_HEAP_SIZE
+#define configMINIMAL_STACK_SIZE            ( ( unsigned short ) 1024 )
+#define configTOTAL_HEAP_SIZE               ( ( size_t ) ( 1024 * 1024 ) )
+#endif
+
 /* Set the following definitions to 1 to include the API function, or zero
 to exclude the API function. */
 
@@ -105,6 +124,27 @@ to exclude the API function. */
 #define configKERNEL_INTERRUPT_PRIORITY         ( 7 << 5 )    /* Priority 7, or 0xE0 as only the top three bits are implemented.  This is the lowest priority. */
 #define configMAX_SYSCALL_INTERRUPT_PRIORITY     ( 5 << 5 )  /* Priority 5, or 0xA0 as only the top three bits are implemented. */
 
+/* Run time stats and the event trace ring, see src/lib/trace.c.  The trace
+ * hooks expand inside tasks.c and queue.c so they can see the private TCB and
+ * queue structures.  Queue numbers are handed out as queues are created so
+ * their high water marks can be told apart.
+ */
+#include <stdint.h>
+extern void trace_configure_timer(void);
+extern uint32_t trace_timestamp(void);
+extern void trace_task_switched_in(uint32_t task_number);
+extern uint32_t trace_register_queue(void);
+extern void trace_queue_level(uint32_t queue_number, uint32_t level);
+
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() trace_configure_timer()
+#define portGET_RUN_TIME_COUNTER_VALUE()         trace_timestamp()
+
+#define traceTASK_SWITCHED_IN()                  trace_task_switched_in( pxCurrentTCB->uxTCBNumber )
+#define traceQUEUE_CREATE( pxNewQueue )          ( ( pxNewQueue )->uxQueueNumber = trace_register_queue() )
+#define traceCREATE_MUTEX( pxNewQueue )          ( ( pxNewQueue )->uxQueueNumber = trace_register_queue() )
+#define traceQUEUE_SEND( pxQueue )               trace_queue_level( ( pxQueue )->uxQueueNumber, ( pxQueue )->uxMessagesWaiting + 1 )
+#define traceQUEUE_SEND_FROM_ISR( pxQueue )      trace_queue_level( ( pxQueue )->uxQueueNumber, ( pxQueue )->uxMessagesWaiting + 1 )
+
 /* I added this so we can tell when something isn't configured correctly
 *  a lot of the FreeRTOS libraries call this, if it's defined, and it'll let
 *  us know if something gets misconfigured.  For the actual robot build,
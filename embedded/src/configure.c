@@ -149,7 +149,9 @@ void configureI2C(void) {
   //
   // Initialize the I2C master.
   //
-  ROM_I2CMasterInitExpClk(I2C0_BASE, ROM_SysCtlClockGet(), false);
+  // I2C0 runs in fast mode (400kHz) so a full thruster update fits in one
+  // THRUSTER_UPDATE_HZ period
+  ROM_I2CMasterInitExpClk(I2C0_BASE, ROM_SysCtlClockGet(), true);
   ROM_I2CMasterInitExpClk(I2C3_BASE, ROM_SysCtlClockGet(), false);
 
   //
@@ -16,7 +16,8 @@
  */
 
 extern TaskHandle_t qubobus_test_handle;
+extern TaskHandle_t thruster_task_handle;
 
-#define DECLARE_TASK_HANDLES TaskHandle_t qubobus_test_handle /*, other_handle,...*/
+#define DECLARE_TASK_HANDLES TaskHandle_t qubobus_test_handle, thruster_task_handle /*, other_handle,...*/
 
 #endif
@@ -4,8 +4,11 @@
 */
 
 #include "interrupts/include/i2c0_interrupt.h"
+#include "lib/include/trace.h"
 
 void I2C0IntHandler(void) {
+    trace_isr_enter(TRACE_ISR_I2C0);
+
     // Clear the I2C interrupt.
     ROM_I2CMasterIntClear(I2C_DEVICE);
 
@@ -128,4 +131,6 @@ void I2C0IntHandler(void) {
         break;
       }
     }
+
+    trace_isr_exit(TRACE_ISR_I2C0);
 }
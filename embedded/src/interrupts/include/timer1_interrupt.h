@@ -0,0 +1,11 @@
+/*
+ * R@M 2017
+ */
+
+#ifndef _TIMER1_INTERRUPT_H_
+#define _TIMER1_INTERRUPT_H_
+
+// Paces the thruster output task
+void Timer1AIntHandler(void);
+
+#endif
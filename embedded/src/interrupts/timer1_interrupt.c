@@ -0,0 +1,23 @@
+/*
+ * R@M 2017
+ */
+
+#include "interrupts/include/timer1_interrupt.h"
+#include "tasks/include/thruster_task.h"
+#include "lib/include/trace.h"
+
+void Timer1AIntHandler(void) {
+    BaseType_t higher_priority_task_woken = pdFALSE;
+
+    trace_isr_enter(TRACE_ISR_TIMER1);
+
+    ROM_TimerIntClear(THRUSTER_TIMER_BASE, TIMER_TIMA_TIMEOUT);
+
+    // Ticks that arrive while the task is still writing the last update
+    // collapse into one, so a slow bus lowers the rate instead of queueing up
+    vTaskNotifyGiveFromISR(thruster_task_handle, &higher_priority_task_woken);
+
+    trace_isr_exit(TRACE_ISR_TIMER1);
+
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
@@ -16,11 +16,14 @@
 
 #include "interrupts/include/uart0_interrupt.h"
 #include "lib/include/uart_queue.h"
+#include "lib/include/trace.h"
 
 // Handle an interrupt triggered for UART0
 void UART0IntHandler(void) {
     volatile struct UART_Queue *queue = &uart0_queue;
 
+    trace_isr_enter(TRACE_ISR_UART0);
+
 	uint32_t status = ROM_UARTIntStatus(queue->hardware_base_address, true);
 
 	if( status & (UART_INT_RX | UART_INT_RT) ){
@@ -33,4 +36,5 @@ void UART0IntHandler(void) {
 
     ROM_UARTIntClear(queue->hardware_base_address, ( UART_INT_TX | UART_INT_RX | UART_INT_RT));
 
+    trace_isr_exit(TRACE_ISR_UART0);
 }
@@ -5,9 +5,12 @@
 
 // Queue for the UART interrupt
 #include "interrupts/include/uart1_interrupt.h"
+#include "lib/include/trace.h"
 
 // Interrupt for UART
 void UART1IntHandler(void) {
+  trace_isr_enter(TRACE_ISR_UART1);
+
   uint32_t status = ROM_UARTIntStatus(UART_DEVICE, true);
 
   // Clear interrupt
@@ -22,4 +25,6 @@ void UART1IntHandler(void) {
   uint8_t c = (uint8_t)(ROM_UARTCharGetNonBlocking(UART_DEVICE));
   // Push to the queue
   xQueueSendToBackFromISR(read_uart1_queue, &c, NULL);
+
+  trace_isr_exit(TRACE_ISR_UART1);
 }
@@ -47,8 +47,6 @@ bool bme280_begin(uint32_t device) {
 }
 
 float bme280_readTemperature(uint32_t device) {
-  int32_t var1, var2;
-
   uint8_t adc_T_ptr[3];
 
   // Zero this out so 3 bytes can properly be converted to a 32bit int
@@ -62,28 +60,15 @@ float bme280_readTemperature(uint32_t device) {
 
   adc_T >>= 4;
 
-  var1  = ((((adc_T>>3) - ((int32_t)_bme280_calib.dig_T1 <<1))) *
-           ((int32_t)_bme280_calib.dig_T2)) >> 11;
-
-  var2  = (((((adc_T>>4) - ((int32_t)_bme280_calib.dig_T1)) *
-             ((adc_T>>4) - ((int32_t)_bme280_calib.dig_T1))) >> 12) *
-           ((int32_t)_bme280_calib.dig_T3)) >> 14;
-
-  t_fine = var1 + var2;
-
-  float T  = (t_fine * 5 + 128) >> 8;
-  return T/100;
+  return _IQ16toF(compensate_bme280_temperature(&_bme280_calib, adc_T, &t_fine));
 }
 
 float bme280_readPressure(uint32_t device) {
-  int64_t var1, var2, p;
-
   bme280_readTemperature(device); // must be done first to get t_fine
 
   uint8_t adc_P_ptr[3];
   int32_t adc_P = 0;
 
-  uint8_t reg = BME280_REGISTER_PRESSUREDATA;
   readI2C(device, BME280_ADDRESS, BME280_REGISTER_PRESSUREDATA, adc_P_ptr, 3);
 
   // Make the 3 bytes into a 32 bit
@@ -91,24 +76,7 @@ float bme280_readPressure(uint32_t device) {
 
   adc_P >>= 4;
 
-  var1 = ((int64_t)t_fine) - 128000;
-  var2 = var1 * var1 * (int64_t)_bme280_calib.dig_P6;
-  var2 = var2 + ((var1*(int64_t)_bme280_calib.dig_P5)<<17);
-  var2 = var2 + (((int64_t)_bme280_calib.dig_P4)<<35);
-  var1 = ((var1 * var1 * (int64_t)_bme280_calib.dig_P3)>>8) +
-    ((var1 * (int64_t)_bme280_calib.dig_P2)<<12);
-  var1 = (((((int64_t)1)<<47)+var1))*((int64_t)_bme280_calib.dig_P1)>>33;
-
-  if (var1 == 0) {
-    return 0;  // avoid exception caused by division by zero
-  }
-  p = 1048576 - adc_P;
-  p = (((p<<31) - var2)*3125) / var1;
-  var1 = (((int64_t)_bme280_calib.dig_P9) * (p>>13) * (p>>13)) >> 25;
-  var2 = (((int64_t)_bme280_calib.dig_P8) * p) >> 19;
-
-  p = ((p + var1 + var2) >> 8) + (((int64_t)_bme280_calib.dig_P7)<<4);
-  return (float)p/256;
+  return _IQ8toF(compensate_bme280_pressure(&_bme280_calib, adc_P, t_fine));
 }
 
 float bme280_readHumidity(uint32_t device) {
@@ -123,23 +91,7 @@ float bme280_readHumidity(uint32_t device) {
   // Make the 2 bytes to a 32bit
   ARR_TO_16(adc_H, adc_H_ptr);
 
-  int32_t v_x1_u32r;
-
-  v_x1_u32r = (t_fine - ((int32_t)76800));
-
-  v_x1_u32r = (((((adc_H << 14) - (((int32_t)_bme280_calib.dig_H4) << 20) -
-                  (((int32_t)_bme280_calib.dig_H5) * v_x1_u32r)) + ((int32_t)16384)) >> 15) *
-               (((((((v_x1_u32r * ((int32_t)_bme280_calib.dig_H6)) >> 10) *
-                    (((v_x1_u32r * ((int32_t)_bme280_calib.dig_H3)) >> 11) + ((int32_t)32768))) >> 10) +
-                  ((int32_t)2097152)) * ((int32_t)_bme280_calib.dig_H2) + 8192) >> 14));
-
-  v_x1_u32r = (v_x1_u32r - (((((v_x1_u32r >> 15) * (v_x1_u32r >> 15)) >> 7) *
-                             ((int32_t)_bme280_calib.dig_H1)) >> 4));
-
-  v_x1_u32r = (v_x1_u32r < 0) ? 0 : v_x1_u32r;
-  v_x1_u32r = (v_x1_u32r > 419430400) ? 419430400 : v_x1_u32r;
-  float h = (v_x1_u32r>>12);
-  return  h / 1024.0;
+  return _IQ16toF(compensate_bme280_humidity(&_bme280_calib, adc_H, t_fine));
 }
 
 /**************************************************************************/
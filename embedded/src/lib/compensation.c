@@ -0,0 +1,257 @@
+/*
+ * R@M 2017
+ */
+
+#include "lib/include/compensation.h"
+
+_iq16 compensate_bme280_temperature(const bme280_calib_data *calib, int32_t adc_T, int32_t *t_fine) {
+  int32_t var1, var2;
+
+  var1  = ((((adc_T>>3) - ((int32_t)calib->dig_T1 <<1))) *
+           ((int32_t)calib->dig_T2)) >> 11;
+
+  var2  = (((((adc_T>>4) - ((int32_t)calib->dig_T1)) *
+             ((adc_T>>4) - ((int32_t)calib->dig_T1))) >> 12) *
+           ((int32_t)calib->dig_T3)) >> 14;
+
+  *t_fine = var1 + var2;
+
+  // t_fine is 5120ths of a degree
+  return (*t_fine * 64) / 5;
+}
+
+_iq8 compensate_bme280_pressure(const bme280_calib_data *calib, int32_t adc_P, int32_t t_fine) {
+  int32_t var1, var2;
+  uint32_t p;
+
+  var1 = (t_fine >> 1) - (int32_t)64000;
+  var2 = (((var1 >> 2) * (var1 >> 2)) >> 11) * ((int32_t)calib->dig_P6);
+  var2 = var2 + ((var1 * ((int32_t)calib->dig_P5)) << 1);
+  var2 = (var2 >> 2) + (((int32_t)calib->dig_P4) << 16);
+  var1 = (((calib->dig_P3 * (((var1 >> 2) * (var1 >> 2)) >> 13)) >> 3) +
+          ((((int32_t)calib->dig_P2) * var1) >> 1)) >> 18;
+  var1 = (((32768 + var1)) * ((int32_t)calib->dig_P1)) >> 15;
+
+  if (var1 == 0) {
+    return 0;  // avoid exception caused by division by zero
+  }
+
+  p = (((uint32_t)(((int32_t)1048576) - adc_P) - (var2 >> 12))) * 3125;
+  if (p < 0x80000000) {
+    p = (p << 1) / ((uint32_t)var1);
+  } else {
+    p = (p / (uint32_t)var1) * 2;
+  }
+
+  var1 = (((int32_t)calib->dig_P9) * ((int32_t)(((p >> 3) * (p >> 3)) >> 13))) >> 12;
+  var2 = (((int32_t)(p >> 2)) * ((int32_t)calib->dig_P8)) >> 13;
+  p = (uint32_t)((int32_t)p + ((var1 + var2 + calib->dig_P7) >> 4));
+
+  return (_iq8)p << 8;
+}
+
+_iq16 compensate_bme280_humidity(const bme280_calib_data *calib, int32_t adc_H, int32_t t_fine) {
+  int32_t v_x1_u32r;
+
+  v_x1_u32r = (t_fine - ((int32_t)76800));
+
+  v_x1_u32r = (((((adc_H << 14) - (((int32_t)calib->dig_H4) << 20) -
+                  (((int32_t)calib->dig_H5) * v_x1_u32r)) + ((int32_t)16384)) >> 15) *
+               (((((((v_x1_u32r * ((int32_t)calib->dig_H6)) >> 10) *
+                    (((v_x1_u32r * ((int32_t)calib->dig_H3)) >> 11) + ((int32_t)32768))) >> 10) +
+                  ((int32_t)2097152)) * ((int32_t)calib->dig_H2) + 8192) >> 14));
+
+  v_x1_u32r = (v_x1_u32r - (((((v_x1_u32r >> 15) * (v_x1_u32r >> 15)) >> 7) *
+                             ((int32_t)calib->dig_H1)) >> 4));
+
+  v_x1_u32r = (v_x1_u32r < 0) ? 0 : v_x1_u32r;
+  v_x1_u32r = (v_x1_u32r > 419430400) ? 419430400 : v_x1_u32r;
+
+  // Percent in Q22
+  return v_x1_u32r >> 6;
+}
+
+void compensate_ms5837(const uint16_t *C, uint8_t model, uint32_t D1, uint32_t D2,
+                       _iq8 *pressure, _iq16 *temperature) {
+  int32_t dT = (int32_t)D2 - ((int32_t)C[5] << 8);
+
+  // SENS and OFF are scaled so the pressure is just D1 * sens - off,
+  // sens is SENS / 2^34 (30BA) or / 2^36 (02BA), off is in units of the result
+  _iq30 sens;
+  _iq7 off;
+  _iq7 p;
+
+  // Hundredths of a degree
+  _iq8 temp = (2000 << 8) + _IQ8mpyIQX(dT, 23, C[6], 0);
+  int32_t t;
+
+  // Second order corrections, in the datasheet's units
+  _iq8 Ti = 0;
+  int32_t OFFi = 0;
+  int32_t SENSi = 0;
+
+  if ( model == COMPENSATION_MS5837_02BA ) {
+    // C1 / 2^20 + C3 * dT / 2^43
+    sens = ((_iq30)C[1] << 10) + _IQ30mpyIQX(C[3], 21, dT, 22);
+    // C2 * 2^2 + C4 * dT / 2^21
+    off = ((_iq7)C[2] << 9) + _IQ7mpyIQX(C[4], 10, dT, 11);
+  } else {
+    // C1 / 2^19 + C3 * dT / 2^42
+    sens = ((_iq30)C[1] << 11) + _IQ30mpyIQX(C[3], 21, dT, 21);
+    // C2 * 2^3 + C4 * dT / 2^20
+    off = ((_iq7)C[2] << 10) + _IQ7mpyIQX(C[4], 10, dT, 10);
+  }
+
+  t = temp >> 8;
+
+  // (t - 2000)^2 is shifted before the multiply so it can't overflow
+  if ( model == COMPENSATION_MS5837_02BA ) {
+    if ( t < 2000 ) {
+      int32_t sq = (t - 2000) * (t - 2000);
+      // 11 * dT^2 / 2^35
+      Ti = 11 * _IQ8mpyIQX(dT, 17, dT, 18);
+      OFFi = 31 * (sq >> 3);
+      SENSi = 63 * (sq >> 5);
+    }
+
+    off -= OFFi >> 8;
+    sens -= SENSi >> 6;
+  } else {
+    int32_t sq = (t - 2000) * (t - 2000);
+    if ( t < 2000 ) {
+      // 3 * dT^2 / 2^33
+      Ti = 3 * _IQ8mpyIQX(dT, 16, dT, 17);
+      OFFi = 3 * (sq >> 1);
+      SENSi = 5 * (sq >> 3);
+      if ( t < -1500 ) {
+        int32_t cold = (t + 1500) * (t + 1500);
+        OFFi += 7 * cold;
+        SENSi += 4 * cold;
+      }
+    } else {
+      // 2 * dT^2 / 2^37
+      Ti = 2 * _IQ8mpyIQX(dT, 18, dT, 19);
+      OFFi = sq >> 4;
+    }
+
+    off -= OFFi >> 6;
+    sens -= SENSi >> 4;
+  }
+
+  p = _IQ7mpyIQX((int32_t)D1, 0, sens, 30) - off;
+
+  // 02BA counts in Pa, 30BA in 10 Pa
+  if ( model == COMPENSATION_MS5837_02BA ) {
+    *pressure = p * 2;
+  } else {
+    *pressure = p * 20;
+  }
+
+  // Hundredths in Q8 to degrees in Q16
+  *temperature = ((temp - Ti) * 256) / 100;
+}
+
+int32_t compensate_depth_scale(float density) {
+  return (int32_t)((float)(1LL << COMPENSATION_DEPTH_SCALE_Q) / (density * COMPENSATION_GRAVITY));
+}
+
+_iq16 compensate_depth(_iq8 pressure, int32_t depth_scale) {
+  return _IQ16mpyIQX(pressure - ((_iq8)COMPENSATION_SURFACE_PA << 8), 8, depth_scale, COMPENSATION_DEPTH_SCALE_Q);
+}
+
+double compensate_bme280_temperature_reference(const bme280_calib_data *calib, int32_t adc_T, int32_t *t_fine) {
+  double var1, var2;
+
+  var1 = (((double)adc_T) / 16384.0 - ((double)calib->dig_T1) / 1024.0) * ((double)calib->dig_T2);
+  var2 = ((((double)adc_T) / 131072.0 - ((double)calib->dig_T1) / 8192.0) *
+          (((double)adc_T) / 131072.0 - ((double)calib->dig_T1) / 8192.0)) * ((double)calib->dig_T3);
+
+  *t_fine = (int32_t)(var1 + var2);
+  return (var1 + var2) / 5120.0;
+}
+
+double compensate_bme280_pressure_reference(const bme280_calib_data *calib, int32_t adc_P, int32_t t_fine) {
+  double var1, var2, p;
+
+  var1 = ((double)t_fine / 2.0) - 64000.0;
+  var2 = var1 * var1 * ((double)calib->dig_P6) / 32768.0;
+  var2 = var2 + var1 * ((double)calib->dig_P5) * 2.0;
+  var2 = (var2 / 4.0) + (((double)calib->dig_P4) * 65536.0);
+  var1 = (((double)calib->dig_P3) * var1 * var1 / 524288.0 + ((double)calib->dig_P2) * var1) / 524288.0;
+  var1 = (1.0 + var1 / 32768.0) * ((double)calib->dig_P1);
+
+  if (var1 == 0.0) {
+    return 0;
+  }
+
+  p = 1048576.0 - (double)adc_P;
+  p = (p - (var2 / 4096.0)) * 6250.0 / var1;
+  var1 = ((double)calib->dig_P9) * p * p / 2147483648.0;
+  var2 = p * ((double)calib->dig_P8) / 32768.0;
+  return p + (var1 + var2 + ((double)calib->dig_P7)) / 16.0;
+}
+
+double compensate_bme280_humidity_reference(const bme280_calib_data *calib, int32_t adc_H, int32_t t_fine) {
+  double var_H;
+
+  var_H = (((double)t_fine) - 76800.0);
+  var_H = (adc_H - (((double)calib->dig_H4) * 64.0 + ((double)calib->dig_H5) / 16384.0 * var_H)) *
+    (((double)calib->dig_H2) / 65536.0 * (1.0 + ((double)calib->dig_H6) / 67108864.0 * var_H *
+                                          (1.0 + ((double)calib->dig_H3) / 67108864.0 * var_H)));
+  var_H = var_H * (1.0 - ((double)calib->dig_H1) * var_H / 524288.0);
+
+  if (var_H > 100.0) {
+    var_H = 100.0;
+  } else if (var_H < 0.0) {
+    var_H = 0.0;
+  }
+  return var_H;
+}
+
+void compensate_ms5837_reference(const uint16_t *C, uint8_t model, uint32_t D1, uint32_t D2,
+                                 double *pressure, double *temperature) {
+  double dT = (double)D2 - C[5] * 256.0;
+  double SENS, OFF, TEMP;
+  double Ti = 0, OFFi = 0, SENSi = 0;
+
+  TEMP = 2000.0 + dT * C[6] / 8388608.0;
+
+  if ( model == COMPENSATION_MS5837_02BA ) {
+    SENS = C[1] * 65536.0 + (C[3] * dT) / 128.0;
+    OFF = C[2] * 131072.0 + (C[4] * dT) / 64.0;
+    if ( TEMP < 2000 ) {
+      Ti = 11 * dT * dT / 34359738368.0;
+      OFFi = 31 * (TEMP - 2000) * (TEMP - 2000) / 8;
+      SENSi = 63 * (TEMP - 2000) * (TEMP - 2000) / 32;
+    }
+  } else {
+    SENS = C[1] * 32768.0 + (C[3] * dT) / 256.0;
+    OFF = C[2] * 65536.0 + (C[4] * dT) / 128.0;
+    if ( TEMP < 2000 ) {
+      Ti = 3 * dT * dT / 8589934592.0;
+      OFFi = 3 * (TEMP - 2000) * (TEMP - 2000) / 2;
+      SENSi = 5 * (TEMP - 2000) * (TEMP - 2000) / 8;
+      if ( TEMP < -1500 ) {
+        OFFi += 7 * (TEMP + 1500) * (TEMP + 1500);
+        SENSi += 4 * (TEMP + 1500) * (TEMP + 1500);
+      }
+    } else {
+      Ti = 2 * dT * dT / 137438953472.0;
+      OFFi = (TEMP - 2000) * (TEMP - 2000) / 16;
+    }
+  }
+
+  OFF -= OFFi;
+  SENS -= SENSi;
+
+  if ( model == COMPENSATION_MS5837_02BA ) {
+    *pressure = (D1 * SENS / 2097152.0 - OFF) / 32768.0;
+  } else {
+    *pressure = (D1 * SENS / 2097152.0 - OFF) / 8192.0 * 10;
+  }
+  *temperature = (TEMP - Ti) / 100.0;
+}
+
+double compensate_depth_reference(double pressure, float density) {
+  return (pressure - COMPENSATION_SURFACE_PA) / (density * 9.80665);
+}
@@ -13,6 +13,7 @@
 #define _BME280_H_
 
 #include "lib/include/query_i2c.h"
+#include "lib/include/compensation.h"
 
 #include <math.h>
 
@@ -72,34 +73,6 @@
 #define BME280_REGISTER_TEMPDATA 			0xFA
 #define BME280_REGISTER_HUMIDDATA 		0xFD
 
-/*=========================================================================
-  CALIBRATION DATA
-  -----------------------------------------------------------------------*/
-
-typedef struct
-{
-  uint16_t dig_T1;
-  int16_t  dig_T2;
-  int16_t  dig_T3;
-
-  uint16_t dig_P1;
-  int16_t  dig_P2;
-  int16_t  dig_P3;
-  int16_t  dig_P4;
-  int16_t  dig_P5;
-  int16_t  dig_P6;
-  int16_t  dig_P7;
-  int16_t  dig_P8;
-  int16_t  dig_P9;
-
-  uint8_t  dig_H1;
-  int16_t  dig_H2;
-  uint8_t  dig_H3;
-  int16_t  dig_H4;
-  int16_t  dig_H5;
-  int8_t   dig_H6;
-} bme280_calib_data;
-
 // Public
 
 bool bme280_begin(uint32_t device);
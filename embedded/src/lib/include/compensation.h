@@ -0,0 +1,122 @@
+/*
+ * R@M 2017
+ *
+ * Fixed point compensation for the BME280 and MS5837.
+ *
+ * Everything here is 32 bit integer or IQmath, so nothing goes through the
+ * software double or 64 bit divide routines on the M4. The only 64 bit maths
+ * is inside IQmath's multiplies, which is a single SMULL. No I/O, so it also
+ * builds on the host for test/test_compensation.c.
+ *
+ * Pressures are Pa in Q8, temperatures and humidity are Q16, depth is
+ * meters in Q16.
+ */
+
+#ifndef _COMPENSATION_H_
+#define _COMPENSATION_H_
+
+#include <stdint.h>
+
+#include <IQmath/IQmathLib.h>
+
+// Standard atmosphere at the surface, what depth is measured from
+#define COMPENSATION_SURFACE_PA 101300
+
+#define COMPENSATION_GRAVITY 9.80665f
+
+// Fraction bits of the depth scale. Meters per Pa is around 1e-4, so none of
+// IQmath's formats keep enough of it.
+#define COMPENSATION_DEPTH_SCALE_Q 36
+
+/*=========================================================================
+  CALIBRATION DATA
+  -----------------------------------------------------------------------*/
+
+typedef struct
+{
+  uint16_t dig_T1;
+  int16_t  dig_T2;
+  int16_t  dig_T3;
+
+  uint16_t dig_P1;
+  int16_t  dig_P2;
+  int16_t  dig_P3;
+  int16_t  dig_P4;
+  int16_t  dig_P5;
+  int16_t  dig_P6;
+  int16_t  dig_P7;
+  int16_t  dig_P8;
+  int16_t  dig_P9;
+
+  uint8_t  dig_H1;
+  int16_t  dig_H2;
+  uint8_t  dig_H3;
+  int16_t  dig_H4;
+  int16_t  dig_H5;
+  int8_t   dig_H6;
+} bme280_calib_data;
+
+// MS5837 variants, they scale the PROM coefficients differently
+#define COMPENSATION_MS5837_30BA 0
+#define COMPENSATION_MS5837_02BA 1
+
+/*=========================================================================
+  BME280
+  -----------------------------------------------------------------------*/
+
+/**
+ * Temperature in degrees C. Also sets t_fine, which the pressure and
+ * humidity compensation need from a reading taken at the same time.
+ */
+_iq16 compensate_bme280_temperature(const bme280_calib_data *calib, int32_t adc_T, int32_t *t_fine);
+
+/**
+ * Pressure in Pa, to the nearest Pa. This is the datasheet's 32 bit
+ * version, the 64 bit one needs a 64 bit divide.
+ */
+_iq8 compensate_bme280_pressure(const bme280_calib_data *calib, int32_t adc_P, int32_t t_fine);
+
+/**
+ * Relative humidity in percent
+ */
+_iq16 compensate_bme280_humidity(const bme280_calib_data *calib, int32_t adc_H, int32_t t_fine);
+
+/*=========================================================================
+  MS5837
+  -----------------------------------------------------------------------*/
+
+/**
+ * First and second order compensation from the datasheet, with C the PROM
+ * coefficients and D1, D2 the raw pressure and temperature conversions.
+ */
+void compensate_ms5837(const uint16_t *C, uint8_t model, uint32_t D1, uint32_t D2,
+                       _iq8 *pressure, _iq16 *temperature);
+
+/**
+ * 1 / (density * g) in COMPENSATION_DEPTH_SCALE_Q, worked out once when the
+ * fluid density is set
+ */
+int32_t compensate_depth_scale(float density);
+
+/**
+ * Meters of fluid above the sensor
+ */
+_iq16 compensate_depth(_iq8 pressure, int32_t depth_scale);
+
+/*=========================================================================
+  REFERENCE
+  -----------------------------------------------------------------------*/
+
+/*
+ * The datasheets' double precision versions of the above, with the same
+ * units but not scaled. These are what the fixed point versions are tested
+ * against, and are slow on the M4 where doubles are done in software.
+ */
+double compensate_bme280_temperature_reference(const bme280_calib_data *calib, int32_t adc_T, int32_t *t_fine);
+double compensate_bme280_pressure_reference(const bme280_calib_data *calib, int32_t adc_P, int32_t t_fine);
+double compensate_bme280_humidity_reference(const bme280_calib_data *calib, int32_t adc_H, int32_t t_fine);
+void compensate_ms5837_reference(const uint16_t *C, uint8_t model, uint32_t D1, uint32_t D2,
+                                 double *pressure, double *temperature);
+double compensate_depth_reference(double pressure, float density);
+
+#endif
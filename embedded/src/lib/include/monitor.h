@@ -0,0 +1,84 @@
+/*
+ * R@M 2017
+ *
+ * Evaluates sensor samples against the Qubobus monitor configs.
+ *
+ * The battery, power, depth and thruster monitor configs are flattened into
+ * one table with a channel per monitored value, so checking a sample is a
+ * table lookup and four compares. Producers call monitor_sample() as each
+ * value is read, bme280_task does for the battery hull's environment. When a
+ * channel changes warning level an event is queued for the host to pick up
+ * with M_ID_SAFETY_MONITOR_EVENTS, and a channel going critical puts the
+ * vehicle in safe mode without waiting on the host.
+ */
+
+#ifndef _MONITOR_H_
+#define _MONITOR_H_
+
+// FreeRTOS
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+
+// Qubobus
+#include "qubobus.h"
+#include "io.h"
+
+#include "lib/include/safe_mode.h"
+
+#define MONITOR_NUM_BATTERIES 2
+#define MONITOR_NUM_RAILS (RAIL_ID_SHORE + 1)
+#define MONITOR_NUM_THRUSTERS 8
+
+// How far back inside a limit, as a fraction of the limit, a value has to come
+// before its channel drops a level, so a value sitting on a limit doesn't raise
+// an event every sample
+#define MONITOR_HYSTERESIS 0.02f
+
+/**
+ * Turns evaluation on or off for every channel of a module
+ * @param module M_ID_OFFSET_* of the module
+ */
+void monitor_enable(uint8_t module, bool enable);
+
+/**
+ * Checks one sample against its limits, raising an event if its level changed
+ * @param module M_ID_OFFSET_* of the module the sample came from
+ * @param index battery, rail or thruster id, 0 for depth
+ * @param field MONITOR_FIELD_* of the sample
+ * @return the channel's warning level after the sample
+ */
+uint8_t monitor_sample(uint8_t module, uint8_t index, uint8_t field, float value);
+
+/**
+ * @return the last warning level of a channel, MONITOR_LEVEL_NORMAL if it
+ * doesn't exist
+ */
+uint8_t monitor_level(uint8_t module, uint8_t index, uint8_t field);
+
+/**
+ * Moves every queued event into events, oldest first
+ */
+void monitor_read_events(struct Monitor_Events *events);
+
+/*
+ * The config setters store the limits of config->warning_level. The getters
+ * use the warning_level (and rail_id) already in config to choose which
+ * limits to report. Unknown levels or rails are ignored.
+ */
+void monitor_set_battery_config(const struct Battery_Monitor_Config *config);
+void monitor_get_battery_config(struct Battery_Monitor_Config *config);
+
+void monitor_set_power_config(const struct Power_Monitor_Config *config);
+void monitor_get_power_config(struct Power_Monitor_Config *config);
+
+void monitor_set_depth_config(const struct Depth_Monitor_Config *config);
+void monitor_get_depth_config(struct Depth_Monitor_Config *config);
+
+void monitor_set_thruster_config(const struct Thruster_Monitor_Config *config);
+void monitor_get_thruster_config(struct Thruster_Monitor_Config *config);
+
+#endif
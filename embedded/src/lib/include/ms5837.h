@@ -43,6 +43,7 @@ THE SOFTWARE.
 #include <task.h>
 
 #include "lib/include/query_i2c.h"
+#include "lib/include/compensation.h"
 
 #define MS5837_ADDR               0x76
 #define MS5837_RESET              0x1E
@@ -55,8 +56,8 @@ static const float Pa = 100.0f;
 static const float bar = 0.001f;
 static const float mbar = 1.0f;
 
-static const uint8_t MS5837_30BA = 0;
-static const uint8_t MS5837_02BA = 1;
+static const uint8_t MS5837_30BA = COMPENSATION_MS5837_30BA;
+static const uint8_t MS5837_02BA = COMPENSATION_MS5837_02BA;
 
 // Public
 void ms5837_init(uint32_t device);
@@ -102,11 +103,13 @@ float ms5837_altitude(uint32_t device);
 // Private
 static uint16_t C[8];
 static uint32_t D1, D2;
-static int32_t TEMP;
-static int32_t P;
+static _iq16 TEMP;
+static _iq8 P;
 static uint8_t _model;
 
 static float fluidDensity = 1029;
+// 1 / (fluidDensity * g), only worked out again when the density changes
+static int32_t depthScale;
 
 	/** Performs calculations per the sensor data sheet for conversion and
 	 *  second order compensation.
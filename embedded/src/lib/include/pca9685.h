@@ -53,6 +53,7 @@ void pca9685_reset(uint32_t device);
 void pca9685_setPWMFreq(uint32_t device, float freq);
 void pca9685_setPWM(uint32_t device, uint8_t num, uint16_t on, uint16_t off);
 void pca9685_setPin(uint32_t device, uint8_t num, uint16_t val, bool invert);
+void pca9685_setPWMBurst(uint32_t device, uint8_t first, uint8_t count, const uint16_t *off);
 
 
 static uint8_t _i2caddr;
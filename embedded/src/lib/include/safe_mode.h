@@ -0,0 +1,21 @@
+/*
+ * R@M 2017
+ *
+ * Software safe mode. Entered by M_ID_SAFETY_SET_SAFE from the host, or
+ * locally by the monitor when a value goes critical. While it is active the
+ * thruster task holds every thruster at neutral.
+ */
+
+#ifndef _SAFE_MODE_H_
+#define _SAFE_MODE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+void safe_mode_enter(void);
+
+void safe_mode_exit(void);
+
+bool safe_mode_active(void);
+
+#endif
@@ -0,0 +1,101 @@
+/*
+ * R@M 2017
+ *
+ * Run time stats timer and binary event trace ring.
+ *
+ * The kernel hooks in FreeRTOSConfig.h call into this library on every task
+ * switch and queue send, the interrupt handlers bracket themselves with
+ * trace_isr_enter/exit, and tiqu records every Qubobus frame. The host reads
+ * the ring back with M_ID_DEBUG_TRACE_READ and the per task run time with
+ * M_ID_DEBUG_RUNTIME_STATS.
+ */
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+// FreeRTOS
+#include <FreeRTOS.h>
+#include <task.h>
+
+// Tiva
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <inc/hw_memmap.h>
+#include <inc/hw_types.h>
+#include <inc/hw_timer.h>
+#include <driverlib/rom.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/timer.h>
+
+// Qubobus
+#include "qubobus.h"
+#include "io.h"
+
+// Number of events kept in the ring, must be a power of two
+#define TRACE_RING_LENGTH 256
+
+// The run time stats timer counts at 1MHz, so it wraps about every 71 minutes
+#define TRACE_TIMER_BASE WTIMER5_BASE
+#define TRACE_TIMER_PERIPH SYSCTL_PERIPH_WTIMER5
+#define TRACE_TIMER_HZ 1000000
+
+/**
+ * Starts the free running timer used for run time stats and trace timestamps.
+ * Called by the kernel through portCONFIGURE_TIMER_FOR_RUN_TIME_STATS.
+ * Events recorded before this is called are dropped.
+ */
+void trace_configure_timer(void);
+
+/**
+ * @return the current value of the run time stats timer
+ */
+uint32_t trace_timestamp(void);
+
+/**
+ * Appends an event to the ring, overwriting the oldest one if it is full.
+ * Safe to call from tasks, ISRs, and the kernel trace hooks.
+ */
+void trace_record(uint8_t type, uint8_t id, uint16_t value);
+
+/**
+ * Hands out the next queue number for a newly created queue, or 0 once
+ * DEBUG_MAX_QUEUES have been given out. Queue 0 is not traced.
+ */
+uint32_t trace_register_queue(void);
+
+/**
+ * Records a queue's fill level after a send, emitting an event only when it
+ * passes that queue's previous high water mark.
+ */
+void trace_queue_level(uint32_t queue_number, uint32_t level);
+
+/**
+ * Records the task the kernel just switched in, by its TCB number.
+ */
+void trace_task_switched_in(uint32_t task_number);
+
+#define trace_isr_enter(isr) trace_record(TRACE_EVENT_ISR_ENTER, (isr), 0)
+#define trace_isr_exit(isr) trace_record(TRACE_EVENT_ISR_EXIT, (isr), 0)
+
+#define trace_frame(type, message)                                      \
+	trace_record((type), (message)->header.message_id,                  \
+				 ((message)->header.message_type << 12) | ((message)->header.num_bytes & 0xFFF))
+
+#define trace_frame_in(message) trace_frame(TRACE_EVENT_FRAME_IN, message)
+#define trace_frame_out(message) trace_frame(TRACE_EVENT_FRAME_OUT, message)
+
+/**
+ * Copies events starting at block->sequence into the block.
+ * If the requested events were already overwritten, the block starts at the
+ * oldest event still in the ring instead.
+ */
+void trace_read(struct Trace_Block *block);
+
+/**
+ * Fills in the run time counters, stack high water marks and queue high water
+ * marks for every task on the system.
+ */
+void trace_runtime_stats(struct Runtime_Stats *stats);
+
+#endif
@@ -0,0 +1,25 @@
+/*
+ * R@M 2017
+ *
+ * The parts of IQmath that lib/compensation.c and lib/bme280.c use. TI only
+ * ships IQmathLib prebuilt for CCS and Keil, so the gcc build and make test
+ * both get these instead. Anything else from IQmathLib.h has to be added here
+ * before it is used.
+ */
+
+#include <stdint.h>
+
+#include <IQmath/IQmathLib.h>
+
+// (A * B) >> (32 - S), with the product in 64 bits like the M4's SMULL
+long __IQxmpy(long A, long B, long S) {
+    return (long)(int32_t)(((int64_t)(int32_t)A * (int32_t)B) >> (32 - S));
+}
+
+float _IQ8toF(_iq8 A) {
+    return (float)(int32_t)A / (1 << 8);
+}
+
+float _IQ16toF(_iq16 A) {
+    return (float)(int32_t)A / (1 << 16);
+}
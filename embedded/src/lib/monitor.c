@@ -0,0 +1,372 @@
+/*
+ * R@M 2017
+ */
+
+#include "lib/include/monitor.h"
+
+// Limits for the warning and critical levels of one monitored value. A level
+// that has never been configured never trips.
+struct Monitor_Channel {
+	float low[2];
+	float high[2];
+	bool configured[2];
+	uint8_t level;
+};
+
+#define BATTERY_FIELDS 5
+#define POWER_FIELDS 2
+#define THRUSTER_FIELDS 2
+
+// Channels are laid out module by module, then by id, then by field
+#define BATTERY_BASE 0
+#define POWER_BASE (BATTERY_BASE + MONITOR_NUM_BATTERIES * BATTERY_FIELDS)
+#define DEPTH_BASE (POWER_BASE + MONITOR_NUM_RAILS * POWER_FIELDS)
+#define THRUSTER_BASE (DEPTH_BASE + 1)
+#define NUM_CHANNELS (THRUSTER_BASE + MONITOR_NUM_THRUSTERS * THRUSTER_FIELDS)
+
+static struct Monitor_Channel channels[NUM_CHANNELS];
+
+// Module offsets are multiples of ten, so this is indexed by module / 10
+static bool enabled[M_ID_OFFSET_MAX / 10];
+
+static struct Monitor_Event events[SAFETY_MAX_MONITOR_EVENTS];
+static uint8_t events_head = 0;
+static uint8_t events_count = 0;
+static uint8_t events_dropped = 0;
+
+// Column of each field within a module's channels, -1 if it isn't monitored
+static int8_t battery_column(uint8_t field) {
+	switch (field) {
+	case MONITOR_FIELD_VOLTAGE: return 0;
+	case MONITOR_FIELD_HUMIDITY: return 1;
+	case MONITOR_FIELD_PRESSURE: return 2;
+	case MONITOR_FIELD_TEMPERATURE: return 3;
+	case MONITOR_FIELD_HYDROGEN: return 4;
+	default: return -1;
+	}
+}
+
+static int8_t power_column(uint8_t field) {
+	switch (field) {
+	case MONITOR_FIELD_VOLTAGE: return 0;
+	case MONITOR_FIELD_CURRENT: return 1;
+	default: return -1;
+	}
+}
+
+// The channels belonging to module are [*first, *end), empty if it has none
+static void module_channels(uint8_t module, uint8_t *first, uint8_t *end) {
+	switch (module) {
+	case M_ID_OFFSET_BATTERY: *first = BATTERY_BASE; *end = POWER_BASE; break;
+	case M_ID_OFFSET_POWER: *first = POWER_BASE; *end = DEPTH_BASE; break;
+	case M_ID_OFFSET_DEPTH: *first = DEPTH_BASE; *end = THRUSTER_BASE; break;
+	case M_ID_OFFSET_THRUSTER: *first = THRUSTER_BASE; *end = NUM_CHANNELS; break;
+	default: *first = *end = 0; break;
+	}
+}
+
+static int16_t channel_number(uint8_t module, uint8_t index, uint8_t field) {
+	int8_t column;
+
+	switch (module) {
+	case M_ID_OFFSET_BATTERY:
+		column = battery_column(field);
+		if (column < 0 || index >= MONITOR_NUM_BATTERIES) {
+			return -1;
+		}
+		return BATTERY_BASE + index * BATTERY_FIELDS + column;
+	case M_ID_OFFSET_POWER:
+		column = power_column(field);
+		if (column < 0 || index >= MONITOR_NUM_RAILS) {
+			return -1;
+		}
+		return POWER_BASE + index * POWER_FIELDS + column;
+	case M_ID_OFFSET_DEPTH:
+		if (field != MONITOR_FIELD_DEPTH || index != 0) {
+			return -1;
+		}
+		return DEPTH_BASE;
+	case M_ID_OFFSET_THRUSTER:
+		// Thrusters share the voltage/current columns with the power rails
+		column = power_column(field);
+		if (column < 0 || index >= MONITOR_NUM_THRUSTERS) {
+			return -1;
+		}
+		return THRUSTER_BASE + index * THRUSTER_FIELDS + column;
+	default:
+		return -1;
+	}
+}
+
+// Index into the channel limit arrays for a MONITOR_LEVEL_*, -1 for NORMAL
+static int8_t level_slot(uint8_t warning_level) {
+	switch (warning_level) {
+	case MONITOR_LEVEL_WARNING: return 0;
+	case MONITOR_LEVEL_CRITICAL: return 1;
+	default: return -1;
+	}
+}
+
+// Whether a value is outside one level's limits. A channel already at that
+// level only leaves it once the value is back inside by MONITOR_HYSTERESIS
+static bool outside(const struct Monitor_Channel *channel, int8_t slot, float value, bool tripped) {
+	float low = channel->low[slot];
+	float high = channel->high[slot];
+
+	if (!channel->configured[slot]) {
+		return false;
+	}
+	if (tripped) {
+		// Open ended limits (the thruster ones) have nothing to back off from
+		if (isfinite(low)) {
+			low += fabsf(low) * MONITOR_HYSTERESIS;
+		}
+		if (isfinite(high)) {
+			high -= fabsf(high) * MONITOR_HYSTERESIS;
+		}
+	}
+	return value < low || value > high;
+}
+
+static uint8_t evaluate(const struct Monitor_Channel *channel, float value) {
+	if (outside(channel, 1, value, channel->level == MONITOR_LEVEL_CRITICAL)) {
+		return MONITOR_LEVEL_CRITICAL;
+	}
+	if (outside(channel, 0, value, channel->level != MONITOR_LEVEL_NORMAL)) {
+		return MONITOR_LEVEL_WARNING;
+	}
+	return MONITOR_LEVEL_NORMAL;
+}
+
+// Must be called inside a critical section
+static void push_event(uint8_t module, uint8_t index, uint8_t field, uint8_t level, float value) {
+	struct Monitor_Event *event;
+
+	if (events_count == SAFETY_MAX_MONITOR_EVENTS) {
+		// Keep the newest events, the host cares most about the current state
+		events_head = (events_head + 1) % SAFETY_MAX_MONITOR_EVENTS;
+		events_count--;
+		if (events_dropped < UINT8_MAX) {
+			events_dropped++;
+		}
+	}
+
+	event = &events[(events_head + events_count) % SAFETY_MAX_MONITOR_EVENTS];
+	event->value = value;
+	event->uptime = xTaskGetTickCount();
+	event->module = module;
+	event->index = index;
+	event->field = field;
+	event->warning_level = level;
+	events_count++;
+}
+
+static void set_limits(uint8_t module, uint8_t index, uint8_t field, int8_t slot, float low, float high) {
+	struct Monitor_Channel *channel = &channels[channel_number(module, index, field)];
+	channel->low[slot] = low;
+	channel->high[slot] = high;
+	channel->configured[slot] = true;
+}
+
+static void get_limits(uint8_t module, uint8_t index, uint8_t field, int8_t slot, float *limits) {
+	const struct Monitor_Channel *channel = &channels[channel_number(module, index, field)];
+	limits[LLIMIT] = channel->low[slot];
+	limits[HLIMIT] = channel->high[slot];
+}
+
+void monitor_enable(uint8_t module, bool enable) {
+	uint8_t i, first, end;
+
+	if (module >= M_ID_OFFSET_MAX) {
+		return;
+	}
+
+	taskENTER_CRITICAL();
+	enabled[module / 10] = enable;
+	if (!enable) {
+		// Start from normal again when re-enabled, rather than a stale level.
+		// Other modules keep theirs
+		module_channels(module, &first, &end);
+		for (i = first; i < end; i++) {
+			channels[i].level = MONITOR_LEVEL_NORMAL;
+		}
+	}
+	taskEXIT_CRITICAL();
+}
+
+uint8_t monitor_sample(uint8_t module, uint8_t index, uint8_t field, float value) {
+	int16_t number = channel_number(module, index, field);
+	struct Monitor_Channel *channel;
+	uint8_t level;
+
+	if (number < 0 || !enabled[module / 10]) {
+		return MONITOR_LEVEL_NORMAL;
+	}
+	channel = &channels[number];
+
+	taskENTER_CRITICAL();
+	level = evaluate(channel, value);
+	if (level != channel->level) {
+		channel->level = level;
+		push_event(module, index, field, level, value);
+	}
+	taskEXIT_CRITICAL();
+
+	if (level == MONITOR_LEVEL_CRITICAL) {
+		safe_mode_enter();
+	}
+	return level;
+}
+
+uint8_t monitor_level(uint8_t module, uint8_t index, uint8_t field) {
+	int16_t number = channel_number(module, index, field);
+
+	if (number < 0) {
+		return MONITOR_LEVEL_NORMAL;
+	}
+	return channels[number].level;
+}
+
+void monitor_read_events(struct Monitor_Events *out) {
+	uint8_t i;
+
+	taskENTER_CRITICAL();
+	for (i = 0; i < events_count; i++) {
+		out->events[i] = events[(events_head + i) % SAFETY_MAX_MONITOR_EVENTS];
+	}
+	out->num_events = events_count;
+	out->dropped = events_dropped;
+	events_head = 0;
+	events_count = 0;
+	events_dropped = 0;
+	taskEXIT_CRITICAL();
+}
+
+void monitor_set_battery_config(const struct Battery_Monitor_Config *config) {
+	int8_t slot = level_slot(config->warning_level);
+	uint8_t i;
+
+	if (slot < 0) {
+		return;
+	}
+
+	// The config has no battery id, the same limits apply to both
+	taskENTER_CRITICAL();
+	for (i = 0; i < MONITOR_NUM_BATTERIES; i++) {
+		set_limits(M_ID_OFFSET_BATTERY, i, MONITOR_FIELD_VOLTAGE, slot,
+				   config->voltage[LLIMIT], config->voltage[HLIMIT]);
+		set_limits(M_ID_OFFSET_BATTERY, i, MONITOR_FIELD_HUMIDITY, slot,
+				   config->humidity[LLIMIT], config->humidity[HLIMIT]);
+		set_limits(M_ID_OFFSET_BATTERY, i, MONITOR_FIELD_PRESSURE, slot,
+				   config->pressure[LLIMIT], config->pressure[HLIMIT]);
+		set_limits(M_ID_OFFSET_BATTERY, i, MONITOR_FIELD_TEMPERATURE, slot,
+				   config->temperature[LLIMIT], config->temperature[HLIMIT]);
+		set_limits(M_ID_OFFSET_BATTERY, i, MONITOR_FIELD_HYDROGEN, slot,
+				   config->hydrogen[LLIMIT], config->hydrogen[HLIMIT]);
+	}
+	taskEXIT_CRITICAL();
+}
+
+void monitor_get_battery_config(struct Battery_Monitor_Config *config) {
+	int8_t slot = level_slot(config->warning_level);
+
+	if (slot < 0) {
+		return;
+	}
+
+	taskENTER_CRITICAL();
+	get_limits(M_ID_OFFSET_BATTERY, 0, MONITOR_FIELD_VOLTAGE, slot, config->voltage);
+	get_limits(M_ID_OFFSET_BATTERY, 0, MONITOR_FIELD_HUMIDITY, slot, config->humidity);
+	get_limits(M_ID_OFFSET_BATTERY, 0, MONITOR_FIELD_PRESSURE, slot, config->pressure);
+	get_limits(M_ID_OFFSET_BATTERY, 0, MONITOR_FIELD_TEMPERATURE, slot, config->temperature);
+	get_limits(M_ID_OFFSET_BATTERY, 0, MONITOR_FIELD_HYDROGEN, slot, config->hydrogen);
+	taskEXIT_CRITICAL();
+}
+
+void monitor_set_power_config(const struct Power_Monitor_Config *config) {
+	int8_t slot = level_slot(config->warning_level);
+
+	if (slot < 0 || !IS_POWER_RAIL_ID(config->rail_id)) {
+		return;
+	}
+
+	taskENTER_CRITICAL();
+	set_limits(M_ID_OFFSET_POWER, config->rail_id, MONITOR_FIELD_VOLTAGE, slot,
+			   config->voltage[LLIMIT], config->voltage[HLIMIT]);
+	set_limits(M_ID_OFFSET_POWER, config->rail_id, MONITOR_FIELD_CURRENT, slot,
+			   config->current[LLIMIT], config->current[HLIMIT]);
+	taskEXIT_CRITICAL();
+}
+
+void monitor_get_power_config(struct Power_Monitor_Config *config) {
+	int8_t slot = level_slot(config->warning_level);
+
+	if (slot < 0 || !IS_POWER_RAIL_ID(config->rail_id)) {
+		return;
+	}
+
+	taskENTER_CRITICAL();
+	get_limits(M_ID_OFFSET_POWER, config->rail_id, MONITOR_FIELD_VOLTAGE, slot, config->voltage);
+	get_limits(M_ID_OFFSET_POWER, config->rail_id, MONITOR_FIELD_CURRENT, slot, config->current);
+	taskEXIT_CRITICAL();
+}
+
+void monitor_set_depth_config(const struct Depth_Monitor_Config *config) {
+	int8_t slot = level_slot(config->warning_level);
+
+	if (slot < 0) {
+		return;
+	}
+
+	taskENTER_CRITICAL();
+	set_limits(M_ID_OFFSET_DEPTH, 0, MONITOR_FIELD_DEPTH, slot,
+			   config->depth[LLIMIT], config->depth[HLIMIT]);
+	taskEXIT_CRITICAL();
+}
+
+void monitor_get_depth_config(struct Depth_Monitor_Config *config) {
+	int8_t slot = level_slot(config->warning_level);
+
+	if (slot < 0) {
+		return;
+	}
+
+	taskENTER_CRITICAL();
+	get_limits(M_ID_OFFSET_DEPTH, 0, MONITOR_FIELD_DEPTH, slot, config->depth);
+	taskEXIT_CRITICAL();
+}
+
+void monitor_set_thruster_config(const struct Thruster_Monitor_Config *config) {
+	int8_t slot = level_slot(config->warning_level);
+	uint8_t i;
+
+	if (slot < 0) {
+		return;
+	}
+
+	// Thrusters only have a current ceiling and a voltage floor
+	taskENTER_CRITICAL();
+	for (i = 0; i < MONITOR_NUM_THRUSTERS; i++) {
+		set_limits(M_ID_OFFSET_THRUSTER, i, MONITOR_FIELD_CURRENT, slot,
+				   -INFINITY, config->thruster_high_A);
+		set_limits(M_ID_OFFSET_THRUSTER, i, MONITOR_FIELD_VOLTAGE, slot,
+				   config->thruster_low_V, INFINITY);
+	}
+	taskEXIT_CRITICAL();
+}
+
+void monitor_get_thruster_config(struct Thruster_Monitor_Config *config) {
+	int8_t slot = level_slot(config->warning_level);
+	float limits[2];
+
+	if (slot < 0) {
+		return;
+	}
+
+	taskENTER_CRITICAL();
+	get_limits(M_ID_OFFSET_THRUSTER, 0, MONITOR_FIELD_CURRENT, slot, limits);
+	config->thruster_high_A = limits[HLIMIT];
+	get_limits(M_ID_OFFSET_THRUSTER, 0, MONITOR_FIELD_VOLTAGE, slot, limits);
+	config->thruster_low_V = limits[LLIMIT];
+	taskEXIT_CRITICAL();
+}
@@ -28,6 +28,8 @@ void ms5837_init(uint32_t device) {
     C[i] = (buffer[0] << 8) | buffer[1];
   }
 
+	depthScale = compensate_depth_scale(fluidDensity);
+
 	// Verify that data is correct with CRC
 	uint8_t crcRead = C[0] >> 12;
 	uint8_t crcCalculated = crc4(C);
@@ -45,6 +47,7 @@ void ms5837_setModel(uint8_t model) {
 
 void ms5837_setFluidDensity(uint32_t device, float density) {
 	fluidDensity = density;
+	depthScale = compensate_depth_scale(density);
 }
 
 void ms5837_read(uint32_t device) {
@@ -116,15 +119,15 @@ void ms5837_readTestCase(uint32_t device) {
 
 
 float ms5837_pressure(uint32_t device, float conversion) {
-	return P*conversion;
+	return _IQ8toF(P) / Pa * conversion;
 }
 
 float ms5837_temperature(uint32_t device) {
-	return TEMP/100.0f;
+	return _IQ16toF(TEMP);
 }
 
 float ms5837_depth(uint32_t device) {
-	return (ms5837_pressure(device, Pa)-101300)/(fluidDensity*9.80665);
+	return _IQ16toF(compensate_depth(P, depthScale));
 }
 
 float ms5837_altitude(uint32_t device) {
@@ -133,67 +136,8 @@ float ms5837_altitude(uint32_t device) {
 
 static void calculate() {
 	// Given C1-C6 and D1, D2, calculated TEMP and P
-	// Do conversion first and then second order temp compensation
-
-	int32_t dT = 0;
-	int64_t SENS = 0;
-	int64_t OFF = 0;
-	int32_t SENSi = 0;
-	int32_t OFFi = 0;
-	int32_t Ti = 0;
-	int64_t OFF2 = 0;
-	int64_t SENS2 = 0;
-
-	// Terms called
-	dT = D2-(uint32_t)(C[5])*256l;
-	if ( _model == MS5837_02BA ) {
-		SENS = (int64_t)(C[1])*65536l+((int64_t)(C[3])*dT)/128l;
-		OFF = (int64_t)(C[2])*131072l+((int64_t)(C[4])*dT)/64l;
-		P = (D1*SENS/(2097152l)-OFF)/(32768l);
-	} else {
-		SENS = (int64_t)(C[1])*32768l+((int64_t)(C[3])*dT)/256l;
-		OFF = (int64_t)(C[2])*65536l+((int64_t)(C[4])*dT)/128l;
-		P = (D1*SENS/(2097152l)-OFF)/(8192l);
-	}
-
-	// Temp conversion
-	TEMP = 2000l+(int64_t)(dT)*C[6]/8388608LL;
-
-	//Second order compensation
-	if ( _model == MS5837_02BA ) {
-		if((TEMP/100)<20){         //Low temp
-			//Serial.println("here");
-			Ti = (11*(int64_t)(dT)*(int64_t)(dT))/(34359738368LL);
-			OFFi = (31*(TEMP-2000)*(TEMP-2000))/8;
-			SENSi = (63*(TEMP-2000)*(TEMP-2000))/32;
-		}
-	} else {
-		if((TEMP/100)<20){         //Low temp
-			Ti = (3*(int64_t)(dT)*(int64_t)(dT))/(8589934592LL);
-			OFFi = (3*(TEMP-2000)*(TEMP-2000))/2;
-			SENSi = (5*(TEMP-2000)*(TEMP-2000))/8;
-			if((TEMP/100)<-15){    //Very low temp
-				OFFi = OFFi+7*(TEMP+1500l)*(TEMP+1500l);
-				SENSi = SENSi+4*(TEMP+1500l)*(TEMP+1500l);
-			}
-		}
-		else if((TEMP/100)>=20){    //High temp
-			Ti = 2*(dT*dT)/(137438953472LL);
-			OFFi = (1*(TEMP-2000)*(TEMP-2000))/16;
-			SENSi = 0;
-		}
-	}
-
-	OFF2 = OFF-OFFi;           //Calculate pressure and temp second order
-	SENS2 = SENS-SENSi;
-
-	if ( _model == MS5837_02BA ) {
-		TEMP = (TEMP-Ti);
-		P = (((D1*SENS2)/2097152l-OFF2)/32768l)/100;
-	} else {
-		TEMP = (TEMP-Ti);
-		P = (((D1*SENS2)/2097152l-OFF2)/8192l)/10;
-	}
+	// Conversion and second order temp compensation are in lib/compensation.c
+	compensate_ms5837(C, _model, D1, D2, &P, &TEMP);
 }
 
 static uint8_t crc4(uint16_t *n_prom) {
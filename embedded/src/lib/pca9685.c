@@ -72,6 +72,26 @@ void pca9685_setPWM(uint32_t device, uint8_t num, uint16_t on, uint16_t off) {
   writeI2C(device, _i2caddr, buffer, 5);
 }
 
+// Sets count consecutive channels starting at first in a single I2C write,
+// using the register auto increment turned on in setPWMFreq. Every pulse
+// starts at tick 0 and ends at the matching off value.
+void pca9685_setPWMBurst(uint32_t device, uint8_t first, uint8_t count, const uint16_t *off) {
+  uint8_t buffer[1 + 4*16];
+  uint8_t i;
+
+  if ( first + count > 16 )
+    count = 16 - first;
+
+  buffer[0] = LED0_ON_L + 4*first;
+  for (i = 0; i < count; i++) {
+    buffer[1 + 4*i] = 0;
+    buffer[2 + 4*i] = 0;
+    buffer[3 + 4*i] = off[i];
+    buffer[4 + 4*i] = off[i] >> 8;
+  }
+  writeI2C(device, _i2caddr, buffer, 1 + 4*count);
+}
+
 // Sets pin without having to deal with on/off tick placement and properly handles
 // a zero value as completely off.  Optional invert parameter supports inverting
 // the pulse for sinking to ground.  Val should be a value from 0 to 4095 inclusive.
@@ -64,9 +64,10 @@ void writeI2C(uint32_t device, uint8_t addr, uint8_t *data, uint32_t length) {
     }
     */
   }
-  // Don't return until done
+  // Don't return until done. Poll every tick, a burst only takes a few ms
+  // and the thruster task writes one every THRUSTER_UPDATE_HZ
   while(*i2c_int_state != STATE_IDLE) {
-    vTaskDelay(250);
+    vTaskDelay(1);
   }
 
   // Give semaphore back
@@ -156,7 +157,7 @@ void readI2C(uint32_t device, uint8_t addr, uint8_t reg, uint8_t *data, uint32_t
   }
 
   while(*i2c_int_state != STATE_IDLE) {
-    vTaskDelay(250);
+    vTaskDelay(1);
   }
 
   #ifdef DEBUG
@@ -0,0 +1,20 @@
+/*
+ * R@M 2017
+ */
+
+#include "lib/include/safe_mode.h"
+
+// Written by whichever task trips it, read by the thruster task every update
+static volatile bool safe = false;
+
+void safe_mode_enter(void) {
+	safe = true;
+}
+
+void safe_mode_exit(void) {
+	safe = false;
+}
+
+bool safe_mode_active(void) {
+	return safe;
+}
@@ -0,0 +1,170 @@
+/*
+ * R@M 2017
+ */
+
+#include "lib/include/trace.h"
+
+#ifdef SIMULATOR
+#include "sim.h"
+#endif
+
+static struct Trace_Event ring[TRACE_RING_LENGTH];
+
+// Sequence number the next event will be written with
+static uint32_t head = 0;
+
+static uint16_t queue_high_water[DEBUG_MAX_QUEUES];
+static uint32_t next_queue_number = 1;
+
+static bool timer_running = false;
+
+// The trace hooks run inside the kernel and from interrupts above
+// configMAX_SYSCALL_INTERRUPT_PRIORITY, so mask everything rather than
+// using the FreeRTOS critical sections.
+#ifdef SIMULATOR
+// Simulated interrupts are called from a task, only the tick can get in the way
+static inline uint32_t trace_lock(void) {
+	return portSET_INTERRUPT_MASK_FROM_ISR();
+}
+
+static inline void trace_unlock(uint32_t mask) {
+	portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+#else
+static inline uint32_t trace_lock(void) {
+	uint32_t primask;
+	__asm volatile ("mrs %0, primask\n\tcpsid i" : "=r" (primask) :: "memory");
+	return primask;
+}
+
+static inline void trace_unlock(uint32_t primask) {
+	__asm volatile ("msr primask, %0" :: "r" (primask) : "memory");
+}
+#endif
+
+void trace_configure_timer(void) {
+	ROM_SysCtlPeripheralEnable(TRACE_TIMER_PERIPH);
+	while(!ROM_SysCtlPeripheralReady(TRACE_TIMER_PERIPH)) {}
+
+	// A 32 bit half of the wide timer can use the prescaler when counting
+	// down, so divide the system clock down to TRACE_TIMER_HZ and count
+	// down from the top. trace_timestamp() inverts it to count up.
+	ROM_TimerConfigure(TRACE_TIMER_BASE, TIMER_CFG_SPLIT_PAIR | TIMER_CFG_A_PERIODIC);
+	ROM_TimerPrescaleSet(TRACE_TIMER_BASE, TIMER_A, (configCPU_CLOCK_HZ / TRACE_TIMER_HZ) - 1);
+	ROM_TimerLoadSet(TRACE_TIMER_BASE, TIMER_A, UINT32_MAX);
+	ROM_TimerEnable(TRACE_TIMER_BASE, TIMER_A);
+
+	timer_running = true;
+}
+
+uint32_t trace_timestamp(void) {
+	if (!timer_running) {
+		return 0;
+	}
+#ifdef SIMULATOR
+	return sim_time_us();
+#else
+	// Read the register directly, this is called on every context switch
+	return UINT32_MAX - HWREG(TRACE_TIMER_BASE + TIMER_O_TAV);
+#endif
+}
+
+void trace_record(uint8_t type, uint8_t id, uint16_t value) {
+	struct Trace_Event *event;
+	uint32_t primask;
+
+	if (!timer_running) {
+		return;
+	}
+
+	primask = trace_lock();
+
+	event = &ring[head & (TRACE_RING_LENGTH - 1)];
+	event->timestamp = trace_timestamp();
+	event->type = type;
+	event->id = id;
+	event->value = value;
+	head++;
+
+	trace_unlock(primask);
+}
+
+void trace_task_switched_in(uint32_t task_number) {
+	trace_record(TRACE_EVENT_TASK_SWITCH, task_number, 0);
+}
+
+uint32_t trace_register_queue(void) {
+	uint32_t primask = trace_lock();
+	uint32_t number = 0;
+
+	if (next_queue_number < DEBUG_MAX_QUEUES) {
+		number = next_queue_number++;
+	}
+
+	trace_unlock(primask);
+	return number;
+}
+
+void trace_queue_level(uint32_t queue_number, uint32_t level) {
+	if (queue_number == 0 || queue_number >= DEBUG_MAX_QUEUES) {
+		return;
+	}
+	// Cheap check first, this runs on every byte that goes through the UART queues
+	if (level <= queue_high_water[queue_number]) {
+		return;
+	}
+	queue_high_water[queue_number] = level;
+	trace_record(TRACE_EVENT_QUEUE_HIGH_WATER, queue_number, level);
+}
+
+void trace_read(struct Trace_Block *block) {
+	uint32_t primask = trace_lock();
+	uint32_t oldest = (head > TRACE_RING_LENGTH) ? head - TRACE_RING_LENGTH : 0;
+	uint8_t i;
+
+	// Skip ahead if the reader fell behind, or asked for events we don't have yet
+	if (block->sequence < oldest || block->sequence > head) {
+		block->sequence = oldest;
+	}
+
+	for (i = 0; i < DEBUG_TRACE_BLOCK_EVENTS && block->sequence + i != head; i++) {
+		block->events[i] = ring[(block->sequence + i) & (TRACE_RING_LENGTH - 1)];
+	}
+	block->num_events = i;
+	block->head = head;
+
+	trace_unlock(primask);
+}
+
+void trace_runtime_stats(struct Runtime_Stats *stats) {
+	// Only tiqu asks for these, so one copy does. Kept off the heap, which
+	// rarely has this much to spare
+	static TaskStatus_t status[DEBUG_MAX_TASKS];
+	UBaseType_t num_tasks;
+	UBaseType_t i;
+
+	stats->timer_hz = TRACE_TIMER_HZ;
+	stats->num_tasks = 0;
+	for (i = 0; i < DEBUG_MAX_QUEUES; i++) {
+		stats->queue_high_water[i] = queue_high_water[i];
+	}
+
+	// Fills in nothing if there are more tasks than fit
+	num_tasks = uxTaskGetSystemState(status, DEBUG_MAX_TASKS, &(stats->total_run_time));
+	if (num_tasks == 0) {
+		stats->total_run_time = trace_timestamp();
+		return;
+	}
+
+	for (i = 0; i < num_tasks && i < DEBUG_MAX_TASKS; i++) {
+		struct Task_Stats *task = &(stats->tasks[i]);
+		strncpy(task->name, status[i].pcTaskName, DEBUG_TASK_NAME_LENGTH);
+		task->name[DEBUG_TASK_NAME_LENGTH - 1] = '\0';
+		task->run_time = status[i].ulRunTimeCounter;
+		task->stack_high_water = status[i].usStackHighWaterMark;
+		task->task_number = status[i].xTaskNumber;
+		task->priority = status[i].uxCurrentPriority;
+		task->state = status[i].eCurrentState;
+	}
+	stats->num_tasks = i;
+}
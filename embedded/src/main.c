@@ -11,6 +11,7 @@
 #include "tasks/include/example_blink.h"
 #include "tasks/include/example_uart.h"
 #include "tasks/include/i2c_test.h"
+#include "tasks/include/compensation_test.h"
 #include "lib/include/usb_serial.h"
 
 // FreeRTOS
@@ -59,6 +60,12 @@
 #include "include/task_handles.h"
 #include "include/task_queues.h"
 #include "tasks/include/qubobus_test.h"
+#include "tasks/include/thruster_task.h"
+#include "tasks/include/bme280_task.h"
+
+#ifdef SIMULATOR
+#include "sim.h"
+#endif
 
 
 SemaphoreHandle_t i2c0_mutex;
@@ -141,7 +148,9 @@ int main() {
   configureUART();
   configureGPIO();
   configureI2C();
+#ifndef SIMULATOR
   USB_serial_configure();
+#endif
 
   // Master enable interrupts
   ROM_IntMasterEnable();
@@ -223,6 +232,10 @@ int main() {
   if (qubobus_test_init() ){
     while(1){}
   }
+
+  if ( thruster_task_init() ) {
+    while(1){}
+  }
   /*
     if ( read_uart0_init() ) {
     while(1){}
@@ -234,18 +247,28 @@ int main() {
     while(1){}
     }
   */
+  // Feeds the safety monitor, there's no BME280 in the simulator
+#ifndef SIMULATOR
+  if ( bme280_task_init()){
+    while(1){}
+  }
+#endif
+
   /*
-    if ( bme280_task_init()){
+    if ( example_uart_init() ) {
     while(1){}
     }
   */
-
   /*
-    if ( example_uart_init() ) {
+    if ( compensation_test_init() ) {
     while(1){}
     }
   */
 
+#ifdef SIMULATOR
+  sim_init();
+#endif
+
   vTaskStartScheduler();
 
   while(1){}
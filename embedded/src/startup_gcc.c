@@ -41,6 +41,8 @@
 #include "interrupts/include/i2c2_interrupt.h"
 #include "interrupts/include/i2c3_interrupt.h"
 
+#include "interrupts/include/timer1_interrupt.h"
+
 //*****************************************************************************
 //
 // Forward declaration of the default fault handlers.
@@ -123,7 +125,7 @@ void (* const g_pfnVectors[])(void) =
     IntDefaultHandler,                      // Watchdog timer
     IntDefaultHandler,                      // Timer 0 subtimer A
     IntDefaultHandler,                      // Timer 0 subtimer B
-    IntDefaultHandler,                      // Timer 1 subtimer A
+    Timer1AIntHandler,                      // Timer 1 subtimer A
     IntDefaultHandler,                      // Timer 1 subtimer B
     IntDefaultHandler,                      // Timer 2 subtimer A
     IntDefaultHandler,                      // Timer 2 subtimer B
@@ -5,6 +5,10 @@
  */
 #include "tasks/include/bme280_task.h"
 #include "lib/include/printfloat.h"
+#include "lib/include/bme280.h"
+#include "lib/include/monitor.h"
+
+static void bme280_task_loop(void *params);
 
 bool bme280_task_init() {
   if ( xTaskCreate(bme280_task_loop, (const portCHAR *)"BME280 Task", 256, NULL, tskIDLE_PRIORITY + 1, NULL) != pdTRUE) {
@@ -14,12 +18,8 @@ bool bme280_task_init() {
 }
 
 static void bme280_task_loop(void *params) {
-
-  // garbage data
-  uint8_t reg = 0xF0;
-  uint8_t buffer = 0xAA;
-
-
+  TickType_t last_wake;
+  float temperature, pressure, humidity;
 
   #ifdef DEBUG
   UARTprintf("Starting task\n");
@@ -29,40 +29,24 @@ static void bme280_task_loop(void *params) {
     #ifdef DEBUG
     UARTprintf("bme280 amnessia\n");
     #endif
-    //while(1){}
+    // Readings from a sensor that didn't start would only trip the monitor
+    vTaskDelete(NULL);
   }
   #ifdef DEBUG
   UARTprintf("initialized sensor\n");
   #endif
 
-  char string[8];
-  float a = 3;
-  //ftoa(a, string, 5);
-  //ROM_I2CMasterSlaveAddrSet(I2C0_BASE, 0x3C, false);
-
-
+  last_wake = xTaskGetTickCount();
+  for (;;) {
+    // The sensor sits in the battery hull, so it feeds the battery monitor
+    temperature = bme280_readTemperature(I2C0_BASE);
+    pressure = bme280_readPressure(I2C0_BASE);
+    humidity = bme280_readHumidity(I2C0_BASE);
 
+    monitor_sample(M_ID_OFFSET_BATTERY, 0, MONITOR_FIELD_TEMPERATURE, temperature);
+    monitor_sample(M_ID_OFFSET_BATTERY, 0, MONITOR_FIELD_PRESSURE, pressure);
+    monitor_sample(M_ID_OFFSET_BATTERY, 0, MONITOR_FIELD_HUMIDITY, humidity);
 
-    a = bme280_readTemperature(I2C0_BASE);
-    write_uart_wrapper(NULL, &a, sizeof(a));
-    #ifdef DEBUG
-    UARTprintf("finished function call, now in i2c_test task\n");
-    #endif
-    //ftoa(a, string, 5);
-    //sprintf(string, "%f", a);
-
-    #ifdef DEBUG
-    //UARTprintf("%s\n", string);
-    #endif
-    /*
-		#ifdef DEBUG
-    UARTprintf("sending data on i2c");
-		#endif
-    a = bme280_readTemperature(I2C0_BASE);
-    #ifdef DEBUG
-    UARTprintf("Temp: %f\n");
-    #endif
-    */
-  for (;;) {
+    vTaskDelayUntil(&last_wake, BME280_PERIOD_MS / portTICK_RATE_MS);
   }
 }
@@ -0,0 +1,118 @@
+/*
+ * R@M 2017
+ */
+
+#include "tasks/include/compensation_test.h"
+
+// Samples per measurement, the inputs change each one so nothing is hoisted
+#define SAMPLES 256
+
+// TivaWare only has the DWT base address
+#define DWT_O_CTRL   0x00000000
+#define DWT_O_CYCCNT 0x00000004
+#define DWT_CTRL_CYCCNTENA 0x00000001
+// Trace enable in the debug exception and monitor control register
+#define NVIC_DBG_INT_TRCENA 0x01000000
+
+// Example calibration from the BME280 datasheet, same as test/test_compensation.c
+static const bme280_calib_data bme280_calib = {
+  .dig_T1 = 27504, .dig_T2 = 26435, .dig_T3 = -1000,
+  .dig_P1 = 36477, .dig_P2 = -10685, .dig_P3 = 3024, .dig_P4 = 2855, .dig_P5 = 140,
+  .dig_P6 = -7, .dig_P7 = 15500, .dig_P8 = -14600, .dig_P9 = 6000,
+  .dig_H1 = 75, .dig_H2 = 362, .dig_H3 = 0, .dig_H4 = 313, .dig_H5 = 50, .dig_H6 = 30,
+};
+
+static const uint16_t ms5837_prom[8] = {0, 34982, 36352, 20328, 22354, 26646, 26146, 0};
+
+// Results go here so the calls can't be optimized out
+static volatile int32_t sink;
+static volatile double sink_reference;
+
+bool compensation_test_init(void) {
+  if ( xTaskCreate(compensation_test_task, (const portCHAR *)"Compensation Test", 256, NULL,
+                   tskIDLE_PRIORITY + 1, NULL) != pdTRUE) {
+    return true;
+  }
+  return false;
+}
+
+static void cycle_counter_enable(void) {
+  HWREG(NVIC_DBG_INT) |= NVIC_DBG_INT_TRCENA;
+  HWREG(DWT_BASE + DWT_O_CYCCNT) = 0;
+  HWREG(DWT_BASE + DWT_O_CTRL) |= DWT_CTRL_CYCCNTENA;
+}
+
+static uint32_t bme280_fixed(void) {
+  uint32_t start = HWREG(DWT_BASE + DWT_O_CYCCNT);
+  int32_t t_fine;
+  uint32_t i;
+
+  for ( i = 0; i < SAMPLES; i++ ) {
+    sink = compensate_bme280_temperature(&bme280_calib, 519888 + i, &t_fine);
+    sink = compensate_bme280_pressure(&bme280_calib, 415148 + i, t_fine);
+    sink = compensate_bme280_humidity(&bme280_calib, 30000 + i, t_fine);
+  }
+  return (HWREG(DWT_BASE + DWT_O_CYCCNT) - start) / SAMPLES;
+}
+
+static uint32_t bme280_reference(void) {
+  uint32_t start = HWREG(DWT_BASE + DWT_O_CYCCNT);
+  int32_t t_fine;
+  uint32_t i;
+
+  for ( i = 0; i < SAMPLES; i++ ) {
+    sink_reference = compensate_bme280_temperature_reference(&bme280_calib, 519888 + i, &t_fine);
+    sink_reference = compensate_bme280_pressure_reference(&bme280_calib, 415148 + i, t_fine);
+    sink_reference = compensate_bme280_humidity_reference(&bme280_calib, 30000 + i, t_fine);
+  }
+  return (HWREG(DWT_BASE + DWT_O_CYCCNT) - start) / SAMPLES;
+}
+
+static uint32_t ms5837_fixed(void) {
+  uint32_t start = HWREG(DWT_BASE + DWT_O_CYCCNT);
+  int32_t depth_scale = compensate_depth_scale(1029);
+  _iq8 p;
+  _iq16 t;
+  uint32_t i;
+
+  for ( i = 0; i < SAMPLES; i++ ) {
+    compensate_ms5837(ms5837_prom, COMPENSATION_MS5837_30BA, 4958179 + i, 6815414, &p, &t);
+    sink = compensate_depth(p, depth_scale);
+  }
+  return (HWREG(DWT_BASE + DWT_O_CYCCNT) - start) / SAMPLES;
+}
+
+static uint32_t ms5837_reference(void) {
+  uint32_t start = HWREG(DWT_BASE + DWT_O_CYCCNT);
+  double p, t;
+  uint32_t i;
+
+  for ( i = 0; i < SAMPLES; i++ ) {
+    compensate_ms5837_reference(ms5837_prom, COMPENSATION_MS5837_30BA, 4958179 + i, 6815414, &p, &t);
+    sink_reference = compensate_depth_reference(p, 1029);
+  }
+  return (HWREG(DWT_BASE + DWT_O_CYCCNT) - start) / SAMPLES;
+}
+
+static void compensation_test_task(void *params) {
+  uint32_t cycles[4];
+
+  cycle_counter_enable();
+
+  for (;;) {
+    // Nothing else gets to run while it's timing
+    vTaskSuspendAll();
+    cycles[0] = bme280_fixed();
+    cycles[1] = bme280_reference();
+    cycles[2] = ms5837_fixed();
+    cycles[3] = ms5837_reference();
+    xTaskResumeAll();
+
+    #ifdef DEBUG
+    UARTprintf("BME280 cycles/sample: fixed %u reference %u\n", cycles[0], cycles[1]);
+    UARTprintf("MS5837 cycles/sample: fixed %u reference %u\n", cycles[2], cycles[3]);
+    #endif
+
+    vTaskDelay(5000 / portTICK_RATE_MS);
+  }
+}
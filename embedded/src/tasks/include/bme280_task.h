@@ -10,10 +10,11 @@
 #include <FreeRTOS.h>
 #include <task.h>
 
-#include "lib/include/bme280.h"
+#include <stdbool.h>
 
-bool bme280_task_init(void);
+// How often the hull environment is read and checked
+#define BME280_PERIOD_MS 1000
 
-static void bme280_task_loop(void *params);
+bool bme280_task_init(void);
 
 #endif
@@ -0,0 +1,28 @@
+/*
+ * R@M 2017
+ *
+ * Times the fixed point compensation in lib/compensation.c against the double
+ * precision reference with the cycle counter, and prints cycles per sample
+ * over UART0 in debug builds.
+ */
+
+#ifndef _COMPENSATION_TEST_H_
+#define _COMPENSATION_TEST_H_
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <inc/hw_memmap.h>
+#include <inc/hw_nvic.h>
+#include <inc/hw_types.h>
+#include <utils/uartstdio.h>
+
+#include "lib/include/compensation.h"
+
+bool compensation_test_init(void);
+
+static void compensation_test_task(void *params);
+
+#endif
@@ -0,0 +1,73 @@
+/*
+ * R@M 2017
+ *
+ * Fixed rate thruster output stage.
+ *
+ * tiqu drops M_ID_THRUSTER_SET payloads on thruster_queue, this task keeps the
+ * latest setpoint for each thruster and is woken by TIMER1A at
+ * THRUSTER_UPDATE_HZ to slew the outputs towards them and write every channel
+ * to the PCA9685 in one auto increment burst. If no setpoint arrives for
+ * THRUSTER_TIMEOUT_MS, or while in safe mode, all thrusters drop straight to
+ * neutral.
+ */
+
+#ifndef _THRUSTER_TASK_H_
+#define _THRUSTER_TASK_H_
+
+// FreeRTOS
+#include <FreeRTOS.h>
+#include <queue.h>
+#include <task.h>
+
+// Tiva
+#include <stdbool.h>
+#include <stdint.h>
+#include <inc/hw_ints.h>
+#include <inc/hw_memmap.h>
+#include <driverlib/interrupt.h>
+#include <driverlib/rom.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/timer.h>
+
+// Qubobus
+#include "qubobus.h"
+#include "io.h"
+
+#include "include/task_handles.h"
+#include "include/task_queues.h"
+#include "lib/include/pca9685.h"
+#include "lib/include/safe_mode.h"
+
+#define THRUSTER_COUNT 8
+
+#define THRUSTER_I2C_DEVICE I2C0_BASE
+#define THRUSTER_PCA9685_ADDRESS 0x40
+// Channel on the PCA9685 wired to thruster 0, the rest follow in order
+#define THRUSTER_FIRST_CHANNEL 0
+
+// Rate the outputs are recomputed and written at
+#define THRUSTER_UPDATE_HZ 400
+#define THRUSTER_TIMER_BASE TIMER1_BASE
+#define THRUSTER_TIMER_PERIPH SYSCTL_PERIPH_TIMER1
+#define THRUSTER_TIMER_INT INT_TIMER1A
+
+// ESC pulse widths for throttles of -1, 0 and 1, at THRUSTER_PWM_FREQ
+#define THRUSTER_PWM_FREQ 400
+#define THRUSTER_PULSE_MIN_US 1100
+#define THRUSTER_PULSE_NEUTRAL_US 1500
+#define THRUSTER_PULSE_MAX_US 1900
+
+// Default limits, applied to every thruster until changed
+#define THRUSTER_SLEW_PER_SEC 4.0f
+#define THRUSTER_DEADBAND 0.05f
+
+// Thrusters go neutral if no setpoint has been received in this long
+#define THRUSTER_TIMEOUT_MS 500
+
+/**
+ * Creates the thruster output task
+ * @return true on failure
+ */
+bool thruster_task_init(void);
+
+#endif
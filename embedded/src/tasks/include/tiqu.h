@@ -25,6 +25,9 @@
 
 #include "lib/include/uart_queue.h"
 #include "lib/include/rgb.h"
+#include "lib/include/trace.h"
+#include "lib/include/monitor.h"
+#include "lib/include/safe_mode.h"
 #include "include/task_handles.h"
 #include "include/task_queues.h"
 
@@ -33,21 +33,6 @@ ssize_t qubobus_test_task(void* params){
 			}
 			break;
 		}
-		case M_ID_THRUSTER_SET: {
-			if (xQueueReceive(thruster_queue, (void*)&msg, 0) != pdPASS) {
-				blink_rgb(RED_LED, 1);
-				return -1;
-			} else {
-				struct Thruster_Set t_s = *((struct Thruster_Set*)msg.payload);
-				if (t_s.throttle > 128 && t_s.thruster_id < 5) {
-					/* blink_rgb(GREEN_LED, 1); */
-				} else {
-					/* blink_rgb(BLUE_LED, 1); */
-				}
-				vPortFree(msg.payload);
-			}
-			break;
-		}
 		default: {
 			break;
 		}
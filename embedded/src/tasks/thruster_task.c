@@ -0,0 +1,163 @@
+/*
+ * R@M 2017
+ */
+
+#include "tasks/include/thruster_task.h"
+
+#include <math.h>
+
+// Latest throttle requested for each thruster, and what is being output now
+static float setpoint[THRUSTER_COUNT];
+static float output[THRUSTER_COUNT];
+
+// Per thruster limits, the most a throttle can move in one update and the
+// smallest throttle that isn't treated as zero
+static float slew_step[THRUSTER_COUNT];
+static float deadband[THRUSTER_COUNT];
+
+static void thruster_task(void *params);
+
+bool thruster_task_init(void) {
+	if ( xTaskCreate(thruster_task, (const portCHAR *) "Thrusters", 256, NULL,
+					 tskIDLE_PRIORITY + 3, &thruster_task_handle) != pdTRUE) {
+		return true;
+	}
+	return false;
+}
+
+static void configure_timer(void) {
+	ROM_SysCtlPeripheralEnable(THRUSTER_TIMER_PERIPH);
+	while(!ROM_SysCtlPeripheralReady(THRUSTER_TIMER_PERIPH)) {}
+
+	ROM_TimerConfigure(THRUSTER_TIMER_BASE, TIMER_CFG_PERIODIC);
+	ROM_TimerLoadSet(THRUSTER_TIMER_BASE, TIMER_A, (configCPU_CLOCK_HZ / THRUSTER_UPDATE_HZ) - 1);
+	ROM_TimerIntEnable(THRUSTER_TIMER_BASE, TIMER_TIMA_TIMEOUT);
+
+	// The handler uses the FromISR API, so it can't be above the syscall priority
+	ROM_IntPrioritySet(THRUSTER_TIMER_INT, configMAX_SYSCALL_INTERRUPT_PRIORITY);
+	ROM_IntEnable(THRUSTER_TIMER_INT);
+	ROM_TimerEnable(THRUSTER_TIMER_BASE, TIMER_A);
+}
+
+// Converts a throttle in [-1, 1] to the PCA9685 tick the pulse ends on
+static uint16_t throttle_to_ticks(float throttle) {
+	float us;
+
+	if (throttle >= 0) {
+		us = THRUSTER_PULSE_NEUTRAL_US + throttle * (THRUSTER_PULSE_MAX_US - THRUSTER_PULSE_NEUTRAL_US);
+	} else {
+		us = THRUSTER_PULSE_NEUTRAL_US + throttle * (THRUSTER_PULSE_NEUTRAL_US - THRUSTER_PULSE_MIN_US);
+	}
+
+	return (uint16_t)(us * THRUSTER_PWM_FREQ * 4096 / 1000000 + 0.5f);
+}
+
+// Moves each output one step towards its setpoint
+static bool slew_outputs(void) {
+	bool changed = false;
+	uint8_t i;
+
+	for (i = 0; i < THRUSTER_COUNT; i++) {
+		float target = setpoint[i];
+		float next;
+
+		if (target < deadband[i] && target > -deadband[i]) {
+			target = 0;
+		}
+
+		if (target > output[i] + slew_step[i]) {
+			next = output[i] + slew_step[i];
+		} else if (target < output[i] - slew_step[i]) {
+			next = output[i] - slew_step[i];
+		} else {
+			next = target;
+		}
+
+		if (next != output[i]) {
+			output[i] = next;
+			changed = true;
+		}
+	}
+	return changed;
+}
+
+static void write_outputs(void) {
+	uint16_t ticks[THRUSTER_COUNT];
+	uint8_t i;
+
+	for (i = 0; i < THRUSTER_COUNT; i++) {
+		ticks[i] = throttle_to_ticks(output[i]);
+	}
+	pca9685_setPWMBurst(THRUSTER_I2C_DEVICE, THRUSTER_FIRST_CHANNEL, THRUSTER_COUNT, ticks);
+}
+
+static void thruster_task(void *params) {
+	TickType_t last_command = xTaskGetTickCount();
+	bool timed_out = true;
+	QMsg msg;
+	uint8_t i;
+
+	for (i = 0; i < THRUSTER_COUNT; i++) {
+		setpoint[i] = 0;
+		output[i] = 0;
+		slew_step[i] = THRUSTER_SLEW_PER_SEC / THRUSTER_UPDATE_HZ;
+		deadband[i] = THRUSTER_DEADBAND;
+	}
+
+	pca9685_begin(THRUSTER_I2C_DEVICE, THRUSTER_PCA9685_ADDRESS);
+	pca9685_setPWMFreq(THRUSTER_I2C_DEVICE, THRUSTER_PWM_FREQ);
+	write_outputs();
+
+	configure_timer();
+
+	for (;;) {
+		bool changed;
+
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+		// Only the newest setpoint for each thruster matters
+		while (xQueueReceive(thruster_queue, &msg, 0) == pdPASS) {
+			struct Thruster_Set *t_s = (struct Thruster_Set*) msg.payload;
+			if (t_s->thruster_id < THRUSTER_COUNT) {
+				float throttle = t_s->throttle;
+				// NaN would get past the clamp, and converting it to ticks is undefined
+				if (!isfinite(throttle)) {
+					throttle = 0;
+				} else if (throttle > 1) {
+					throttle = 1;
+				} else if (throttle < -1) {
+					throttle = -1;
+				}
+				setpoint[t_s->thruster_id] = throttle;
+				last_command = xTaskGetTickCount();
+				timed_out = false;
+			}
+			vPortFree(msg.payload);
+		}
+
+		if ((xTaskGetTickCount() - last_command) > pdMS_TO_TICKS(THRUSTER_TIMEOUT_MS)) {
+			timed_out = true;
+		}
+
+		// Lost the host or told to be safe, stop now rather than slewing down
+		if (timed_out || safe_mode_active()) {
+			changed = false;
+			for (i = 0; i < THRUSTER_COUNT; i++) {
+				changed |= (output[i] != 0);
+				setpoint[i] = 0;
+				output[i] = 0;
+			}
+			if (changed) {
+				write_outputs();
+			}
+			continue;
+		}
+
+		changed = slew_outputs();
+
+		// Nothing to do if the outputs already match what the PCA9685 holds
+		if (changed) {
+			write_outputs();
+		}
+	}
+}
@@ -8,9 +8,111 @@
 
 extern struct UART_Queue uart0_queue;
 static char buffer[QUBOBUS_MAX_PAYLOAD_LENGTH];
+// Payload of the responses built here. The heap has no room for the bigger
+// ones (trace blocks and runtime stats are most of this), and the last one has
+// to stay put in case it needs re-sending, so it is never reused until the
+// next request.
+static uint32_t response_buffer[QUBOBUS_MAX_PAYLOAD_LENGTH / sizeof(uint32_t)];
 // This is where a message received from a queue will be put.
 static QMsg q_msg = {.transaction = NULL, .error =  NULL, .payload = NULL};
 
+// Points q_msg at the response for transaction, with response_buffer for its payload if it has one
+static bool prepare_response(const Transaction *transaction){
+	q_msg = (QMsg){.transaction = (Transaction*)transaction,
+				   .error = NULL,
+				   .payload = NULL};
+	if (transaction->response != EMPTY) {
+		if (transaction->response > sizeof(response_buffer)) {
+			return true;
+		}
+		q_msg.payload = response_buffer;
+	}
+	return false;
+}
+
+// Monitor enable/disable/set config/get config are laid out the same way in
+// every module, handled here so each module only has to say which is which
+static uint8_t handle_monitor_request(Message *message){
+	uint8_t id = message->header.message_id;
+
+	if (id == M_ID_BATTERY_MONITOR_ENABLE || id == M_ID_POWER_MONITOR_ENABLE ||
+		id == M_ID_DEPTH_MONITOR_ENABLE || id == M_ID_THRUSTER_MONITOR_ENABLE) {
+		monitor_enable(id - id % 10, true);
+		return prepare_response(id == M_ID_BATTERY_MONITOR_ENABLE ? &tBatteryMonitorEnable :
+								id == M_ID_POWER_MONITOR_ENABLE ? &tPowerMonitorEnable :
+								id == M_ID_DEPTH_MONITOR_ENABLE ? &tDepthMonitorEnable :
+								&tThrusterMonitorEnable);
+	}
+	if (id == M_ID_BATTERY_MONITOR_DISABLE || id == M_ID_POWER_MONITOR_DISABLE ||
+		id == M_ID_DEPTH_MONITOR_DISABLE || id == M_ID_THRUSTER_MONITOR_DISABLE) {
+		monitor_enable(id - id % 10, false);
+		return prepare_response(id == M_ID_BATTERY_MONITOR_DISABLE ? &tBatteryMonitorDisable :
+								id == M_ID_POWER_MONITOR_DISABLE ? &tPowerMonitorDisable :
+								id == M_ID_DEPTH_MONITOR_DISABLE ? &tDepthMonitorDisable :
+								&tThrusterMonitorDisable);
+	}
+
+	switch (id) {
+	case M_ID_BATTERY_MONITOR_SET_CONFIG: {
+		monitor_set_battery_config((struct Battery_Monitor_Config*)message->payload);
+		return prepare_response(&tBatteryMonitorSetConfig);
+	}
+	case M_ID_BATTERY_MONITOR_GET_CONFIG: {
+		if (prepare_response(&tBatteryMonitorGetConfig)) {
+			return -1;
+		}
+		// The request doesn't say which level, report the warning limits
+		((struct Battery_Monitor_Config*)q_msg.payload)->warning_level = MONITOR_LEVEL_WARNING;
+		monitor_get_battery_config((struct Battery_Monitor_Config*)q_msg.payload);
+		return 0;
+	}
+	case M_ID_POWER_MONITOR_SET_CONFIG: {
+		monitor_set_power_config((struct Power_Monitor_Config*)message->payload);
+		return prepare_response(&tPowerMonitorSetConfig);
+	}
+	case M_ID_POWER_MONITOR_GET_CONFIG: {
+		struct Power_Monitor_Config_Request *request = message->payload;
+		struct Power_Monitor_Config *config;
+		if (prepare_response(&tPowerMonitorGetConfig)) {
+			return -1;
+		}
+		config = q_msg.payload;
+		config->rail_id = request->rail_id;
+		config->warning_level = request->warning_level;
+		monitor_get_power_config(config);
+		return 0;
+	}
+	case M_ID_DEPTH_MONITOR_SET_CONFIG: {
+		monitor_set_depth_config((struct Depth_Monitor_Config*)message->payload);
+		return prepare_response(&tDepthMonitorSetConfig);
+	}
+	case M_ID_DEPTH_MONITOR_GET_CONFIG: {
+		if (prepare_response(&tDepthMonitorGetConfig)) {
+			return -1;
+		}
+		((struct Depth_Monitor_Config*)q_msg.payload)->warning_level =
+			((struct Depth_Monitor_Config_Request*)message->payload)->warning_level;
+		monitor_get_depth_config((struct Depth_Monitor_Config*)q_msg.payload);
+		return 0;
+	}
+	case M_ID_THRUSTER_MONITOR_SET_CONFIG: {
+		monitor_set_thruster_config((struct Thruster_Monitor_Config*)message->payload);
+		return prepare_response(&tThrusterMonitorSetConfig);
+	}
+	case M_ID_THRUSTER_MONITOR_GET_CONFIG: {
+		if (prepare_response(&tThrusterMonitorGetConfig)) {
+			return -1;
+		}
+		((struct Thruster_Monitor_Config*)q_msg.payload)->warning_level = MONITOR_LEVEL_WARNING;
+		monitor_get_thruster_config((struct Thruster_Monitor_Config*)q_msg.payload);
+		return 0;
+	}
+	default: {
+		return -1;
+	}
+	}
+}
+
 bool tiqu_task_init(void){
 	if ( xTaskCreate(tiqu_task, (const portCHAR *) "Tiva Qubobus", 1024, NULL,
 					 tskIDLE_PRIORITY + 2, NULL) != pdTRUE) {
@@ -31,12 +133,50 @@ static uint8_t handle_request(IO_State *state, Message *message, const uint8_t*
 
 	else if (message->header.message_id >= M_ID_OFFSET_DEBUG) {
 
-		return 0;
+		switch (message->header.message_id) {
+
+		case M_ID_DEBUG_TRACE_READ: {
+			// The trace ring is readable from here, no need to bother another task
+			if (prepare_response(&tDebugTraceRead)) {
+				return -1;
+			}
+
+			((struct Trace_Block*)q_msg.payload)->sequence =
+				((struct Trace_Read_Request*)message->payload)->sequence;
+			trace_read((struct Trace_Block*)q_msg.payload);
+			break;
+		}
+		case M_ID_DEBUG_RUNTIME_STATS: {
+			if (prepare_response(&tDebugRuntimeStats)) {
+				return -1;
+			}
+
+			trace_runtime_stats((struct Runtime_Stats*)q_msg.payload);
+			break;
+		}
+		default: {
+			return 0;
+		}
+		}
 	}
 
 	else if (message->header.message_id >= M_ID_OFFSET_DEPTH) {
 
-		return 0;
+		switch (message->header.message_id) {
+
+		case M_ID_DEPTH_MONITOR_ENABLE:
+		case M_ID_DEPTH_MONITOR_DISABLE:
+		case M_ID_DEPTH_MONITOR_SET_CONFIG:
+		case M_ID_DEPTH_MONITOR_GET_CONFIG: {
+			if (handle_monitor_request(message)) {
+				return -1;
+			}
+			break;
+		}
+		default: {
+			return 0;
+		}
+		}
 	}
 
 	else if (message->header.message_id >= M_ID_OFFSET_PNEUMATICS) {
@@ -56,32 +196,103 @@ static uint8_t handle_request(IO_State *state, Message *message, const uint8_t*
 
 			*((struct Thruster_Set*)q_msg.payload) = *((struct Thruster_Set*)message->payload);
 
-			/* Send it to the task */
+			/* The thruster task picks it up on its next update */
 			if ( xQueueSend(thruster_queue, (void*)&q_msg,
 							((struct UART_Queue*)state->io_host)->transfer_timeout) != pdPASS) {
+				vPortFree(q_msg.payload);
 				return -1;
 			}
-			/* Notify the task */
-			xTaskNotify(qubobus_test_handle, message->header.message_id, eSetValueWithOverwrite);
-				/* create response */
-				q_msg.payload = NULL;
+			/* create response */
+			q_msg.payload = NULL;
+			break;
+		}
+		case M_ID_THRUSTER_MONITOR_ENABLE:
+		case M_ID_THRUSTER_MONITOR_DISABLE:
+		case M_ID_THRUSTER_MONITOR_SET_CONFIG:
+		case M_ID_THRUSTER_MONITOR_GET_CONFIG: {
+			if (handle_monitor_request(message)) {
+				return -1;
+			}
+			break;
+		}
+		default: {
+			return 0;
 		}
 		}
 	}
 
 	else if (message->header.message_id >= M_ID_OFFSET_POWER) {
 
-		return 0;
+		switch (message->header.message_id) {
+
+		case M_ID_POWER_MONITOR_ENABLE:
+		case M_ID_POWER_MONITOR_DISABLE:
+		case M_ID_POWER_MONITOR_SET_CONFIG:
+		case M_ID_POWER_MONITOR_GET_CONFIG: {
+			if (handle_monitor_request(message)) {
+				return -1;
+			}
+			break;
+		}
+		default: {
+			return 0;
+		}
+		}
 	}
 
 	else if (message->header.message_id >= M_ID_OFFSET_BATTERY) {
 
-		return 0;
+		switch (message->header.message_id) {
+
+		case M_ID_BATTERY_MONITOR_ENABLE:
+		case M_ID_BATTERY_MONITOR_DISABLE:
+		case M_ID_BATTERY_MONITOR_SET_CONFIG:
+		case M_ID_BATTERY_MONITOR_GET_CONFIG: {
+			if (handle_monitor_request(message)) {
+				return -1;
+			}
+			break;
+		}
+		default: {
+			return 0;
+		}
+		}
 	}
 
 	else if (message->header.message_id >= M_ID_OFFSET_SAFETY) {
 
-		return 0;
+		switch (message->header.message_id) {
+
+		case M_ID_SAFETY_STATUS: {
+			if (prepare_response(&tSafetyStatus)) {
+				return -1;
+			}
+			// There is no hardware kill switch input wired to the Tiva
+			((struct Safety_Status*)q_msg.payload)->hardware_sw = 0;
+			((struct Safety_Status*)q_msg.payload)->sofware_sw = safe_mode_active();
+			break;
+		}
+		case M_ID_SAFETY_SET_SAFE: {
+			safe_mode_enter();
+			prepare_response(&tSafetySetSafe);
+			break;
+		}
+		case M_ID_SAFETY_SET_UNSAFE: {
+			safe_mode_exit();
+			prepare_response(&tSafetySetUnsafe);
+			break;
+		}
+		case M_ID_SAFETY_MONITOR_EVENTS: {
+			if (prepare_response(&tSafetyMonitorEvents)) {
+				return -1;
+			}
+			monitor_read_events((struct Monitor_Events*)q_msg.payload);
+			break;
+		}
+		default: {
+			return 0;
+		}
+		}
 	}
 
 	else if (message->header.message_id >= M_ID_OFFSET_EMBEDDED) {
@@ -120,6 +331,7 @@ static uint8_t handle_request(IO_State *state, Message *message, const uint8_t*
 		blink_rgb(RED_LED, 1);
 		return -1;
 	}
+	trace_frame_out(&response);
 	// Everything worked
 	return 0;
 }
@@ -139,6 +351,7 @@ static uint8_t handle_error(IO_State *state, Message *message, const uint8_t* bu
 		if ( write_message( state, &response ) ){
 			return -1;
 		}
+		trace_frame_out(&response);
 		return 0;
 	}
 	default: {
@@ -163,6 +376,7 @@ static void tiqu_task(void *params){
 		for(;;){
 
 			if( read_message( &state, &message, buffer ) != 0 ) break;
+			trace_frame_in(&message);
 
 			switch ( message.header.message_type ){
 
@@ -181,13 +395,17 @@ static void tiqu_task(void *params){
 				if ( write_message( &state, &message ) != 0){
 					goto reconnect;
 				}
+				trace_frame_out(&message);
 				break;
 			}
 			case MT_REQUEST: {
 
 				// we free here so that the previous message can hang around so we
-				// can re-transmit it in case of a checksum error
-				vPortFree(q_msg.payload);
+				// can re-transmit it in case of a checksum error. Only payloads
+				// from other tasks were allocated
+				if (q_msg.payload != response_buffer) {
+					vPortFree(q_msg.payload);
+				}
 				q_msg.payload = NULL;
 				if (handle_request(&state, &message, buffer)){
 					goto reconnect;
@@ -0,0 +1,15 @@
+/*
+ * R@M 2017
+ *
+ * Just enough of FreeRTOS for make test to build src/lib on this machine.
+ * Everything runs on one thread, so critical sections have nothing to do.
+ */
+
+#ifndef _TEST_FREERTOS_H_
+#define _TEST_FREERTOS_H_
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+
+#endif
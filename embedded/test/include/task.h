@@ -0,0 +1,17 @@
+/*
+ * R@M 2017
+ */
+
+#ifndef _TEST_TASK_H_
+#define _TEST_TASK_H_
+
+#include "FreeRTOS.h"
+
+// The tests set this to whatever time they want the code to see
+extern TickType_t test_tick_count;
+
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+#define xTaskGetTickCount() (test_tick_count)
+
+#endif
@@ -0,0 +1,252 @@
+/*
+ * R@M 2017
+ *
+ * Checks the fixed point compensation in src/lib/compensation.c against the
+ * datasheets' double precision formulas, over the range the sensors will
+ * actually see. Also prints how long each takes per sample on this machine,
+ * see tasks/compensation_test.c for cycle counts on the Tiva.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+
+#include "lib/include/compensation.h"
+
+// Largest allowed difference from the reference
+#define BME280_TEMPERATURE_ERROR 0.01    // C
+// The datasheet's 32 bit pressure algorithm, still well inside the sensor's
+// 12 Pa relative accuracy
+#define BME280_PRESSURE_ERROR    8.0     // Pa
+#define BME280_HUMIDITY_ERROR    0.05    // %
+#define MS5837_TEMPERATURE_ERROR 0.01    // C
+#define MS5837_02BA_ERROR        1.0     // Pa
+#define MS5837_30BA_ERROR        5.0     // Pa
+#define DEPTH_ERROR              0.001   // m
+
+#define TIMING_SAMPLES 1000000
+
+// Example calibration from the BME280 datasheet, with typical humidity values
+static const bme280_calib_data bme280_calib = {
+    .dig_T1 = 27504, .dig_T2 = 26435, .dig_T3 = -1000,
+    .dig_P1 = 36477, .dig_P2 = -10685, .dig_P3 = 3024, .dig_P4 = 2855, .dig_P5 = 140,
+    .dig_P6 = -7, .dig_P7 = 15500, .dig_P8 = -14600, .dig_P9 = 6000,
+    .dig_H1 = 75, .dig_H2 = 362, .dig_H3 = 0, .dig_H4 = 313, .dig_H5 = 50, .dig_H6 = 30,
+};
+
+// PROM contents from the MS5837 datasheets' example calculations
+static const uint16_t ms5837_30ba_prom[8] = {0, 34982, 36352, 20328, 22354, 26646, 26146, 0};
+static const uint16_t ms5837_02ba_prom[8] = {0, 46372, 43981, 29059, 27842, 31553, 28165, 0};
+
+static volatile int32_t sink;
+static volatile double sink_reference;
+
+static int check(const char *name, double worst, double bound, int samples) {
+    int success = samples > 0 && worst <= bound;
+
+    printf("%-24s %8d samples, worst error %.6f (bound %.6f) %s\n",
+           name, samples, worst, bound, success ? "OK" : "FAIL");
+    return success;
+}
+
+static void track(double *worst, double error) {
+    error = fabs(error);
+    if (error > *worst) {
+        *worst = error;
+    }
+}
+
+static double elapsed_ns(clock_t start) {
+    return (double)(clock() - start) / CLOCKS_PER_SEC * 1e9 / TIMING_SAMPLES;
+}
+
+static int test_bme280(void) {
+    int success = 1;
+    double worst_t = 0, worst_p = 0, worst_h = 0;
+    int samples_t = 0, samples_p = 0, samples_h = 0;
+    int32_t adc_T, adc_P, adc_H;
+
+    for (adc_T = 0; adc_T < (1 << 20); adc_T += 37) {
+        int32_t t_fine, t_fine_reference;
+        double reference = compensate_bme280_temperature_reference(&bme280_calib, adc_T, &t_fine_reference);
+        _iq16 t = compensate_bme280_temperature(&bme280_calib, adc_T, &t_fine);
+
+        if (reference < -40.0 || reference > 85.0) {
+            continue;
+        }
+        track(&worst_t, _IQ16toF(t) - reference);
+        samples_t++;
+
+        // Pressure and humidity at a spread of temperatures
+        if (adc_T % 111 != 0) {
+            continue;
+        }
+
+        for (adc_P = 0; adc_P < (1 << 20); adc_P += 1013) {
+            double p_reference = compensate_bme280_pressure_reference(&bme280_calib, adc_P, t_fine_reference);
+
+            if (p_reference < 30000.0 || p_reference > 110000.0) {
+                continue;
+            }
+            // Both from the same t_fine, so only the pressure maths is compared
+            track(&worst_p, _IQ8toF(compensate_bme280_pressure(&bme280_calib, adc_P, t_fine_reference)) - p_reference);
+            samples_p++;
+        }
+
+        for (adc_H = 0; adc_H < (1 << 16); adc_H += 17) {
+            double h_reference = compensate_bme280_humidity_reference(&bme280_calib, adc_H, t_fine_reference);
+
+            track(&worst_h, _IQ16toF(compensate_bme280_humidity(&bme280_calib, adc_H, t_fine_reference)) - h_reference);
+            samples_h++;
+        }
+    }
+
+    success &= check("BME280 temperature", worst_t, BME280_TEMPERATURE_ERROR, samples_t);
+    success &= check("BME280 pressure", worst_p, BME280_PRESSURE_ERROR, samples_p);
+    success &= check("BME280 humidity", worst_h, BME280_HUMIDITY_ERROR, samples_h);
+    return success;
+}
+
+static int test_ms5837(const char *name, const uint16_t *C, uint8_t model, double min, double max, double bound) {
+    char label[32];
+    double worst_t = 0, worst_p = 0;
+    int samples = 0;
+    uint32_t D1, D2;
+
+    for (D2 = C[5] << 8; D2 < (1 << 24); D2 += 1021) {
+        for (D1 = 0; D1 < (1 << 24); D1 += 8191) {
+            double p_reference, t_reference;
+            _iq8 p;
+            _iq16 t;
+
+            compensate_ms5837_reference(C, model, D1, D2, &p_reference, &t_reference);
+            if (t_reference < -20.0 || t_reference > 85.0) {
+                break;
+            }
+            if (p_reference < min || p_reference > max) {
+                continue;
+            }
+
+            compensate_ms5837(C, model, D1, D2, &p, &t);
+            track(&worst_p, _IQ8toF(p) - p_reference);
+            track(&worst_t, _IQ16toF(t) - t_reference);
+            samples++;
+        }
+    }
+
+    // The loop above starts at 20C, the second order corrections are below it
+    for (D2 = C[5] << 8; D2 > (1 << 22); D2 -= 1021) {
+        double p_reference, t_reference;
+        _iq8 p;
+        _iq16 t;
+
+        D1 = C[1] * 100;
+        compensate_ms5837_reference(C, model, D1, D2, &p_reference, &t_reference);
+        if (t_reference < -20.0) {
+            break;
+        }
+        compensate_ms5837(C, model, D1, D2, &p, &t);
+        track(&worst_t, _IQ16toF(t) - t_reference);
+        samples++;
+    }
+
+    snprintf(label, sizeof(label), "%s pressure", name);
+    int success = check(label, worst_p, bound, samples);
+    snprintf(label, sizeof(label), "%s temperature", name);
+    success &= check(label, worst_t, MS5837_TEMPERATURE_ERROR, samples);
+    return success;
+}
+
+// The datasheets' worked examples
+static int test_ms5837_examples(void) {
+    int success = 1;
+    _iq8 p;
+    _iq16 t;
+
+    compensate_ms5837(ms5837_30ba_prom, COMPENSATION_MS5837_30BA, 4958179, 6815414, &p, &t);
+    printf("MS5837-30BA example      %.2f mbar %.2f C (datasheet 3999.8 mbar 19.81 C)\n",
+           _IQ8toF(p) / 100, _IQ16toF(t));
+    success &= fabs(_IQ8toF(p) / 100 - 3999.8) < 0.2 && fabs(_IQ16toF(t) - 19.81) < 0.01;
+
+    compensate_ms5837(ms5837_02ba_prom, COMPENSATION_MS5837_02BA, 6465444, 8077636, &p, &t);
+    printf("MS5837-02BA example      %.2f mbar %.2f C (datasheet 1100.02 mbar 20.00 C)\n",
+           _IQ8toF(p) / 100, _IQ16toF(t));
+    success &= fabs(_IQ8toF(p) / 100 - 1100.02) < 0.02 && fabs(_IQ16toF(t) - 20.00) < 0.01;
+
+    return success;
+}
+
+static int test_depth(void) {
+    double worst = 0;
+    int samples = 0;
+    double pressure;
+    float density;
+
+    for (density = 997; density <= 1029; density += 32) {
+        int32_t scale = compensate_depth_scale(density);
+
+        // Surface to 30 bar
+        for (pressure = COMPENSATION_SURFACE_PA; pressure < 3000000; pressure += 97.3) {
+            _iq8 p = (_iq8)(pressure * 256);
+            track(&worst, _IQ16toF(compensate_depth(p, scale)) - compensate_depth_reference(pressure, density));
+            samples++;
+        }
+    }
+
+    return check("Depth", worst, DEPTH_ERROR, samples);
+}
+
+static void timing(void) {
+    clock_t start;
+    int32_t i, t_fine = 0;
+    _iq8 p;
+    _iq16 t;
+    double p_reference, t_reference;
+
+    start = clock();
+    for (i = 0; i < TIMING_SAMPLES; i++) {
+        int32_t adc = 519888 + (i & 1023);
+        sink = compensate_bme280_temperature(&bme280_calib, adc, &t_fine);
+        sink = compensate_bme280_pressure(&bme280_calib, 415148 + (i & 1023), t_fine);
+        sink = compensate_bme280_humidity(&bme280_calib, 30000 + (i & 1023), t_fine);
+    }
+    printf("BME280 fixed point       %.1f ns/sample\n", elapsed_ns(start));
+
+    start = clock();
+    for (i = 0; i < TIMING_SAMPLES; i++) {
+        int32_t adc = 519888 + (i & 1023);
+        sink_reference = compensate_bme280_temperature_reference(&bme280_calib, adc, &t_fine);
+        sink_reference = compensate_bme280_pressure_reference(&bme280_calib, 415148 + (i & 1023), t_fine);
+        sink_reference = compensate_bme280_humidity_reference(&bme280_calib, 30000 + (i & 1023), t_fine);
+    }
+    printf("BME280 reference         %.1f ns/sample\n", elapsed_ns(start));
+
+    start = clock();
+    for (i = 0; i < TIMING_SAMPLES; i++) {
+        compensate_ms5837(ms5837_30ba_prom, COMPENSATION_MS5837_30BA, 4958179 + (i & 1023), 6815414, &p, &t);
+        sink = p;
+    }
+    printf("MS5837 fixed point       %.1f ns/sample\n", elapsed_ns(start));
+
+    start = clock();
+    for (i = 0; i < TIMING_SAMPLES; i++) {
+        compensate_ms5837_reference(ms5837_30ba_prom, COMPENSATION_MS5837_30BA, 4958179 + (i & 1023), 6815414,
+                                    &p_reference, &t_reference);
+        sink_reference = p_reference;
+    }
+    printf("MS5837 reference         %.1f ns/sample\n", elapsed_ns(start));
+}
+
+int main() {
+    int success = 1;
+
+    success &= test_bme280();
+    success &= test_ms5837("MS5837-02BA", ms5837_02ba_prom, COMPENSATION_MS5837_02BA, 30000, 110000, MS5837_02BA_ERROR);
+    success &= test_ms5837("MS5837-30BA", ms5837_30ba_prom, COMPENSATION_MS5837_30BA, 30000, 3000000, MS5837_30BA_ERROR);
+    success &= test_ms5837_examples();
+    success &= test_depth();
+
+    timing();
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+/*
+ * R@M 2017
+ *
+ * Drives src/lib/monitor.c through its levels: events on each change, the
+ * hysteresis that keeps a value sitting on a limit from raising one every
+ * sample, safe mode on critical, and the event queue overflowing.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "lib/include/monitor.h"
+
+TickType_t test_tick_count = 0;
+
+static int failures = 0;
+
+static void expect(const char *what, int condition) {
+    if (!condition) {
+        printf("FAIL %s\n", what);
+        failures++;
+    }
+}
+
+// Samples the depth channel and checks the level it ends up at, and how many
+// events that raised
+static void depth(float value, uint8_t level, int new_events) {
+    struct Monitor_Events events;
+    char what[64];
+
+    test_tick_count++;
+    snprintf(what, sizeof(what), "depth %.2f level", value);
+    expect(what, monitor_sample(M_ID_OFFSET_DEPTH, 0, MONITOR_FIELD_DEPTH, value) == level);
+
+    monitor_read_events(&events);
+    snprintf(what, sizeof(what), "depth %.2f events", value);
+    expect(what, events.num_events == new_events);
+    if (new_events > 0) {
+        snprintf(what, sizeof(what), "depth %.2f event", value);
+        expect(what, events.events[0].module == M_ID_OFFSET_DEPTH
+               && events.events[0].field == MONITOR_FIELD_DEPTH
+               && events.events[0].warning_level == level
+               && events.events[0].value == value
+               && events.events[0].uptime == test_tick_count);
+    }
+}
+
+static void test_depth(void) {
+    struct Depth_Monitor_Config config;
+    struct Monitor_Events events;
+
+    // Warning outside 0.5 to 10 m, critical outside 0.25 to 20 m
+    config.warning_level = MONITOR_LEVEL_WARNING;
+    config.depth[LLIMIT] = 0.5f;
+    config.depth[HLIMIT] = 10.0f;
+    monitor_set_depth_config(&config);
+    config.warning_level = MONITOR_LEVEL_CRITICAL;
+    config.depth[LLIMIT] = 0.25f;
+    config.depth[HLIMIT] = 20.0f;
+    monitor_set_depth_config(&config);
+
+    // Nothing is checked until the module is enabled
+    depth(30.0f, MONITOR_LEVEL_NORMAL, 0);
+    expect("disabled leaves safe mode alone", !safe_mode_active());
+    monitor_enable(M_ID_OFFSET_DEPTH, true);
+
+    depth(5.0f, MONITOR_LEVEL_NORMAL, 0);
+    depth(10.1f, MONITOR_LEVEL_WARNING, 1);
+    depth(10.5f, MONITOR_LEVEL_WARNING, 0);
+
+    // 2% of 10 m, back under 9.8 m before it counts as normal again
+    depth(9.9f, MONITOR_LEVEL_WARNING, 0);
+    depth(10.05f, MONITOR_LEVEL_WARNING, 0);
+    depth(9.7f, MONITOR_LEVEL_NORMAL, 1);
+    depth(9.9f, MONITOR_LEVEL_NORMAL, 0);
+
+    expect("safe mode before critical", !safe_mode_active());
+    depth(25.0f, MONITOR_LEVEL_CRITICAL, 1);
+    expect("critical enters safe mode", safe_mode_active());
+
+    // Critical holds until under 19.6 m, then it is only a warning
+    depth(19.8f, MONITOR_LEVEL_CRITICAL, 0);
+    depth(19.5f, MONITOR_LEVEL_WARNING, 1);
+    expect("safe mode waits for the host", safe_mode_active());
+    safe_mode_exit();
+
+    // The low limits back off upwards
+    depth(3.0f, MONITOR_LEVEL_NORMAL, 1);
+    depth(0.4f, MONITOR_LEVEL_WARNING, 1);
+    depth(0.505f, MONITOR_LEVEL_WARNING, 0);
+    depth(0.52f, MONITOR_LEVEL_NORMAL, 1);
+
+    // A disabled module forgets its level, and starts over when enabled
+    depth(12.0f, MONITOR_LEVEL_WARNING, 1);
+    monitor_enable(M_ID_OFFSET_DEPTH, false);
+    expect("disable resets the level",
+           monitor_level(M_ID_OFFSET_DEPTH, 0, MONITOR_FIELD_DEPTH) == MONITOR_LEVEL_NORMAL);
+    monitor_enable(M_ID_OFFSET_DEPTH, true);
+    depth(9.9f, MONITOR_LEVEL_NORMAL, 0);
+
+    // Flapping across a limit past the hysteresis fills the queue, the newest are kept
+    for (int i = 0; i < SAFETY_MAX_MONITOR_EVENTS + 3; i++) {
+        monitor_sample(M_ID_OFFSET_DEPTH, 0, MONITOR_FIELD_DEPTH, (i % 2) ? 5.0f : 15.0f);
+    }
+    monitor_read_events(&events);
+    expect("queue full", events.num_events == SAFETY_MAX_MONITOR_EVENTS);
+    expect("queue dropped", events.dropped == 3);
+    // Eleven changes starting with a warning, the first three are gone
+    expect("queue keeps the newest",
+           events.events[0].warning_level == MONITOR_LEVEL_NORMAL
+           && events.events[0].uptime == test_tick_count
+           && events.events[SAFETY_MAX_MONITOR_EVENTS - 1].warning_level == MONITOR_LEVEL_WARNING);
+    monitor_read_events(&events);
+    expect("queue emptied", events.num_events == 0 && events.dropped == 0);
+}
+
+static void test_thrusters(void) {
+    struct Thruster_Monitor_Config config;
+    struct Monitor_Events events;
+
+    config.warning_level = MONITOR_LEVEL_WARNING;
+    config.thruster_high_A = 20.0f;
+    config.thruster_low_V = 14.0f;
+    monitor_set_thruster_config(&config);
+    monitor_enable(M_ID_OFFSET_THRUSTER, true);
+
+    // Only a current ceiling and a voltage floor, the other sides are open
+    expect("thruster current low", monitor_sample(M_ID_OFFSET_THRUSTER, 3, MONITOR_FIELD_CURRENT, -100.0f)
+           == MONITOR_LEVEL_NORMAL);
+    expect("thruster current high", monitor_sample(M_ID_OFFSET_THRUSTER, 3, MONITOR_FIELD_CURRENT, 21.0f)
+           == MONITOR_LEVEL_WARNING);
+    expect("thruster current hysteresis", monitor_sample(M_ID_OFFSET_THRUSTER, 3, MONITOR_FIELD_CURRENT, 19.8f)
+           == MONITOR_LEVEL_WARNING);
+    expect("thruster current back", monitor_sample(M_ID_OFFSET_THRUSTER, 3, MONITOR_FIELD_CURRENT, 19.0f)
+           == MONITOR_LEVEL_NORMAL);
+    expect("thruster voltage high", monitor_sample(M_ID_OFFSET_THRUSTER, 3, MONITOR_FIELD_VOLTAGE, 1000.0f)
+           == MONITOR_LEVEL_NORMAL);
+    expect("thruster voltage low", monitor_sample(M_ID_OFFSET_THRUSTER, 3, MONITOR_FIELD_VOLTAGE, 13.0f)
+           == MONITOR_LEVEL_WARNING);
+    expect("other thrusters untouched",
+           monitor_level(M_ID_OFFSET_THRUSTER, 2, MONITOR_FIELD_VOLTAGE) == MONITOR_LEVEL_NORMAL);
+    expect("no critical limits, no safe mode", !safe_mode_active());
+
+    monitor_read_events(&events);
+    expect("thruster events", events.num_events == 3 && events.events[2].index == 3);
+
+    // Disabling another module leaves these levels alone
+    monitor_enable(M_ID_OFFSET_DEPTH, false);
+    expect("other module disabled", monitor_level(M_ID_OFFSET_THRUSTER, 3, MONITOR_FIELD_VOLTAGE)
+           == MONITOR_LEVEL_WARNING);
+    monitor_enable(M_ID_OFFSET_THRUSTER, false);
+    expect("own module disabled", monitor_level(M_ID_OFFSET_THRUSTER, 3, MONITOR_FIELD_VOLTAGE)
+           == MONITOR_LEVEL_NORMAL);
+}
+
+static void test_unknown(void) {
+    monitor_enable(M_ID_OFFSET_BATTERY, true);
+
+    // Unconfigured channels and ones that don't exist never trip
+    expect("unconfigured", monitor_sample(M_ID_OFFSET_BATTERY, 0, MONITOR_FIELD_TEMPERATURE, 1e6f)
+           == MONITOR_LEVEL_NORMAL);
+    expect("bad index", monitor_sample(M_ID_OFFSET_BATTERY, MONITOR_NUM_BATTERIES,
+                                       MONITOR_FIELD_VOLTAGE, 0.0f) == MONITOR_LEVEL_NORMAL);
+    expect("bad field", monitor_sample(M_ID_OFFSET_DEPTH, 0, MONITOR_FIELD_VOLTAGE, 1e6f)
+           == MONITOR_LEVEL_NORMAL);
+}
+
+int main() {
+    test_depth();
+    test_thrusters();
+    test_unknown();
+
+    printf("Monitor                  %s\n", failures ? "FAIL" : "OK");
+    return failures ? 1 : 0;
+}
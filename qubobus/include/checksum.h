@@ -0,0 +1,35 @@
+/*
+ * Checksums used by Qubobus and the serial drivers built around it.
+ *
+ * The Qubobus and DVL protocols use a 16 bit sum of the bytes, the PNI AHRS
+ * uses CRC-16/XMODEM. Both take the running value so a message can be
+ * checked in pieces, start from 0.
+ */
+
+#ifndef QUBOBUS_CHECKSUM_H
+#define QUBOBUS_CHECKSUM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 16 bit sum of the bytes, overflow wraps.
+ */
+uint16_t checksum_sum16(uint16_t sum, const void *data, size_t bytes);
+
+/*
+ * CRC-CCITT, polynomial 0x1021, MSB first with no final XOR. Starting from
+ * 0 this is CRC-16/XMODEM, from 0xFFFF it is CRC-16/CCITT-FALSE.
+ * One table lookup per byte.
+ */
+uint16_t checksum_crc16_ccitt(uint16_t crc, const void *data, size_t bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -10,6 +10,10 @@ enum {
     M_ID_DEBUG_LOG_ENABLE,
 
     M_ID_DEBUG_LOG_DISABLE,
+
+    M_ID_DEBUG_TRACE_READ,
+
+    M_ID_DEBUG_RUNTIME_STATS,
     
     /* TODO: add more debugging operations. */
 };
@@ -20,6 +24,29 @@ enum {
     /* TODO: determine what kinds of errors can occur during debugging operations. */
 };
 
+/* Kinds of events recorded in the embedded trace ring. */
+enum {
+    TRACE_EVENT_TASK_SWITCH,
+    TRACE_EVENT_ISR_ENTER,
+    TRACE_EVENT_ISR_EXIT,
+    TRACE_EVENT_QUEUE_HIGH_WATER,
+    TRACE_EVENT_FRAME_IN,
+    TRACE_EVENT_FRAME_OUT,
+};
+
+/* Interrupt sources reported by ISR trace events. */
+enum {
+    TRACE_ISR_UART0,
+    TRACE_ISR_UART1,
+    TRACE_ISR_I2C0,
+    TRACE_ISR_TIMER1,
+};
+
+#define DEBUG_TRACE_BLOCK_EVENTS 60
+#define DEBUG_MAX_TASKS 16
+#define DEBUG_MAX_QUEUES 16
+#define DEBUG_TASK_NAME_LENGTH 12
+
 struct Log_Read_Request {
     uint32_t block_id;
 };
@@ -28,9 +55,69 @@ struct Log_Block {
     char data[512];
 };
 
+/*
+ * A single entry in the trace ring.
+ * Timestamps are in ticks of the run time stats timer, which wraps.
+ * The meaning of id and value depends on the type:
+ *   TASK_SWITCH       id = task number switched in
+ *   ISR_ENTER/EXIT    id = TRACE_ISR_* source
+ *   QUEUE_HIGH_WATER  id = queue number, value = new high water mark
+ *   FRAME_IN/OUT      id = message id, value = message type << 12 | num_bytes
+ */
+struct Trace_Event {
+    uint32_t timestamp;
+    uint8_t type;
+    uint8_t id;
+    uint16_t value;
+};
+
+struct Trace_Read_Request {
+    /* Sequence number of the first event wanted. */
+    uint32_t sequence;
+};
+
+struct Trace_Block {
+    /* 
+     * Sequence number of events[0].
+     * This is later than the requested sequence if events were overwritten.
+     */
+    uint32_t sequence;
+
+    /* Sequence number the next recorded event will get. */
+    uint32_t head;
+
+    uint8_t num_events;
+
+    struct Trace_Event events[DEBUG_TRACE_BLOCK_EVENTS];
+};
+
+struct Task_Stats {
+    char name[DEBUG_TASK_NAME_LENGTH];
+    uint32_t run_time;
+    uint16_t stack_high_water;
+    uint8_t task_number;
+    uint8_t priority;
+    uint8_t state;
+};
+
+struct Runtime_Stats {
+    /* Total run time counter and the rate it counts at. */
+    uint32_t total_run_time;
+    uint32_t timer_hz;
+
+    /* High water marks of the traced queues, indexed by queue number. */
+    uint16_t queue_high_water[DEBUG_MAX_QUEUES];
+
+    uint8_t num_tasks;
+
+    struct Task_Stats tasks[DEBUG_MAX_TASKS];
+};
+
 extern const Transaction tDebugLogRead;
 extern const Transaction tDebugLogEnable;
 extern const Transaction tDebugLogDisable;
+extern const Transaction tDebugTraceRead;
+extern const Transaction tDebugRuntimeStats;
 extern const Error eDebugLogError;
 
 #endif
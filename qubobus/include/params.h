@@ -1,5 +1,5 @@
 
-#define QUBOBUS_PROTOCOL_VERSION 3
+#define QUBOBUS_PROTOCOL_VERSION 4
 
 #define QUBOBUS_ANNOUNCE_INTERVAL_S 5
 #define QUBOBUS_KEEPALIVE_INTERVAL_S 1
@@ -9,16 +9,55 @@ enum {
 
     M_ID_SAFETY_SET_SAFE,
 
-    M_ID_SAFETY_SET_UNSAFE
+    M_ID_SAFETY_SET_UNSAFE,
+
+    M_ID_SAFETY_MONITOR_EVENTS
+};
+
+/* Quantities a monitor event can be raised for. */
+enum {
+    MONITOR_FIELD_VOLTAGE,
+    MONITOR_FIELD_CURRENT,
+    MONITOR_FIELD_HUMIDITY,
+    MONITOR_FIELD_PRESSURE,
+    MONITOR_FIELD_TEMPERATURE,
+    MONITOR_FIELD_HYDROGEN,
+    MONITOR_FIELD_DEPTH,
 };
 
+#define SAFETY_MAX_MONITOR_EVENTS 8
+
 struct Safety_Status {
     uint8_t hardware_sw;
     uint8_t sofware_sw;
 };
 
+/*
+ * Raised by the QSCU whenever a monitored value changes warning level.
+ * module is the M_ID_OFFSET_* of the module the value belongs to, and index
+ * is the battery, rail, or thruster id within it.
+ */
+struct Monitor_Event {
+    float value;
+    uint32_t uptime;
+
+    uint8_t module;
+    uint8_t index;
+    uint8_t field;
+    uint8_t warning_level;
+};
+
+struct Monitor_Events {
+    struct Monitor_Event events[SAFETY_MAX_MONITOR_EVENTS];
+
+    uint8_t num_events;
+    /* Events lost because the host didn't read them fast enough */
+    uint8_t dropped;
+};
+
 extern const Transaction tSafetyStatus;
 extern const Transaction tSafetySetSafe;
 extern const Transaction tSafetySetUnsafe;
+extern const Transaction tSafetyMonitorEvents;
 
 #endif
@@ -21,6 +21,20 @@ const Transaction tDebugLogDisable = {
     .response = EMPTY,
 };
 
+const Transaction tDebugTraceRead = {
+    .name = "Debug Trace Read",
+    .id = M_ID_DEBUG_TRACE_READ,
+    .request = sizeof(struct Trace_Read_Request),
+    .response = sizeof(struct Trace_Block),
+};
+
+const Transaction tDebugRuntimeStats = {
+    .name = "Debug Runtime Stats",
+    .id = M_ID_DEBUG_RUNTIME_STATS,
+    .request = EMPTY,
+    .response = sizeof(struct Runtime_Stats),
+};
+
 const Error eDebugLogError = {
     .name = "Debug Log Error",
     .id = E_ID_DEBUG_LOG_ERROR,
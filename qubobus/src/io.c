@@ -1,9 +1,9 @@
 #include <io.h>
+#include <checksum.h>
 
 /* Local function definitions. */
 static int read_announce(IO_State *state, Message *message);
 static int safe_io(void *io_host, raw_io_function raw_io, void *data, size_t size);
-static uint16_t crc16(uint16_t crc, const void *data, size_t bytes);
 static void create_message(Message *message, uint8_t message_type, uint8_t message_id, void *payload, size_t payload_size);
 
 /*
@@ -233,10 +233,10 @@ uint16_t checksum_message(Message *message) {
     uint16_t checksum = 0;
 
     /* Compute the checksum for the message header. */
-    checksum = crc16(checksum, &(message->header), sizeof(struct Message_Header));
+    checksum = checksum_sum16(checksum, &(message->header), sizeof(struct Message_Header));
 
     /* Compute the checksum for the payload itself. */
-    checksum = crc16(checksum, message->payload, message->payload_size);
+    checksum = checksum_sum16(checksum, message->payload, message->payload_size);
 
     return checksum;
 }
@@ -264,7 +264,7 @@ static int read_announce(IO_State *state, Message *message) {
     } while (
             header->num_bytes != ANNOUNCE_SIZE ||
             header->message_type != MT_ANNOUNCE ||
-            footer->checksum != crc16(0, header, sizeof(struct Message_Header))
+            footer->checksum != checksum_sum16(0, header, sizeof(struct Message_Header))
             );
 
     message->header = *header;
@@ -295,13 +295,6 @@ static int safe_io(void *io_host, raw_io_function raw_io, void *data, size_t siz
     return bytes_transferred != size;
 }
 
-static uint16_t crc16(uint16_t crc, const void* ptr, size_t bytes) {
-    const uint8_t* data = (const uint8_t*) ptr;
-    for (; bytes > 0; bytes--, data++)
-        crc += *data;
-    return crc;
-}
-
 static void create_message(Message *message, uint8_t message_type, uint8_t message_id, void *payload, size_t payload_size) {
 
     message->header.message_type = message_type;
@@ -20,3 +20,10 @@ const Transaction tSafetySetUnsafe = {
     .request = EMPTY,
     .response = EMPTY,
 };
+
+const Transaction tSafetyMonitorEvents = {
+    .name = "Safety Monitor Events",
+    .id = M_ID_SAFETY_MONITOR_EVENTS,
+    .request = EMPTY,
+    .response = sizeof(struct Monitor_Events),
+};
@@ -0,0 +1,99 @@
+/*
+ * Checks the table driven CRC against the bitwise one the AHRS driver used,
+ * for every CRC state and input byte, and the sum against the loops the DVL
+ * and io.c used. Then times each.
+ */
+
+#include <checksum.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define TIMING_BYTES (64 * 1024 * 1024)
+
+/* AHRS::crc_xmodem_update, as it was */
+static uint16_t crc_xmodem_update(uint16_t crc, uint8_t data) {
+    int i;
+    crc = crc ^ ((uint16_t)data << 8);
+    for (i=0; i<8; i++)
+    {
+        if (crc & 0x8000)
+            crc = (crc << 1) ^ 0x1021;
+        else
+            crc <<= 1;
+    }
+    return crc;
+}
+
+static uint16_t crc_bitwise(uint16_t crc, const uint8_t *data, size_t bytes) {
+    for (; bytes > 0; bytes--, data++)
+        crc = crc_xmodem_update(crc, *data);
+    return crc;
+}
+
+/* DVL::crc16, which summed signed chars */
+static uint16_t sum_signed(uint16_t crc, const char *data, size_t bytes) {
+    for (; bytes > 0; bytes--, data++)
+        crc += *data;
+    return crc;
+}
+
+static double elapsed_ns(clock_t start, size_t bytes) {
+    return (double)(clock() - start) / CLOCKS_PER_SEC * 1e9 / bytes;
+}
+
+int main() {
+    int success = 1;
+    uint32_t crc, byte;
+    size_t i, mismatches = 0;
+    uint8_t *buffer = malloc(TIMING_BYTES);
+    volatile uint16_t sink;
+    clock_t start;
+
+    /* Every state and byte, which covers any message one byte at a time. */
+    for (crc = 0; crc <= 0xFFFF; crc++) {
+        for (byte = 0; byte <= 0xFF; byte++) {
+            uint8_t b = byte;
+            if (checksum_crc16_ccitt(crc, &b, 1) != crc_xmodem_update(crc, b))
+                mismatches++;
+        }
+    }
+    printf("CRC every state and byte   %zu mismatches %s\n", mismatches, mismatches ? "FAIL" : "OK");
+    success &= !mismatches;
+
+    for (i = 0; i < TIMING_BYTES; i++)
+        buffer[i] = rand();
+
+    /* Check values for CRC-16/XMODEM and CRC-16/CCITT-FALSE */
+    success &= checksum_crc16_ccitt(0, "123456789", 9) == 0x31C3;
+    success &= checksum_crc16_ccitt(0xFFFF, "123456789", 9) == 0x29B1;
+    /* Whole buffers, the running value carried through the table */
+    success &= checksum_crc16_ccitt(0, buffer, 4096) == crc_bitwise(0, buffer, 4096);
+    printf("CRC check values           %s\n", success ? "OK" : "FAIL");
+
+    /* Only the low byte was ever compared for the DVL, that has to hold */
+    mismatches = 0;
+    for (i = 0; i < 4096; i++) {
+        if ((checksum_sum16(0, buffer, i) ^ sum_signed(0, (const char*) buffer, i)) & 0xFF)
+            mismatches++;
+    }
+    printf("Sum against signed sum     %zu mismatches %s\n", mismatches, mismatches ? "FAIL" : "OK");
+    success &= !mismatches;
+
+    start = clock();
+    sink = crc_bitwise(0, buffer, TIMING_BYTES);
+    printf("CRC bitwise                %.2f ns/byte\n", elapsed_ns(start, TIMING_BYTES));
+
+    start = clock();
+    sink = checksum_crc16_ccitt(0, buffer, TIMING_BYTES);
+    printf("CRC table                  %.2f ns/byte\n", elapsed_ns(start, TIMING_BYTES));
+
+    start = clock();
+    sink = checksum_sum16(0, buffer, TIMING_BYTES);
+    printf("Sum                        %.2f ns/byte\n", elapsed_ns(start, TIMING_BYTES));
+    (void) sink;
+
+    free(buffer);
+    return success ? 0 : 1;
+}
@@ -4,7 +4,7 @@
 
 #include <qubobus.h>
 
-#if QUBOBUS_PROTOCOL_VERSION != 3
+#if QUBOBUS_PROTOCOL_VERSION != 4
 #error Update me with new message defs!
 #endif
 
@@ -44,6 +44,7 @@ int main() {
     success &= transact(&tSafetyStatus);
     success &= transact(&tSafetySetSafe);
     success &= transact(&tSafetySetUnsafe);
+    success &= transact(&tSafetyMonitorEvents);
 
     /* Tests for messages involving the battery subsystem */
     success &= transact(&tBatteryStatus);
@@ -89,6 +90,8 @@ int main() {
     success &= transact(&tDebugLogRead);
     success &= transact(&tDebugLogEnable);
     success &= transact(&tDebugLogDisable);
+    success &= transact(&tDebugTraceRead);
+    success &= transact(&tDebugRuntimeStats);
     success &= error(&eDebugLogError);
 
     if (success) {
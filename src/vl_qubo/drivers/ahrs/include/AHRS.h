@@ -28,6 +28,18 @@
 #include <termios.h>
 // shared_ptr type
 #include <memory>
+// system_clock type
+#include <chrono>
+// std::thread type
+#include <thread>
+// std::atomic type
+#include <atomic>
+// Lock-free sample buffers
+#include "buffers.h"
+// Buffered serial I/O
+#include "SerialPort.h"
+// CRC shared with the other serial drivers
+#include "checksum.h"
 
 /**
  * Exception class for handling IO/Data integrity errors.
@@ -79,20 +91,44 @@ class AHRS
       /** Data rate to communicate with */
       speed_t _termBaud;
       /** Serial port for I/O with the AHRS */
-      int _deviceFD;
-      /** Timeout (sec,usec) on read/write */
-      struct timeval _timeout;
+      SerialPort _port;
+      /** Time allowed to read or write a whole message */
+      std::chrono::milliseconds _timeout;
       /** Storage for readings from the AHRS for caching purposes. */
       AHRSData _lastReading;
 
-      /** Checksum helper function. */
-      checksum_t crc_xmodem_update (checksum_t crc, uint8_t data);
-      /** Checksum function to compute binary CRC16s. */
-      checksum_t crc16(checksum_t crc, uint8_t* data, bytecount_t bytes);
-      /** Read bytes to a blob, return the bytes not read. */
-      int readRaw(void* blob, int bytes_to_read);
-      /** Write bytes from a blob, return the bytes not written. */
-      int writeRaw(void* blob, int bytes_to_write);
+      /** Number of past samples kept for the consumer in continuous mode. */
+      static constexpr size_t kHistorySize = 64;
+      /** Consecutive bad frames before the reader gives up on the device. */
+      static constexpr int kMaxStreamErrors = 10;
+      /** Reader thread for continuous mode. */
+      std::thread _streamThread;
+      /** Set while the reader thread should keep going. */
+      std::atomic<bool> _streaming;
+      /** Newest sample from continuous mode. */
+      LatestSlot<AHRSSample> _latestSample;
+      /** Every sample from continuous mode, until the consumer takes it. */
+      HistoryRing<AHRSSample, kHistorySize> _sampleHistory;
+      /** Frames the reader couldn't decode. */
+      std::atomic<uint32_t> _streamErrors;
+      /** Data frames decoded, polled or streamed. */
+      uint32_t _sequence;
+
+      /** Body of the reader thread, decodes frames until stopped. */
+      void streamLoop();
+      /** Tell the reader thread to stop, and wait for it. */
+      void joinStream();
+      /** Copy a raw data frame into the user facing format. */
+      AHRSData convertData(const RawData& data);
+      /** Stamp a data frame that has just been read in full. */
+      AHRSSample stampData(const RawData& data);
+      /** Time a frame with this much payload takes on the wire at _termBaud. */
+      std::chrono::nanoseconds frameTime(size_t payload_size);
+
+      /** Read bytes to a blob by the deadline, return the bytes not read. */
+      int readRaw(void* blob, int bytes_to_read, SerialPort::Deadline deadline);
+      /** Write bytes from a blob by the deadline, return the bytes not written. */
+      int writeRaw(const void* blob, int bytes_to_write, SerialPort::Deadline deadline);
 
       /** Read an incoming frame and format it for interpreting. */
       Message readMessage();
@@ -0,0 +1,114 @@
+#ifndef AHRS_BUFFERS_H
+#define AHRS_BUFFERS_H
+
+/*
+ * buffers.h
+ * Lock-free hand-off of samples from the AHRS reader thread.
+ *
+ * Copyright (C) 2017 Robotics at Maryland
+ * All rights reserved.
+ *
+ * Both are single producer, single consumer: the reader thread writes, and
+ * one other thread reads. Neither side ever waits on the other.
+ */
+
+// std::atomic type
+#include <atomic>
+// size_t type
+#include <stddef.h>
+
+/**
+ * Holds the most recent value written to it.
+ * A triple buffer: the writer fills its own slot and swaps it with the shared
+ * one, the reader swaps the shared one for its own. Nothing is copied while
+ * the other side could be touching it.
+ */
+template <typename T>
+class LatestSlot
+{
+   public:
+      LatestSlot() : _shared(1), _back(2), _front(0) {}
+
+      /** Replace the stored value. Producer only. */
+      void write(const T& value) {
+         _slots[_back] = value;
+         _back = _shared.exchange(_back | kFresh) & kIndex;
+      }
+
+      /**
+       * Copy out the stored value. Consumer only.
+       * @return (bool) true if it was written since the last read.
+       */
+      bool read(T& value) {
+         bool fresh = _shared.load() & kFresh;
+         if (fresh)
+            _front = _shared.exchange(_front) & kIndex;
+         value = _slots[_front];
+         return fresh;
+      }
+
+   private:
+      static constexpr unsigned kIndex = 0x3;
+      static constexpr unsigned kFresh = 0x4;
+
+      T _slots[3];
+      /** Slot index the two sides swap through, with kFresh set by the writer. */
+      std::atomic<unsigned> _shared;
+      /** Writer's own slot. */
+      unsigned _back;
+      /** Reader's own slot. */
+      unsigned _front;
+};
+
+/**
+ * Bounded FIFO of the last N values.
+ * When the reader falls behind new values are dropped rather than blocking
+ * the writer, and counted.
+ */
+template <typename T, size_t N>
+class HistoryRing
+{
+   public:
+      HistoryRing() : _head(0), _tail(0), _dropped(0) {}
+
+      /**
+       * Append a value. Producer only.
+       * @return (bool) false if the ring was full and it was dropped.
+       */
+      bool push(const T& value) {
+         size_t head = _head.load(std::memory_order_relaxed);
+         if (head - _tail.load(std::memory_order_acquire) == N) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+         }
+         _slots[head % N] = value;
+         _head.store(head + 1, std::memory_order_release);
+         return true;
+      }
+
+      /**
+       * Take the oldest value. Consumer only.
+       * @return (bool) false if the ring was empty.
+       */
+      bool pop(T& value) {
+         size_t tail = _tail.load(std::memory_order_relaxed);
+         if (tail == _head.load(std::memory_order_acquire))
+            return false;
+         value = _slots[tail % N];
+         _tail.store(tail + 1, std::memory_order_release);
+         return true;
+      }
+
+      /** Number of values dropped because the ring was full. */
+      size_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+   private:
+      T _slots[N];
+      /** Total values pushed, only the producer writes it. */
+      std::atomic<size_t> _head;
+      /** Total values popped, only the consumer writes it. */
+      std::atomic<size_t> _tail;
+      std::atomic<size_t> _dropped;
+};
+
+#endif
@@ -215,6 +215,51 @@ void sendAHRSDataFormat();
  */
 AHRSData pollAHRSData();
 
+/**
+ * Polls the AHRS for position information, and when it was taken.
+ * @return an AHRSSample struct of formatted, stamped AHRS data.
+ */
+AHRSSample pollAHRSSample();
+
+/**
+ * Put the AHRS into continuous mode and start a thread that reads the
+ * frames it sends, so no request round trip is needed per sample.
+ * None of the other calls may be used until the stream is stopped.
+ * @param (float) Seconds between samples, 0 for as fast as possible.
+ */
+void startStreaming(float sample_delay);
+
+/** Stop the reader thread and take the AHRS out of continuous mode. */
+void stopStreaming();
+
+/**
+ * Checks if the reader thread is running.
+ * It stops on its own if the device keeps sending frames it can't decode.
+ * @return (bool) true while samples are being read.
+ */
+bool isStreaming();
+
+/**
+ * Get the newest sample from continuous mode.
+ * @param (AHRSSample&) filled with the sample.
+ * @return (bool) true if it arrived since the last call.
+ */
+bool getLatestSample(AHRSSample& sample);
+
+/**
+ * Take the oldest sample not yet taken from continuous mode.
+ * Up to the last 64 are kept, see droppedSamples() for ones lost after that.
+ * @param (AHRSSample&) filled with the sample.
+ * @return (bool) false if there are none waiting.
+ */
+bool popSample(AHRSSample& sample);
+
+/** @return (size_t) samples dropped because popSample() fell behind. */
+size_t droppedSamples();
+
+/** @return (uint32_t) frames the reader has failed to decode. */
+uint32_t streamErrors();
+
 /**
  * Start User Calibration.
  * @param (CalType) type of calibration.
@@ -282,3 +282,17 @@ typedef struct _AHRSData {
 } AHRSData;
 
 #pragma pack(pop)
+
+/** A reading, with when it arrived and when it was taken. */
+typedef struct _AHRSSample {
+   AHRSData data;
+   /** Host clock when the last byte of the frame was read. */
+   std::chrono::system_clock::time_point received;
+   /**
+    * Host clock estimate of when the AHRS took the reading, which it sends
+    * straight away: received less the time the frame takes on the wire.
+    */
+   std::chrono::system_clock::time_point sampled;
+   /** Counts up by one for every data frame decoded. */
+   uint32_t sequence;
+} AHRSSample;
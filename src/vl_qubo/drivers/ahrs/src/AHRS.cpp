@@ -22,65 +22,27 @@
 #include "impl.cpp"
 
    AHRS::AHRS(std::string deviceFile, AHRSSpeed speed) 
-: _deviceFile(deviceFile), _termBaud(speed.baud), _deviceFD(-1), _timeout({1,0})
+: _deviceFile(deviceFile), _termBaud(speed.baud), _timeout(1000),
+   _streaming(false), _streamErrors(0), _sequence(0)
 { }
 
 AHRS::~AHRS() { closeDevice(); }
 
 void AHRS::openDevice() {
-   struct termios termcfg;
-   int modemcfg = 0, fd = -1;
-   /* Open the serial port and store into a file descriptor.
-    * O_RDWR allows for bi-directional I/O, and
-    * O_NONBLOCK makes it so that read/write does not block.
-    */
-   fd = open(_deviceFile.c_str(), O_RDWR, O_NONBLOCK);
-   // Check to see if the device exists.
-   if (fd == -1)
-      throw AHRSException("Device '"+_deviceFile+"' unavaliable.");
-   // Read the config of the interface.
-   if(tcgetattr(fd, &termcfg)) 
-      throw AHRSException("Unable to read terminal configuration.");
-
-   // Set the baudrate for the terminal
-   if(cfsetospeed(&termcfg, _termBaud))
-      throw AHRSException("Unable to set terminal output speed.");
-   if(cfsetispeed(&termcfg, _termBaud))
-      throw AHRSException("Unable to set terminal intput speed.");
-
-   // Set raw I/O rules to read and write the data purely.
-   cfmakeraw(&termcfg);
-
-   // Configure the read timeout (deciseconds)
-   termcfg.c_cc[VTIME] = 0;
-   // Configure the minimum number of chars for read.
-   termcfg.c_cc[VMIN] = 1;
-
-   // Push the configuration to the terminal NOW.
-   if(tcsetattr(fd, TCSANOW, &termcfg))
-      throw AHRSException("Unable to set terminal configuration.");
-
-   // Pull in the modem configuration
-   if(ioctl(fd, TIOCMGET, &modemcfg))
-      throw AHRSException("Unable to read modem configuration.");
-   // Enable Request to Send
-   modemcfg |= TIOCM_RTS;
-   // Push the modem config back to the modem.
-   if(ioctl(fd, TIOCMSET, &modemcfg))
-      throw AHRSException("Unable to set modem configuration.");
-
-   // Successful execution!
-   _deviceFD = fd;
+   try {
+      _port.openDevice(_deviceFile, _termBaud);
+   } catch (SerialException& ex) {
+      throw AHRSException(ex.what());
+   }
 }
 
-bool AHRS::isOpen() {return _deviceFD >= 0;}
+bool AHRS::isOpen() {return _port.isOpen();}
 
 void AHRS::assertOpen() { if (!isOpen()) throw AHRSException("Device needs to be open!"); }
 
 void AHRS::closeDevice() {
-   if (isOpen()) 
-      close(_deviceFD);
-   _deviceFD = -1;
+   joinStream();
+   _port.closeDevice();
 }
 
 /******************************************************************************
@@ -88,96 +50,20 @@ void AHRS::closeDevice() {
  * All of the following functions are meant for internal-use only
  ******************************************************************************/
 
-AHRS::checksum_t AHRS::crc_xmodem_update (checksum_t crc, uint8_t data)
+int AHRS::readRaw(void* blob, int bytes_to_read, SerialPort::Deadline deadline)
 {
-   int i;
-   crc = crc ^ ((uint16_t)data << 8);
-   for (i=0; i<8; i++)
-   {
-      if (crc & 0x8000)
-         crc = (crc << 1) ^ 0x1021;
-      else
-         crc <<= 1;
-   }
-   return crc;
-}
-
-AHRS::checksum_t AHRS::crc16(checksum_t crc, uint8_t* data, bytecount_t bytes){
-   for (; bytes > 0; bytes--, data++)
-      crc = crc_xmodem_update(crc, *data);
-   return crc;
-}
-
-int AHRS::readRaw(void* blob, int bytes_to_read)
-{  
-   // Keep track of the number of bytes read, and the number of fds that are ready.
-   int bytes_read = 0, current_read = 0, fds_ready = 0;
-   // Sets of file descriptors for use with select(2).
-   fd_set read_fds, write_fds, except_fds;
-   // Timeout in the form of {sec, usec}, for use with select(2).
-   struct timeval timeout = _timeout;
    // Ensure the device is avaliable and open.
    assertOpen();
-   // Check if we need to read data at all.
-   if (bytes_to_read > 0) {
-      do {
-         // Set up for the select call to handle timeouts.
-         FD_ZERO(&read_fds);
-         FD_ZERO(&write_fds);
-         FD_ZERO(&except_fds);
-         FD_SET(_deviceFD, &read_fds);
-         // Wait until the device is ready to read, return the number of FDs avalaible.
-         fds_ready = select(_deviceFD+1, &read_fds, &write_fds, &except_fds, &timeout);
-         if (fds_ready == 1) {
-            // The filedescriptor is ready to read.
-            current_read = read(_deviceFD, (((char*)blob) + bytes_read), 
-                  (bytes_to_read - bytes_read));
-            // If the read was successful, record the number of bytes read.
-            if (current_read > 0) {
-               bytes_read += current_read;
-            }
-         }
-         // Keep reading until we've run out of data, or we couldnt read more data.
-      } while ((bytes_read < bytes_to_read) && (fds_ready == 1) && (current_read > 0));
-   }
-   // Return the number of bytes we actually managed to read.
-   return bytes_to_read - bytes_read;
+   // Return the number of bytes we didn't manage to read.
+   return bytes_to_read - _port.read(blob, bytes_to_read, deadline);
 }
 
-int AHRS::writeRaw(void* blob, int bytes_to_write)
+int AHRS::writeRaw(const void* blob, int bytes_to_write, SerialPort::Deadline deadline)
 {
-   // Keep track of the number of bytes written, and the number of fds that are ready.
-   int bytes_written = 0, current_write = 0, fds_ready = 0;
-   // Sets of file descriptors for use with select(2).
-   fd_set read_fds, write_fds, except_fds;
-   // Timeout in the form of {sec, usec}, for use with select(2).
-   struct timeval timeout = _timeout;
    // Ensure the device is avaliable and open.
    assertOpen();
-   // Check if we need to write data at all.
-   if (bytes_to_write > 0) {
-      do {
-         // Set up for the select call to handle timeouts.
-         FD_ZERO(&read_fds);
-         FD_ZERO(&write_fds);
-         FD_ZERO(&except_fds);
-         FD_SET(_deviceFD, &write_fds);
-         // Wait until the device is ready to write, return the number of FDs avalaible.
-         fds_ready = select(_deviceFD+1, &read_fds, &write_fds, &except_fds, &timeout);
-         if (fds_ready == 1) {
-            // The filedescriptor is ready to write.
-            current_write = write(_deviceFD, (((char*)blob) + bytes_written), 
-                  (bytes_to_write - bytes_written));
-            // If the write was successful, record the number of bytes written.
-            if (current_write > 0) {
-               bytes_written += current_write;
-            }
-         }
-         // Keep writing until we've run out of data, or we couldnt write more data.
-      } while ((bytes_written < bytes_to_write) && (fds_ready == 1) && (current_write > 0));
-   }
-   // Return the number of bytes we actually managed to write.
-   return bytes_to_write - bytes_written;
+   // Return the number of bytes we didn't manage to write.
+   return bytes_to_write - _port.write(blob, bytes_to_write, deadline);
 }
 
 AHRS::Message AHRS::readMessage()
@@ -188,12 +74,14 @@ AHRS::Message AHRS::readMessage()
    checksum_t remote_checksum, checksum = 0x0;
    // Output structure, storage for the read memory.
    Message message;
+   // The whole message has to arrive in one timeout.
+   SerialPort::Deadline deadline = SerialPort::deadline(_timeout);
 
    // Read in the header of the datagram packet: UInt16.
-   if (readRaw(&total_size, sizeof(bytecount_t)))
+   if (readRaw(&total_size, sizeof(bytecount_t), deadline))
       throw AHRSException("Unable to read bytecount of incoming packet.");
    // Add the total size to the checksum.
-   checksum = crc16(checksum, (uint8_t*) &total_size, sizeof(bytecount_t));
+   checksum = checksum_crc16_ccitt(checksum, &total_size, sizeof(bytecount_t));
    // Convert the total size from big-endian to host-endian.
    total_size = be16toh(total_size);
    // Do not include the checksum, frameid, or bytecount in the payload.
@@ -205,17 +93,17 @@ AHRS::Message AHRS::readMessage()
    message.payload->reserve(message.payload_size);
 
    // Read in the frameid: UInt8.
-   if (readRaw(&message.id, sizeof(frameid_t)))
+   if (readRaw(&message.id, sizeof(frameid_t), deadline))
       throw AHRSException("Unable to read frameid of incoming packet");
    // Add the message id to the checksum.
-   checksum = crc16(checksum, (uint8_t*) &message.id, sizeof(frameid_t));
+   checksum = checksum_crc16_ccitt(checksum, &message.id, sizeof(frameid_t));
    // Read in the payload and spit it into the vector storage.
-   if (readRaw(message.payload->data(), message.payload_size))
+   if (readRaw(message.payload->data(), message.payload_size, deadline))
       throw AHRSException("Unable to read payload of incoming packet");
    // Add the data read in to the checksum.
-   checksum = crc16(checksum, (uint8_t*) message.payload->data(), message.payload_size);
+   checksum = checksum_crc16_ccitt(checksum, message.payload->data(), message.payload_size);
    // Read the remote checksum that the device computed.
-   if (readRaw(&remote_checksum, sizeof(checksum_t)))
+   if (readRaw(&remote_checksum, sizeof(checksum_t), deadline))
       throw AHRSException("Unable to read checksum of incoming packet");
    // Convert the checksum from big-endian to host-endian.
    remote_checksum = be16toh(remote_checksum);
@@ -235,28 +123,30 @@ void AHRS::writeMessage(Message message)
       sizeof(bytecount_t) + sizeof(frameid_t) + message.payload_size + sizeof(checksum_t);
    // Storage for the checksum.
    checksum_t checksum = 0x0;
+   // The whole message has to be sent in one timeout.
+   SerialPort::Deadline deadline = SerialPort::deadline(_timeout);
 
    // Convert from host-endian to big-endian
    total_size = htobe16(total_size);
 
    // Compute the checksum from the packet data.
-   checksum = crc16(checksum, (uint8_t*) &total_size, sizeof(bytecount_t));
-   checksum = crc16(checksum, (uint8_t*) &message.id, sizeof(frameid_t));
-   checksum = crc16(checksum, (uint8_t*) message.payload->data(), message.payload_size);
+   checksum = checksum_crc16_ccitt(checksum, &total_size, sizeof(bytecount_t));
+   checksum = checksum_crc16_ccitt(checksum, &message.id, sizeof(frameid_t));
+   checksum = checksum_crc16_ccitt(checksum, message.payload->data(), message.payload_size);
    // Convert from host-endian to big-endian
    checksum = htobe16(checksum);
 
    // Attempt to write the datagram to the serial port.
-   if (writeRaw(&total_size, sizeof(bytecount_t)))
+   if (writeRaw(&total_size, sizeof(bytecount_t), deadline))
       throw AHRSException("Unable to write bytecount.");
    // Attempt to write the frameid to the serial port.
-   if (writeRaw(&message.id, sizeof(frameid_t)))
+   if (writeRaw(&message.id, sizeof(frameid_t), deadline))
       throw AHRSException("Unable to write frameid.");
    // Attempt to write the payload to the serial port.
-   if (writeRaw(message.payload->data(), message.payload_size))
+   if (writeRaw(message.payload->data(), message.payload_size, deadline))
       throw AHRSException("Unable to write payload.");
    // Attempt to write the checksum to the serial port.
-   if (writeRaw(&checksum, sizeof(checksum_t)))
+   if (writeRaw(&checksum, sizeof(checksum_t), deadline))
       throw AHRSException("Unable to write checksum.");
 }
 
@@ -438,6 +328,9 @@ AHRS::Command AHRS::inferCommand(Message message)
 
 void AHRS::readCommand(Command cmd, void* target)
 {
+   // The reader thread would take the response.
+   if (_streaming)
+      throw AHRSException("Stop streaming before sending commands.");
    // Read until the message we receive is the one we want.
    Message message;
    do {
@@ -451,6 +344,8 @@ void AHRS::readCommand(Command cmd, void* target)
 
 void AHRS::writeCommand(Command cmd, const void* payload)
 {
+   if (_streaming)
+      throw AHRSException("Stop streaming before sending commands.");
    writeMessage(createMessage(cmd, payload));
 }
 
@@ -462,6 +357,89 @@ void AHRS::sendCommand(Command send, const void* payload, Command resp, void* ta
    readCommand(resp, target);
 }
 
+AHRS::AHRSData AHRS::convertData(const RawData& data)
+{
+   AHRSData out;
+   out.quaternion[0] = data.quaternion[0];
+   out.quaternion[1] = data.quaternion[1];
+   out.quaternion[2] = data.quaternion[2];
+   out.quaternion[3] = data.quaternion[3];
+   out.gyroX = data.gyroX;
+   out.gyroY = data.gyroY;
+   out.gyroZ = data.gyroZ;
+   out.accelX = data.accelX;
+   out.accelY = data.accelY;
+   out.accelZ = data.accelZ;
+   out.magX = data.magX;
+   out.magY = data.magY;
+   out.magZ = data.magZ;
+   return out;
+}
+
+void AHRS::streamLoop()
+{
+   RawData data;
+   AHRSSample sample;
+   int errors = 0;
+
+   while (_streaming) {
+      try {
+         Message message = readMessage();
+         // Anything besides data is a late reply from before the stream started.
+         if (message.id != kGetDataResp.id || message.payload_size != sizeof(RawData))
+            continue;
+         memcpy(&data, message.payload->data(), sizeof(RawData));
+         sample = stampData(data);
+         _latestSample.write(sample);
+         _sampleHistory.push(sample);
+         errors = 0;
+      } catch (AHRSException& ex) {
+         _streamErrors++;
+         // Frames have no start marker, so drop whatever is half read and
+         // pick up again at the start of the next one.
+         _port.flush();
+         if (++errors >= kMaxStreamErrors)
+            _streaming = false;
+      }
+   }
+}
+
+AHRS::AHRSSample AHRS::stampData(const RawData& data)
+{
+   AHRSSample sample;
+   // Stamp it before anything else, this is as close to arrival as we get.
+   sample.received = std::chrono::system_clock::now();
+   // The AHRS sends a reading as soon as it takes it, so the reading is as
+   // old as the frame took to come down the wire.
+   sample.sampled = sample.received - std::chrono::duration_cast<
+      std::chrono::system_clock::duration>(frameTime(sizeof(RawData)));
+   sample.data = convertData(data);
+   sample.sequence = _sequence++;
+   return sample;
+}
+
+std::chrono::nanoseconds AHRS::frameTime(size_t payload_size)
+{
+   // Start bit, 8 data bits and a stop bit per byte.
+   static constexpr int64_t kBitsPerByte = 10;
+   int64_t bits_per_second = SerialPort::bitsPerSecond(_termBaud);
+   size_t bytes = sizeof(bytecount_t) + sizeof(frameid_t) + payload_size + sizeof(checksum_t);
+
+   if (bits_per_second == 0)
+      return std::chrono::nanoseconds(0);
+   return std::chrono::nanoseconds(bytes * kBitsPerByte * 1000000000LL / bits_per_second);
+}
+
+void AHRS::joinStream()
+{
+   _streaming = false;
+   if (_streamThread.joinable())
+      _streamThread.join();
+}
+
+constexpr size_t AHRS::kHistorySize;
+constexpr int AHRS::kMaxStreamErrors;
+
 constexpr AHRS::Command AHRS::kGetModInfo;
 constexpr AHRS::Command AHRS::kGetModInfoResp;
 constexpr AHRS::Command AHRS::kSetDataComponents;
@@ -241,25 +241,63 @@ void AHRS::sendAHRSDataFormat()
 }
 
 AHRS::AHRSData AHRS::pollAHRSData()
+{
+   return pollAHRSSample().data;
+}
+
+AHRS::AHRSSample AHRS::pollAHRSSample()
 {
    RawData data;
    // Poll the AHRS for a data message.
    sendCommand(kGetData, NULL, kGetDataResp, &data);
+   AHRSSample sample = stampData(data);
    // Copy all the data to the actual AHRS storage.
-   _lastReading.quaternion[0] = data.quaternion[0];
-   _lastReading.quaternion[1] = data.quaternion[1];
-   _lastReading.quaternion[2] = data.quaternion[2];
-   _lastReading.quaternion[3] = data.quaternion[3];
-   _lastReading.gyroX = data.gyroX;
-   _lastReading.gyroY = data.gyroY;
-   _lastReading.gyroZ = data.gyroZ;
-   _lastReading.accelX = data.accelX;
-   _lastReading.accelY = data.accelY;
-   _lastReading.accelZ = data.accelZ;
-   _lastReading.magX = data.magX;
-   _lastReading.magY = data.magY;
-   _lastReading.magZ = data.magZ;
-   return _lastReading;
+   _lastReading = sample.data;
+   return sample;
+}
+
+void AHRS::startStreaming(float sample_delay)
+{
+   assertOpen();
+   if (_streaming)
+      return;
+   // Clean up after a stream that stopped itself.
+   joinStream();
+   // Continuous acquisition, without flushing the filters between samples.
+   setAcqConfig({sample_delay, false, false});
+   writeCommand(kStartContinuousMode, NULL);
+   _streamErrors = 0;
+   _streaming = true;
+   _streamThread = std::thread(&AHRS::streamLoop, this);
+}
+
+void AHRS::stopStreaming()
+{
+   joinStream();
+   if (isOpen()) {
+      writeCommand(kStopContinousMode, NULL);
+      _port.flush();
+   }
+}
+
+bool AHRS::isStreaming() {
+   return _streaming;
+}
+
+bool AHRS::getLatestSample(AHRSSample& sample) {
+   return _latestSample.read(sample);
+}
+
+bool AHRS::popSample(AHRSSample& sample) {
+   return _sampleHistory.pop(sample);
+}
+
+size_t AHRS::droppedSamples() {
+   return _sampleHistory.dropped();
+}
+
+uint32_t AHRS::streamErrors() {
+   return _streamErrors;
 }
 
 void AHRS::startCalibration(CalType type) {
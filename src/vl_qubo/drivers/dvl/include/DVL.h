@@ -26,6 +26,14 @@
 #include <termios.h>
 // shared_ptr type
 #include <memory>
+// milliseconds type
+#include <chrono>
+// std::function type
+#include <functional>
+// Buffered serial I/O
+#include "SerialPort.h"
+// Checksum shared with the other serial drivers
+#include "checksum.h"
 
 /**
  * Exception class for handling IO/Data integrity errors.
@@ -74,36 +82,58 @@ class DVL
     private: // Internal functionality.
         /** Unix file name to connect to */
         std::string _deviceFile;
-        /** Data rate to communicate with */
-        speed_t _termBaud;
+        /** Data rate to communicate with, on both ends of the link */
+        DVLSpeed _termSpeed;
         /** Serial port for I/O with the DVL */
-        int _deviceFD;
-        /** Timeout (sec,usec) on read/write */
-        struct timeval _timeout;
+        SerialPort _port;
+        /** Time allowed to read a whole message, or send a command */
+        std::chrono::milliseconds _timeout;
+        /** Storage for the last binary message, reused once nothing holds it */
+        std::shared_ptr<Payload> _payload;
 
         /** Sends a pause to the DVL, triggering it to restart */
         void sendBreak();
 
-        /** Checksum function to compute modulus 65535 CRC16s. */
-        checksum_t crc16(checksum_t crc, const void* data, int bytes);
-        /** Read bytes to a blob, return the bytes not read. */
-        int readRaw(void* blob, int bytes_to_read);
-        /** Write bytes from a blob, return the bytes not written. */
-        int writeRaw(void* blob, int bytes_to_write);
+        /** Read bytes to a blob by the deadline, return the bytes not read. */
+        int readRaw(void* blob, int bytes_to_read, SerialPort::Deadline deadline);
+        /** Write bytes from a blob by the deadline, return the bytes not written. */
+        int writeRaw(const void* blob, int bytes_to_write, SerialPort::Deadline deadline);
 
+        /** Storage for a binary message of at least bytes, from the pool if it's free. */
+        std::shared_ptr<Payload> takePayload(size_t bytes);
         /** Helper function for readMessage() that reads in a PD0 formatted message. */
-        Message readPD0();
+        Message readPD0(SerialPort::Deadline deadline);
+        /**
+         * Checks for a whole PD0 ensemble with a good checksum at the start of
+         * a recording, and indexes its sections into view.
+         * @return (size_t) bytes in it, ids and checksum included, 0 if there isn't one.
+         */
+        static size_t recordedEnsemble(const char* data, size_t size, PD0View& view);
         /** Helper function for readMessage() that reads in a PD4 formatted message. */
-        Message readPD4();
+        Message readPD4(SerialPort::Deadline deadline);
         /** Helper function for readMessage() that reads in a PD5 formatted message. */
-        Message readPD5();
+        Message readPD5(SerialPort::Deadline deadline);
         /** Helper function for readMessage() that reads in a PD6 formatted message. */
-        Message readPD6();
+        Message readPD6(SerialPort::Deadline deadline);
         /** Helper function for readMessage() that reads in a plaintext formatted message. */
-        Message readText(char first);
+        Message readText(char first, SerialPort::Deadline deadline);
         /** Read an incoming message and format it for interpreting. */
         Message readMessage();
 
+        /** Read one YMODEM packet, skipping anything before its first byte. */
+        YModemPacket readYModemPacket(YModemBlock& block, SerialPort::Deadline deadline);
+        /** Send a single YMODEM control byte. */
+        void sendYModem(uint8_t control);
+        /** Discard input until the line has been quiet for the given time. */
+        void purgeInput(std::chrono::milliseconds quiet);
+        /**
+         * Receive one file over YMODEM, handing its contents to sink as each
+         * packet arrives. Bad or missing packets are asked for again.
+         * @return (size_t) bytes passed to sink.
+         */
+        size_t receiveYModem(const std::function<void(const uint8_t*, size_t)>& sink,
+                RecorderDownload& result);
+
         /** Write a command with any free arguments in a varargs list */
         void writeFormatted(Command cmd, va_list argv);
         /** Write a command and its arguments to the device. */
@@ -152,12 +152,38 @@ void eraseRecorder();
 std::string getRecorderStatus();
 
 /**
- * Get the log file from the device.
- * This is transmitted over the YMODEM protocol. A 2mb file (max size) could 
- * take nearly 20s on the fastest (115kbaud) connection.
- * NOTE: INCOMPLETE
+ * Change the speed of the serial link, on the DVL and on this end.
+ * Not saved, the DVL goes back to its saved speed when it restarts.
+ * @param (DVLSpeed) speed to talk at from now on.
  */
-void getRecordedData();
+void setBaudrate(DVLSpeed speed);
+
+/**
+ * Download the log file from the device into path, and index it.
+ * This is transmitted over the YMODEM protocol. A 2mb file (max size) takes
+ * over three minutes at 115kbaud, and more than half an hour at the 9600
+ * the DVL ships at, so the link is switched to transfer_speed for the download and
+ * back after. The DVL must not be pinging.
+ * The file is streamed to path.part as packets arrive, and renamed to path
+ * once it is all here. Bad packets are asked for again, but if the transfer
+ * fails outright path.part is left with everything up to the failure, which
+ * indexRecording() can still index.
+ * @param (std::string) file to save the recording in.
+ * @param (DVLSpeed) speed to download at.
+ * @return (RecorderDownload) what was saved, and how the transfer went.
+ */
+RecorderDownload getRecordedData(const std::string& path, DVLSpeed transfer_speed);
+
+/**
+ * Index the PD0 ensembles in a recording, so a replay can seek in it.
+ * Writes path.idx, with a line of "offset,bytes,ensemble,time" for every
+ * ensemble that passes its checksum. offset and bytes locate the whole
+ * ensemble in the file, time is the DVL's clock in seconds since 1970.
+ * Anything between good ensembles is skipped over.
+ * @param (std::string) recording to index.
+ * @return (RecorderIndex) how much of it was good.
+ */
+static RecorderIndex indexRecording(const std::string& path);
 
 /**
  * Get the transform matrix.
@@ -209,6 +235,18 @@ std::string testContinuity();
  */
 std::string testWiring();
 
+/**
+ * Configure the DVL to send only what navigation reads, as often as it can.
+ * Water profiling and water mass pings are turned off, every ensemble is a
+ * single bottom track ping with no wait between them, and the output is the
+ * smallest binary format with bottom track velocity and range in it.
+ * Call before enableMeasurement.
+ * @param (bool) true for PD5, which adds attitude, depth and distance made
+ *   good, false for PD4 with velocity and range alone.
+ * @return (OutputProfile) ensemble size, and the ping rate the link allows.
+ */
+OutputProfile setNavigationOutput(bool with_sensor_data);
+
 /**
  * Enable data collection.
  * After this command is called, only the disableMeasurement or getDVLData
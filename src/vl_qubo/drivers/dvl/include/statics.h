@@ -125,6 +125,19 @@ static constexpr frameid_t kPD0SensorDataID              = 0x3001;
 static constexpr frameid_t kPD4HeaderID                  = 0x007d;
 static constexpr frameid_t kPD5HeaderID                  = 0x017d;
 
+// YMODEM control bytes, for downloading the loop recorder
+static constexpr uint8_t kYModemSOH                      = 0x01;
+static constexpr uint8_t kYModemSTX                      = 0x02;
+static constexpr uint8_t kYModemEOT                      = 0x04;
+static constexpr uint8_t kYModemACK                      = 0x06;
+static constexpr uint8_t kYModemNAK                      = 0x15;
+static constexpr uint8_t kYModemCAN                      = 0x18;
+static constexpr uint8_t kYModemCRC                      = 'C';
+/** Packets in a row that can fail before the download is given up. */
+static constexpr int kYModemMaxErrors                    = 10;
+/** Bytes the recording is written to disk in. */
+static constexpr size_t kRecorderWriteSize               = 1 << 16;
+
 public:
 static constexpr DVLSpeed k300                           = {0, B300};
 static constexpr DVLSpeed k1200                          = {1, B1200};
@@ -102,9 +102,14 @@ typedef struct _PD0_VariableLeader {
     uint32_t spare1;
 } PD0_VariableLeader;
 
-typedef short int PD0_CellShortFields[4];
+/** One depth cell of a per-cell section, a value for each beam. */
+typedef struct _PD0_CellShortFields {
+    short int beam[4];
+} PD0_CellShortFields;
 
-typedef uint8_t PD0_CellByteFields[4];
+typedef struct _PD0_CellByteFields {
+    uint8_t beam[4];
+} PD0_CellByteFields;
 
 /** Bottom tracking data */
 typedef struct _PD0_BottomTrack {
@@ -291,6 +296,9 @@ typedef struct _PD5_Data {
     uint32_t ref_distance_error;
 } PD5_Data;
 
+/** Everything after this is only used in memory, so it keeps its natural alignment. */
+#pragma pack(pop)
+
 /************************************************************************
  * INTERNAL STRUCT TYPEDEFS
  * Structs used for internal organization and communication.
@@ -312,33 +320,120 @@ typedef enum _MessageFormat {
 /** Memory storage for a message recieved from the DVL. */
 typedef std::vector<char> Payload;
 
+/** What arrived when a YMODEM packet was expected. */
+typedef enum _YModemPacket {
+    YMODEM_BLOCK, YMODEM_END, YMODEM_CANCEL, YMODEM_BAD, YMODEM_TIMEOUT
+} YModemPacket;
+
+/** One YMODEM data packet, which holds 128 or 1024 bytes. */
+typedef struct _YModemBlock {
+    /** Sequence number, 0 for the header with the file name and size. */
+    uint8_t number;
+    /** Bytes in data, padding included. */
+    size_t size;
+    uint8_t data[1024];
+} YModemBlock;
+
+/** Sections a PD0 ensemble can carry, found through its offset table. */
+typedef enum _PD0Section {
+    PD0_FIXED_LEADER, PD0_VARIABLE_LEADER, PD0_VELOCITY, PD0_CORRELATION,
+    PD0_ECHO_INTENSITY, PD0_PERCENT_GOOD, PD0_STATUS, PD0_BOTTOM_TRACK,
+    PD0_ENVIRONMENT, PD0_BOTTOM_TRACK_COMMAND, PD0_BOTTOM_TRACK_HIGHRES,
+    PD0_BOTTOM_TRACK_RANGE, PD0_SENSOR_DATA, PD0_SECTION_COUNT
+} PD0Section;
+
+/**
+ * Read-only view of a PD0 ensemble stored in a payload.
+ * The offset table is walked once when the view is made, after that each
+ * section is a lookup. Every accessor checks that the whole section lies
+ * inside the ensemble, and returns NULL if it doesn't or isn't there.
+ * The view doesn't own the memory, the Message holding it does.
+ */
+class PD0View
+{
+    public:
+        PD0View() : _data(NULL), _size(0), _sections() {}
+        /**
+         * Index the sections of an ensemble.
+         * Throws a DVLException if the offset table points outside it.
+         * @param (const char*) ensemble, starting at the header after the id.
+         * @param (size_t) bytes in the ensemble, without the id or checksum.
+         */
+        PD0View(const char* data, size_t size);
+
+        const PD0_Header* header() const
+            { return at<PD0_Header>(0, 1); }
+        const PD0_FixedLeader* fixedLeader() const
+            { return section<PD0_FixedLeader>(PD0_FIXED_LEADER, 1); }
+        const PD0_VariableLeader* variableLeader() const
+            { return section<PD0_VariableLeader>(PD0_VARIABLE_LEADER, 1); }
+        /** Number of depth cells in each of the per-cell sections. */
+        size_t cells() const
+            { return fixedLeader() ? fixedLeader()->nr_cells : 0; }
+        const PD0_CellShortFields* velocity() const
+            { return section<PD0_CellShortFields>(PD0_VELOCITY, cells()); }
+        const PD0_CellByteFields* correlation() const
+            { return section<PD0_CellByteFields>(PD0_CORRELATION, cells()); }
+        const PD0_CellByteFields* echoIntensity() const
+            { return section<PD0_CellByteFields>(PD0_ECHO_INTENSITY, cells()); }
+        const PD0_CellByteFields* percentGood() const
+            { return section<PD0_CellByteFields>(PD0_PERCENT_GOOD, cells()); }
+        const PD0_CellByteFields* status() const
+            { return section<PD0_CellByteFields>(PD0_STATUS, cells()); }
+        const PD0_BottomTrack* bottomTrack() const
+            { return section<PD0_BottomTrack>(PD0_BOTTOM_TRACK, 1); }
+        const PD0_Environment* environment() const
+            { return section<PD0_Environment>(PD0_ENVIRONMENT, 1); }
+        const PD0_BottomTrackCommand* bottomTrackCommand() const
+            { return section<PD0_BottomTrackCommand>(PD0_BOTTOM_TRACK_COMMAND, 1); }
+        const PD0_BottomTrackHighRes* bottomTrackHighRes() const
+            { return section<PD0_BottomTrackHighRes>(PD0_BOTTOM_TRACK_HIGHRES, 1); }
+        const PD0_BottomTrackRange* bottomTrackRange() const
+            { return section<PD0_BottomTrackRange>(PD0_BOTTOM_TRACK_RANGE, 1); }
+        const PD0_SensorData* sensorData() const
+            { return section<PD0_SensorData>(PD0_SENSOR_DATA, 1); }
+
+    private:
+        /** Start of the ensemble, NULL for an empty view. */
+        const char* _data;
+        /** Bytes in the ensemble. */
+        size_t _size;
+        /** Offset of the body of each section in _data, 0 if it isn't there. */
+        size_t _sections[PD0_SECTION_COUNT];
+
+        /** Section a frame id in the offset table refers to, -1 if unknown. */
+        static int sectionFor(frameid_t id);
+
+        /** Count Ts starting at offset, NULL unless they all fit in _size. */
+        template <typename T>
+        const T* at(size_t offset, size_t count) const {
+            if (!_data || count == 0 || offset > _size || (_size - offset) / sizeof(T) < count)
+                return NULL;
+            return (const T*) (_data + offset);
+        }
+
+        template <typename T>
+        const T* section(PD0Section id, size_t count) const {
+            return _sections[id] ? at<T>(_sections[id], count) : NULL;
+        }
+};
+
 /** 
  * Message read from the hardware device. 
  * Contains a shared ptr to dynamic storage, so that this struct can be copied
  * as many times as needed, and then deletes any dynamic memory when all
  * copies of the struct go out of scope. Pointers in this struct are often null,
  * otherwise they should point into special places in the dynamic storage.
+ * Binary payloads come from a pool in the DVL, and go back to it once every
+ * copy of the message is gone.
  */
 typedef struct _Message {
     /** Type of data stored in this message */
     MessageFormat                 format;
     /** Pointer to the memory allocated for this message. */
     std::shared_ptr<Payload>      payload;
-    /** Pointers to portions of the PD0 payload */
-    PD0_Header                    *pd0_header;
-    PD0_FixedLeader               *pd0_fixed;
-    PD0_VariableLeader            *pd0_variable;
-    PD0_CellShortFields           *pd0_velocity;
-    PD0_CellByteFields            *pd0_correlation;
-    PD0_CellByteFields            *pd0_echo_intensity;
-    PD0_CellByteFields            *pd0_percent_good;
-    PD0_CellByteFields            *pd0_status;
-    PD0_BottomTrack               *pd0_bottom_track;
-    PD0_Environment               *pd0_environment;
-    PD0_BottomTrackCommand        *pd0_bottom_track_command;
-    PD0_BottomTrackHighRes        *pd0_bottom_track_highres;
-    PD0_BottomTrackRange          *pd0_bottom_track_range;
-    PD0_SensorData                *pd0_sensor_data;   
+    /** Sections of the PD0 payload */
+    PD0View                       pd0;
     /** Pointer to the PD4 formatted data. */
     PD4_Data                      *pd4_data;
     /** Pointer to the PD5 formatted data. */
@@ -505,9 +600,39 @@ typedef struct _DVLData {
     CoordinateSystem transform;
     int water_vel[4];
     int bottom_vel[4];
+    /** Range to the bottom along each beam, 0 where there was no lock. */
+    unsigned int bottom_range[4];
 } DVLData;
 
-#pragma pack(pop)
+/** What an output configuration puts on the serial link. */
+typedef struct _OutputProfile {
+    /** Format the DVL was set to. */
+    DataOutput output_type;
+    /** Bytes in each ensemble, ids and checksum included. */
+    size_t ensemble_bytes;
+    /** Most ensembles per second the link can carry at this size. */
+    double max_ensemble_rate;
+} OutputProfile;
+
+/** What was found indexing a recording. */
+typedef struct _RecorderIndex {
+    /** Ensembles that passed their checksum, one line each in the index. */
+    size_t ensembles;
+    /** Bytes that weren't part of any good ensemble. */
+    size_t skipped_bytes;
+} RecorderIndex;
+
+/** How a download of the loop recorder went. */
+typedef struct _RecorderDownload {
+    /** Bytes of recording saved. */
+    size_t bytes;
+    /** Packets that had to be sent again. */
+    unsigned int retries;
+    /** Seconds from starting the transfer to the last packet. */
+    double seconds;
+    /** Contents of the recording. */
+    RecorderIndex index;
+} RecorderDownload;
 
 
 
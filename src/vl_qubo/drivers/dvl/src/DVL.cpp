@@ -13,6 +13,8 @@
 #include <sys/ioctl.h>
 #include <fcntl.h>
 #include <stdarg.h>
+#include <stdlib.h>
+#include <time.h>
 
 // Header include
 #include "../include/DVL.h"
@@ -23,68 +25,28 @@
 #include <stdio.h>
 
 DVL::DVL(std::string deviceFile, DVLSpeed speed)
-    : _deviceFile(deviceFile), _termBaud(speed.baud), _deviceFD(-1), _timeout({10,0})
+    : _deviceFile(deviceFile), _termSpeed(speed), _timeout(10000)
 { }
 
 DVL::~DVL() { closeDevice(); }
 
 void DVL::openDevice() {
-    struct termios termcfg;
-    int modemcfg = 0, fd = -1;
-    /* Open the serial port and store into a file descriptor.
-     * O_RDWR allows for bi-directional I/O, and
-     * O_NONBLOCK makes it so that read/write does not block.
-     */
-    fd = open(_deviceFile.c_str(), O_RDWR, O_NONBLOCK);
-    // Check to see if the device exists.
-    if (fd == -1)
-        throw DVLException("Device '"+_deviceFile+"' unavaliable.");
-    // Read the config of the interface.
-    if(tcgetattr(fd, &termcfg))
-        throw DVLException("Unable to read terminal configuration.");
-
-    // Set the baudrate for the terminal
-    if(cfsetospeed(&termcfg, _termBaud))
-        throw DVLException("Unable to set terminal output speed.");
-    if(cfsetispeed(&termcfg, _termBaud))
-        throw DVLException("Unable to set terminal intput speed.");
-
-    // Set raw I/O rules to read and write the data purely.
-    cfmakeraw(&termcfg);
-
-    // Configure the read timeout (deciseconds)
-    termcfg.c_cc[VTIME] = 0;
-    // Configure the minimum number of chars for read.
-    termcfg.c_cc[VMIN] = 1;
-
-    // Push the configuration to the terminal NOW.
-    if(tcsetattr(fd, TCSANOW, &termcfg))
-        throw DVLException("Unable to set terminal configuration.");
-
-    // Pull in the modem configuration
-    if(ioctl(fd, TIOCMGET, &modemcfg))
-        throw DVLException("Unable to read modem configuration.");
-    // Enable Request to Send
-    modemcfg |= TIOCM_RTS;
-    // Push the modem config back to the modem.
-    if(ioctl(fd, TIOCMSET, &modemcfg))
-        throw DVLException("Unable to set modem configuration.");
-
-    // Successful execution!
-    _deviceFD = fd;
+    try {
+        _port.openDevice(_deviceFile, _termSpeed.baud);
+    } catch (SerialException& ex) {
+        throw DVLException(ex.what());
+    }
 
     // Prepare to begin communication with the device.
     sendBreak();
 }
 
-bool DVL::isOpen() {return _deviceFD >= 0;}
+bool DVL::isOpen() {return _port.isOpen();}
 
 void DVL::assertOpen() { if (!isOpen()) throw DVLException("Device needs to be open!"); }
 
 void DVL::closeDevice() {
-    if (isOpen())
-        close(_deviceFD);
-    _deviceFD = -1;
+    _port.closeDevice();
 }
 
 /******************************************************************************
@@ -97,225 +59,195 @@ void DVL::sendBreak() {
     // The DVL specs for more than 300ms,
     // but it 'may respond to breaks shorter than this'
     // Here we will spec for 400ms of break time.
-    ioctl(_deviceFD, TCSBRKP, 4);
+    _port.sendBreak(4);
     // Clear any data that is in the read buffer so we start off with a clean slate.
     readMessage();
 }
 
-DVL::checksum_t DVL::crc16(checksum_t crc, const void* ptr, int bytes) {
-    const char* data = (const char*) ptr;
-    for (; bytes > 0; bytes--, data++)
-        crc += *data;
-    return crc;
-}
-
-int DVL::readRaw(void* blob, int bytes_to_read)
+int DVL::readRaw(void* blob, int bytes_to_read, SerialPort::Deadline deadline)
 {
-    // Keep track of the number of bytes read, and the number of fds that are ready.
-    int bytes_read = 0, current_read = 0, fds_ready = 0;
-    // Sets of file descriptors for use with select(2).
-    fd_set read_fds, write_fds, except_fds;
-    // Timeout in the form of {sec, usec}, for use with select(2).
-    struct timeval timeout = _timeout;
     // Ensure the device is avaliable and open.
     assertOpen();
-    // Check if we need to read data at all.
-    if (bytes_to_read > 0) {
-        do {
-            // Set up for the select call to handle timeouts.
-            FD_ZERO(&read_fds);
-            FD_ZERO(&write_fds);
-            FD_ZERO(&except_fds);
-            FD_SET(_deviceFD, &read_fds);
-            // Wait until the device is ready to read, return the number of FDs avalaible.
-            fds_ready = select(_deviceFD+1, &read_fds, &write_fds, &except_fds, &timeout);
-            if (fds_ready == 1) {
-                // The filedescriptor is ready to read.
-                current_read = read(_deviceFD, (((char*)blob) + bytes_read),
-                        (bytes_to_read - bytes_read));
-                // If the read was successful, record the number of bytes read.
-                if (current_read > 0) {
-                    bytes_read += current_read;
-                }
-            }
-            // Keep reading until we've run out of data, or we couldnt read more data.
-        } while ((bytes_read < bytes_to_read) && (fds_ready == 1) && (current_read > 0));
-    }
-    // Return the number of bytes we actually managed to read.
-    return bytes_to_read - bytes_read;
+    // Return the number of bytes we didn't manage to read.
+    return bytes_to_read - _port.read(blob, bytes_to_read, deadline);
 }
 
-int DVL::writeRaw(void* blob, int bytes_to_write)
+int DVL::writeRaw(const void* blob, int bytes_to_write, SerialPort::Deadline deadline)
 {
-    // Keep track of the number of bytes written, and the number of fds that are ready.
-    int bytes_written = 0, current_write = 0, fds_ready = 0;
-    // Sets of file descriptors for use with select(2).
-    fd_set read_fds, write_fds, except_fds;
-    // Timeout in the form of {sec, usec}, for use with select(2).
-    struct timeval timeout = _timeout;
     // Ensure the device is avaliable and open.
     assertOpen();
-    // Check if we need to write data at all.
-    if (bytes_to_write > 0) {
-        do {
-            // Set up for the select call to handle timeouts.
-            FD_ZERO(&read_fds);
-            FD_ZERO(&write_fds);
-            FD_ZERO(&except_fds);
-            FD_SET(_deviceFD, &write_fds);
-            // Wait until the device is ready to write, return the number of FDs avalaible.
-            fds_ready = select(_deviceFD+1, &read_fds, &write_fds, &except_fds, &timeout);
-            if (fds_ready == 1) {
-                // The filedescriptor is ready to write.
-                current_write = write(_deviceFD, (((char*)blob) + bytes_written),
-                        (bytes_to_write - bytes_written));
-                // If the write was successful, record the number of bytes written.
-                if (current_write > 0) {
-                    bytes_written += current_write;
-                }
-            }
-            // Keep writing until we've run out of data, or we couldnt write more data.
-        } while ((bytes_written < bytes_to_write) && (fds_ready == 1) && (current_write > 0));
-    }
-    // Return the number of bytes we actually managed to write.
-    return bytes_to_write - bytes_written;
+    // Return the number of bytes we didn't manage to write.
+    return bytes_to_write - _port.write(blob, bytes_to_write, deadline);
 }
 
-DVL::Message DVL::readPD0()
+std::shared_ptr<DVL::Payload> DVL::takePayload(size_t bytes)
+{
+    // Someone still holds the last message, leave it be and start another.
+    if (!_payload || _payload.use_count() > 1)
+        _payload = std::make_shared<Payload>();
+    // Only grows, so after the largest message this never allocates.
+    if (_payload->size() < bytes)
+        _payload->resize(bytes);
+    return _payload;
+}
+
+DVL::Message DVL::readPD0(SerialPort::Deadline deadline)
 {
     // Create a Message that we can return to the caller.
-    Message message = {FORMAT_PD0, std::make_shared<Payload>()};
+    Message message{};
+    message.format = FORMAT_PD0;
     // Single character buffer for dummy data.
     char dummy;
     // Create storage for the checksum calculations.
     checksum_t remote_checksum, checksum = 0x0;
-    // Bytecounts for parts of the PD0 data format.
-    bytecount_t header_bytes = sizeof(PD0_Header);
-    bytecount_t total_bytes;
-    bytecount_t payload_bytes;
-    // Temporary veriables for decoding the PD0 format.
-    uint8_t data_types_i;
-    data_offset_t *offsets;
+    // The header says how big the rest is, so it gets read on its own first.
+    PD0_Header header;
+    // Bytes in the ensemble after the header id, up to the checksum.
+    size_t payload_bytes;
+    char* data;
 
     // Read in the data source (dummy data) to prepare to read real data.
-    if (readRaw(&dummy, sizeof(dummy)))
+    if (readRaw(&dummy, sizeof(dummy), deadline))
         throw DVLException("Unable to read data source of incoming packet");
     // Compute the local checksum of data already read in.
-    checksum = crc16(checksum, &kPD0HeaderID, sizeof(kPD0HeaderID));
+    checksum = checksum_sum16(checksum, &kPD0HeaderID, sizeof(kPD0HeaderID));
 
-    // Prepare to read the header information
-    message.payload->reserve(header_bytes);
-    // Read in the header and spit it into the vector storage.
-    if (readRaw(message.payload->data(), header_bytes))
+    // Read in the header.
+    if (readRaw(&header, sizeof(header), deadline))
         throw DVLException("Unable to read header of incoming packet");
-    // Compute the local checksum with the read data.
-    checksum = crc16(checksum, message.payload->data(), header_bytes);
-
-    // Get a nice pointer to the header struct, this will get invalidated later.
-    message.pd0_header = (PD0_Header*) message.payload->data();
-    // Pull the total number of bytes from the header we just read.
-    total_bytes = message.pd0_header->bytes_in_ensemble;
-    // Calculate the number of bytes we have yet to read.
-    payload_bytes = total_bytes - header_bytes - sizeof(kPD0HeaderID);
-    // Reserve enough storage for the payload.
-    message.payload->reserve(header_bytes + payload_bytes);
-    // This invalidates the header we read in, so just to be safe null it out.
-    message.pd0_header = NULL;
-
-    // Read in the remaining payload and spit it into the vector storage.
-    if (readRaw(message.payload->data() + header_bytes, payload_bytes))
+    // The byte count includes the header id we already read.
+    if (header.bytes_in_ensemble < sizeof(kPD0HeaderID) + sizeof(header))
+        throw DVLException("Ensemble too short to hold its header");
+    payload_bytes = header.bytes_in_ensemble - sizeof(kPD0HeaderID);
+
+    // Read the whole ensemble into one pooled buffer, header and all.
+    message.payload = takePayload(payload_bytes);
+    data = message.payload->data();
+    memcpy(data, &header, sizeof(header));
+    if (readRaw(data + sizeof(header), payload_bytes - sizeof(header), deadline))
         throw DVLException("Unable to read payload of incoming packet");
     // Compute the local checksum with the read data.
-    checksum = crc16(checksum, message.payload->data() + header_bytes, payload_bytes);
+    checksum = checksum_sum16(checksum, data, payload_bytes);
 
     // Read the remote checksum that the device computed.
-    if (readRaw(&remote_checksum, sizeof(remote_checksum)))
+    if (readRaw(&remote_checksum, sizeof(remote_checksum), deadline))
         throw DVLException("Unable to read checksum of incoming packet");
 
     // Compare the LSBs of the checksums to validate the message.
     if ((remote_checksum ^ checksum) & 0xff)
         throw DVLException("Remote and local checksum mismatch");
 
-    // Reassign the header pointer, because the old pointer got invalidated by reserve()
-    message.pd0_header = (PD0_Header*) message.payload->data();
-    // Get a pointer to the data offset array.
-    offsets = (data_offset_t*) message.payload->data() + header_bytes;
-    // Loop over the offset array to find all the data in the packet.
-    for(data_types_i = 0; data_types_i < message.pd0_header->data_types; data_types_i++) {
-        // Pull out the offset from the offset array.
-        data_offset_t offset = offsets[data_types_i];
-        // Get a pointer to the beginning of the data referenced by the offset.
-        char* frame = message.payload->data() + offset - sizeof(kPD0HeaderID);
-        // The body of the data at that point is one frameid_t length farther.
-        char* body = frame + sizeof(frameid_t);
-        // Access the frameid at the start of the frame and decide what is there.
-        switch (*((frameid_t*) frame)) {
-            case kPD0FixedLeaderID:
-                message.pd0_fixed =(PD0_FixedLeader*) body;
-                break;
-            case kPD0VariableLeaderID:
-                message.pd0_variable = (PD0_VariableLeader*) body;
-                break;
-            case kPD0VelocityDataID:
-                message.pd0_velocity = (PD0_CellShortFields*) body;
-                break;
-            case kPD0CorrelationMagnitudeID:
-                message.pd0_correlation = (PD0_CellByteFields*) body;
-                break;
-            case kPD0EchoIntensityID:
-                message.pd0_echo_intensity = (PD0_CellByteFields*) body;
-                break;
-            case kPD0PercentGoodID:
-                message.pd0_percent_good = (PD0_CellByteFields*) body;
-                break;
-            case kPD0StatusDataID:
-                message.pd0_status = (PD0_CellByteFields*) body;
-                break;
-            case kPD0BottomTrackID:
-                message.pd0_bottom_track = (PD0_BottomTrack*) body;
-                break;
-            case kPD0EnvironmentID:
-                message.pd0_environment = (PD0_Environment*) body;
-                break;
-            case kPD0BottomTrackCommandID:
-                message.pd0_bottom_track_command = (PD0_BottomTrackCommand*) body;
-                break;
-            case kPD0BottomTrackHighResID:
-                message.pd0_bottom_track_highres = (PD0_BottomTrackHighRes*) body;
-                break;
-            case kPD0BottomTrackRangeID:
-                message.pd0_bottom_track_range = (PD0_BottomTrackRange*) body;
-                break;
-            case kPD0SensorDataID:
-                message.pd0_sensor_data = (PD0_SensorData*) body;
-                break;
-            default:
-                // If the packet is well formed then this shouldnt happen.
-                printf("Unrecogized data header: 0x%x\n",*((frameid_t*) frame));
-                //throw DVLException("Unknown data format in PD0 packet");
-        }
-    }
+    // Find all the data in the packet.
+    message.pd0 = PD0View(data, payload_bytes);
     // Return the finished message to the caller.
     return message;
 }
 
-DVL::Message DVL::readPD4()
+DVL::PD0View::PD0View(const char* data, size_t size)
+    : _data(data), _size(size), _sections()
+{
+    const PD0_Header* header = at<PD0_Header>(0, 1);
+    const data_offset_t* offsets;
+
+    if (!header)
+        throw DVLException("Ensemble too short to hold its header");
+    if (header->data_types == 0)
+        return;
+    // The offset array follows the header.
+    offsets = at<data_offset_t>(sizeof(PD0_Header), header->data_types);
+    if (!offsets)
+        throw DVLException("Ensemble too short to hold its offset table");
+
+    for (uint8_t i = 0; i < header->data_types; i++) {
+        // Sections can start at odd addresses, so copy the fields out.
+        data_offset_t offset;
+        frameid_t id;
+        size_t frame;
+        int section;
+
+        memcpy(&offset, offsets + i, sizeof(offset));
+        // Offsets count from the header id, which isn't in the payload.
+        frame = offset - sizeof(kPD0HeaderID);
+        if (offset < sizeof(kPD0HeaderID) + sizeof(PD0_Header) || !at<frameid_t>(frame, 1))
+            throw DVLException("Data offset outside of the ensemble");
+        memcpy(&id, _data + frame, sizeof(id));
+        section = sectionFor(id);
+        if (section < 0) {
+            // If the packet is well formed then this shouldnt happen.
+            printf("Unrecogized data header: 0x%x\n", id);
+            continue;
+        }
+        // The body of the data is one frameid_t length farther.
+        _sections[section] = frame + sizeof(frameid_t);
+    }
+}
+
+int DVL::PD0View::sectionFor(frameid_t id)
+{
+    switch (id) {
+        case kPD0FixedLeaderID:             return PD0_FIXED_LEADER;
+        case kPD0VariableLeaderID:          return PD0_VARIABLE_LEADER;
+        case kPD0VelocityDataID:            return PD0_VELOCITY;
+        case kPD0CorrelationMagnitudeID:    return PD0_CORRELATION;
+        case kPD0EchoIntensityID:           return PD0_ECHO_INTENSITY;
+        case kPD0PercentGoodID:             return PD0_PERCENT_GOOD;
+        case kPD0StatusDataID:              return PD0_STATUS;
+        case kPD0BottomTrackID:             return PD0_BOTTOM_TRACK;
+        case kPD0EnvironmentID:             return PD0_ENVIRONMENT;
+        case kPD0BottomTrackCommandID:      return PD0_BOTTOM_TRACK_COMMAND;
+        case kPD0BottomTrackHighResID:      return PD0_BOTTOM_TRACK_HIGHRES;
+        case kPD0BottomTrackRangeID:        return PD0_BOTTOM_TRACK_RANGE;
+        case kPD0SensorDataID:              return PD0_SENSOR_DATA;
+        default:                            return -1;
+    }
+}
+
+size_t DVL::recordedEnsemble(const char* data, size_t size, PD0View& view)
+{
+    frameid_t id;
+    PD0_Header header;
+    checksum_t remote_checksum;
+    size_t bytes;
+
+    if (size < sizeof(id) + sizeof(header) + sizeof(remote_checksum))
+        return 0;
+    memcpy(&id, data, sizeof(id));
+    memcpy(&header, data + sizeof(id), sizeof(header));
+    // The byte count runs from the header id up to the checksum.
+    bytes = header.bytes_in_ensemble;
+    if (id != kPD0HeaderID || bytes < sizeof(id) + sizeof(header) ||
+            bytes + sizeof(remote_checksum) > size)
+        return 0;
+    // Check the whole sum, not just the low byte like readPD0(). Here it
+    // also has to tell a real ensemble from a header id inside one.
+    memcpy(&remote_checksum, data + bytes, sizeof(remote_checksum));
+    if (remote_checksum != checksum_sum16(0, data, bytes))
+        return 0;
+    try {
+        view = PD0View(data + sizeof(id), bytes - sizeof(id));
+    } catch (DVLException& ex) {
+        return 0;
+    }
+    return bytes + sizeof(remote_checksum);
+}
+
+DVL::Message DVL::readPD4(SerialPort::Deadline deadline)
 {
     // Create a Message that we can return to the caller.
-    Message message = {FORMAT_PD4, std::make_shared<Payload>()};
+    Message message{};
+    message.format = FORMAT_PD4;
+    message.payload = takePayload(sizeof(PD4_Data));
     // Create storage for the checksum operation.
     checksum_t remote_checksum, checksum = 0x0;
     // Compute the checksum with the read info so far.
-    checksum = crc16(checksum, &kPD4HeaderID, sizeof(kPD4HeaderID));
-    // Pre-allocate storage for the whole packet.
-    message.payload->reserve(sizeof(PD4_Data));
+    checksum = checksum_sum16(checksum, &kPD4HeaderID, sizeof(kPD4HeaderID));
     // Read in the payload and spit it into the vector storage.
-    if (readRaw(message.payload->data(), sizeof(PD4_Data)))
+    if (readRaw(message.payload->data(), sizeof(PD4_Data), deadline))
         throw DVLException("Unable to read payload of incoming packet");
     // Compute the local checksum with the read data.
-    checksum = crc16(checksum, message.payload->data(), sizeof(PD4_Data));
+    checksum = checksum_sum16(checksum, message.payload->data(), sizeof(PD4_Data));
     // Read the remote checksum that the device computed.
-    if (readRaw(&remote_checksum, sizeof(remote_checksum)))
+    if (readRaw(&remote_checksum, sizeof(remote_checksum), deadline))
         throw DVLException("Unable to read checksum of incoming packet");
 
     // Compare the checksums to validate the message.
@@ -327,23 +259,23 @@ DVL::Message DVL::readPD4()
     return message;
 }
 
-DVL::Message DVL::readPD5()
+DVL::Message DVL::readPD5(SerialPort::Deadline deadline)
 {
     // Create a Message that we can return to the caller.
-    Message message = {FORMAT_PD5, std::make_shared<Payload>()};
+    Message message{};
+    message.format = FORMAT_PD5;
+    message.payload = takePayload(sizeof(PD5_Data));
     // Create storage for the checksum operation.
     checksum_t remote_checksum, checksum = 0x0;
-    // Pre-allocate storage for the whole packet.
-    message.payload->reserve(sizeof(PD5_Data));
     // Compute the checksum with the read info so far.
-    checksum = crc16(checksum, &kPD5HeaderID, sizeof(kPD5HeaderID));
+    checksum = checksum_sum16(checksum, &kPD5HeaderID, sizeof(kPD5HeaderID));
     // Read in the payload and spit it into the vector storage.
-    if (readRaw(message.payload->data(), sizeof(PD5_Data)))
+    if (readRaw(message.payload->data(), sizeof(PD5_Data), deadline))
         throw DVLException("Unable to read payload of incoming packet");
     // Compute the local checksum with the read data.
-    checksum = crc16(checksum, message.payload->data(), sizeof(PD5_Data));
+    checksum = checksum_sum16(checksum, message.payload->data(), sizeof(PD5_Data));
     // Read the remote checksum that the device computed.
-    if (readRaw(&remote_checksum, sizeof(remote_checksum)))
+    if (readRaw(&remote_checksum, sizeof(remote_checksum), deadline))
         throw DVLException("Unable to read checksum of incoming packet");
 
     // Compare the checksums to validate the message.
@@ -355,12 +287,14 @@ DVL::Message DVL::readPD5()
     return message;
 }
 
-DVL::Message DVL::readPD6()
+DVL::Message DVL::readPD6(SerialPort::Deadline deadline)
 {
     // Create a Message that we can return to the caller.
-    Message message = {FORMAT_PD6, std::make_shared<Payload>()};
-    // Create buffer storage to read in data char-by-char.
-    char text;
+    Message message{};
+    message.format = FORMAT_PD6;
+    message.payload = std::make_shared<Payload>();
+    // Storage for one line at a time.
+    std::string line;
     // Keep a list of the starts of strings.
     int attitude = 0, timing = 0, w_instrument, b_instrument;
     int w_ship, b_ship, w_earth, b_earth, w_distance, b_distance;
@@ -374,15 +308,15 @@ DVL::Message DVL::readPD6()
     // We need to read at least 3 lines, and then the limit changes based on what
     // lines we have seen so far. Seeing a ":W" line or ":B" line adds 4 to the total.
     for (int lines = 0; lines < 3 || lines < (2 + (water?4:0) + (bottom?4:0)); lines++) {
-        do {
-            // Read in a single char and push it onto the payload.
-            if (readRaw(&text, sizeof(char)))
-                throw DVLException("Unable to read text character");
-            // Disregard some characters from the input.
+        // Read until the end of the line.
+        line.clear();
+        if (!_port.readUntil('\n', line, deadline))
+            throw DVLException("Unable to read text line");
+        // Push it onto the payload, disregarding some characters from the input.
+        for (char text : line) {
             if (text != '\r' && text != '\n')
                 message.payload->push_back(text);
-            // Read until the end of the line.
-        } while (text != '\n');
+        }
         // Null terminate the string
         message.payload->push_back('\0');
 
@@ -454,18 +388,20 @@ DVL::Message DVL::readPD6()
     return message;
 }
 
-DVL::Message DVL::readText(char text)
+DVL::Message DVL::readText(char text, SerialPort::Deadline deadline)
 {
     // Create a Message that we can return to the caller.
-    Message message = {FORMAT_TEXT, std::make_shared<Payload>()};
+    Message message{};
+    message.format = FORMAT_TEXT;
+    message.payload = std::make_shared<Payload>();
+    // Storage for the rest of the text.
+    std::string rest;
     // Read until the next prompt appears.
-    while (text != '>') {
-        // Put what we just read into storage.
-        message.payload->push_back(text);
-        // Read in a single char and push it onto the payload.
-        if (readRaw(&text, sizeof(text)))
-            throw DVLException("Unable to read text character");
-    }
+    if (!_port.readUntil('>', rest, deadline))
+        throw DVLException("Unable to read text until the prompt");
+    // Put what we read into storage, without the prompt.
+    message.payload->push_back(text);
+    message.payload->insert(message.payload->end(), rest.begin(), rest.end() - 1);
     // Null terminate the string
     message.payload->push_back('\0');
     // The string pointer will start at the beginning of the payload vector.
@@ -477,29 +413,184 @@ DVL::Message DVL::readText(char text)
 DVL::Message DVL::readMessage()
 {
     char first = 0;
+    // The whole message has to arrive in one timeout.
+    SerialPort::Deadline deadline = SerialPort::deadline(_timeout);
     // Read in the beginning of the incoming message.
     do {
-        if (readRaw(&first, sizeof(first)))
+        if (readRaw(&first, sizeof(first), deadline))
             throw DVLException("Unable to read beginning of incoming message.");
     } while (!first);
     // From the first byte, determine the type of message being sent in.
     switch (first) {
         case kPD0HeaderID & 0xff: // We grabbed a PD0 packet that we have to read.
-            return readPD0();
+            return readPD0(deadline);
         case kPD4HeaderID & 0xff: // We grabbed a PD4/5 packet that we have to read.
-            if (readRaw(&first, sizeof(first)))
+            if (readRaw(&first, sizeof(first), deadline))
                 throw DVLException("Unable to read beginning of PD4/5 message.");
             if (first) {
-                return readPD5();
+                return readPD5(deadline);
              } else {
-                return readPD4();
+                return readPD4(deadline);
             }
         case ':': // We grabbed a PD6 packet that we have to read.
-            return readPD6();
+            return readPD6(deadline);
         case '>': // The message that came back was just a prompt.
-            return {FORMAT_EMPTY};
+            {
+                Message message{};
+                message.format = FORMAT_EMPTY;
+                return message;
+            }
         default:
-            return readText(first);
+            return readText(first, deadline);
+    }
+}
+
+DVL::YModemPacket DVL::readYModemPacket(YModemBlock& block, SerialPort::Deadline deadline)
+{
+    uint8_t start, number[2], crc[2];
+    // The DVL can say something before it starts, skip up to the first packet.
+    do {
+        if (readRaw(&start, sizeof(start), deadline))
+            return YMODEM_TIMEOUT;
+    } while (start != kYModemSOH && start != kYModemSTX &&
+            start != kYModemEOT && start != kYModemCAN);
+
+    if (start == kYModemEOT)
+        return YMODEM_END;
+    if (start == kYModemCAN) {
+        // It takes two in a row to cancel, one could just be noise.
+        if (readRaw(&start, sizeof(start), deadline))
+            return YMODEM_TIMEOUT;
+        return (start == kYModemCAN) ? YMODEM_CANCEL : YMODEM_BAD;
+    }
+
+    block.size = (start == kYModemSOH) ? 128 : sizeof(block.data);
+    if (readRaw(number, sizeof(number), deadline) ||
+            readRaw(block.data, block.size, deadline) ||
+            readRaw(crc, sizeof(crc), deadline))
+        return YMODEM_TIMEOUT;
+    // The packet number comes twice, the second time inverted.
+    if ((number[0] ^ number[1]) != 0xff)
+        return YMODEM_BAD;
+    // The CRC is sent high byte first.
+    if (checksum_crc16_ccitt(0, block.data, block.size) != ((crc[0] << 8) | crc[1]))
+        return YMODEM_BAD;
+    block.number = number[0];
+    return YMODEM_BLOCK;
+}
+
+void DVL::sendYModem(uint8_t control)
+{
+    if (writeRaw(&control, sizeof(control), SerialPort::deadline(_timeout)))
+        throw DVLException("Unable to send YMODEM reply");
+}
+
+void DVL::purgeInput(std::chrono::milliseconds quiet)
+{
+    // Something that never goes quiet is only given one timeout.
+    SerialPort::Deadline deadline = SerialPort::deadline(_timeout);
+    while (SerialPort::Clock::now() < deadline &&
+            _port.fill(1, SerialPort::deadline(quiet)))
+        _port.consume(_port.available());
+}
+
+size_t DVL::receiveYModem(const std::function<void(const uint8_t*, size_t)>& sink,
+        RecorderDownload& result)
+{
+    // A header with the file name and size comes first, then the data, then
+    // an empty header to end the batch.
+    enum { HEADER, DATA, CLOSING } stage = HEADER;
+    YModemBlock block;
+    size_t file_size = 0, received = 0;
+    uint8_t expected = 1;
+    int errors = 0;
+    bool refused_end = false;
+
+    try {
+        // Asks for packets with a CRC rather than a sum.
+        sendYModem(kYModemCRC);
+        while (true) {
+            YModemPacket packet = readYModemPacket(block, SerialPort::deadline(_timeout));
+
+            if (packet == YMODEM_CANCEL)
+                throw DVLException("DVL cancelled the download");
+            if (packet == YMODEM_TIMEOUT || packet == YMODEM_BAD) {
+                if (++errors > kYModemMaxErrors)
+                    throw DVLException("Too many bad packets in the download");
+                result.retries++;
+                // Let the rest of a bad packet go by before asking again.
+                purgeInput(std::chrono::milliseconds(500));
+                // Outside the data the DVL is waiting to be asked for a header.
+                sendYModem(stage == DATA ? kYModemNAK : kYModemCRC);
+                continue;
+            }
+            errors = 0;
+
+            if (packet == YMODEM_END) {
+                if (stage != DATA)
+                    throw DVLException("Download ended before it started");
+                // The first end is refused, in case it was noise.
+                if (!refused_end) {
+                    refused_end = true;
+                    sendYModem(kYModemNAK);
+                    continue;
+                }
+                sendYModem(kYModemACK);
+                sendYModem(kYModemCRC);
+                stage = CLOSING;
+                continue;
+            }
+
+            // Our last ACK went missing, so it was sent again.
+            if (stage == DATA && block.number == (uint8_t) (expected - 1)) {
+                sendYModem(kYModemACK);
+                // If it was the header, the DVL also needs asking for the data.
+                if (received == 0 && block.number == 0)
+                    sendYModem(kYModemCRC);
+                continue;
+            }
+
+            if (stage != DATA) {
+                // Header packets are number 0, and hold "name\0size ...".
+                std::string fields((const char*) block.data, block.size);
+                const char* name = fields.c_str();
+                size_t name_end = strlen(name) + 1;
+
+                if (block.number != 0)
+                    throw DVLException("Expected a YMODEM header packet");
+                // Only one file is wanted, turn down any after it.
+                if (stage == CLOSING && *name) {
+                    uint8_t cancel[] = {kYModemCAN, kYModemCAN};
+                    writeRaw(cancel, sizeof(cancel), SerialPort::deadline(_timeout));
+                    return received;
+                }
+                sendYModem(kYModemACK);
+                // No name is the end of the batch.
+                if (!*name)
+                    return received;
+                if (name_end < fields.size())
+                    file_size = strtoul(fields.c_str() + name_end, NULL, 10);
+                sendYModem(kYModemCRC);
+                stage = DATA;
+                continue;
+            }
+
+            if (block.number != expected)
+                throw DVLException("YMODEM packet out of sequence");
+            // The last packet is padded out, the header said how much is real.
+            if (file_size && block.size > file_size - received)
+                block.size = file_size - received;
+            sink(block.data, block.size);
+            received += block.size;
+            expected++;
+            sendYModem(kYModemACK);
+        }
+    } catch (...) {
+        // Tell the DVL to stop sending, so it goes back to taking commands.
+        uint8_t cancel[] = {kYModemCAN, kYModemCAN};
+        if (isOpen())
+            writeRaw(cancel, sizeof(cancel), SerialPort::deadline(_timeout));
+        throw;
     }
 }
 
@@ -509,25 +600,27 @@ void DVL::writeFormatted(Command cmd, va_list argv)
 {
     char buffer[BUF_SIZE];
     char cr = '\r';
+    // Sending the command and reading the echo share one timeout.
+    SerialPort::Deadline deadline = SerialPort::deadline(_timeout);
     // Assemble the command to a string from the format string.
     int bytes = vsnprintf(buffer, BUF_SIZE, cmd.format, argv);
     // Bytes written will not include the null char at the end.
     if (bytes == BUF_SIZE - 1)
         throw DVLException("Write buffer overflow");
     // Write the command to the output line to the DVL.
-    if (writeRaw(buffer, bytes))
+    if (writeRaw(buffer, bytes, deadline))
         throw DVLException("Unable to send command");
     // Write a carriage return to complete the command line.
-    if (writeRaw(&cr, 1))
+    if (writeRaw(&cr, 1, deadline))
         throw DVLException("Unable to send carriage return");
     // Read the echoed command that comes back from the DVL.
-    if (readRaw(buffer, bytes))
+    if (readRaw(buffer, bytes, deadline))
         throw DVLException("Unable to read command");
     // Read the echoed carriage return.
-    if (readRaw(&cr, 1))
+    if (readRaw(&cr, 1, deadline))
         throw DVLException("Unable to read carriage return");
     // Read the linefeed that the DVL responds with.
-    if (readRaw(&cr, 1))
+    if (readRaw(&cr, 1, deadline))
         throw DVLException("Unable to read linefeed");
 }
 
@@ -0,0 +1,42 @@
+
+#include "../include/util.h"
+
+#include <string>
+#include <stdio.h>
+#include <sysexits.h>
+#include <stdlib.h>
+
+int main(int argc, char *argv[])
+{
+   if (argc == 4 || argc == 5) {
+      std::string path(argv[3]);
+      try {
+         DVL *dvl = new DVL(std::string(argv[1]), getBaudrate(argv[2]));
+         // Download as fast as the DVL goes unless told otherwise.
+         DVL::DVLSpeed transfer = (argc == 5) ? getBaudrate(argv[4]) : DVL::k115200;
+         // Connect to the DVL, which also stops it pinging.
+         dvl->openDevice();
+         printf("%s\n", dvl->getRecorderStatus().c_str());
+         // Pull the recording down and index it.
+         DVL::RecorderDownload result = dvl->getRecordedData(path, transfer);
+         dvl->closeDevice();
+         printf("Saved %zu bytes to %s in %.1fs (%.0f bytes/s), %u packets resent.\n",
+               result.bytes, path.c_str(), result.seconds,
+               result.seconds > 0 ? result.bytes / result.seconds : 0.0, result.retries);
+         printf("Indexed %zu ensembles in %s.idx, skipped %zu bytes.\n",
+               result.index.ensembles, path.c_str(), result.index.skipped_bytes);
+         exit(0);
+      } catch (std::exception& e) {
+         printError(e);
+      }
+      // Whatever made it before the failure can still be replayed.
+      try {
+         DVL::RecorderIndex index = DVL::indexRecording(path + ".part");
+         printf("Kept %zu ensembles in %s.part, indexed in %s.part.idx.\n",
+               index.ensembles, path.c_str(), path.c_str());
+      } catch (std::exception& e) { }
+      exit(DVL_ERR);
+   }
+   printf("Usage: <dvl-tty> <dvl-baud> <recording-file> [<transfer-baud>]\n");
+   exit(EX_USAGE);
+}
@@ -194,7 +194,135 @@ std::string DVL::getRecorderStatus() {
     return std::string(sendCommand(cShowMemoryUsage).text);
 }
 
-void DVL::getRecordedData() {
+void DVL::setBaudrate(DVLSpeed speed) {
+    // The echo comes back at the old speed, the prompt after it at the new.
+    writeCommand(cSerialPortControl, speed.id, NO_PARITY, 1);
+    try {
+        _port.setSpeed(speed.baud);
+    } catch (SerialException& ex) {
+        throw DVLException(ex.what());
+    }
+    _termSpeed = speed;
+    // Whatever arrived while the two ends disagreed is noise.
+    purgeInput(std::chrono::milliseconds(200));
+}
+
+DVL::RecorderDownload DVL::getRecordedData(const std::string& path, DVLSpeed transfer_speed) {
+    RecorderDownload result = {};
+    DVLSpeed original = _termSpeed;
+    std::string part = path + ".part";
+    std::vector<char> buffer(kRecorderWriteSize);
+    SerialPort::Clock::time_point start;
+    FILE* file;
+    bool saved;
+
+    file = fopen(part.c_str(), "wb");
+    if (!file)
+        throw DVLException("Unable to create " + part);
+    // Let stdio gather up the packets and write them out in large pieces.
+    setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+
+    try {
+        if (transfer_speed.baud != original.baud)
+            setBaudrate(transfer_speed);
+        start = SerialPort::Clock::now();
+        writeCommand(cFileDownload);
+        result.bytes = receiveYModem([file](const uint8_t* data, size_t bytes) {
+            if (fwrite(data, 1, bytes, file) != bytes)
+                throw DVLException("Unable to write the recording");
+        }, result);
+        result.seconds = std::chrono::duration<double>(SerialPort::Clock::now() - start).count();
+        // The DVL prompts again once the transfer is over.
+        purgeInput(std::chrono::milliseconds(200));
+        if (transfer_speed.baud != original.baud)
+            setBaudrate(original);
+    } catch (...) {
+        fclose(file);
+        // Leave the link how we found it if we can, the first error is the
+        // one to report either way.
+        try {
+            if (_termSpeed.baud != original.baud)
+                setBaudrate(original);
+        } catch (DVLException&) { }
+        throw;
+    }
+
+    saved = fflush(file) == 0 && fsync(fileno(file)) == 0;
+    if (fclose(file) || !saved)
+        throw DVLException("Unable to save " + part);
+    if (rename(part.c_str(), path.c_str()))
+        throw DVLException("Unable to rename " + part + " to " + path);
+    result.index = indexRecording(path);
+    return result;
+}
+
+DVL::RecorderIndex DVL::indexRecording(const std::string& path) {
+    RecorderIndex index = {};
+    std::string index_path = path + ".idx";
+    std::vector<char> data, buffer(kRecorderWriteSize);
+    size_t pos = 0;
+    FILE* file;
+    long size;
+    bool done;
+
+    // The recorder holds a few megabytes at most, so read it in whole.
+    file = fopen(path.c_str(), "rb");
+    if (!file)
+        throw DVLException("Unable to open " + path);
+    done = !fseek(file, 0, SEEK_END) && (size = ftell(file)) >= 0 && !fseek(file, 0, SEEK_SET);
+    if (done) {
+        data.resize(size);
+        done = fread(data.data(), 1, data.size(), file) == data.size();
+    }
+    fclose(file);
+    if (!done)
+        throw DVLException("Unable to read " + path);
+
+    file = fopen(index_path.c_str(), "w");
+    if (!file)
+        throw DVLException("Unable to create " + index_path);
+    setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+    fprintf(file, "offset,bytes,ensemble,time\n");
+
+    while (pos < data.size()) {
+        PD0View ensemble;
+        size_t bytes = recordedEnsemble(data.data() + pos, data.size() - pos, ensemble);
+        const PD0_VariableLeader* leader;
+
+        if (!bytes) {
+            // Not a good ensemble here, skip to the next thing that could be.
+            const char* next = (const char*) memchr(data.data() + pos + 1,
+                    kPD0HeaderID & 0xff, data.size() - pos - 1);
+            size_t skip = (next ? next - data.data() : data.size()) - pos;
+            index.skipped_bytes += skip;
+            pos += skip;
+            continue;
+        }
+
+        fprintf(file, "%zu,%zu", pos, bytes);
+        leader = ensemble.variableLeader();
+        if (leader) {
+            // The real time clock only has the last two digits of the year.
+            struct tm rtc = {};
+            rtc.tm_year = 100 + leader->rtc_year;
+            rtc.tm_mon = leader->rtc_month - 1;
+            rtc.tm_mday = leader->rtc_day;
+            rtc.tm_hour = leader->rtc_hour;
+            rtc.tm_min = leader->rtc_minute;
+            rtc.tm_sec = leader->rtc_second;
+            fprintf(file, ",%lu,%.2f\n",
+                    leader->ensemble_number | ((unsigned long) leader->ensemble_number_msb << 16),
+                    timegm(&rtc) + leader->rtc_hundreths / 100.0);
+        } else {
+            fprintf(file, ",,\n");
+        }
+        index.ensembles++;
+        pos += bytes;
+    }
+
+    if (fclose(file))
+        throw DVLException("Unable to write " + index_path);
+    return index;
 }
 
 std::string DVL::getInstrumentTransformationMatrix() {
@@ -222,11 +350,38 @@ std::string DVL::testWiring() {
 }
 
 void DVL::enableMeasurement() {
-    sendCommand(cTimePerEnsemble, 0,0,0);
-    sendCommand(cTimeBetweenPings, 0,0,0);
+    sendCommand(cTimePerEnsemble, 0,0,0.0);
+    sendCommand(cTimeBetweenPings, 0,0.0);
     sendCommand(cStartPinging);
 }
 
+DVL::OutputProfile DVL::setNavigationOutput(bool with_sensor_data) {
+    // Start bit, 8 data bits and a stop bit per byte.
+    static constexpr double kBitsPerByte = 10;
+    DataConfig output = {};
+    OutputProfile profile;
+
+    // Without water profile cells the ping is only as long as the bottom
+    // track needs, which is what sets the ping rate.
+    sendCommand(cPingsPerEnsemble, 0);
+    sendCommand(cWaterMassPing, WM_PING_DISABLE);
+    // One bottom track ping per ensemble, each sent as soon as it's ready.
+    sendCommand(cBottomTrackPingsPerEnsemble, 1);
+    sendCommand(cTimePerEnsemble, 0,0,0.0);
+    sendCommand(cTimeBetweenPings, 0,0.0);
+
+    output.output_type = with_sensor_data ? PARTIAL_DATA : MINIMUM_DATA;
+    setDataTransferConfiguration(output);
+
+    profile.output_type = output.output_type;
+    // Header id and format byte, the data, then the checksum.
+    profile.ensemble_bytes = sizeof(frameid_t) + sizeof(checksum_t) +
+        (with_sensor_data ? sizeof(PD5_Data) : sizeof(PD4_Data));
+    profile.max_ensemble_rate = SerialPort::bitsPerSecond(_termSpeed.baud) /
+        (kBitsPerByte * profile.ensemble_bytes);
+    return profile;
+}
+
 void DVL::disableMeasurement() {
     sendBreak();
 }
@@ -236,43 +391,64 @@ DVL::DVLData DVL::getDVLData() {
     DVLData data = {};
     int scanned;
     switch (message.format) {
-        case FORMAT_PD0:
+        case FORMAT_PD0: {
+            const PD0_FixedLeader* fixed = message.pd0.fixedLeader();
+            const PD0_CellShortFields* velocity = message.pd0.velocity();
+            const PD0_BottomTrackHighRes* bottom = message.pd0.bottomTrackHighRes();
+            const PD0_BottomTrack* track = message.pd0.bottomTrack();
+            if (!fixed)
+                throw DVLException("PD0 ensemble without a fixed leader");
             data.transform = (CoordinateSystem)
-                ((message.pd0_fixed->coord_transform >> 3) & 0x3);
-            if (message.pd0_velocity) {
-                data.water_vel[0] = message.pd0_velocity[0][0];
-                data.water_vel[1] = message.pd0_velocity[0][1];
-                data.water_vel[2] = message.pd0_velocity[0][2];
-                data.water_vel[3] = message.pd0_velocity[0][3];
+                ((fixed->coord_transform >> 3) & 0x3);
+            if (velocity) {
+                data.water_vel[0] = velocity[0].beam[0];
+                data.water_vel[1] = velocity[0].beam[1];
+                data.water_vel[2] = velocity[0].beam[2];
+                data.water_vel[3] = velocity[0].beam[3];
+            }
+            if (bottom) {
+                data.bottom_vel[0] = bottom->bot_velocity[0];
+                data.bottom_vel[1] = bottom->bot_velocity[1];
+                data.bottom_vel[2] = bottom->bot_velocity[2];
+                data.bottom_vel[3] = bottom->bot_velocity[3];
             }
-            if (message.pd0_bottom_track_highres) {
-                data.bottom_vel[0] = message.pd0_bottom_track_highres->bot_velocity[0];
-                data.bottom_vel[1] = message.pd0_bottom_track_highres->bot_velocity[1];
-                data.bottom_vel[2] = message.pd0_bottom_track_highres->bot_velocity[2];
-                data.bottom_vel[3] = message.pd0_bottom_track_highres->bot_velocity[3];
+            if (track) {
+                // The top byte of each range comes separately.
+                for (int beam = 0; beam < 4; beam++)
+                    data.bottom_range[beam] = track->bot_range[beam] |
+                        ((unsigned int) track->range_msb[beam] << 16);
             }
             break;
+        }
         case FORMAT_PD4:
             data.transform = (CoordinateSystem) (message.pd4_data->system_config >> 6);
-            data.water_vel[0] = message.pd4_data->velocity[0];
-            data.water_vel[1] = message.pd4_data->velocity[1];
-            data.water_vel[2] = message.pd4_data->velocity[2];
-            data.water_vel[3] = message.pd4_data->velocity[3];
-            data.bottom_vel[0] = message.pd4_data->bottom[0];
-            data.bottom_vel[1] = message.pd4_data->bottom[1];
-            data.bottom_vel[2] = message.pd4_data->bottom[2];
-            data.bottom_vel[3] = message.pd4_data->bottom[3];
+            data.water_vel[0] = (int16_t) message.pd4_data->velocity[0];
+            data.water_vel[1] = (int16_t) message.pd4_data->velocity[1];
+            data.water_vel[2] = (int16_t) message.pd4_data->velocity[2];
+            data.water_vel[3] = (int16_t) message.pd4_data->velocity[3];
+            data.bottom_vel[0] = (int16_t) message.pd4_data->bottom[0];
+            data.bottom_vel[1] = (int16_t) message.pd4_data->bottom[1];
+            data.bottom_vel[2] = (int16_t) message.pd4_data->bottom[2];
+            data.bottom_vel[3] = (int16_t) message.pd4_data->bottom[3];
+            data.bottom_range[0] = message.pd4_data->beam_range[0];
+            data.bottom_range[1] = message.pd4_data->beam_range[1];
+            data.bottom_range[2] = message.pd4_data->beam_range[2];
+            data.bottom_range[3] = message.pd4_data->beam_range[3];
             break;
         case FORMAT_PD5:
             data.transform = (CoordinateSystem) (message.pd5_data->system_config >> 6);
-            data.water_vel[0] = message.pd5_data->velocity[0];
-            data.water_vel[1] = message.pd5_data->velocity[1];
-            data.water_vel[2] = message.pd5_data->velocity[2];
-            data.water_vel[3] = message.pd5_data->velocity[3];
-            data.bottom_vel[0] = message.pd5_data->bottom[0];
-            data.bottom_vel[1] = message.pd5_data->bottom[1];
-            data.bottom_vel[2] = message.pd5_data->bottom[2];
-            data.bottom_vel[3] = message.pd5_data->bottom[3];
+            data.water_vel[0] = (int16_t) message.pd5_data->velocity[0];
+            data.water_vel[1] = (int16_t) message.pd5_data->velocity[1];
+            data.water_vel[2] = (int16_t) message.pd5_data->velocity[2];
+            data.water_vel[3] = (int16_t) message.pd5_data->velocity[3];
+            data.bottom_vel[0] = (int16_t) message.pd5_data->bottom[0];
+            data.bottom_vel[1] = (int16_t) message.pd5_data->bottom[1];
+            data.bottom_vel[2] = (int16_t) message.pd5_data->bottom[2];
+            data.bottom_vel[3] = (int16_t) message.pd5_data->bottom[3];
+            data.bottom_range[0] = message.pd5_data->beam_range[0];
+            data.bottom_range[1] = message.pd5_data->beam_range[1];
+            data.bottom_range[2] = message.pd5_data->beam_range[2];
+            data.bottom_range[3] = message.pd5_data->beam_range[3];
             break;
         case FORMAT_PD6:
             /* These are the basic ways to grab data from the PD6 format.
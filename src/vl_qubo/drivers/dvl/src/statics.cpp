@@ -121,6 +121,16 @@ constexpr DVL::frameid_t DVL::kPD0SensorDataID;
 constexpr DVL::frameid_t DVL::kPD4HeaderID;
 constexpr DVL::frameid_t DVL::kPD5HeaderID;
 
+constexpr uint8_t DVL::kYModemSOH;
+constexpr uint8_t DVL::kYModemSTX;
+constexpr uint8_t DVL::kYModemEOT;
+constexpr uint8_t DVL::kYModemACK;
+constexpr uint8_t DVL::kYModemNAK;
+constexpr uint8_t DVL::kYModemCAN;
+constexpr uint8_t DVL::kYModemCRC;
+constexpr int DVL::kYModemMaxErrors;
+constexpr size_t DVL::kRecorderWriteSize;
+
 constexpr DVL::DVLSpeed DVL::k300;
 constexpr DVL::DVLSpeed DVL::k1200;
 constexpr DVL::DVLSpeed DVL::k2400;
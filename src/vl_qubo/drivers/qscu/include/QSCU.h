@@ -26,6 +26,10 @@
 #include <termios.h>
 // shared_ptr type
 #include <memory>
+// milliseconds type
+#include <chrono>
+// Buffered serial I/O
+#include "SerialPort.h"
 
 // Qubobus protocol definitions
 //TODO move the extern C into the qubobus code
@@ -90,16 +94,16 @@ class QSCU
         /** Data rate to communicate with */
         speed_t _termBaud;
         /** Serial port for serial I/O */
-        int _deviceFD;
-        /** Timeout (sec,usec) on read/write */
-        struct timeval _timeout;
+        SerialPort _port;
+        /** Timeout on each read/write the protocol library asks for */
+        std::chrono::milliseconds _timeout;
         /** State of the protocol link. */
         IO_State _state;
 
         /** Read bytes to a blob, return the bytes not read. */
         ssize_t readRaw(void* blob, size_t bytes_to_read);
         /** Write bytes from a blob, return the bytes not written. */
-        ssize_t writeRaw(void* blob, size_t bytes_to_write);
+        ssize_t writeRaw(const void* blob, size_t bytes_to_write);
 
         /* Maximum number of retries when we get a checksum error */
         const int _max_retries = 2;
@@ -17,7 +17,7 @@
 // Header include
 #include "QSCU.h"
 
-#if QUBOBUS_PROTOCOL_VERSION != 3
+#if QUBOBUS_PROTOCOL_VERSION != 4
 #error Update me with new message defs!
 #endif
 
@@ -26,8 +26,7 @@
 QSCU::QSCU(std::string deviceFile, speed_t baud)
     : _deviceFile(deviceFile),
       _termBaud(baud),
-      _deviceFD(-1),
-      _timeout({1,500})
+      _timeout(1000)
 {
 
 }
@@ -35,73 +34,25 @@ QSCU::QSCU(std::string deviceFile, speed_t baud)
 QSCU::~QSCU() { closeDevice(); }
 
 void QSCU::openDevice() {
-    struct termios termcfg;
-    int modemcfg = 0, fd = -1;
-    /* Open the serial port and store into a file descriptor.
-     * O_RDWR allows for bi-directional I/O, and
-     * O_NONBLOCK makes it so that read/write does not block.
-     */
-    fd = open(_deviceFile.c_str(), O_RDWR, O_NONBLOCK);
-    // Check to see if the device exists.
-    if (fd == -1) {
-        throw QSCUException("Device '"+_deviceFile+"' unavaliable.");
-    }
-    // Read the config of the interface.
-    if (tcgetattr(fd, &termcfg)) {
-        throw QSCUException("Unable to read terminal configuration.");
-    }
-
-    // Set the baudrate for the terminal
-    if (cfsetospeed(&termcfg, _termBaud)) {
-        throw QSCUException("Unable to set terminal output speed.");
-    }
-    if (cfsetispeed(&termcfg, _termBaud)) {
-        throw QSCUException("Unable to set terminal intput speed.");
-    }
-
-    // Set raw I/O rules to read and write the data purely.
-    cfmakeraw(&termcfg);
-
-    termcfg.c_cflag &= ~CSTOPB;
-
-    // Configure the read timeout (deciseconds)
-    termcfg.c_cc[VTIME] = 0;
-    // Configure the minimum number of chars for read.
-    termcfg.c_cc[VMIN] = 1;
-
-    // Push the configuration to the terminal NOW.
-    if (tcsetattr(fd, TCSANOW, &termcfg)) {
-        throw QSCUException("Unable to set terminal configuration.");
-    }
-
-    // Pull in the modem configuration
-    if (ioctl(fd, TIOCMGET, &modemcfg)) {
-        throw QSCUException("Unable to read modem configuration.");
-    }
-    // Enable Request to Send
-    modemcfg |= TIOCM_RTS;
-    // Push the modem config back to the modem.
-    if (ioctl(fd, TIOCMSET, &modemcfg)) {
-        throw QSCUException("Unable to set modem configuration.");
+    try {
+        _port.openDevice(_deviceFile, _termBaud);
+    } catch (SerialException& ex) {
+        throw QSCUException(ex.what());
     }
 
     // Successful hardware connection!
-    // Needs to be set for the qscu protocol library to make the connection.
-    _deviceFD = fd;
-
+    // Needs to be open for the qscu protocol library to make the connection.
     _state = initialize(this, QSCU::serialRead, QSCU::serialWrite, 10);
 
     connect();
 }
 
-bool QSCU::isOpen() {return _deviceFD >= 0;}
+bool QSCU::isOpen() {return _port.isOpen();}
 
 void QSCU::assertOpen() { if (!isOpen()) throw QSCUException("Device needs to be open!"); }
 
 void QSCU::closeDevice() {
-    if (isOpen())
-        close(_deviceFD);
-    _deviceFD = -1;
+    _port.closeDevice();
 }
 
 /******************************************************************************
@@ -133,73 +84,17 @@ ssize_t QSCU::serialWrite(void *io_host, void *buffer, size_t size) {
 }
 
 ssize_t QSCU::readRaw(void* blob, size_t bytes_to_read) {
-    // Keep track of the number of bytes read, and the number of fds that are ready.
-    int bytes_read = 0, current_read = 0, fds_ready = 0;
-    // Sets of file descriptors for use with select(2).
-    fd_set read_fds, write_fds, except_fds;
-    // Timeout in the form of {sec, usec}, for use with select(2).
-    struct timeval timeout = _timeout;
     // Ensure the device is avaliable and open.
     assertOpen();
-    // Check if we need to read data at all.
-    if (bytes_to_read > 0) {
-        do {
-            // Set up for the select call to handle timeouts.
-            FD_ZERO(&read_fds);
-            FD_ZERO(&write_fds);
-            FD_ZERO(&except_fds);
-            FD_SET(_deviceFD, &read_fds);
-            // Wait until the device is ready to read, return the number of FDs avalaible.
-            fds_ready = select(FD_SETSIZE, &read_fds, NULL, NULL, &timeout);
-            if (fds_ready == 1) {
-                // The filedescriptor is ready to read.
-                current_read = read(_deviceFD, (((char*)blob) + bytes_read),
-                        (bytes_to_read - bytes_read));
-                // If the read was successful, record the number of bytes read.
-                if (current_read >= 0) {
-                    bytes_read += current_read;
-                }
-            }
-            // Keep reading until we've run out of data, or we couldnt read more data.
-        } while ((bytes_read < bytes_to_read) && (fds_ready == 1) && (current_read >= 0));
-    }
     // Return the number of bytes we actually managed to read.
-    return bytes_read;
+    return _port.read(blob, bytes_to_read, SerialPort::deadline(_timeout));
 }
 
-ssize_t QSCU::writeRaw(void* blob, size_t bytes_to_write) {
-    // Keep track of the number of bytes written, and the number of fds that are ready.
-    int bytes_written = 0, current_write = 0, fds_ready = 0;
-    // Sets of file descriptors for use with select(2).
-    fd_set read_fds, write_fds, except_fds;
-    // Timeout in the form of {sec, usec}, for use with select(2).
-    struct timeval timeout = _timeout;
+ssize_t QSCU::writeRaw(const void* blob, size_t bytes_to_write) {
     // Ensure the device is avaliable and open.
     assertOpen();
-    // Check if we need to write data at all.
-    if (bytes_to_write > 0) {
-        do {
-            // Set up for the select call to handle timeouts.
-            FD_ZERO(&read_fds);
-            FD_ZERO(&write_fds);
-            FD_ZERO(&except_fds);
-            FD_SET(_deviceFD, &write_fds);
-            // Wait until the device is ready to write, return the number of FDs avalaible.
-            fds_ready = select(_deviceFD+1, &read_fds, &write_fds, &except_fds, &timeout);
-            if (fds_ready == 1) {
-                // The filedescriptor is ready to write.
-                current_write = write(_deviceFD, (((char*)blob) + bytes_written),
-                        (bytes_to_write - bytes_written));
-                // If the write was successful, record the number of bytes written.
-                if (current_write >= 0) {
-                    bytes_written += current_write;
-                }
-            }
-            // Keep writing until we've run out of data, or we couldnt write more data.
-        } while ((bytes_written < bytes_to_write) && (fds_ready == 1) && (current_write >= 0));
-    }
     // Return the number of bytes we actually managed to write.
-    return bytes_written;
+    return _port.write(blob, bytes_to_write, SerialPort::deadline(_timeout));
 }
 
 void QSCU::sendMessage(Transaction *transaction, void *payload, void *response) {
@@ -93,7 +93,14 @@ void QSCUNode::QubobusCallback(const ros::TimerEvent& event){
 
 	try {
 		if (m_outgoing.empty()) {
-			qscu.keepAlive();
+			// Nothing else to say, so check for monitor events instead of
+			// just keeping the link alive
+			QMsg msg;
+			msg.type = tSafetyMonitorEvents;
+			msg.payload = nullptr;
+			msg.reply = std::make_shared<struct Monitor_Events>();
+			qscu.sendMessage(&msg.type, msg.payload.get(), msg.reply.get());
+			m_incoming.push(msg);
 		} else {
 			QMsg msg = m_outgoing.front();
 			qscu.sendMessage(&msg.type, msg.payload.get(), msg.reply.get());
@@ -119,6 +126,25 @@ void QSCUNode::QubobusIncomingCallback(const ros::TimerEvent& event){
 			std::shared_ptr<struct Embedded_Status> e_s =
 				std::static_pointer_cast<struct Embedded_Status>(msg.reply);
 			ROS_ERROR("Uptime: %i, Mem: %f", e_s->uptime, e_s->mem_capacity);
+		} else if (msg.type.id == tSafetyMonitorEvents.id) {
+			std::shared_ptr<struct Monitor_Events> m_e =
+				std::static_pointer_cast<struct Monitor_Events>(msg.reply);
+			if (m_e->dropped) {
+				ROS_ERROR("Missed %i monitor events", m_e->dropped);
+			}
+			for (int i = 0; i < m_e->num_events && i < SAFETY_MAX_MONITOR_EVENTS; i++) {
+				const struct Monitor_Event &e = m_e->events[i];
+				if (e.warning_level == MONITOR_LEVEL_CRITICAL) {
+					ROS_ERROR("Monitor critical: module %i id %i field %i = %f, QSCU is now safe",
+							  e.module, e.index, e.field, e.value);
+				} else if (e.warning_level == MONITOR_LEVEL_WARNING) {
+					ROS_WARN("Monitor warning: module %i id %i field %i = %f",
+							 e.module, e.index, e.field, e.value);
+				} else {
+					ROS_INFO("Monitor normal: module %i id %i field %i = %f",
+							 e.module, e.index, e.field, e.value);
+				}
+			}
 		}
 
 		m_incoming.pop();
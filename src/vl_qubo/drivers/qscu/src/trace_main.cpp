@@ -0,0 +1,247 @@
+/******************************************************************************
+ * trace_main.cpp
+ * Pulls the run time stats and event trace off the Tiva over Qubobus.
+ *
+ * Prints the CPU usage of each task over the capture and a histogram of time
+ * spent in each interrupt handler, and writes the events out as Chrome trace
+ * JSON (load it in chrome://tracing or ui.perfetto.dev).
+ *
+ * usage: qscu_trace [device] [seconds] [output.json]
+ *
+ * Copyright (C) 2017 Robotics at Maryland
+ * All rights reserved.
+ ******************************************************************************/
+
+#include "QSCU.h"
+
+#if QUBOBUS_PROTOCOL_VERSION != 4
+#error Update me with new message defs!
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <map>
+#include <vector>
+
+// Trace events with their timestamps unwrapped to 64 bits.
+struct Event {
+    uint64_t timestamp;
+    uint8_t type;
+    uint8_t id;
+    uint16_t value;
+};
+
+static const char *isr_names[] = {"UART0", "UART1", "I2C0", "TIMER1"};
+
+static std::string isrName(uint8_t id) {
+    if (id < sizeof(isr_names) / sizeof(isr_names[0]))
+        return isr_names[id];
+    return "ISR " + std::to_string(id);
+}
+
+static struct Runtime_Stats readStats(QSCU &qscu) {
+    Transaction t_s = tDebugRuntimeStats;
+    struct Runtime_Stats stats;
+    qscu.sendMessage(&t_s, NULL, &stats);
+    return stats;
+}
+
+static void printCpuUsage(const struct Runtime_Stats &before, const struct Runtime_Stats &after) {
+    // Unsigned differences keep working across a single wrap of the counters.
+    uint32_t total = after.total_run_time - before.total_run_time;
+
+    printf("\n%-12s %8s %10s %6s\n", "task", "cpu %", "run time", "stack");
+    for (int i = 0; i < after.num_tasks; i++) {
+        const struct Task_Stats &task = after.tasks[i];
+        uint32_t run_time = task.run_time;
+        for (int j = 0; j < before.num_tasks; j++) {
+            if (before.tasks[j].task_number == task.task_number) {
+                run_time -= before.tasks[j].run_time;
+                break;
+            }
+        }
+        printf("%-12.*s %7.2f%% %10u %6u\n", DEBUG_TASK_NAME_LENGTH, task.name,
+               total ? 100.0 * run_time / total : 0.0, run_time, task.stack_high_water);
+    }
+
+    printf("\n%-8s %10s\n", "queue", "high water");
+    for (int i = 1; i < DEBUG_MAX_QUEUES; i++) {
+        if (after.queue_high_water[i])
+            printf("%-8d %10u\n", i, after.queue_high_water[i]);
+    }
+}
+
+static void printIsrHistograms(const std::vector<Event> &events, uint32_t timer_hz) {
+    // Buckets are powers of two of microseconds, the last one catches the rest.
+    const int num_buckets = 16;
+    std::map<uint8_t, std::vector<unsigned>> histograms;
+    std::map<uint8_t, uint64_t> entered;
+
+    for (const Event &e : events) {
+        if (e.type == TRACE_EVENT_ISR_ENTER) {
+            entered[e.id] = e.timestamp;
+        } else if (e.type == TRACE_EVENT_ISR_EXIT && entered.count(e.id)) {
+            uint64_t us = (e.timestamp - entered[e.id]) * 1000000 / timer_hz;
+            int bucket = 0;
+            while ((1ULL << bucket) <= us && bucket < num_buckets - 1)
+                bucket++;
+            histograms[e.id].resize(num_buckets);
+            histograms[e.id][bucket]++;
+            entered.erase(e.id);
+        }
+    }
+
+    for (auto &h : histograms) {
+        printf("\n%s handler time\n", isrName(h.first).c_str());
+        for (int b = 0; b < num_buckets; b++) {
+            if (!h.second[b])
+                continue;
+            if (b == 0)
+                printf("  %6s < %6u us: %u\n", "", 1, h.second[b]);
+            else if (b == num_buckets - 1)
+                printf("  %6u <= %5s us: %u\n", 1u << (b - 1), "", h.second[b]);
+            else
+                printf("  %6u - %6u us: %u\n", 1u << (b - 1), 1u << b, h.second[b]);
+        }
+    }
+}
+
+static void writeChromeTrace(const std::string &file, const std::vector<Event> &events,
+                             const struct Runtime_Stats &stats) {
+    std::ofstream out(file);
+    std::map<uint8_t, std::string> task_names;
+    std::map<uint8_t, uint64_t> entered;
+    const Event *running = NULL;
+    bool first = true;
+
+    for (int i = 0; i < stats.num_tasks; i++) {
+        task_names[stats.tasks[i].task_number] =
+            std::string(stats.tasks[i].name, strnlen(stats.tasks[i].name, DEBUG_TASK_NAME_LENGTH));
+    }
+
+    auto us = [&](uint64_t ticks) { return ticks * 1e6 / stats.timer_hz; };
+    auto emit = [&](const std::string &json) {
+        out << (first ? "\n" : ",\n") << json;
+        first = false;
+    };
+
+    out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+    const char *threads[] = {"tasks", "interrupts", "qubobus"};
+    for (int tid = 0; tid < 3; tid++) {
+        char buf[128];
+        snprintf(buf, sizeof(buf),
+                 "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": %d, \"args\": {\"name\": \"%s\"}}",
+                 tid, threads[tid]);
+        emit(buf);
+    }
+    for (const Event &e : events) {
+        char buf[256];
+        switch (e.type) {
+        case TRACE_EVENT_TASK_SWITCH:
+            // Each switch ends the slice of whatever task was running before it.
+            if (running) {
+                std::string name = task_names.count(running->id) ?
+                    task_names[running->id] : "task " + std::to_string(running->id);
+                snprintf(buf, sizeof(buf),
+                         "{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 0, \"tid\": 0, \"ts\": %.3f, \"dur\": %.3f}",
+                         name.c_str(), us(running->timestamp), us(e.timestamp - running->timestamp));
+                emit(buf);
+            }
+            running = &e;
+            break;
+        case TRACE_EVENT_ISR_ENTER:
+            entered[e.id] = e.timestamp;
+            break;
+        case TRACE_EVENT_ISR_EXIT:
+            if (entered.count(e.id)) {
+                snprintf(buf, sizeof(buf),
+                         "{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 0, \"tid\": 1, \"ts\": %.3f, \"dur\": %.3f}",
+                         isrName(e.id).c_str(), us(entered[e.id]), us(e.timestamp - entered[e.id]));
+                emit(buf);
+                entered.erase(e.id);
+            }
+            break;
+        case TRACE_EVENT_QUEUE_HIGH_WATER:
+            snprintf(buf, sizeof(buf),
+                     "{\"name\": \"queue %u\", \"ph\": \"C\", \"pid\": 0, \"ts\": %.3f, \"args\": {\"high water\": %u}}",
+                     e.id, us(e.timestamp), e.value);
+            emit(buf);
+            break;
+        case TRACE_EVENT_FRAME_IN:
+        case TRACE_EVENT_FRAME_OUT:
+            snprintf(buf, sizeof(buf),
+                     "{\"name\": \"%s id %u\", \"ph\": \"i\", \"s\": \"t\", \"pid\": 0, \"tid\": 2, \"ts\": %.3f,"
+                     " \"args\": {\"type\": %u, \"bytes\": %u}}",
+                     e.type == TRACE_EVENT_FRAME_IN ? "rx" : "tx", e.id, us(e.timestamp),
+                     e.value >> 12, e.value & 0xFFF);
+            emit(buf);
+            break;
+        }
+    }
+    out << "\n]}\n";
+}
+
+int main(int argc, char *argv[]) {
+    std::string device = argc > 1 ? argv[1] : "/dev/ttyACM0";
+    double seconds = argc > 2 ? atof(argv[2]) : 5.0;
+    std::string output = argc > 3 ? argv[3] : "trace.json";
+
+    QSCU qscu(device, B115200);
+    std::vector<Event> events;
+    struct Runtime_Stats before, after;
+    uint32_t dropped = 0;
+
+    try {
+        qscu.openDevice();
+
+        before = readStats(qscu);
+
+        Transaction t_r = tDebugTraceRead;
+        struct Trace_Read_Request request;
+        struct Trace_Block block;
+        uint64_t high_bits = 0;
+        uint32_t last = 0;
+
+        // Start from whatever is in the ring now, older events may predate the first snapshot.
+        request.sequence = 0;
+        qscu.sendMessage(&t_r, &request, &block);
+        request.sequence = block.head;
+
+        auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+        while (std::chrono::steady_clock::now() < end) {
+            qscu.sendMessage(&t_r, &request, &block);
+
+            if (block.sequence != request.sequence)
+                dropped += block.sequence - request.sequence;
+
+            for (int i = 0; i < block.num_events; i++) {
+                const struct Trace_Event &e = block.events[i];
+                // The timer wraps every 2^32 ticks, we read often enough to see every wrap.
+                if (!events.empty() && e.timestamp < last)
+                    high_bits += 1ULL << 32;
+                last = e.timestamp;
+                events.push_back({high_bits | e.timestamp, e.type, e.id, e.value});
+            }
+            request.sequence = block.sequence + block.num_events;
+
+            if (block.num_events == 0)
+                usleep(10000);
+        }
+
+        after = readStats(qscu);
+    } catch (const QSCUException &ex) {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    printf("%zu events captured, %u dropped\n", events.size(), dropped);
+    printCpuUsage(before, after);
+    printIsrHistograms(events, after.timer_hz);
+    writeChromeTrace(output, events, after);
+    printf("\nwrote %s\n", output.c_str());
+
+    return 0;
+}
@@ -0,0 +1,153 @@
+#ifndef SERIAL_PORT_H
+#define SERIAL_PORT_H
+
+/*
+ * SerialPort.h
+ * Buffered serial I/O shared by the AHRS, DVL and QSCU drivers.
+ *
+ * Copyright (C) 2017 Robotics at Maryland
+ * All rights reserved.
+ */
+
+// std::string type
+#include <string>
+// Error handling
+#include <stdexcept>
+// uint*_t types
+#include <stdint.h>
+// speed_t type
+#include <termios.h>
+// steady_clock type
+#include <chrono>
+
+/**
+ * Exception class for errors opening or configuring the port.
+ * The drivers rethrow these as their own exception type.
+ */
+class SerialException : public std::runtime_error
+{
+    public:
+        SerialException(std::string message)
+            : runtime_error(message) {}
+};
+
+/**
+ * Raw serial terminal with a receive ring in user space.
+ * Every read from the device takes as much as has arrived and will fit, so
+ * protocols can pull a byte or a line at a time without a syscall for each.
+ * Every operation runs until a monotonic deadline, so a caller reading a
+ * whole message in pieces can give it one time limit for all of them.
+ *
+ * One thread may read while another writes, but not two of either.
+ */
+class SerialPort
+{
+    public:
+        typedef std::chrono::steady_clock Clock;
+        typedef Clock::time_point Deadline;
+
+        /** Size of the receive ring, must be a power of two. */
+        static constexpr size_t kBufferSize = 4096;
+
+        SerialPort();
+        /** Closes the device if it is open. */
+        ~SerialPort();
+
+        /**
+         * Opens the device and configures it for raw I/O at the given speed,
+         * with RTS asserted.
+         * @param (std::string) unix device name
+         * @param (speed_t) termios baudrate
+         * @param (bool) true for two stop bits, false for one.
+         */
+        void openDevice(const std::string& deviceFile, speed_t baud, bool twoStopBits = false);
+        /** @return (bool) whether the device is open. */
+        bool isOpen();
+        /** Closes the device and drops anything buffered. */
+        void closeDevice();
+        /**
+         * Changes the speed of the open device, once what was written has gone
+         * out at the old one. Anything received around the change is likely
+         * garbage, flush() it.
+         * @param (speed_t) termios baudrate
+         */
+        void setSpeed(speed_t baud);
+
+        /**
+         * Deadline for an operation starting now.
+         * @param (Clock::duration) how long it may take.
+         */
+        static Deadline deadline(Clock::duration timeout) { return Clock::now() + timeout; }
+
+        /**
+         * Line rate of a termios speed, for working out transfer times.
+         * @return (long) bits per second, 0 if it isn't a speed we know.
+         */
+        static long bitsPerSecond(speed_t baud);
+
+        /** @return (size_t) bytes buffered and ready to take without waiting. */
+        size_t available();
+        /**
+         * Waits until at least bytes are buffered.
+         * @return (size_t) bytes buffered, fewer than asked for if the deadline
+         * passed or the device failed.
+         */
+        size_t fill(size_t bytes, Deadline deadline);
+        /**
+         * Copies up to bytes from the front of the buffer without taking them.
+         * @return (size_t) bytes copied.
+         */
+        size_t peek(void* blob, size_t bytes, Deadline deadline);
+        /** Drops bytes from the front of the buffer, no more than available(). */
+        void consume(size_t bytes);
+        /**
+         * Reads exactly bytes, or as many as arrive before the deadline.
+         * @return (size_t) bytes read.
+         */
+        size_t read(void* blob, size_t bytes, Deadline deadline);
+        /**
+         * Appends everything up to and including delim to line.
+         * @return (bool) false if the deadline passed before delim arrived,
+         * what did arrive is still appended.
+         */
+        bool readUntil(char delim, std::string& line, Deadline deadline);
+        /**
+         * Writes exactly bytes, or as many as the device takes before the deadline.
+         * @return (size_t) bytes written.
+         */
+        size_t write(const void* blob, size_t bytes, Deadline deadline);
+
+        /** Discards the buffered input, and whatever the terminal has queued. */
+        void flush();
+        /** Holds the line in a break for the given number of deciseconds. */
+        void sendBreak(int deciseconds);
+
+        /** @return (uint64_t) read syscalls made so far, for profiling. */
+        uint64_t readCalls() { return _readCalls; }
+
+    private:
+        /** Serial port file descriptor, -1 when closed. */
+        int _deviceFD;
+        /** Receive ring, indexed by the counters modulo kBufferSize. */
+        uint8_t _buffer[kBufferSize];
+        /** Total bytes put into the ring. */
+        size_t _head;
+        /** Total bytes taken out of the ring. */
+        size_t _tail;
+        /** Number of read(2) calls. */
+        uint64_t _readCalls;
+
+        /**
+         * Waits for the device to become ready.
+         * @param (short) poll(2) events to wait for.
+         * @return (bool) false if the deadline passed or the device failed.
+         */
+        bool waitFor(short events, Deadline deadline);
+        /**
+         * Reads whatever has arrived into the free space in the ring.
+         * @return (bool) false if nothing could be read.
+         */
+        bool receive();
+};
+
+#endif
@@ -0,0 +1,264 @@
+/******************************************************************************
+ * SerialPort.cpp
+ * Buffered serial I/O implementation.
+ *
+ * Copyright (C) 2017 Robotics at Maryland
+ * All rights reserved.
+ ******************************************************************************/
+
+// UNIX Serial includes
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+// std::min
+#include <algorithm>
+
+// Header include
+#include "SerialPort.h"
+
+static_assert((SerialPort::kBufferSize & (SerialPort::kBufferSize - 1)) == 0,
+        "SerialPort::kBufferSize must be a power of two");
+
+SerialPort::SerialPort()
+    : _deviceFD(-1), _head(0), _tail(0), _readCalls(0)
+{ }
+
+SerialPort::~SerialPort() { closeDevice(); }
+
+void SerialPort::openDevice(const std::string& deviceFile, speed_t baud, bool twoStopBits) {
+    struct termios termcfg;
+    int modemcfg = 0, fd = -1;
+    const char* error = NULL;
+
+    closeDevice();
+
+    /* Open the serial port and store into a file descriptor.
+     * O_RDWR allows for bi-directional I/O, and
+     * O_NONBLOCK makes it so that read/write does not block, everything
+     * waits in poll(2) instead so it can give up at the deadline.
+     */
+    fd = open(deviceFile.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+    // Check to see if the device exists.
+    if (fd == -1)
+        throw SerialException("Device '"+deviceFile+"' unavaliable.");
+
+    // Read the config of the interface.
+    if (tcgetattr(fd, &termcfg))
+        error = "Unable to read terminal configuration.";
+    // Set the baudrate for the terminal
+    else if (cfsetospeed(&termcfg, baud))
+        error = "Unable to set terminal output speed.";
+    else if (cfsetispeed(&termcfg, baud))
+        error = "Unable to set terminal intput speed.";
+
+    if (!error) {
+        // Set raw I/O rules to read and write the data purely.
+        cfmakeraw(&termcfg);
+
+        if (twoStopBits)
+            termcfg.c_cflag |= CSTOPB;
+        else
+            termcfg.c_cflag &= ~CSTOPB;
+
+        // Configure the read timeout (deciseconds)
+        termcfg.c_cc[VTIME] = 0;
+        // Configure the minimum number of chars for read.
+        termcfg.c_cc[VMIN] = 1;
+
+        // Push the configuration to the terminal NOW.
+        if (tcsetattr(fd, TCSANOW, &termcfg))
+            error = "Unable to set terminal configuration.";
+        // Pull in the modem configuration
+        else if (ioctl(fd, TIOCMGET, &modemcfg))
+            error = "Unable to read modem configuration.";
+    }
+
+    if (!error) {
+        // Enable Request to Send
+        modemcfg |= TIOCM_RTS;
+        // Push the modem config back to the modem.
+        if (ioctl(fd, TIOCMSET, &modemcfg))
+            error = "Unable to set modem configuration.";
+    }
+
+    if (error) {
+        close(fd);
+        throw SerialException(error);
+    }
+
+    // Successful execution!
+    _deviceFD = fd;
+    _head = _tail = 0;
+}
+
+bool SerialPort::isOpen() { return _deviceFD >= 0; }
+
+void SerialPort::closeDevice() {
+    if (isOpen())
+        close(_deviceFD);
+    _deviceFD = -1;
+    _head = _tail = 0;
+}
+
+void SerialPort::setSpeed(speed_t baud) {
+    struct termios termcfg;
+
+    if (!isOpen())
+        throw SerialException("Device needs to be open!");
+    if (tcgetattr(_deviceFD, &termcfg))
+        throw SerialException("Unable to read terminal configuration.");
+    if (cfsetospeed(&termcfg, baud) || cfsetispeed(&termcfg, baud))
+        throw SerialException("Unable to set terminal speed.");
+    // Let the output drain first, so the last command goes at the old speed.
+    if (tcsetattr(_deviceFD, TCSADRAIN, &termcfg))
+        throw SerialException("Unable to set terminal configuration.");
+}
+
+long SerialPort::bitsPerSecond(speed_t baud) {
+    switch (baud) {
+        case B300:      return 300;
+        case B1200:     return 1200;
+        case B2400:     return 2400;
+        case B4800:     return 4800;
+        case B9600:     return 9600;
+        case B19200:    return 19200;
+        case B38400:    return 38400;
+        case B57600:    return 57600;
+        case B115200:   return 115200;
+        case B230400:   return 230400;
+        default:        return 0;
+    }
+}
+
+size_t SerialPort::available() { return _head - _tail; }
+
+size_t SerialPort::fill(size_t bytes, Deadline deadline) {
+    // More than the ring holds would never be satisfied.
+    if (bytes > kBufferSize)
+        bytes = kBufferSize;
+    while (available() < bytes) {
+        if (!waitFor(POLLIN, deadline) || !receive())
+            break;
+    }
+    return available();
+}
+
+size_t SerialPort::peek(void* blob, size_t bytes, Deadline deadline) {
+    size_t start, first;
+
+    bytes = std::min(bytes, fill(bytes, deadline));
+    // Copy out in up to two pieces, either side of the end of the ring.
+    start = _tail % kBufferSize;
+    first = std::min(bytes, kBufferSize - start);
+    memcpy(blob, _buffer + start, first);
+    memcpy(((uint8_t*) blob) + first, _buffer, bytes - first);
+    return bytes;
+}
+
+void SerialPort::consume(size_t bytes) {
+    _tail += std::min(bytes, available());
+}
+
+size_t SerialPort::read(void* blob, size_t bytes, Deadline deadline) {
+    size_t bytes_read = 0;
+    // Anything longer than the ring goes through it a ring at a time.
+    while (bytes_read < bytes) {
+        size_t chunk = std::min(bytes - bytes_read, kBufferSize);
+        size_t current = peek(((uint8_t*) blob) + bytes_read, chunk, deadline);
+        consume(current);
+        bytes_read += current;
+        if (current < chunk)
+            break;
+    }
+    return bytes_read;
+}
+
+bool SerialPort::readUntil(char delim, std::string& line, Deadline deadline) {
+    while (fill(1, deadline)) {
+        // Scan what is already here before asking the device for more.
+        size_t bytes = available();
+        for (size_t i = 0; i < bytes; i++) {
+            char c = _buffer[(_tail + i) % kBufferSize];
+            line.push_back(c);
+            if (c == delim) {
+                consume(i + 1);
+                return true;
+            }
+        }
+        consume(bytes);
+    }
+    return false;
+}
+
+size_t SerialPort::write(const void* blob, size_t bytes, Deadline deadline) {
+    size_t bytes_written = 0;
+    while (bytes_written < bytes && waitFor(POLLOUT, deadline)) {
+        ssize_t current = ::write(_deviceFD, ((const uint8_t*) blob) + bytes_written,
+                bytes - bytes_written);
+        if (current > 0)
+            bytes_written += current;
+        else if (current < 0 && errno != EAGAIN && errno != EINTR)
+            break;
+    }
+    return bytes_written;
+}
+
+void SerialPort::flush() {
+    _tail = _head;
+    if (isOpen())
+        tcflush(_deviceFD, TCIFLUSH);
+}
+
+void SerialPort::sendBreak(int deciseconds) {
+    if (isOpen())
+        ioctl(_deviceFD, TCSBRKP, deciseconds);
+}
+
+bool SerialPort::waitFor(short events, Deadline deadline) {
+    struct pollfd pfd = {_deviceFD, events, 0};
+    int ready;
+
+    if (!isOpen())
+        return false;
+    do {
+        // Round up so we never wake just before the deadline and spin.
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - Clock::now() + std::chrono::milliseconds(1) - Clock::duration(1));
+        int timeout = remaining.count() > 0 ? remaining.count() : 0;
+        ready = poll(&pfd, 1, timeout);
+    } while (ready < 0 && errno == EINTR);
+
+    return ready > 0 && (pfd.revents & events);
+}
+
+bool SerialPort::receive() {
+    // Read straight into the free space, which may wrap around the end.
+    size_t free = kBufferSize - available();
+    size_t start = _head % kBufferSize;
+    size_t first = std::min(free, kBufferSize - start);
+    struct iovec iov[2] = {
+        {_buffer + start, first},
+        {_buffer, free - first},
+    };
+    ssize_t current;
+
+    if (free == 0)
+        return false;
+    current = readv(_deviceFD, iov, (free > first) ? 2 : 1);
+    _readCalls++;
+    if (current > 0) {
+        _head += current;
+        return true;
+    }
+    // Nothing there after all, poll again. Anything else is end of file or
+    // an error, and waiting won't fix it.
+    return current < 0 && (errno == EAGAIN || errno == EINTR);
+}
+
+constexpr size_t SerialPort::kBufferSize;
@@ -8,6 +8,7 @@
 #include <iostream>
 #include <sstream>
 #include <thread>
+#include <vector>
 #include <stdio.h>
 
 //AHRS includes
@@ -19,12 +20,35 @@
 #include "tf/tf.h"
 #include "std_msgs/Float64.h"
 
+//the AHRS measures acceleration in g, sensor_msgs/Imu wants m/s^2
+#define G_IN_MS2 9.80665
+
 class AHRSQuboNode{
     public:
-    AHRSQuboNode(ros::NodeHandle n, std::string node_name, std::string ahrs_device);
+    /**
+     * @param streaming     true to have the AHRS send samples on its own, false to poll for each one
+     * @param sample_delay  seconds between samples when streaming, 0 for as fast as it can
+     * @param publish_euler also publish roll, pitch and yaw worked out from the quaternion
+     */
+    AHRSQuboNode(ros::NodeHandle n, std::string node_name, std::string ahrs_device,
+                 bool streaming = true, float sample_delay = 0, bool publish_euler = true);
     ~AHRSQuboNode();
 
+    /**
+     * Sets the covariances published with every imu message, each a row major
+     * 3x3 matrix in the message's units (rad, rad/s and m/s^2). An empty one
+     * leaves that field unknown, which sensor_msgs/Imu marks with -1 in the
+     * first element.
+     */
+    void setCovariances(const std::vector<double> &orientation,
+                        const std::vector<double> &angular_velocity,
+                        const std::vector<double> &linear_acceleration);
+
 
+    /**
+     * Publishes every sample that arrived since the last call when streaming,
+     * otherwise polls for one and publishes that
+     */
     void update();
 
     void updateAHRS();
@@ -41,9 +65,16 @@ class AHRSQuboNode{
     
     //defined in AHRS driver
     AHRS::AHRSData m_ahrs_data;
+
+    bool m_streaming;
+    float m_sample_delay;
+    bool m_publish_euler;
+
+    //last error counts we warned about
+    uint32_t m_stream_errors = 0;
+    size_t m_dropped_samples = 0;
     
-    //not sure this will actually work for what we want to publish
-    //    sensor_msgs::Imu m_msg;
+    sensor_msgs::Imu m_msg;
     std_msgs::Float64 m_roll_msg;
     std_msgs::Float64 m_pitch_msg;
     std_msgs::Float64 m_yaw_msg;
@@ -56,10 +87,16 @@ class AHRSQuboNode{
     //--------------------------------------------------------------------------
     //Orientation parameters (possibly fused from AHRS/IMU)
     
-    //    ros::Publisher m_orientPub;
+    ros::Publisher m_imu_pub;
     ros::Publisher m_roll_pub;
     ros::Publisher m_pitch_pub;
     ros::Publisher m_yaw_pub;
+
+    //puts the device in continuous mode if we're streaming
+    void startDevice();
+
+    //publishes one sample, stamped with when the AHRS took it
+    void publish(const AHRS::AHRSSample &sample);
     
 };
 
@@ -0,0 +1,145 @@
+#ifndef QUBO_ARDUINO_NODE_H
+#define QUBO_ARDUINO_NODE_H
+
+//ros includes
+#include "ros/ros.h"
+#include "ram_msgs/ArduinoTelemetry.h"
+#include "std_msgs/Float64.h"
+#include "std_msgs/Float64MultiArray.h"
+#include "std_msgs/String.h"
+#include "std_srvs/Empty.h"
+
+//c++ library includes
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <termios.h>
+
+//shared with the arduino sketch
+#include "Frame.h"
+
+/**
+ * Talks to the arduino over its binary frames, see embedded/arduino/Frame.h.
+ *
+ * The arduino streams telemetry on its own, so a reader thread decodes the
+ * serial port as bytes come in and publishes each frame straight away, with
+ * the stamp moved back to when the arduino sampled it. The main thread only
+ * sends thruster commands.
+ */
+class ArduinoQuboNode {
+
+public:
+
+	/**
+	 * @param n              NodeHandle to publish on
+	 * @param device         serial device of the arduino
+	 * @param telemetry_rate telemetry frames per second to ask the arduino for
+	 */
+	ArduinoQuboNode(ros::NodeHandle n, std::string device, int telemetry_rate);
+
+	/**
+	 * Stops the reader thread and closes the device
+	 */
+	~ArduinoQuboNode();
+
+	/**
+	 * Sends the latest thruster commands, call at the control rate
+	 */
+	void update();
+
+protected:
+
+	std::string device;
+
+	int telemetry_rate;
+
+	//-1 when closed, only the reader thread opens and closes it
+	std::atomic<int> fd;
+
+	std::thread reader;
+
+	std::atomic<bool> running;
+
+	//serializes writes from the main and reader threads
+	std::mutex write_mutex;
+
+	uint8_t seq = 0;
+
+	ros::Publisher telemetry_pub;
+	ros::Publisher depth_pub;
+	ros::Publisher status_pub;
+	ros::Subscriber thruster_sub;
+	ros::ServiceServer shutdown_srv;
+
+	//mapped thruster commands, guarded by cmd_mutex
+	std::mutex cmd_mutex;
+	std::vector<uint16_t> thruster_cmds;
+	bool shutdown_flag = false;
+
+	//--------------------------------------------------------------------------
+	//clock offset estimate, only touched by the reader thread
+
+	//ROS time minus arduino time of the quickest frame seen, in seconds
+	double clock_offset;
+
+	bool have_offset = false;
+
+	ros::Time last_offset_update;
+
+	//millis() wraps every 49 days, this counts the wraps
+	uint32_t last_arduino_ms = 0;
+	uint64_t arduino_ms_high = 0;
+
+	//--------------------------------------------------------------------------
+
+	static const int NUM_THRUSTERS = 8;
+
+	static const speed_t BAUD = B115200;
+	static const int BITS_PER_BYTE = 10;
+	static const int BAUD_RATE = 115200;
+
+	//how far the arduino's clock can drift from ours, its ceramic resonator is
+	//good to about 0.5%
+	static constexpr double MAX_CLOCK_DRIFT = 0.005;
+
+	//pulse width in us that stops a thruster, THRUSTER_NEUTRAL in qubo_arduino.ino
+	static const uint16_t THRUSTER_NEUTRAL = 1520;
+
+	//same mapping arduino_node.py used, from control effort to pulse width in us
+	static constexpr double CONTROL_MIN = -128.0;
+	static constexpr double CONTROL_MAX = 128.0;
+	static constexpr double PULSE_MIN = 1029.0;
+	static constexpr double PULSE_MAX = 1541.0;
+
+	void openDevice();
+	void closeDevice();
+
+	/**
+	 * Body of the reader thread, (re)opens the device and decodes everything
+	 * it reads until the node shuts down
+	 */
+	void readLoop();
+
+	void handleFrame(const FrameDecoder &decoder, ros::Time received);
+
+	/**
+	 * Works out when the arduino sampled a frame that finished arriving at
+	 * received, from the arduino's millis() in it.
+	 *
+	 * received - sent is the transport latency plus the offset between the
+	 * clocks. The smallest of these is the closest to the offset alone, so that
+	 * is tracked, let rise slowly to follow drift.
+	 */
+	ros::Time correctStamp(uint32_t arduino_ms, ros::Time received, size_t frame_size);
+
+	void sendFrame(uint8_t type, const uint8_t *payload);
+
+	uint16_t thrusterMap(double control);
+
+	void thrusterCallback(const std_msgs::Float64MultiArray::ConstPtr &msg);
+
+	bool shutdownThrusters(std_srvs::Empty::Request &req, std_srvs::Empty::Response &res);
+};
+
+#endif
@@ -16,8 +16,12 @@ public:
 	 * @param rate   rate handed to ros::rate
 	 * @param name   device description, used when publishing data
 	 * @param device file location of the DVL device
+	 * @param output "navigation" for PD4 bottom track only at the highest ping
+	 *               rate, "navigation_sensors" for PD5, which adds attitude and
+	 *               depth, or "full" for PD0 with the water profile
 	 */
-	DvlQuboNode(ros::NodeHandle n, int rate, std::string name, std::string device);
+	DvlQuboNode(ros::NodeHandle n, int rate, std::string name, std::string device,
+	            std::string output = "navigation");
 
 	/**
 	 * Desctructor for the DVL ROS node
@@ -32,6 +36,22 @@ protected:
 	 */
 	std::string name;
 
+	/**
+	 * which output setup_dvl configures, see the constructor
+	 */
+	std::string output_mode;
+
+	/**
+	 * ensembles since rate_start, for reporting the ping rate we actually get
+	 */
+	int ensembles = 0;
+	ros::Time rate_start;
+
+	/**
+	 * seconds between ping rate reports
+	 */
+	static constexpr double RATE_REPORT_PERIOD = 10.0;
+
 	/**
 	 * ROS publisher for the DVL data
 	 */
@@ -17,12 +17,31 @@ void signal_handler(int sig) {
 int main(int argc, char* argv[]){
 	ros::init(argc, argv, "ahrs_node");
     ros::NodeHandle nh;
+    ros::NodeHandle private_nh("~");
+
+    //streaming has the AHRS send samples on its own, polling waits on a request for each
+    bool streaming, publish_euler;
+    double sample_delay, loop_rate;
+    private_nh.param("streaming", streaming, true);
+    private_nh.param("sample_delay", sample_delay, 0.0);
+    //when streaming, update() publishes everything that came in since the last call
+    private_nh.param("loop_rate", loop_rate, 100.0);
+    //roll, pitch and yaw topics, for whatever doesn't read /qubo/imu yet
+    private_nh.param("publish_euler", publish_euler, true);
+
+    //row major 3x3 matrices, left unknown if they aren't set
+    vector<double> orientation_covariance, angular_velocity_covariance, linear_acceleration_covariance;
+    private_nh.getParam("orientation_covariance", orientation_covariance);
+    private_nh.getParam("angular_velocity_covariance", angular_velocity_covariance);
+    private_nh.getParam("linear_acceleration_covariance", linear_acceleration_covariance);
 	
-	AHRSQuboNode cn(nh, "hardware_node", "/dev/ttyUSB0");
-	
-    while(1){
+	AHRSQuboNode cn(nh, "hardware_node", "/dev/ttyUSB0", streaming, sample_delay, publish_euler);
+    cn.setCovariances(orientation_covariance, angular_velocity_covariance, linear_acceleration_covariance);
+
+    ros::Rate rate(loop_rate);
+    while(ros::ok()){
         cn.update();
-        this_thread::sleep_for(chrono::seconds(1)); //this is really slow right now
+        rate.sleep();
     }
 	
 	return 0;
@@ -1,20 +1,29 @@
 #include "ahrs_node.h"
 
+#include <algorithm>
+
 
 using namespace std;
 using namespace ros;
 
-AHRSQuboNode::AHRSQuboNode(ros::NodeHandle n, string node_name, string ahrs_device)
-    :m_node_name{node_name}, m_ahrs_device{ahrs_device}, m_ahrs(ahrs_device,AHRS::k115200) {
+AHRSQuboNode::AHRSQuboNode(ros::NodeHandle n, string node_name, string ahrs_device,
+                           bool streaming, float sample_delay, bool publish_euler)
+    :m_node_name{node_name}, m_ahrs_device{ahrs_device}, m_ahrs(ahrs_device,AHRS::k115200),
+     m_streaming{streaming}, m_sample_delay{sample_delay}, m_publish_euler{publish_euler} {
 
 
 
 		//initialize publisher
-		m_roll_pub  = n.advertise<std_msgs::Float64>("/qubo/roll", 1000);
-		m_pitch_pub = n.advertise<std_msgs::Float64>("/qubo/pitch", 1000);
-		m_yaw_pub   = n.advertise<std_msgs::Float64>("qubo/yaw", 1000);
+		if(m_publish_euler){
+			m_roll_pub  = n.advertise<std_msgs::Float64>("/qubo/roll", 1000);
+			m_pitch_pub = n.advertise<std_msgs::Float64>("/qubo/pitch", 1000);
+			m_yaw_pub   = n.advertise<std_msgs::Float64>("/qubo/yaw", 1000);
+		}
 		
-		//        m_orientPub = n.advertise<sensor_msgs::Imu>("/qubo/orientation",1000);
+		m_imu_pub   = n.advertise<sensor_msgs::Imu>("/qubo/imu", 1000);
+
+		m_msg.header.frame_id = "ahrs";
+		setCovariances({}, {}, {});
 
 		ROS_ERROR("opening device %s", ahrs_device.c_str());
 
@@ -35,28 +44,71 @@ AHRSQuboNode::AHRSQuboNode(ros::NodeHandle n, string node_name, string ahrs_devi
             ROS_ERROR("AHRS %s didn't open succsesfully", m_ahrs_device.c_str());
             return;
         }
-        //configs the device
-        m_ahrs.sendAHRSDataFormat();
-    
         ROS_DEBUG("Device Info: %s", m_ahrs.getInfo().c_str());
-    
-        
+
+        startDevice();
+}
+
+void AHRSQuboNode::startDevice(){
+	try{
+		//configs the device
+		m_ahrs.sendAHRSDataFormat();
+		if(m_streaming){
+			m_ahrs.startStreaming(m_sample_delay);
+		}
+	}catch(AHRSException& ex){
+		ROS_ERROR("%s", ex.what());
+	}
+}
+
+void AHRSQuboNode::setCovariances(const vector<double> &orientation,
+                                  const vector<double> &angular_velocity,
+                                  const vector<double> &linear_acceleration){
+	//they're the same for every message, so they're filled in once here
+	auto fill = [](const vector<double> &values, boost::array<double, 9> &covariance, const char *name){
+		covariance.fill(0);
+		if(values.size() == covariance.size()){
+			copy(values.begin(), values.end(), covariance.begin());
+			return;
+		}
+		if(!values.empty()){
+			ROS_WARN("%s covariance needs 9 values, got %zu, leaving it unknown", name, values.size());
+		}
+		// the -1's imply we don't know the covariance
+		covariance[0] = -1;
+	};
+
+	fill(orientation, m_msg.orientation_covariance, "orientation");
+	fill(angular_velocity, m_msg.angular_velocity_covariance, "angular velocity");
+	fill(linear_acceleration, m_msg.linear_acceleration_covariance, "linear acceleration");
 }
 
 AHRSQuboNode::~AHRSQuboNode(){
+    //leave it polled, otherwise it floods whatever opens it next
+    try{
+        m_ahrs.stopStreaming();
+    }catch(AHRSException& ex){
+        ROS_ERROR("%s", ex.what());
+    }
     m_ahrs.closeDevice();
 
     
 }
 
 void AHRSQuboNode::update(){
-    static int id = 0;
     static int attempts = 0;
 
+	//the reader thread gives up if the device stops making sense, start over
+	if(m_streaming && m_ahrs.isOpen() && !m_ahrs.isStreaming()){
+		ROS_ERROR("AHRS stream stopped, reconnecting");
+		m_ahrs.closeDevice();
+	}
+
 	//if we aren't connected yet, lets try a few more times
 	if(!m_ahrs.isOpen()){
 		try{
 			m_ahrs.openDevice();
+			startDevice();
 		}catch(AHRSException& ex){
 			ROS_ERROR("Attempt %i to connect to AHRS failed.", attempts++);
 			ROS_ERROR("DEVICE NOT FOUND! ");
@@ -70,56 +122,77 @@ void AHRSQuboNode::update(){
 	}
 	attempts = 0;
 
+	if(m_streaming){
+		AHRS::AHRSSample sample;
+
+		//everything the reader thread got since last time, oldest first
+		while(m_ahrs.popSample(sample)){
+			publish(sample);
+		}
+
+		if(m_ahrs.streamErrors() != m_stream_errors){
+			m_stream_errors = m_ahrs.streamErrors();
+			ROS_WARN("%u bad frames from the AHRS so far", m_stream_errors);
+		}
+		if(m_ahrs.droppedSamples() != m_dropped_samples){
+			m_dropped_samples = m_ahrs.droppedSamples();
+			ROS_WARN("%zu AHRS samples dropped, update() isn't keeping up", m_dropped_samples);
+		}
+		return;
+	}
+
 	ROS_DEBUG("Beginning to read data");
 	//sit and wait for an update
+	AHRS::AHRSSample sample;
 	try{
-		m_ahrs_data = m_ahrs.pollAHRSData();
+		sample = m_ahrs.pollAHRSSample();
 	}catch(AHRSException& ex){
 		//every so often an exception gets thrown and hangs on my vm
 		//This might be solved by running ROS on actual hardware
 		ROS_WARN("%s", ex.what());
 		return;
 	}
+	m_ahrs_data = sample.data;
+
+	publish(sample);
+}
+
+void AHRSQuboNode::publish(const AHRS::AHRSSample &sample){
+	const AHRS::AHRSData &data = sample.data;
+
+	//construct the imu data message, stamped with when the AHRS took the
+	//reading so it lines up with the DVL and depth
+	m_msg.header.stamp.fromNSec(chrono::duration_cast<chrono::nanoseconds>(sample.sampled.time_since_epoch()).count());
+	m_msg.header.seq++;
+
+	m_msg.orientation.x = data.quaternion[0];
+	m_msg.orientation.y = data.quaternion[1];
+	m_msg.orientation.z = data.quaternion[2];
+	m_msg.orientation.w = data.quaternion[3];
 
-	//construct the imu data message
-	/// /	ROS_ERROR("Data has been read");
-	// m_msg.header.stamp = ros::Time::now();
-	// m_msg.header.seq = ++id;
-	// m_msg.header.frame_id = "ahrs";
+	m_msg.angular_velocity.x = data.gyroX;
+	m_msg.angular_velocity.y = data.gyroY;
+	m_msg.angular_velocity.z = data.gyroZ;
 
-	// m_msg.orientation.x = m_ahrs_data.quaternion[0];
-	// m_msg.orientation.y = m_ahrs_data.quaternion[1];
-	// m_msg.orientation.z = m_ahrs_data.quaternion[2];
-	// m_msg.orientation.w = m_ahrs_data.quaternion[3];
-   
+	m_msg.linear_acceleration.x = data.accelX * G_IN_MS2;
+	m_msg.linear_acceleration.y = data.accelY * G_IN_MS2;
+	m_msg.linear_acceleration.z = data.accelZ * G_IN_MS2;
+
+	m_imu_pub.publish(m_msg);
+
+	if(!m_publish_euler){
+		return;
+	}
 
 	//this is a little clunky, but it's the best way I could find to convert from a quaternion to Euler Angles
-	tf::Quaternion q(m_ahrs_data.quaternion[0], m_ahrs_data.quaternion[1], m_ahrs_data.quaternion[2], m_ahrs_data.quaternion[3]);
+	tf::Quaternion q(data.quaternion[0], data.quaternion[1], data.quaternion[2], data.quaternion[3]);
 	tf::Matrix3x3 m(q);
 	
 	m.getRPY(m_roll_msg.data, m_pitch_msg.data, m_yaw_msg.data); //roll pitch and yaw are populated
 
-	ROS_ERROR("%f, %f, %f", m_roll_msg.data, m_pitch_msg.data, m_yaw_msg.data);
+	ROS_DEBUG("%f, %f, %f", m_roll_msg.data, m_pitch_msg.data, m_yaw_msg.data);
 
 	m_roll_pub.publish(m_roll_msg);
 	m_pitch_pub.publish(m_pitch_msg);
 	m_yaw_pub.publish(m_yaw_msg);
-	
-
-	
-	// the -1's imply we don't know the covariance
-	// m_msg.orientation_covariance[0] = -1;
-
-	// m_msg.angular_velocity.x = m_ahrs_data.gyroX;
-	// m_msg.angular_velocity.y = m_ahrs_data.gyroY;
-	// m_msg.angular_velocity.z = m_ahrs_data.gyroZ;
-	// m_msg.angular_velocity_covariance[0] = -1;
-
-	// m_msg.linear_acceleration.x = m_ahrs_data.accelX;
-	// m_msg.linear_acceleration.y = m_ahrs_data.accelY;
-	// m_msg.linear_acceleration.z = m_ahrs_data.accelZ;
-	// m_msg.linear_acceleration_covariance[0] = -1;
-
-	// //ahrsPub.publish(_msg);
-    
 }
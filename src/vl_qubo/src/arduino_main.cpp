@@ -0,0 +1,33 @@
+#include "arduino_node.h"
+
+/**
+ * main method for the arduino node
+ * Sends thruster commands at a fixed rate, telemetry is published from the
+ * node's own reader thread as it arrives
+ * @param  argc number of cmd-line arguments found
+ * @param  argv char* array of the cmd-line arguments
+ * @return      an exit code
+ */
+int main(int argc, char** argv){
+	ros::init(argc, argv, "arduino_node");
+
+	ros::NodeHandle nh;
+	ros::NodeHandle private_nh("~");
+
+	std::string device;
+	int telemetry_rate, command_rate;
+	private_nh.param<std::string>("device", device, "/dev/ttyACM4");
+	private_nh.param("telemetry_rate", telemetry_rate, 50);
+	private_nh.param("command_rate", command_rate, 10);
+
+	ArduinoQuboNode node(nh, device, telemetry_rate);
+
+	ros::Rate rate(command_rate);
+	while(ros::ok()){
+		ros::spinOnce();
+		node.update();
+		rate.sleep();
+	}
+
+	return 0;
+}
@@ -0,0 +1,248 @@
+#include "arduino_node.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+/**
+ * See the header file for actual function/object descriptions
+ */
+ArduinoQuboNode::ArduinoQuboNode(ros::NodeHandle n, std::string device, int telemetry_rate)
+	: device(device), telemetry_rate(telemetry_rate), fd(-1), running(true),
+	  thruster_cmds(NUM_THRUSTERS, thrusterMap(0)) {
+
+	//I can't think of a situation where we want to change the namespace but I guess you never know
+	std::string qubo_namespace = "/qubo/";
+
+	telemetry_pub = n.advertise<ram_msgs::ArduinoTelemetry>(qubo_namespace + "arduino_telemetry", 100);
+	depth_pub = n.advertise<std_msgs::Float64>(qubo_namespace + "depth", 10);
+	status_pub = n.advertise<std_msgs::String>(qubo_namespace + "status", 10);
+
+	thruster_sub = n.subscribe(qubo_namespace + "thruster_cmds", 10, &ArduinoQuboNode::thrusterCallback, this);
+	shutdown_srv = n.advertiseService(qubo_namespace + "shutdown_thrusters", &ArduinoQuboNode::shutdownThrusters, this);
+
+	reader = std::thread(&ArduinoQuboNode::readLoop, this);
+}
+
+ArduinoQuboNode::~ArduinoQuboNode() {
+	running = false;
+	if (reader.joinable()) {
+		reader.join();
+	}
+	closeDevice();
+}
+
+void ArduinoQuboNode::update() {
+	uint8_t payload[2 * NUM_THRUSTERS];
+
+	{
+		std::lock_guard<std::mutex> lock(cmd_mutex);
+		for (int i = 0; i < NUM_THRUSTERS; i++) {
+			uint16_t pulse = thruster_cmds[i];
+			//once shut down they're held at neutral, so the ESCs keep a signal and stay armed
+			if (shutdown_flag) {
+				pulse = THRUSTER_NEUTRAL;
+			}
+			framePutU16(&payload[2 * i], pulse);
+		}
+	}
+
+	sendFrame(FRAME_THRUSTER, payload);
+}
+
+void ArduinoQuboNode::openDevice() {
+	struct termios termcfg;
+
+	int new_fd = open(device.c_str(), O_RDWR | O_NOCTTY);
+	if (new_fd < 0) {
+		return;
+	}
+
+	if (tcgetattr(new_fd, &termcfg) || cfsetospeed(&termcfg, BAUD) || cfsetispeed(&termcfg, BAUD)) {
+		ROS_ERROR("Unable to configure %s", device.c_str());
+		close(new_fd);
+		return;
+	}
+
+	// Set raw I/O rules to read and write the data purely.
+	cfmakeraw(&termcfg);
+
+	// readLoop polls before reading, so reads only need to return whatever
+	// has arrived
+	termcfg.c_cc[VTIME] = 0;
+	termcfg.c_cc[VMIN] = 0;
+
+	if (tcsetattr(new_fd, TCSANOW, &termcfg)) {
+		ROS_ERROR("Unable to configure %s", device.c_str());
+		close(new_fd);
+		return;
+	}
+
+	fd = new_fd;
+	have_offset = false;
+	ROS_INFO("Connected to the arduino on %s", device.c_str());
+
+	//opening the port resets the arduino, setup() has to finish before it listens
+	ros::Duration(2.0).sleep();
+
+	uint8_t rate = std::min(std::max(telemetry_rate, 0), 255);
+	sendFrame(FRAME_TELEMETRY_RATE, &rate);
+}
+
+void ArduinoQuboNode::closeDevice() {
+	std::lock_guard<std::mutex> lock(write_mutex);
+	if (fd >= 0) {
+		close(fd);
+	}
+	fd = -1;
+}
+
+void ArduinoQuboNode::readLoop() {
+	FrameDecoder decoder;
+	uint8_t buffer[256];
+
+	while (running && ros::ok()) {
+		if (fd < 0) {
+			openDevice();
+			if (fd < 0) {
+				ros::Duration(0.25).sleep();
+			}
+			continue;
+		}
+
+		//wake every 0.1s so the thread can notice when it's time to stop
+		struct pollfd pfd = {fd, POLLIN, 0};
+		int ready = poll(&pfd, 1, 100);
+		if (ready == 0 || (ready < 0 && errno == EINTR)) {
+			continue;
+		}
+
+		ssize_t n = -1;
+		if (ready > 0 && !(pfd.revents & (POLLHUP | POLLERR | POLLNVAL))) {
+			n = read(fd, buffer, sizeof(buffer));
+		}
+		//everything in this read landed by now, which only makes the stamps later
+		ros::Time received = ros::Time::now();
+
+		//a hung up USB serial port polls readable and then reads nothing
+		if (n <= 0) {
+			ROS_ERROR("Lost the arduino on %s", device.c_str());
+			closeDevice();
+			decoder = FrameDecoder();
+			continue;
+		}
+
+		for (ssize_t i = 0; i < n; i++) {
+			if (decoder.push(buffer[i])) {
+				handleFrame(decoder, received);
+			}
+			else if (uint8_t error = decoder.error()) {
+				ROS_WARN("Dropped a frame from the arduino, error %d", error);
+			}
+		}
+	}
+}
+
+void ArduinoQuboNode::handleFrame(const FrameDecoder &decoder, ros::Time received) {
+	switch (decoder.type) {
+	case FRAME_TELEMETRY: {
+		ram_msgs::ArduinoTelemetry msg;
+		const uint8_t *p = decoder.payload;
+
+		msg.arduino_time = frameGetU32(&p[FRAME_TELEMETRY_TIME]);
+		msg.header.stamp = correctStamp(msg.arduino_time, received, FRAME_TELEMETRY_LENGTH + FRAME_OVERHEAD);
+		msg.seq = decoder.seq;
+		msg.depth = frameGetFloat(&p[FRAME_TELEMETRY_DEPTH]);
+		msg.temperature = frameGetFloat(&p[FRAME_TELEMETRY_TEMP]);
+		msg.bus_voltage = frameGetFloat(&p[FRAME_TELEMETRY_VOLTAGE]);
+		msg.current = frameGetFloat(&p[FRAME_TELEMETRY_CURRENT]);
+		msg.status = p[FRAME_TELEMETRY_STATUS];
+		for (int i = 0; i < NUM_THRUSTERS; i++) {
+			msg.thruster_pulses[i] = frameGetU16(&p[FRAME_TELEMETRY_PULSES + 2 * i]);
+		}
+		telemetry_pub.publish(msg);
+
+		std_msgs::Float64 depth;
+		depth.data = msg.depth;
+		depth_pub.publish(depth);
+
+		static const char *status_names[] = {"OK", "TIMEOUT", "OVERHEAT", "OVERHEAT WARNING"};
+		if (msg.status < sizeof(status_names) / sizeof(status_names[0])) {
+			std_msgs::String status;
+			status.data = status_names[msg.status];
+			status_pub.publish(status);
+		}
+		break;
+	}
+	case FRAME_THRUSTER_REPLY:
+		if (frameGetU16(decoder.payload) == FRAME_THRUSTER_INVALID) {
+			ROS_WARN_THROTTLE(1, "Arduino rejected a thruster command");
+		}
+		break;
+	case FRAME_TELEMETRY_RATE_REPLY:
+		ROS_INFO("Arduino telemetry at %d Hz", decoder.payload[0]);
+		break;
+	case FRAME_ERROR:
+		ROS_WARN("Arduino couldn't decode a frame, error %d", decoder.payload[0]);
+		break;
+	default:
+		break;
+	}
+}
+
+ros::Time ArduinoQuboNode::correctStamp(uint32_t arduino_ms, ros::Time received, size_t frame_size) {
+	if (arduino_ms < last_arduino_ms) {
+		arduino_ms_high += 1ULL << 32;
+	}
+	last_arduino_ms = arduino_ms;
+	double sent = (arduino_ms_high + arduino_ms) / 1000.0;
+
+	//the last byte arrived a frame's worth of serial time after the first
+	double offset = received.toSec() - (double)frame_size * BITS_PER_BYTE / BAUD_RATE - sent;
+
+	if (!have_offset || offset < clock_offset) {
+		clock_offset = offset;
+		have_offset = true;
+	}
+	else {
+		clock_offset = std::min(offset, clock_offset + (received - last_offset_update).toSec() * MAX_CLOCK_DRIFT);
+	}
+	last_offset_update = received;
+
+	return ros::Time(sent + clock_offset);
+}
+
+void ArduinoQuboNode::sendFrame(uint8_t type, const uint8_t *payload) {
+	uint8_t frame[FRAME_MAX_SIZE];
+
+	std::lock_guard<std::mutex> lock(write_mutex);
+	if (fd < 0) {
+		return;
+	}
+
+	size_t size = frameEncode(type, seq++, payload, frame);
+	if (write(fd, frame, size) != (ssize_t)size) {
+		ROS_WARN_THROTTLE(1, "Unable to write to the arduino");
+	}
+}
+
+uint16_t ArduinoQuboNode::thrusterMap(double control) {
+	double ratio = (PULSE_MAX - PULSE_MIN) / (CONTROL_MAX - CONTROL_MIN);
+	return (uint16_t)std::lround((control - CONTROL_MIN) * ratio + PULSE_MIN);
+}
+
+void ArduinoQuboNode::thrusterCallback(const std_msgs::Float64MultiArray::ConstPtr &msg) {
+	std::lock_guard<std::mutex> lock(cmd_mutex);
+	for (int i = 0; i < NUM_THRUSTERS && i < (int)msg->data.size(); i++) {
+		thruster_cmds[i] = thrusterMap(msg->data[i]);
+	}
+}
+
+bool ArduinoQuboNode::shutdownThrusters(std_srvs::Empty::Request &req, std_srvs::Empty::Response &res) {
+	std::lock_guard<std::mutex> lock(cmd_mutex);
+	shutdown_flag = true;
+	return true;
+}
@@ -3,24 +3,47 @@
 #sgillen - this program serves as a node that offers the arduino up to the rest of the ros system.
 
 
-# the packets send to the arduino should be in the following format: p<data>!
-# p tells the arduino which command to execute, the data that follows will depend on which command this is
-# in general the , character is used as a delimiter, and the ! is used to mark the end of the message
+# the arduino talks in binary frames, both ways, see embedded/arduino/Frame.h for the details
+# sync | type | payload | seq | crc16
+# the payload length is fixed by the type, and replies carry the seq of the request
 
 # commands so far
-# t,x0,x1,x2,x3,x4,x5,x6,x7!    - this sets all 8 thruster values
-# d!                            - this requests the most recent depth value from the arduino (TODO)
+# t + 8 x uint16 pulse widths   - this sets all 8 thruster values, replies T
+# d                             - this requests the most recent depth value from the arduino, replies D
+# c                             - temperature, replies C
+# s                             - startup voltage, replies S
 
-import serial, time, sys, select
+import serial, time, sys, select, struct
 import rospy
 from std_msgs.msg import Int64, Float64, String, Float64MultiArray
 from std_srvs.srv import Empty, EmptyResponse
 
-THRUSTER_INVALID = '65535'
-STATUS_OK = '0'
-STATUS_TIMEOUT = '1'
-STATUS_OVERHEAT = '2'
-STATUS_OVERHEAT_WARNING = '3'
+THRUSTER_INVALID = 0xFFFF
+STATUS_OK = 0
+STATUS_TIMEOUT = 1
+STATUS_OVERHEAT = 2
+STATUS_OVERHEAT_WARNING = 3
+
+FRAME_SYNC = 0xA5
+# type -> struct format of the payload, has to match frameLength() in Frame.cpp
+FRAME_FORMATS = {
+    't': '<8H',
+    'd': '',
+    'c': '',
+    's': '',
+    'T': '<HB',
+    'D': '<f',
+    'C': '<f',
+    'S': '<H',
+    'E': '<B',
+    'r': '<B',
+    'R': '<B',
+    # streamed, see FRAME_TELEMETRY in Frame.h
+    'M': '<I4fB8H',
+}
+
+# how long to wait for the reply to a request, in seconds
+REPLY_TIMEOUT = 0.05
 
 V_START = 2.0
 
@@ -41,6 +64,78 @@ depth_cmd = 0
 surge_cmd = 0
 sway_cmd  = 0
 
+# CRC-16/CCITT, same as frameCRC() in Frame.cpp
+def frame_crc(data):
+    crc = 0xFFFF
+    for byte in bytearray(data):
+        crc ^= byte << 8
+        for _ in range(8):
+            if crc & 0x8000:
+                crc = ((crc << 1) ^ 0x1021) & 0xFFFF
+            else:
+                crc = (crc << 1) & 0xFFFF
+    return crc
+
+def encode_frame(frame_type, seq, *values):
+    body = frame_type + struct.pack(FRAME_FORMATS[frame_type], *values) + chr(seq)
+    return chr(FRAME_SYNC) + body + struct.pack('<H', frame_crc(body))
+
+class FrameDecoder(object):
+    """reassembles frames from the serial stream, skipping anything it can't make sense of"""
+    def __init__(self):
+        self.buf = bytearray()
+
+    # returns a list of (type, seq, values) for every complete, good frame in data
+    def push(self, data):
+        self.buf.extend(bytearray(data))
+        frames = []
+        while True:
+            start = self.buf.find(chr(FRAME_SYNC))
+            if start < 0:
+                del self.buf[:]
+                return frames
+            del self.buf[:start]
+            if len(self.buf) < 2:
+                return frames
+
+            frame_type = chr(self.buf[1])
+            if frame_type not in FRAME_FORMATS:
+                del self.buf[:1]
+                continue
+
+            length = struct.calcsize(FRAME_FORMATS[frame_type]) if FRAME_FORMATS[frame_type] else 0
+            if len(self.buf) < length + 5:
+                return frames
+
+            body = bytes(self.buf[1:length + 3])
+            crc, = struct.unpack('<H', bytes(self.buf[length + 3:length + 5]))
+            if crc != frame_crc(body):
+                del self.buf[:1]
+                continue
+
+            values = struct.unpack(FRAME_FORMATS[frame_type], body[1:-1]) if length else ()
+            frames.append((frame_type, ord(body[-1]), values))
+            del self.buf[:length + 5]
+
+decoder = FrameDecoder()
+seq = 0
+
+# sends a request and waits for the reply with its seq, returns the reply's values or None
+def request(frame_type, reply_type, *values):
+    global seq
+    seq = (seq + 1) % 256
+    ser.write(encode_frame(frame_type, seq, *values))
+
+    deadline = time.time() + REPLY_TIMEOUT
+    while time.time() < deadline:
+        for (got_type, got_seq, got_values) in decoder.push(ser.read(ser.inWaiting())):
+            if got_type == reply_type and got_seq == seq:
+                return got_values
+            elif got_type == 'E':
+                print('Arduino frame error {0}'.format(got_values[0]))
+        time.sleep(0.001)
+    return None
+
 # Maps values from control_domain to arduino_domain
 def thruster_map(control_in):
     ratio = (arduino_domain[1] - arduino_domain[0]) / (control_domain[1] - control_domain[0])
@@ -57,24 +152,16 @@ def read_cmd_stdin():
 
 
 #sends an array of ints to the thrusters using the agreed upon protocol
-#the actual over the wire value is t,x1,x2,x3,x4,x5,x6,x7,x8!
+#returns the (last thruster value, status) the arduino replied with, or None
 def send_thruster_cmds(thruster_cmds):
-    cmd_str = "t"
-    for cmd in thruster_cmds:
-        cmd_str += (",")
-        cmd_str += (str(cmd))
-
-    cmd_str += ("!")
-    ser.write(cmd_str)
-    #print "arduino return", ser.readline()
-    ##TODO parse return value
+    return request('t', 'T', *thruster_cmds)
 
-# requests depth from arduino, and waits until it receives it
+# requests depth from arduino, and waits for it, None if it doesn't come
 def get_depth():
-    ser.write('d!')
-    # blocks forever until receives a newline
-    depth = ser.readline()
-    return depth
+    reply = request('d', 'D')
+    if reply is None:
+        return None
+    return reply[0]
 
 
 ##------------------------------------------------------------------------------
@@ -118,8 +205,8 @@ def thruster_callback(msg):
 # main
 if __name__ == '__main__':
 
-    # map for messages
-    msg = {'t': '', 'd': '', 's': ''}
+    # latest value of each reply
+    msg = {'t': None, 'd': None, 's': None}
 
     #!!! this also restarts the arduino! (apparently)
 
@@ -165,23 +252,20 @@ if __name__ == '__main__':
     # zero the thrusters
     send_thruster_cmds([0] * num_thrusters)
     '''
-    zero = ser.readline().strip()
-
     while startup_voltage <= V_START:
-        ser.write('s!')
-        startup_voltage = float(ser.readline())
+        reply = request('s', 'S')
+        if reply is not None:
+            startup_voltage = float(reply[0])
         time.sleep(0.1)
     '''
 
 
     while not rospy.is_shutdown():
 
-        depth = get_depth() #TODO
-        if depth == '':
-            pass
-        else:
-            msg[depth[0]] = depth[1:]
-            depth_pub.publish(float(msg[depth[0]]))
+        depth = get_depth()
+        if depth is not None:
+            msg['d'] = depth
+            depth_pub.publish(depth)
 
 
         #thruster layout found here https://docs.google.com/presentation/d/1mApi5nQUcGGsAsevM-5AlKPS6-FG0kfG9tn8nH2BauY/edit#slide=id.g1d529f9e65_0_3
@@ -202,24 +286,17 @@ if __name__ == '__main__':
 
         # Build the thruster message to send
         if shutdown_flag:
-            send_thruster_cmds([0] * num_thrusters)
+            reply = send_thruster_cmds([0] * num_thrusters)
         else:
-            send_thruster_cmds(thruster_cmds)
+            reply = send_thruster_cmds(thruster_cmds)
         # print "hello"
 
-        #ser.write('c!')
-        #temp = ser.readline()
+        #temp = request('c', 'C')
         #print(temp)
 
-        # get thruster cmd
-        x = ser.readline().strip()
-        if x != '':
-            msg[x[0]] = x[1:]
-        # get status
-        x = ser.readline().strip()
-        if x != '':
-            msg[x[0]] = x[1:]
-        #status = ser.readline().strip()
+        # thruster cmd and status come back together
+        if reply is not None:
+            msg['t'], msg['s'] = reply
 
         print(thruster_cmds)
         print('Thruster: {0}, status: {1}, depth: {2}'.format(msg['t'], msg['s'], msg['d']))
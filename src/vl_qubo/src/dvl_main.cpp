@@ -24,9 +24,14 @@ int main(int argc, char** argv){
 
 	//create a shared_ptr to the NodeHandle
 	ros::NodeHandle nh;
+	ros::NodeHandle private_nh("~");
+
+	//navigation, navigation_sensors or full, see DvlQuboNode
+	std::string output;
+	private_nh.param<std::string>("output", output, "navigation");
 
 	//pointer to the node
-	DvlQuboNode node0(nh, 10, "DVL", argv[1]);
+	DvlQuboNode node0(nh, 10, "DVL", argv[1], output);
 
 	
 	//read and sleep
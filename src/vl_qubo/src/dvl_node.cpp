@@ -5,9 +5,12 @@
 /**
  * See the header file for actual function/object descriptions
  */
-DvlQuboNode::DvlQuboNode(ros::NodeHandle n, int rate, std::string name, std::string device){
+DvlQuboNode::DvlQuboNode(ros::NodeHandle n, int rate, std::string name, std::string device,
+                         std::string output){
 
 	this->name = name;
+	this->output_mode = output;
+	rate_start = ros::Time::now();
 
 	//inits a publisher on this node
 	dvlPub = n.advertise<ram_msgs::DVL_qubo>("qubo/" + name, 1000);
@@ -96,6 +99,15 @@ void DvlQuboNode::update(){
 		return;
 	}
 
+	//the DVL pings slower in deeper water, so say what we're really getting
+	ensembles++;
+	double elapsed = (ros::Time::now() - rate_start).toSec();
+	if(elapsed >= RATE_REPORT_PERIOD){
+		ROS_INFO("DVL at %.1f ensembles per second", ensembles / elapsed);
+		ensembles = 0;
+		rate_start = ros::Time::now();
+	}
+
 	//begin constructing the ros msg
 	//Currently assuming the data is formatted similar to the
 	//messages given to us by ROS - might be wrong
@@ -139,6 +151,21 @@ void DvlQuboNode::update(){
         default:
             ROS_ERROR("Invalid BEAM_COORD");
 	}
+
+	//average over the beams that found the bottom, the binary formats give
+	//cm per beam where PD6 gave one range in m
+	double range = 0;
+	int beams = 0;
+	for(int i = 0; i < 4; i++){
+		if(sensor_data.bottom_range[i]){
+			range += sensor_data.bottom_range[i];
+			beams++;
+		}
+	}
+	if(beams){
+		msg.bd_range = range / beams / 100.0;
+	}
+
 	dvlPub.publish(msg);
 }
 
@@ -156,19 +183,31 @@ void DvlQuboNode::setup_dvl(){
     config.serial_output=true;
     config.turnkey=true;
     config.recorder_enable=false;
-    output.output_type = DVL::DataOutput::ALL_DATA;
-    //output.output_type = DVL::DataOutput::PARTIAL_DATA;
-    //output.output_type = DVL::DataOutput::MINIMUM_DATA;
-    //output.output_type = DVL::DataOutput::TEXT_DATA;
-    output.profile_output[DVL::VELOCITY] = true,
-    output.profile_output[DVL::CORRELATION] = true,
-    output.profile_output[DVL::ECHO_INTENSITY] = true,
-    output.profile_output[DVL::PERCENT_GOOD] = true,
-    output.profile_output[DVL::STATUS] = true;
     dvl->loadUserSettings();
-    dvl->enableMeasurement();
     dvl->setSystemConfiguration(config);
-    dvl->setDataTransferConfiguration(output);
-    ROS_DEBUG("DVL succsesfully setup");
+
+    if(output_mode == "navigation" || output_mode == "navigation_sensors"){
+        //only the bottom track, in the smallest format that has it
+        DVL::OutputProfile profile = dvl->setNavigationOutput(output_mode == "navigation_sensors");
+        ROS_INFO("DVL sending %s, %zu bytes per ensemble, the link can carry %.0f per second",
+                 profile.output_type == DVL::DataOutput::PARTIAL_DATA ? "PD5" : "PD4",
+                 profile.ensemble_bytes, profile.max_ensemble_rate);
+    }else{
+        if(output_mode != "full"){
+            ROS_WARN("Unknown DVL output \"%s\", sending everything", output_mode.c_str());
+        }
+        output.output_type = DVL::DataOutput::ALL_DATA;
+        //output.output_type = DVL::DataOutput::TEXT_DATA;
+        output.profile_output[DVL::VELOCITY] = true,
+        output.profile_output[DVL::CORRELATION] = true,
+        output.profile_output[DVL::ECHO_INTENSITY] = true,
+        output.profile_output[DVL::PERCENT_GOOD] = true,
+        output.profile_output[DVL::STATUS] = true;
+        dvl->setDataTransferConfiguration(output);
+    }
     ROS_DEBUG("DVL INFO: \n%s", dvl->getSystemInfo().c_str());
+
+    //everything has to be set before it starts pinging
+    dvl->enableMeasurement();
+    ROS_DEBUG("DVL succsesfully setup");
 }
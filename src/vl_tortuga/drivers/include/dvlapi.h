@@ -27,6 +27,15 @@ extern "C" {
 #define ERR_NOSYNC            0x0001
 #define ERR_TOOBIG            0x0002
 #define ERR_CHKSUM            0x0006
+#define ERR_NOFRAME           0x0008
+#define ERR_IO                0x0010
+#define ERR_TOOSMALL          0x0020
+
+/* A PD4 frame is 47 bytes, anything claiming more than this is noise */
+#define DVL_MAX_FRAME 512
+
+/* Bytes the reader buffers, a power of two */
+#define DVL_RING_SIZE 2048
 
 /* This will hold *ALL* of the data from the DVL */
 /* It should NOT be passed every time the sensor is polled */
@@ -98,6 +107,26 @@ typedef struct _RawDVLData
     CompleteDVLPacket *privDbgInf;
 } RawDVLData;
 
+/* Reads the port in bulk into a ring and finds frames in memory,
+   instead of a read() per byte */
+typedef struct _DVLReader
+{
+    int fd;
+
+    unsigned char ring[DVL_RING_SIZE];
+    /* Free running, the ring holds head - tail bytes from ring[tail % size] */
+    unsigned int head;
+    unsigned int tail;
+
+    /* Everything from the last good frame, RawDVLData points here */
+    CompleteDVLPacket packet;
+
+    unsigned long frames;       /* Good frames decoded */
+    unsigned long badFrames;    /* Bad checksums and impossible sizes */
+    unsigned long lostSyncs;    /* Times junk came before a sync sequence */
+    unsigned long skippedBytes; /* Bytes thrown away looking for sync */
+} DVLReader;
+
 /** Opens a serial channel to the imu using the given devices
  *
  *  @param  devName  Device filename
@@ -106,11 +135,17 @@ typedef struct _RawDVLData
  */
 int openDVL(const char *devName);
 
-/** Read the latest DVL measurements into the given structure
+/** Sets up a reader on a device returned by openDVL */
+void initDVLReader(DVLReader *reader, int fd);
+
+/** Decodes the next frame the DVL has sent, without waiting for one.
+ *  Call it until it returns ERR_NOFRAME whenever the fd is readable.
  *
- *  @param fd  The device file returned by openDVL
+ *  @return 0 with the frame in dvl, ERR_NOFRAME if there is no whole frame
+ *          yet, ERR_CHKSUM, ERR_TOOSMALL or ERR_TOOBIG if a bad frame was
+ *          dropped, or ERR_IO if the port failed
  */
-int readDVLData(int fd, RawDVLData *dvl);
+int readDVLData(DVLReader *reader, RawDVLData *dvl);
 
 // If we are compiling as C++ code we need to use extern "C" linkage
 #ifdef __cplusplus
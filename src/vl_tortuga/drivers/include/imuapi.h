@@ -38,6 +38,29 @@ typedef struct _RawIMUData
     int checksumValid;
 } RawIMUData;
 
+/* Bytes in a frame after the four 0xFF sync bytes */
+#define IMU_FRAME_SIZE 34
+
+/* Bytes the reader buffers, a power of two, room for a few dozen frames */
+#define IMU_RING_SIZE 2048
+
+/** Buffered frame reader. Reads the port in bulk into a ring and finds
+ *  frames in memory, instead of a read() per byte */
+typedef struct _IMUReader
+{
+    int fd;
+
+    unsigned char ring[IMU_RING_SIZE];
+    /* Free running, the ring holds head - tail bytes from ring[tail % size] */
+    unsigned int head;
+    unsigned int tail;
+
+    unsigned long frames;       /* Good frames returned */
+    unsigned long badFrames;    /* Frames that failed their checksum */
+    unsigned long lostSyncs;    /* Times junk came before a sync sequence */
+    unsigned long skippedBytes; /* Bytes thrown away looking for sync */
+} IMUReader;
+
 /** Opens a serial channel to the imu using the given devices
  *
  *  @param  devName  Device filename
@@ -52,6 +75,17 @@ int openIMU(const char * devName);
  */
 int readIMUData(int fd, RawIMUData * imu);
 
+/** Sets up a reader on a device returned by openIMU */
+void initIMUReader(IMUReader * reader, int fd);
+
+/** Waits for the next frame with a good checksum
+ *
+ *  @param timeoutMs  How long to wait, 0 only looks at what has arrived
+ *
+ *  @return 1 with the frame in imu, 0 on timeout, -1 if the port failed
+ */
+int readIMUFrame(IMUReader * reader, RawIMUData * imu, int timeoutMs);
+
 // If we are compiling as C++ code we need to use extern "C" linkage
 #ifdef __cplusplus
 } // extern "C"
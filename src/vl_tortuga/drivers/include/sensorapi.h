@@ -14,6 +14,10 @@
 
 #define MAX_SYNC_ATTEMPTS 20
 #define NUM_TEMP_SENSORS 7
+#define NUM_THRUSTERS 6
+
+/* What each motor controller answers to a speed it took */
+#define SPEED_RESPONSE_ACK 0x06
 
 #define SENSORAPI_R5
 
@@ -25,15 +29,26 @@
 #define LCD_BL_ON     1
 #define LCD_BL_FLASH  2
 
+/* LCD size, every write replaces a whole line */
+#define LCD_LINES     2
+#define LCD_WIDTH     16
+
 /* Control command return values */
 #define SB_OK        0
 #define SB_UPDATEDONE 1
+#define SB_NOTDUE    2
+#define SB_INPROGRESS 3
 #define SB_IOERROR  -4
 #define SB_BADCC    -3
 #define SB_HWFAIL   -2
 #define SB_ERROR    -1
 
 
+/* Longest command and reply the non-blocking primitives carry,
+   displayText's 19 bytes is the longest command */
+#define SB_MAX_COMMAND 20
+#define SB_MAX_REPLY   64
+
 /* Inputs to the thruster safety command */
 #define CMD_THRUSTER1_OFF     0
 #define CMD_THRUSTER2_OFF     1
@@ -195,6 +210,9 @@ enum partialUpdateType_
     BATTERY_USED,
     SONAR,
     END_OF_UPDATES,
+    /* Not part of the partialRead cycle, only the poll schedule reads it */
+    DEPTH,
+    NUM_POLL_ITEMS
 };
 
 /** Information about the vehicles power state */
@@ -276,6 +294,106 @@ struct boardInfo
 
     /** The latest data from the */
     struct sonarData sonar;
+
+    /** Depth sensor reading, 0-1023. Only the poll schedule fills this in */
+    int depth;
+};
+
+/** One item on the poll schedule, see scheduledRead */
+struct pollItem
+{
+    /** How often to read it, in Hz. 0 leaves it off the schedule */
+    double targetRate;
+    /** When it is next due, in seconds on the monotonic clock */
+    double nextDue;
+    /** Advances by 1/targetRate per read. When more is due than the link
+     *  can carry, the lowest goes first, so each item gets a share of the
+     *  link in proportion to its rate */
+    double pass;
+
+    /** Reads, failed reads and time spent reading since the stats were reset */
+    unsigned int reads;
+    unsigned int errors;
+    double busyTime;
+};
+
+/** Which items to read and how often, in place of the partialRead cycle */
+struct pollSchedule
+{
+    /** Indexed by partialUpdateType_, NO_UPDATE and END_OF_UPDATES are unused */
+    struct pollItem items[NUM_POLL_ITEMS];
+
+    /** Fraction of the link the schedule may use, (0, 1]. Anything less
+     *  leaves gaps between reads for commands like setSpeeds */
+    double linkBudget;
+    /** No read starts before this, to keep within linkBudget */
+    double linkFreeAt;
+
+    /** What the last call to scheduledRead read, or NO_UPDATE */
+    enum partialUpdateType_ lastItem;
+    /** When the stats were last reset */
+    double statsStart;
+};
+
+/** A command to the board and the reply to it, for the non-blocking
+ *  primitives. The command goes out from tx, the reply is parsed into rx a
+ *  byte at a time as it arrives, so neither side ever waits on the port */
+struct sbCommand
+{
+    /** Encoded command, checksum included */
+    unsigned char tx[SB_MAX_COMMAND];
+    int txLen;
+    int txSent;
+
+    /** Reply code expected back, 0xBC for commands answered with a bare ack */
+    unsigned char replyCode;
+    /** Bytes the reply carries between the reply code and its checksum */
+    int replyLen;
+
+    /** The reply so far, starting with the reply code. Once the command is
+     *  done the payload starts at rx[1] */
+    unsigned char rx[SB_MAX_REPLY];
+    int rxLen;
+
+    /** Monotonic time, in seconds, when the command gives up */
+    double deadline;
+    /** SB_INPROGRESS until the reply is in or the deadline passes */
+    int result;
+};
+
+/** What the LCD shows and what it should show, so an update only sends the
+ *  lines that differ. Lines are padded to LCD_WIDTH with spaces, as the
+ *  board shows them */
+struct lcdDisplay
+{
+    char current[LCD_LINES][LCD_WIDTH];
+    char desired[LCD_LINES][LCD_WIDTH];
+    /** 0 until we know what a line shows, so the first update sends it */
+    int known[LCD_LINES];
+    /** Which line lcdUpdate looks at first, so both get a turn */
+    int nextLine;
+
+    /** Bytes per second the display may use, 0 for no limit */
+    double byteBudget;
+    /** No line goes out before this, to keep within byteBudget */
+    double linkFreeAt;
+
+    /** Lines written since the display was set up */
+    unsigned int linesSent;
+};
+
+/** What an item on the poll schedule has managed since the stats were reset */
+struct pollStats
+{
+    /** Requested and achieved (successful) reads per second */
+    double targetRate;
+    double achievedRate;
+    /** Failed reads per second */
+    double errorRate;
+    /** Average time one read takes, in seconds */
+    double readTime;
+    /** Fraction of the time the link spent reading this item */
+    double linkShare;
 };
 
 
@@ -286,10 +404,116 @@ struct boardInfo
  */
 int partialRead(int fd, struct boardInfo * info);
 
+/** Sets up an empty schedule, nothing is read until given a rate.
+ *  The whole link is available until linkBudget is changed */
+void initPollSchedule(struct pollSchedule * sched);
+
+/** Sets how often an item is read, in Hz, 0 takes it off the schedule.
+ *  e.g. setPollRate(&sched, DEPTH, 50) or setPollRate(&sched, TEMP, 1)
+ *  Returns: SB_OK, or SB_ERROR for an unknown item or a negative rate
+ */
+int setPollRate(struct pollSchedule * sched, enum partialUpdateType_ item,
+                double rate);
+
+/* Reads the next item on the schedule into info, if anything is due.
+ * Of the items that are due, the one furthest behind its share goes first.
+ * Returns: SB_OK on success, sched->lastItem says what was read
+ *          SB_NOTDUE if nothing is due yet, see pollWaitTime
+ *          SB_ERROR, SB_IOERROR, SB_BADCC, SB_HWFAIL on failure
+ */
+int scheduledRead(int fd, struct pollSchedule * sched, struct boardInfo * info);
+
+/** Seconds until scheduledRead has something to do, 0 if it already has,
+ *  or -1 if nothing is on the schedule */
+double pollWaitTime(const struct pollSchedule * sched);
+
+/** Fills in how an item has done since the stats were last reset */
+void getPollStats(const struct pollSchedule * sched,
+                  enum partialUpdateType_ item, struct pollStats * stats);
+
+/** Starts the achieved rates over, without changing the schedule */
+void resetPollStats(struct pollSchedule * sched);
+
+/** Fills in cmd with a command, the checksum is added here.
+ *  @param bytes
+ *      The command code followed by any parameters
+ *  @param replyCode
+ *      The reply code expected back, 0xBC if the board only acks it
+ *  @param replyLen
+ *      Bytes between the reply code and its checksum, 0 for an ack
+ *  Returns: SB_OK, or SB_ERROR if the command or reply doesn't fit
+ */
+int sbEncodeCommand(struct sbCommand * cmd, const unsigned char * bytes,
+                    int nbytes, unsigned char replyCode, int replyLen);
+
+/** sbEncodeCommand for the one byte [ReplyCode, Val, CS] reads */
+int sbEncodeSimpleRead(struct sbCommand * cmd, int cmdCode, int replyCode);
+
+/** sbEncodeCommand for the one parameter writes the board acks */
+int sbEncodeSimpleWrite(struct sbCommand * cmd, int cmdCode, int param);
+
+/** Feeds reply bytes to the parser, stopping once the reply is complete.
+ *  Returns: the number of bytes used, cmd->result says how far it got */
+int sbParseReply(struct sbCommand * cmd, const unsigned char * data, int len);
+
+/** Starts sending cmd, which must stay put until it is done
+ *  Returns: SB_INPROGRESS, or the result if it is already over
+ */
+int sbStart(int fd, struct sbCommand * cmd, int timeoutMs);
+
+/** Moves cmd along with whatever the port can take or has ready, without
+ *  blocking. Call it whenever fd is readable (or writable, while tx is
+ *  still going out), or at the deadline.
+ *  Returns: SB_INPROGRESS, SB_OK, or SB_ERROR, SB_IOERROR (timed out),
+ *           SB_BADCC, SB_HWFAIL on failure
+ */
+int sbPoll(int fd, struct sbCommand * cmd);
+
+/** Blocks until cmd is done, returns its result */
+int sbWait(int fd, struct sbCommand * cmd);
+
+/** Seconds until cmd gives up, 0 if it is already over */
+double sbWaitTime(const struct sbCommand * cmd);
+
+/** sbEncodeCommand for writing text to LCD line 0 or 1, text is cut or
+ *  padded to LCD_WIDTH. Returns: SB_OK, or SB_ERROR for a bad line */
+int sbEncodeDisplayText(struct sbCommand * cmd, int line, const char * text);
+
+/** sbEncodeCommand for setSpeeds, so the speeds can go out without waiting
+ *  on the ack */
+int sbEncodeSpeeds(struct sbCommand * cmd, int s1, int s2, int s3, int s4, int s5, int s6);
+
+/** Sets up a display with nothing known about the screen.
+ *  byteBudget is in bytes per second, 0 for no limit */
+void initLCDDisplay(struct lcdDisplay * lcd, double byteBudget);
+
+/** Sets what a line should show, nothing is sent until lcdUpdate.
+ *  Returns: SB_OK, or SB_ERROR for a bad line */
+int lcdSetLine(struct lcdDisplay * lcd, int line, const char * text);
+
+/** Forgets what the screen shows, so every line is sent again, e.g. after
+ *  something else has written to it */
+void lcdInvalidate(struct lcdDisplay * lcd);
+
+/* Sends one line that differs from what the screen shows, if the budget allows.
+ * Returns: SB_OK if a line was sent
+ *          SB_UPDATEDONE if the screen already shows what it should
+ *          SB_NOTDUE if a line differs but the budget says wait, see lcdWaitTime
+ *          SB_ERROR, SB_IOERROR, SB_BADCC, SB_HWFAIL on failure, the line is
+ *          sent again next time
+ */
+int lcdUpdate(int fd, struct lcdDisplay * lcd);
+
+/** Seconds until lcdUpdate can send, 0 if it can now, or -1 if the screen
+ *  already shows what it should */
+double lcdWaitTime(const struct lcdDisplay * lcd);
+
 /** Returns the file*/
 int openSensorBoard(const char * devName);
 
-/** Syncs the communication protocol between the board and vehicle */
+/** Syncs the communication protocol between the board and vehicle.
+ *  Returns as soon as the board acks a sync byte, within IO_TIMEOUT per
+ *  attempt */
 int syncBoard(int fd);
 
 int checkBoard(int fd);
@@ -419,6 +643,16 @@ int setSpeeds(int fd, int s1, int s2, int s3, int s4, int s5, int s6);
  */
 int readSpeedResponses(int fd);
 
+/** readSpeedResponses, giving back what each motor controller said
+ *
+ *  @param codes
+ *      NUM_THRUSTERS bytes, SPEED_RESPONSE_ACK for every controller that
+ *      took its speed
+ *  @return SB_OK if the reply came back whole, otherwise SB_ERROR or
+ *      SB_IOERROR and codes is left alone
+ */
+int readSpeedResponseCodes(int fd, unsigned char * codes);
+
 int readThrusterState(int fd);
 
 int readBarState(int fd);
@@ -650,7 +884,7 @@ int camDisconnect(int fd);
 
 // If we are compiling as C++ code we need to use extern "C" linkage
 #ifdef __cplusplus
-} extern "C"
+} // extern "C"
 #endif // __cplusplus
 
 #endif // RAM_DRIVER_SENSORAPI_H_06_09_2008
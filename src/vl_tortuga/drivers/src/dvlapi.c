@@ -43,93 +43,58 @@ uint16_t dvl_convert16(unsigned char msb, unsigned char lsb)
     return ((((uint16_t) msb) << 8) | lsb);
 }
 
-/* This receives a single byte */
-unsigned char dvl_waitByte(int fd)
+void initDVLReader(DVLReader *reader, int fd)
 {
-    unsigned char rxb;
-    int temp;
-    while((temp= read(fd, &rxb, 1)) != 1 && temp != EOF)
-        ;
-
-    return rxb;
+    memset(reader, 0, sizeof(*reader));
+    reader->fd= fd;
 }
 
-/* This waits for the two starting bytes of 0x7f7f */
-/* I have this failing after SYNC_FAIL_BYTECOUNT */
-int dvl_waitSync(int fd)
+static unsigned char dvl_ringAt(const DVLReader *reader, unsigned int i)
 {
-    int syncLen= 0;
-
-    while(syncLen < SYNC_FAIL_BYTECOUNT) {
-        if(dvl_waitByte(fd) == 0x7D) {
-            if(dvl_waitByte(fd) == 0x00)
-                break;
-         }
+    return reader->ring[(reader->tail + i) % DVL_RING_SIZE];
+}
 
-        syncLen++;
-    }
+/* Reads whatever the port already holds into the ring, without waiting.
+   Returns -1 if the port failed */
+static int dvl_fill(DVLReader *reader)
+{
+    unsigned int start, first;
+    unsigned int space= DVL_RING_SIZE - (reader->head - reader->tail);
+    int waiting= 0, ret;
 
-    if(syncLen >= SYNC_FAIL_BYTECOUNT) {
-        fprintf(stderr, "UNABLE TO SYCHRONIZE WITH DVL!\n");
+    /* Only ask for what is there, so read() never sits on VMIN */
+    if(ioctl(reader->fd, FIONREAD, &waiting) < 0)
         return -1;
+    if((unsigned int) waiting > space)
+        waiting= space;
+
+    while(waiting > 0) {
+        start= reader->head % DVL_RING_SIZE;
+        first= DVL_RING_SIZE - start;
+        if(first > (unsigned int) waiting)
+            first= waiting;
+
+        ret= read(reader->fd, reader->ring + start, first);
+        if(ret < 0 && (errno == EAGAIN || errno == EINTR))
+            break;
+        if(ret <= 0)
+            return -1;
+
+        reader->head+= ret;
+        waiting-= ret;
     }
 
     return 0;
 }
 
-/* This reads in the data from the DVL and stores it so
-   that the AI and controls guys have something to work with! */
-int readDVLData(int fd, RawDVLData* dvl)
+/* Fills in dvl from a whole frame, checksum already checked */
+static void dvl_decode(DVLReader *reader, const unsigned char *dvlData,
+                       int size, RawDVLData *dvl)
 {
-    /* So in the PD4 data format we should only get 47 bytes.
-       We'll stick with the enormous buffer just in case.
-       */
-    unsigned char dvlData[512];
-
-    int len, i, tempsize;
-    uint16_t checksum;
-    static CompleteDVLPacket dbgpkt;
-
-    if(dvl_waitSync(fd))
-        return dvl->valid= ERR_NOSYNC;
-
-    dvl->valid= -1; // Packet is not yet valid
-    dvl->privDbgInf= &dbgpkt;
-
-    /* We got these in the dvl_waitSync() call */
-    dvlData[0]= 0x7D;
-    dvlData[1]= 0;
-
-    /* Set length based on the 0x7D00 we recieved */
-    len= 2;
-
-    /* Get the packet size */
-    while(len < 4)
-        len+= read(fd, dvlData + len, 6 - len);
-
-    tempsize= dvl_convert16(dvlData[3], dvlData[2]);
-
-    while(len < tempsize)
-        len+= read(fd, dvlData + len, tempsize - len);
-
-    checksum= 0;
-    for(i= 0;i < len;i++)
-        checksum+= dvlData[i];
-
-    tempsize+= 2;
-    while(len < tempsize)
-        len+= read(fd, dvlData + len, tempsize - len);
-
-    dbgpkt.checksum= dvl_convert16(dvlData[46], dvlData[45]);
-
-    if(checksum != dbgpkt.checksum) {
-        fprintf(stderr, "WARNING! Bad checksum.\n");
-        fprintf(stderr, "Expected 0x%02x but got 0x%02x\n", checksum, dbgpkt.checksum);
-        dvl->valid= ERR_CHKSUM;
-        return ERR_CHKSUM;
-    }
+    reader->packet.checksum= dvl_convert16(dvlData[size + 1], dvlData[size]);
 
     dvl->valid= 1;
+    dvl->privDbgInf= &reader->packet;
 
     dvl->xvel_btm= dvl_convert16(dvlData[6], dvlData[5]);
     dvl->yvel_btm= dvl_convert16(dvlData[8], dvlData[7]);
@@ -148,6 +113,73 @@ int readDVLData(int fd, RawDVLData* dvl)
     dvl->TOFP_hundreths+= dvlData[37];
     dvl->TOFP_hundreths*= 100;
     dvl->TOFP_hundreths+= dvlData[38];
+}
+
+/* This reads in the data from the DVL and stores it so
+   that the AI and controls guys have something to work with! */
+int readDVLData(DVLReader *reader, RawDVLData *dvl)
+{
+    /* So in the PD4 data format we should only get 47 bytes.
+       We'll stick with the enormous buffer just in case.
+       */
+    unsigned char dvlData[DVL_MAX_FRAME];
+
+    unsigned int i, skipped, size;
+    uint16_t checksum;
+
+    if(dvl_fill(reader))
+        return ERR_IO;
+
+    /* Find the 0x7D00 that starts a frame, dropping anything before it */
+    skipped= 0;
+    while(reader->head - reader->tail >= 2 &&
+          !(dvl_ringAt(reader, 0) == 0x7D && dvl_ringAt(reader, 1) == 0x00)) {
+        reader->tail++;
+        skipped++;
+    }
+    if(skipped) {
+        reader->lostSyncs++;
+        reader->skippedBytes+= skipped;
+    }
+
+    /* Get the packet size */
+    if(reader->head - reader->tail < 4)
+        return ERR_NOFRAME;
+    size= dvl_convert16(dvl_ringAt(reader, 3), dvl_ringAt(reader, 2));
+
+    /* Too short for the fields below or too long to be real, this wasn't a
+       sync after all, so look again a byte on */
+    if(size < 39 || size + 2 > DVL_MAX_FRAME) {
+        reader->tail++;
+        reader->badFrames++;
+        reader->skippedBytes++;
+        return (size < 39) ? ERR_TOOSMALL : ERR_TOOBIG;
+    }
+
+    if(reader->head - reader->tail < size + 2)
+        return ERR_NOFRAME;
+
+    checksum= 0;
+    for(i= 0;i < size + 2;i++) {
+        dvlData[i]= dvl_ringAt(reader, i);
+        if(i < size)
+            checksum+= dvlData[i];
+    }
+
+    if(checksum != dvl_convert16(dvlData[size + 1], dvlData[size])) {
+        fprintf(stderr, "WARNING! Bad checksum.\n");
+        fprintf(stderr, "Expected 0x%02x but got 0x%02x\n", checksum,
+                dvl_convert16(dvlData[size + 1], dvlData[size]));
+        reader->tail++;
+        reader->badFrames++;
+        reader->skippedBytes++;
+        dvl->valid= ERR_CHKSUM;
+        return ERR_CHKSUM;
+    }
+
+    reader->tail+= size + 2;
+    reader->frames++;
+    dvl_decode(reader, dvlData, size, dvl);
 
     return 0;
 }
@@ -18,6 +18,8 @@
 #include <unistd.h>
 #include <termios.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <time.h>
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -68,17 +70,11 @@ double imu_convertData(unsigned char msb, unsigned char lsb, double range)
     return imu_convert16(msb, lsb) * ((range/2.0)*1.5) / 32768.0;
 }
 
-int readIMUData(int fd, RawIMUData* imu)
+/* Fills in imu from the frame after the sync bytes, returns checksumValid */
+static int imu_decodeFrame(const unsigned char * imuData, RawIMUData * imu)
 {
-    unsigned char imuData[34];
-
-    imu_waitSync(fd);
-
-    int len = 0;
     int i=0, sum=0;
-    while(len < 34)
-        len += read(fd, imuData+len, 34-len);
-    
+
     imu->messageID = imuData[0];
     
     imu->sampleTimer = (imuData[3]<<8) | imuData[4];
@@ -99,18 +95,154 @@ int readIMUData(int fd, RawIMUData* imu)
     imu->tempY = (((imu_convert16(imuData[29], imuData[30])*5.0)/32768.0)/0.0084)+25.0;
     imu->tempZ = (((imu_convert16(imuData[31], imuData[32])*5.0)/32768.0)/0.0084)+25.0;
 
-    for(i=0; i<33; i++)
+    for(i=0; i<IMU_FRAME_SIZE-1; i++)
         sum+=imuData[i];
 
     sum += 0xFF * 4;
 
-    imu->checksumValid = (imuData[33] == (sum&0xFF));
-
-    if(!imu->checksumValid)
+    imu->checksumValid = (imuData[IMU_FRAME_SIZE-1] == (sum&0xFF));
 
     return imu->checksumValid;
 }
 
+int readIMUData(int fd, RawIMUData* imu)
+{
+    unsigned char imuData[IMU_FRAME_SIZE];
+
+    imu_waitSync(fd);
+
+    int len = 0;
+    while(len < IMU_FRAME_SIZE)
+        len += read(fd, imuData+len, IMU_FRAME_SIZE-len);
+
+    return imu_decodeFrame(imuData, imu);
+}
+
+void initIMUReader(IMUReader * reader, int fd)
+{
+    memset(reader, 0, sizeof(*reader));
+    reader->fd = fd;
+}
+
+static unsigned char imu_ringAt(const IMUReader * reader, unsigned int i)
+{
+    return reader->ring[(reader->tail + i) % IMU_RING_SIZE];
+}
+
+/* Reads whatever the port already holds into the ring, without waiting.
+ * Returns the bytes read, or -1 if the port failed */
+static int imu_fill(IMUReader * reader)
+{
+    unsigned int start, first, space = IMU_RING_SIZE - (reader->head - reader->tail);
+    int waiting = 0, total = 0, ret;
+
+    /* Only ask for what is there, so read() never sits on VMIN */
+    if(ioctl(reader->fd, FIONREAD, &waiting) < 0)
+        return -1;
+    if((unsigned int) waiting > space)
+        waiting = space;
+
+    while(waiting > 0)
+    {
+        start = reader->head % IMU_RING_SIZE;
+        first = IMU_RING_SIZE - start;
+        if(first > (unsigned int) waiting)
+            first = waiting;
+
+        ret = read(reader->fd, reader->ring + start, first);
+        if(ret < 0 && (errno == EAGAIN || errno == EINTR))
+            break;
+        if(ret <= 0)
+            return -1;
+
+        reader->head += ret;
+        waiting -= ret;
+        total += ret;
+    }
+    return total;
+}
+
+/* Looks for a whole frame in the ring. Returns 1 and consumes it if it
+ * checks out, 0 if more bytes are needed */
+static int imu_parseFrame(IMUReader * reader, RawIMUData * imu)
+{
+    unsigned char frame[IMU_FRAME_SIZE];
+    unsigned int i, skipped;
+
+    while(reader->head - reader->tail >= 4 + IMU_FRAME_SIZE)
+    {
+        /* Find the sync sequence, dropping everything before it */
+        skipped = 0;
+        while(reader->head - reader->tail >= 4 &&
+              !(imu_ringAt(reader, 0) == 0xFF && imu_ringAt(reader, 1) == 0xFF &&
+                imu_ringAt(reader, 2) == 0xFF && imu_ringAt(reader, 3) == 0xFF))
+        {
+            reader->tail++;
+            skipped++;
+        }
+        if(skipped > 0)
+        {
+            reader->lostSyncs++;
+            reader->skippedBytes += skipped;
+        }
+
+        if(reader->head - reader->tail < 4 + IMU_FRAME_SIZE)
+            return 0;
+
+        for(i=0; i<IMU_FRAME_SIZE; i++)
+            frame[i] = imu_ringAt(reader, 4 + i);
+
+        if(imu_decodeFrame(frame, imu))
+        {
+            reader->tail += 4 + IMU_FRAME_SIZE;
+            reader->frames++;
+            return 1;
+        }
+
+        /* Probably 0xFFs inside a frame, look again one byte on */
+        reader->badFrames++;
+        reader->tail++;
+        reader->skippedBytes++;
+    }
+    return 0;
+}
+
+static double imu_monotonicTime(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+int readIMUFrame(IMUReader * reader, RawIMUData * imu, int timeoutMs)
+{
+    struct pollfd pfd;
+    double deadline = imu_monotonicTime() + timeoutMs / 1000.0;
+    double left;
+
+    while(1)
+    {
+        if(imu_parseFrame(reader, imu))
+            return 1;
+        if(imu_fill(reader) < 0)
+            return -1;
+        if(imu_parseFrame(reader, imu))
+            return 1;
+
+        left = deadline - imu_monotonicTime();
+        if(left <= 0)
+            return 0;
+
+        pfd.fd = reader->fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if(poll(&pfd, 1, (int) (left * 1000) + 1) < 0 && errno != EINTR)
+            return -1;
+        if(pfd.revents & (POLLERR | POLLHUP | POLLNVAL))
+            return -1;
+    }
+}
+
 /*
 int openIMU(const char * devName)
 {
@@ -28,6 +28,25 @@ void barCmd(int fd, int cmd)
         printf("Error setting bar state\n");
 }
 
+/* Shows both lines, writing only the ones that changed */
+void showLines(int fd, struct lcdDisplay * lcd, const char * line0, const char * line1)
+{
+    int ret;
+
+    lcdSetLine(lcd, 0, line0);
+    lcdSetLine(lcd, 1, line1);
+    while((ret = lcdUpdate(fd, lcd)) != SB_UPDATEDONE)
+    {
+        if(ret == SB_NOTDUE)
+            usleep(lcdWaitTime(lcd) * 1000000);
+        else if(ret != SB_OK)
+        {
+            printf("Error writing to the LCD: %s\n", sbErrorToText(ret));
+            return;
+        }
+    }
+}
+
 
 int main(int argc, char ** argv)
 {
@@ -802,22 +821,23 @@ int main(int argc, char ** argv)
 
     else if(strcmp(argv[1], "-s") == 0)
     {
-        displayText(fd, 0, "Please attach   ");
-        displayText(fd, 1, "Start magnet    ");
+        struct lcdDisplay lcd;
+        initLCDDisplay(&lcd, 0);
+
+        showLines(fd, &lcd, "Please attach", "Start magnet");
 
         while((readStatus(fd) & STATUS_STARTSW) == 0)
         {
             usleep(100*1000);
         }
 
-        displayText(fd, 0, "Ready to start  ");
-    	displayText(fd, 1, "");
+        showLines(fd, &lcd, "Ready to start", "");
 
     	while((readStatus(fd) & STATUS_STARTSW))
         {
             usleep(100*1000);
         }
-        displayText(fd, 0, "Running...");
+        showLines(fd, &lcd, "Running...", "");
         close(fd);
         return 0;
     }
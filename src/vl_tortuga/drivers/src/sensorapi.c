@@ -12,6 +12,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <time.h>
 
 // UNIX Includes
 #include <unistd.h>
@@ -52,9 +53,19 @@ int hasData(int fd, int timeout)
     return pfd.revents & POLLIN;
 }
 
-void miniSleep()
+/* Seconds on a clock that never jumps, for deadlines and the poll schedule */
+static double monotonicTime(void)
 {
-    usleep(20 * 1000);
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/* Milliseconds left until deadline, rounded up, for poll() */
+static int msecUntil(double deadline)
+{
+    double left = deadline - monotonicTime();
+    return (left > 0) ? (int) (left * 1000) + 1 : 0;
 }
 
 int writeData(int fd, unsigned char * buf, int nbytes)
@@ -71,34 +82,197 @@ int readData(int fd, unsigned char * buf, int nbytes)
     return read(fd, buf, nbytes);
 }
 
-int syncBoard(int fd)
+int sbEncodeCommand(struct sbCommand * cmd, const unsigned char * bytes,
+                    int nbytes, unsigned char replyCode, int replyLen)
 {
-    unsigned char buf[5];
+    int i, cs = 0;
 
-    /* Eat the incoming buffer */
-    while(hasData(fd, 0))
+    if(nbytes < 1 || nbytes + 1 > SB_MAX_COMMAND ||
+       replyLen < 0 || replyLen + 2 > SB_MAX_REPLY)
+        return SB_ERROR;
+
+    memset(cmd, 0, sizeof(*cmd));
+    for(i=0; i<nbytes; i++)
     {
-      if (1 != read(fd, buf, 1))
-	return SB_ERROR;
+        cmd->tx[i] = bytes[i];
+        cs += bytes[i];
     }
+    cmd->tx[nbytes] = cs & 0xFF;
+    cmd->txLen = nbytes + 1;
 
-    int i;
+    cmd->replyCode = replyCode;
+    cmd->replyLen = replyLen;
+    cmd->result = SB_INPROGRESS;
+    return SB_OK;
+}
 
-    for(i=0; i<MAX_SYNC_ATTEMPTS; i++)
+int sbEncodeSimpleRead(struct sbCommand * cmd, int cmdCode, int replyCode)
+{
+    unsigned char buf[1] = {cmdCode};
+    return sbEncodeCommand(cmd, buf, 1, replyCode, 1);
+}
+
+int sbEncodeSimpleWrite(struct sbCommand * cmd, int cmdCode, int param)
+{
+    unsigned char buf[2] = {cmdCode, param};
+    return sbEncodeCommand(cmd, buf, 2, 0xBC, 0);
+}
+
+/* Bytes of reply still to come, code and checksum included */
+static int replyRemaining(const struct sbCommand * cmd)
+{
+    if(cmd->rxLen == 0)
+        return 1;
+    return cmd->replyLen + 2 - cmd->rxLen;
+}
+
+int sbParseReply(struct sbCommand * cmd, const unsigned char * data, int len)
+{
+    int i, cs, used = 0;
+
+    while(used < len && cmd->result == SB_INPROGRESS)
+    {
+        unsigned char b = data[used++];
+        cmd->rx[cmd->rxLen++] = b;
+
+        if(cmd->rxLen == 1)
+        {
+            if(b == cmd->replyCode)
+            {
+                /* A bare ack, or a reply with nothing after the code */
+                if(cmd->replyLen == 0)
+                    cmd->result = SB_OK;
+            }
+            else if(b == 0xCC)
+                cmd->result = SB_BADCC;
+            else if(b == 0xDF)
+                cmd->result = SB_HWFAIL;
+            else
+                cmd->result = SB_ERROR;
+            continue;
+        }
+
+        if(replyRemaining(cmd) == 0)
+        {
+            cs = 0;
+            for(i=0; i<cmd->rxLen - 1; i++)
+                cs += cmd->rx[i];
+            cmd->result = ((cs & 0xFF) == cmd->rx[cmd->rxLen - 1]) ? SB_OK : SB_ERROR;
+        }
+    }
+
+    return used;
+}
+
+int sbStart(int fd, struct sbCommand * cmd, int timeoutMs)
+{
+    cmd->txSent = 0;
+    cmd->rxLen = 0;
+    cmd->result = SB_INPROGRESS;
+    cmd->deadline = monotonicTime() + timeoutMs / 1000.0;
+    return sbPoll(fd, cmd);
+}
+
+int sbPoll(int fd, struct sbCommand * cmd)
+{
+    struct pollfd pfd;
+    unsigned char buf[SB_MAX_REPLY];
+    int ret, waiting;
+
+    if(cmd->result != SB_INPROGRESS)
+        return cmd->result;
+
+    pfd.fd = fd;
+    pfd.events = (cmd->txSent < cmd->txLen) ? POLLOUT : POLLIN;
+    pfd.revents = 0;
+    poll(&pfd, 1, 0);
+
+    if(cmd->txSent < cmd->txLen)
+    {
+        if(pfd.revents & POLLOUT)
+        {
+            ret = write(fd, cmd->tx + cmd->txSent, cmd->txLen - cmd->txSent);
+            if(ret > 0)
+                cmd->txSent += ret;
+            else if(ret < 0 && errno != EAGAIN && errno != EINTR)
+                return cmd->result = SB_IOERROR;
+        }
+    }
+    else if(pfd.revents & POLLIN)
+    {
+        /* Only what is already there, and never past the end of the reply,
+         * so read() can't wait on VMIN and the next reply stays put */
+        waiting = 0;
+        ioctl(fd, FIONREAD, &waiting);
+        if(waiting > replyRemaining(cmd))
+            waiting = replyRemaining(cmd);
+        if(waiting > 0)
+        {
+            ret = read(fd, buf, waiting);
+            if(ret > 0)
+                sbParseReply(cmd, buf, ret);
+            else if(ret < 0 && errno != EAGAIN && errno != EINTR)
+                return cmd->result = SB_IOERROR;
+        }
+    }
+
+    if(cmd->result == SB_INPROGRESS && monotonicTime() >= cmd->deadline)
+        cmd->result = SB_IOERROR;
+    return cmd->result;
+}
+
+int sbWait(int fd, struct sbCommand * cmd)
+{
+    struct pollfd pfd;
+
+    while(sbPoll(fd, cmd) == SB_INPROGRESS)
     {
-        unsigned char b[1];
-        b[0] = 0xFF;
-        writeData(fd, b, 1);
-	    miniSleep();
+        pfd.fd = fd;
+        pfd.events = (cmd->txSent < cmd->txLen) ? POLLOUT : POLLIN;
+        pfd.revents = 0;
+        poll(&pfd, 1, msecUntil(cmd->deadline));
+    }
+    return cmd->result;
+}
+
+double sbWaitTime(const struct sbCommand * cmd)
+{
+    double left = cmd->deadline - monotonicTime();
+    if(cmd->result != SB_INPROGRESS || left < 0)
+        return 0;
+    return left;
+}
 
-        b[0]=0;
+int syncBoard(int fd)
+{
+    unsigned char b;
+    double deadline;
+    int i, waiting;
 
-        if(hasData(fd, IO_TIMEOUT))
-            readData(fd, b, 1);
-	    miniSleep();
+    /* Drop whatever is left over from before */
+    tcflush(fd, TCIFLUSH);
 
-        if(!hasData(fd, IO_TIMEOUT) && b[0]==0xBC)
-            return SB_OK;
+    for(i=0; i<MAX_SYNC_ATTEMPTS; i++)
+    {
+        b = HOST_CMD_SYNC;
+        if(writeData(fd, &b, 1) != 1)
+            return SB_IOERROR;
+
+        /* Done as soon as the ack arrives on a quiet line. Anything else is
+         * the tail end of an old reply, so drain it and try again */
+        deadline = monotonicTime() + IO_TIMEOUT / 1000.0;
+        while(hasData(fd, msecUntil(deadline)))
+        {
+            if(read(fd, &b, 1) != 1)
+                return SB_ERROR;
+
+            waiting = 0;
+            ioctl(fd, FIONREAD, &waiting);
+            if(b == 0xBC && waiting == 0)
+                return SB_OK;
+            if(waiting == 0)
+                break;
+        }
     }
 
     return SB_ERROR;
@@ -107,10 +281,12 @@ int syncBoard(int fd)
 
 int pingBoard(int fd)
 {
-    unsigned char buf[2]={HOST_CMD_PING, HOST_CMD_PING};
-    writeData(fd, buf, 2);
-    readData(fd, buf, 1);
-    if(buf[0] == 0xBC)
+    unsigned char buf[1]={HOST_CMD_PING};
+    struct sbCommand cmd;
+
+    sbEncodeCommand(&cmd, buf, 1, 0xBC, 0);
+    sbStart(fd, &cmd, IO_TIMEOUT);
+    if(sbWait(fd, &cmd) == SB_OK)
         return SB_OK;
     return SB_HWFAIL;
 }
@@ -118,19 +294,12 @@ int pingBoard(int fd)
 
 int checkBoard(int fd)
 {
-    unsigned char buf[2]={HOST_CMD_SYSCHECK, HOST_CMD_SYSCHECK};
-    writeData(fd, buf, 2);
-    readData(fd, buf, 1);
-    if(buf[0] == 0xBC)
-        return SB_OK;
-
-    if(buf[0] == 0xDF)
-        return SB_HWFAIL;
+    unsigned char buf[1]={HOST_CMD_SYSCHECK};
+    struct sbCommand cmd;
 
-    if(buf[0] == 0xCC)
-        return SB_BADCC;
-
-    return SB_ERROR;
+    sbEncodeCommand(&cmd, buf, 1, 0xBC, 0);
+    sbStart(fd, &cmd, IO_TIMEOUT);
+    return sbWait(fd, &cmd);
 }
 
 
@@ -138,18 +307,15 @@ int checkBoard(int fd)
 
 int readDepth(int fd)
 {
-    unsigned char buf[5]={HOST_CMD_DEPTH, HOST_CMD_DEPTH};
-    writeData(fd, buf, 2);
-    readData(fd, buf, 1);
-    if(buf[0] != HOST_REPLY_DEPTH)
-        return SB_ERROR;
+    unsigned char buf[1]={HOST_CMD_DEPTH};
+    struct sbCommand cmd;
 
-    readData(fd, buf, 3);
-
-    if( ((0x03 + buf[0] + buf[1]) & 0xFF) == buf[2])
-        return (buf[0]<<8 | buf[1]);
+    sbEncodeCommand(&cmd, buf, 1, HOST_REPLY_DEPTH, 2);
+    sbStart(fd, &cmd, IO_TIMEOUT);
+    if(sbWait(fd, &cmd) != SB_OK)
+        return SB_ERROR;
 
-    return SB_ERROR;
+    return (cmd.rx[1]<<8 | cmd.rx[2]);
 }
 
 
@@ -159,25 +325,67 @@ int readDepth(int fd)
  */
 int simpleRead(int fd, int cmdCode, int replyCode)
 {
-    unsigned char buf[5];
-    buf[0] = buf[1] = cmdCode;
+    struct sbCommand cmd;
+    int ret;
 
-    writeData(fd, buf, 2);
-    readData(fd, buf, 1);
+    sbEncodeSimpleRead(&cmd, cmdCode, replyCode);
+    sbStart(fd, &cmd, IO_TIMEOUT);
+    ret = sbWait(fd, &cmd);
 
-    if(buf[0] != replyCode)
-    {
-        printf("Bad reply from simple command %02x! (Expected %02x, got %02x)\n", cmdCode, replyCode, buf[0]);
+    if(ret == SB_OK)
+        return cmd.rx[1];
+
+    if(cmd.rxLen > 0 && cmd.rx[0] != replyCode)
+        printf("Bad reply from simple command %02x! (Expected %02x, got %02x)\n", cmdCode, replyCode, cmd.rx[0]);
+    else if(cmd.rxLen == cmd.replyLen + 2)
+        printf("Bad cs in response from simple command %02x!\n", cmdCode);
+
+    return (ret == SB_IOERROR) ? SB_IOERROR : SB_ERROR;
+}
+
+/*
+ * Send:   [CmdCode, CS]
+ * Expect: [ReplyCode, replyLen bytes, CS], left in cmd->rx
+ * A reply that arrives whole but doesn't add up comes back as SB_BADCC
+ */
+static int longRead(int fd, int cmdCode, int replyCode, int replyLen,
+                    struct sbCommand * cmd)
+{
+    unsigned char buf[1] = {cmdCode};
+    int ret;
+
+    if(sbEncodeCommand(cmd, buf, 1, replyCode, replyLen) != SB_OK)
         return SB_ERROR;
-    }
-    readData(fd, buf, 2);
+    sbStart(fd, cmd, IO_TIMEOUT);
+    ret = sbWait(fd, cmd);
+
+    if(ret == SB_ERROR && cmd->rx[0] == replyCode && cmd->rxLen == replyLen + 2)
+        return SB_BADCC;
+    return ret;
+}
 
-    if( ((replyCode + buf[0]) & 0xFF) == buf[1])
-        return buf[0];
+/*
+ * Send:   [bytes, CS]
+ * Expect: [BC | DF | CC]
+ */
+static int sendCommand(int fd, const unsigned char * bytes, int nbytes)
+{
+    struct sbCommand cmd;
 
-    printf("Bad cs in response from simple command %02x!\n", cmdCode);
+    if(sbEncodeCommand(&cmd, bytes, nbytes, HOST_REPLY_SUCCESS, 0) != SB_OK)
+        return SB_ERROR;
+    sbStart(fd, &cmd, IO_TIMEOUT);
+    return sbWait(fd, &cmd);
+}
 
-    return SB_ERROR;
+/*
+ * Send:   [CmdCode, CS]
+ * Expect: [BC | DF | CC]
+ */
+static int simpleCommand(int fd, int cmdCode)
+{
+    unsigned char buf[1] = {cmdCode};
+    return sendCommand(fd, buf, 1);
 }
 
 
@@ -189,33 +397,21 @@ int readStatus(int fd)
 
 int readStatus(int fd)
 {
-    int ret= 0;
-    unsigned char buf[4];
-    buf[0]= buf[1]= HOST_CMD_BOARDSTATUS;
+    struct sbCommand cmd;
+    int ret;
 
-    writeData(fd, buf, 2);
-    readData(fd, buf, 1);
+    ret = longRead(fd, HOST_CMD_BOARDSTATUS, HOST_REPLY_BOARDSTATUS, 2, &cmd);
+    if(ret == SB_OK)
+        /* Now we store the two bytes in one int. */
+        return (cmd.rx[1] << 8) | cmd.rx[2];
 
-    if(buf[0] != HOST_REPLY_BOARDSTATUS) {
+    if(cmd.rxLen > 0 && cmd.rx[0] != HOST_REPLY_BOARDSTATUS)
         printf("Bad reply while attempting to recieve status! \
-                (Expected %02x, got %02x)\n", HOST_REPLY_BOARDSTATUS, buf[0]);
-        return SB_ERROR;
-    }
-
-    readData(fd, buf, 3);
-    if(buf[2] != ((buf[0]+buf[1]+HOST_REPLY_BOARDSTATUS) & 0xFF)) {
+                (Expected %02x, got %02x)\n", HOST_REPLY_BOARDSTATUS, cmd.rx[0]);
+    else if(ret == SB_BADCC)
         printf("Bad checksum while recieving status!\n");
-        printf("Got %x but was expecting %x\n", buf[2], ((buf[0] + buf[1] + HOST_REPLY_BOARDSTATUS) & 0xFF));
-        printf("%x; %x; %x\n", buf[0], buf[1], HOST_REPLY_BOARDSTATUS);
-        return SB_ERROR;
-    }
-
-    /* Now we store the two bytes in one int. */
-    ret|= buf[0];
-    ret<<= 8;
-    ret|= buf[1];
 
-    return ret;
+    return (ret == SB_IOERROR) ? SB_IOERROR : SB_ERROR;
 }
 
 
@@ -249,59 +445,41 @@ int readOvrState(int fd)
 
 int readTemp(int fd, unsigned char * tempData)
 {
-    unsigned char buf[10]={HOST_CMD_TEMPERATURE, HOST_CMD_TEMPERATURE};
-    int i;
+    struct sbCommand cmd;
+    int i, ret;
     for(i=0; i<NUM_TEMP_SENSORS; i++)
         tempData[i]=0;
 
-    writeData(fd, buf, 2);
-    readData(fd, buf, 1);
-
-
-
-    if(buf[0] != 0x0B)
-        return SB_ERROR;
-
-    readData(fd, tempData, NUM_TEMP_SENSORS);
-    readData(fd, buf, 1);
-
-    unsigned char sum = 0x0B;
+    ret = longRead(fd, HOST_CMD_TEMPERATURE, HOST_REPLY_TEMPERATURE,
+                   NUM_TEMP_SENSORS, &cmd);
+    if(ret != SB_OK)
+        return ret;
 
     for(i=0; i<NUM_TEMP_SENSORS; i++)
-        sum = (sum+tempData[i]) & 0xFF;
-
-    if(sum == buf[0])
-        return SB_OK;
+        tempData[i] = cmd.rx[i+1];
 
-    return SB_ERROR;
+    return SB_OK;
 }
 
 
 int getSonarData(int fd, struct sonarData * sd)
 {
-    unsigned char buf[22]={HOST_CMD_SONAR, HOST_CMD_SONAR};
-    int i;
-    unsigned char rawSonar[22] = {0,0,0,0,0};
+    unsigned char buf[1]={HOST_CMD_SONAR};
+    struct sbCommand cmd;
+    unsigned char * rawSonar = cmd.rx + 1;
+    int i, ret;
 
     if(sd == NULL)
         return -1;
 
-    writeData(fd, buf, 2);
-    readData(fd, buf, 1);
-
-    if(buf[0] != 0x0E)
-        return SB_ERROR;
-
-    readData(fd, rawSonar, 22);
-    readData(fd, buf, 1);
-
-    unsigned char sum = 0x0E;
-
-    for(i=0; i<22; i++)
-        sum = (sum+rawSonar[i]) & 0xFF;
+    /* The board answers for the sonar board, so a quiet sonar board times out
+       here instead of hanging the port */
+    sbEncodeCommand(&cmd, buf, 1, HOST_REPLY_SONAR, SONAR_PACKET_LEN);
+    sbStart(fd, &cmd, IO_TIMEOUT);
+    ret = sbWait(fd, &cmd);
 
-    if(sum != buf[0])
-        return SB_ERROR;
+    if(ret != SB_OK)
+        return (ret == SB_IOERROR) ? SB_IOERROR : SB_ERROR;
 
 /*    printf("\nDebug: Received data from sonar board: < ");
     for(i=0; i<20; i++)
@@ -372,20 +550,9 @@ int getSonarData(int fd, struct sonarData * sd)
 
 int hardKill(int fd)
 {
-    unsigned char buf[6]={0x06, 0xDE, 0xAD, 0xBE, 0xEF, 0x3E};
-    writeData(fd, buf, 6);
-    readData(fd, buf, 1);
-
-    if(buf[0] == 0xBC)
-        return SB_OK;
-
-    if(buf[0] == 0xCC)
-        return SB_BADCC;
-
-    if(buf[0] == 0xDF)
-        return SB_HWFAIL;
-
-    return SB_ERROR;
+    /* The checksum makes it 0x06, 0xDE, 0xAD, 0xBE, 0xEF, 0x3E */
+    unsigned char buf[5]={0x06, 0xDE, 0xAD, 0xBE, 0xEF};
+    return sendCommand(fd, buf, 5);
 }
 
 /*  Send:   [cmdCode, param, CS]
@@ -394,44 +561,19 @@ int hardKill(int fd)
  */
 int simpleWrite(int fd, int cmdCode, int param, int range)
 {
+    struct sbCommand cmd;
+
     if(param < 0 || param > range)
         return -255;
 
-    unsigned char buf[3];
-    buf[0] = cmdCode;
-    buf[1] = param;
-    buf[2] = (cmdCode + param) & 0xFF;
-
-    writeData(fd, buf, 3);
-    readData(fd, buf, 1);
-
-    if(buf[0] == 0xBC)
-        return SB_OK;
-
-    if(buf[0] == 0xCC)
-        return SB_BADCC;
-
-    if(buf[0] == 0xDF)
-        return SB_HWFAIL;
-
-    return SB_ERROR;
+    sbEncodeSimpleWrite(&cmd, cmdCode, param);
+    sbStart(fd, &cmd, IO_TIMEOUT);
+    return sbWait(fd, &cmd);
 }
 
 int resetBlackfin(int fd)
 {
-    unsigned char buf[2]={HOST_CMD_BFRESET, HOST_CMD_BFRESET};
-    writeData(fd, buf, 2);
-    readData(fd, buf, 1);
-    if(buf[0] == 0xBC)
-        return SB_OK;
-
-    if(buf[0] == 0xDF)
-        return SB_HWFAIL;
-
-    if(buf[0] == 0xCC)
-        return SB_BADCC;
-
-    return SB_ERROR;
+    return simpleCommand(fd, HOST_CMD_BFRESET);
 }
 
 int startBlackfin(int fd)
@@ -474,34 +616,16 @@ int setThrusterSafety(int fd, int state)
     if(state<0 || state>11)
         return -255;
 
-    unsigned char buf[8]={0x09, 0xB1, 0xD0, 0x23, 0x7A, 0x69, 0, 0};
+    unsigned char buf[7]={0x09, 0xB1, 0xD0, 0x23, 0x7A, 0x69, 0};
 
     buf[6] = state;
 
-    int i;
-
-    for(i=0; i<7; i++)
-        buf[7] += buf[i];
-
 
     if(state > 5)	/* If unsafing, sleep a little */
     	usleep(300 * 1000);
 
 
-    writeData(fd, buf, 8);
-
-    readData(fd, buf, 1);
-
-    if(buf[0] == 0xBC)
-        return SB_OK;
-
-    if(buf[0] == 0xCC)
-        return SB_BADCC;
-
-    if(buf[0] == 0xDF)
-        return SB_HWFAIL;
-
-    return SB_ERROR;
+    return sendCommand(fd, buf, 7);
 }
 
 
@@ -520,49 +644,136 @@ int setBarOutputs(int fd, int bars)
     return simpleWrite(fd, HOST_CMD_SET_BARS, bars, 256);
 }
 
+int sbEncodeDisplayText(struct sbCommand * cmd, int line, const char * text)
+{
+    unsigned char buf[LCD_WIDTH + 2];
+    int i;
+
+    if(line!=0 && line!=1)
+        return SB_ERROR;
+
+    buf[0] = HOST_CMD_PRINTTEXT;
+    buf[1] = line;
+    memset(buf + 2, ' ', LCD_WIDTH);
+    for(i=0; text && text[i]!=0 && i<LCD_WIDTH; i++)
+        buf[i+2]=text[i];
+
+    return sbEncodeCommand(cmd, buf, LCD_WIDTH + 2, 0xBC, 0);
+}
+
 int displayText(int fd, int line, const char* text)
 {
+    struct sbCommand cmd;
+
     if(line!=0 && line!=1)
         return -255;
 
     if(!text)
         return 0;
 
-    unsigned char buf[20]={0x0C, 0,32,32,32,32,32,32,32,32,32,32,32,32,32,32,32,32,0 };
+    sbEncodeDisplayText(&cmd, line, text);
+    sbStart(fd, &cmd, IO_TIMEOUT);
+    return sbWait(fd, &cmd);
+}
 
-    buf[1] = line;
+void initLCDDisplay(struct lcdDisplay * lcd, double byteBudget)
+{
+    memset(lcd, 0, sizeof(*lcd));
+    memset(lcd->desired, ' ', sizeof(lcd->desired));
+    lcd->byteBudget = byteBudget;
+    lcd->linkFreeAt = monotonicTime();
+}
 
+int lcdSetLine(struct lcdDisplay * lcd, int line, const char * text)
+{
     int i;
 
-    for(i=0; text[i]!=0 && i<16; i++)
-        buf[i+2]=text[i];
+    if(line<0 || line>=LCD_LINES)
+        return SB_ERROR;
+
+    memset(lcd->desired[line], ' ', LCD_WIDTH);
+    for(i=0; text && text[i]!=0 && i<LCD_WIDTH; i++)
+        lcd->desired[line][i]=text[i];
 
-    for(i=0; i<18; i++)
-        buf[18] += buf[i];
+    return SB_OK;
+}
 
+void lcdInvalidate(struct lcdDisplay * lcd)
+{
+    memset(lcd->known, 0, sizeof(lcd->known));
+}
 
-    writeData(fd, buf, 19);
+/* The first line that has to go out, starting from nextLine, or -1 */
+static int lcdChangedLine(const struct lcdDisplay * lcd)
+{
+    int i, line;
 
-    readData(fd, buf, 1);
+    for(i=0; i<LCD_LINES; i++)
+    {
+        line = (lcd->nextLine + i) % LCD_LINES;
+        if(!lcd->known[line] ||
+           memcmp(lcd->current[line], lcd->desired[line], LCD_WIDTH) != 0)
+            return line;
+    }
+    return -1;
+}
 
-    if(buf[0] == 0xBC)
-        return SB_OK;
+int lcdUpdate(int fd, struct lcdDisplay * lcd)
+{
+    struct sbCommand cmd;
+    char text[LCD_WIDTH + 1];
+    double start;
+    int line, ret;
 
-    if(buf[0] == 0xCC)
-        return SB_BADCC;
+    line = lcdChangedLine(lcd);
+    if(line < 0)
+        return SB_UPDATEDONE;
 
-    if(buf[0] == 0xDF)
-        return SB_HWFAIL;
+    start = monotonicTime();
+    if(start < lcd->linkFreeAt)
+        return SB_NOTDUE;
 
-    return SB_ERROR;
+    lcd->nextLine = (line + 1) % LCD_LINES;
+
+    memcpy(text, lcd->desired[line], LCD_WIDTH);
+    text[LCD_WIDTH] = 0;
+    sbEncodeDisplayText(&cmd, line, text);
+    sbStart(fd, &cmd, IO_TIMEOUT);
+    ret = sbWait(fd, &cmd);
+
+    /* The command and its ack count against the budget whether it worked or not */
+    if(lcd->byteBudget > 0)
+        lcd->linkFreeAt = start + (cmd.txLen + cmd.replyLen + 1) / lcd->byteBudget;
+
+    if(ret != SB_OK)
+    {
+        /* It may have got through, it may not, send it again */
+        lcd->known[line] = 0;
+        return ret;
+    }
+
+    memcpy(lcd->current[line], lcd->desired[line], LCD_WIDTH);
+    lcd->known[line] = 1;
+    lcd->linesSent++;
+    return SB_OK;
+}
+
+double lcdWaitTime(const struct lcdDisplay * lcd)
+{
+    double now;
+
+    if(lcdChangedLine(lcd) < 0)
+        return -1;
+
+    now = monotonicTime();
+    return (lcd->linkFreeAt > now) ? lcd->linkFreeAt - now : 0;
 }
 
 
 // MSB LSB !! (big endian)
-int setSpeeds(int fd, int s1, int s2, int s3, int s4, int s5, int s6)
+int sbEncodeSpeeds(struct sbCommand * cmd, int s1, int s2, int s3, int s4, int s5, int s6)
 {
-    int i=0;
-    unsigned char buf[14]={HOST_CMD_SETSPEED, 0,0, 0,0, 0,0, 0,0, 0,0, 0,0, 0x00};
+    unsigned char buf[13]={HOST_CMD_SETSPEED, 0,0, 0,0, 0,0, 0,0, 0,0, 0,0};
 //    printf("Sending speeds: %d %d %d %d\n", s1, s2, s3, s4);
 
 
@@ -584,62 +795,60 @@ int setSpeeds(int fd, int s1, int s2, int s3, int s4, int s5, int s6)
     buf[11] = (s6 >> 8);
     buf[12] = (s6 & 0xFF);
 
-    buf[13] = 0;
-
-    for(i=0; i<13; i++)
-        buf[13]+=buf[i];
-
-    writeData(fd, buf, 14);
-    readData(fd, buf, 1);
-
-    if(buf[0] == HOST_REPLY_SUCCESS)
-        return SB_OK;
-
-    if(buf[0] == HOST_REPLY_BADCHKSUM)
-        return SB_BADCC;
+    return sbEncodeCommand(cmd, buf, 13, HOST_REPLY_SUCCESS, 0);
+}
 
-    if(buf[0] == HOST_REPLY_FAILURE)
-        return SB_HWFAIL;
+int setSpeeds(int fd, int s1, int s2, int s3, int s4, int s5, int s6)
+{
+    struct sbCommand cmd;
 
-    return SB_ERROR;
+    sbEncodeSpeeds(&cmd, s1, s2, s3, s4, s5, s6);
+    sbStart(fd, &cmd, IO_TIMEOUT);
+    return sbWait(fd, &cmd);
 }
 
 // 14 xx xx xx xx CS
-int readSpeedResponses(int fd)
+int readSpeedResponseCodes(int fd, unsigned char * codes)
 {
-    unsigned char buf[8]={0x13, 0x13};
-    int i;
+    unsigned char buf[1]={HOST_CMD_MOTOR_READ};
+    struct sbCommand cmd;
+    int i, ret;
 
-    writeData(fd, buf, 2);
-    readData(fd, buf, 1);
+    sbEncodeCommand(&cmd, buf, 1, HOST_CMD_MOTOR_REPLY, NUM_THRUSTERS);
+    sbStart(fd, &cmd, IO_TIMEOUT);
+    ret = sbWait(fd, &cmd);
 
-    if(buf[0] != 0x14)
+    if(ret != SB_OK)
     {
-    	printf("Bad reply: %x\n", buf[0]);
-    	return SB_ERROR;
+        if(cmd.rxLen > 0 && cmd.rx[0] != HOST_CMD_MOTOR_REPLY)
+            printf("Bad reply: %x\n", cmd.rx[0]);
+        else if(cmd.rxLen == cmd.replyLen + 2)
+            printf("bad cs in speed responses\n");
+        return (ret == SB_IOERROR) ? SB_IOERROR : SB_ERROR;
     }
-    readData(fd, buf+1, 7);
-
-    unsigned char sum = 0;
 
-    for(i=0; i<7; i++)
-        sum = (sum+buf[i]) & 0xFF;
+    for(i=0; i<NUM_THRUSTERS; i++)
+        codes[i] = cmd.rx[i+1];
 
-    if(sum != buf[7])
-    {
-        printf("bad cs: got %02x, expected %02x\n", sum, buf[7]);
-        return SB_ERROR;
-    }
+    return SB_OK;
+}
+
+int readSpeedResponses(int fd)
+{
+    unsigned char codes[NUM_THRUSTERS];
+    int i, ret, errCount=0;
 
-    int errCount=0;
+    ret = readSpeedResponseCodes(fd, codes);
+    if(ret != SB_OK)
+        return SB_ERROR;
 
-    for(i=0; i<6; i++)
-        if(buf[i+1] != 0x06)
+    for(i=0; i<NUM_THRUSTERS; i++)
+        if(codes[i] != SPEED_RESPONSE_ACK)
             errCount++;
 
     if(errCount != 0)
     {
-        printf("\t Got: %02x %02x %02x %02x %02x %02x\n", buf[1], buf[2], buf[3], buf[4], buf[5], buf[6]);
+        printf("\t Got: %02x %02x %02x %02x %02x %02x\n", codes[0], codes[1], codes[2], codes[3], codes[4], codes[5]);
         return SB_ERROR;
     }
 
@@ -649,68 +858,34 @@ int readSpeedResponses(int fd)
 
 int readMotorCurrents(int fd, struct powerInfo * info)
 {
-    unsigned char buf[20] = {HOST_CMD_IMOTOR, HOST_CMD_IMOTOR};
-    int i=0, cs=0;
+    struct sbCommand cmd;
+    int i, ret;
 
     if(info == NULL)
         return SB_ERROR;
 
-    writeData(fd, buf, 2);
-    readData(fd, buf, 1);
-
-    if(buf[0] != HOST_REPLY_IMOTOR)
-    {
-        if(buf[0] == 0xCC)
-            return SB_BADCC;
-        if(buf[0] == 0xDF)
-            return SB_HWFAIL;
-
-        return SB_ERROR;
-    }
-
-    readData(fd, buf+1, 17);
-
-    for(i=0; i<17; i++)
-        cs += buf[i];
-
-    if((cs & 0xFF) != buf[17])
-        return SB_BADCC;
+    ret = longRead(fd, HOST_CMD_IMOTOR, HOST_REPLY_IMOTOR, 16, &cmd);
+    if(ret != SB_OK)
+        return ret;
 
     for(i=0; i<8; i++)
-        info->motorCurrents[i] = ((buf[i*2+1] << 8) | (buf[i*2+2])) / 1000.0;
+        info->motorCurrents[i] = ((cmd.rx[i*2+1] << 8) | (cmd.rx[i*2+2])) / 1000.0;
 
     return SB_OK;
 }
 
 int readBoardVoltages(int fd, struct powerInfo * info)
 {
-    unsigned char buf[20] = {HOST_CMD_VLOW, HOST_CMD_VLOW};
-    int i=0, cs=0;
+    struct sbCommand cmd;
+    unsigned char * buf = cmd.rx;
+    int ret;
 
     if(info == NULL)
         return SB_ERROR;
 
-    writeData(fd, buf, 2);
-    readData(fd, buf, 1);
-
-    if(buf[0] != HOST_REPLY_VLOW)
-    {
-        if(buf[0] == 0xCC)
-            return SB_BADCC;
-        if(buf[0] == 0xDF)
-            return SB_HWFAIL;
-
-        return SB_ERROR;
-    }
-
-    readData(fd, buf+1, 11);
-
-
-    for(i=0; i<11; i++)
-        cs += buf[i];
-
-    if((cs & 0xFF) != buf[11])
-        return SB_BADCC;
+    ret = longRead(fd, HOST_CMD_VLOW, HOST_REPLY_VLOW, 10, &cmd);
+    if(ret != SB_OK)
+        return ret;
 
 
     info->v5VBus = ((buf[0*2+1] << 8) | (buf[0*2+2])) / 1000.0;
@@ -725,38 +900,20 @@ int readBoardVoltages(int fd, struct powerInfo * info)
 
 int readBatteryVoltages(int fd, struct powerInfo * info)
 {
-    unsigned char buf[18] = {HOST_CMD_BATTVOLTAGE, HOST_CMD_BATTVOLTAGE};
-    int i=0, cs=0;
+    struct sbCommand cmd;
+    unsigned char * buf = cmd.rx;
+    int i, ret;
 
     if(info == NULL)
         return SB_ERROR;
 
-    writeData(fd, buf, 2);
-    readData(fd, buf, 1);
-
-    if(buf[0] != HOST_REPLY_BATTVOLTAGE)
-    {
-
-        printf("\nbad reply!\n");
-
-        if(buf[0] == 0xCC)
-            return SB_BADCC;
-        if(buf[0] == 0xDF)
-            return SB_HWFAIL;
-
-        return SB_ERROR;
-    }
-
-    readData(fd, buf+1, 15);
-
-    for(i=0; i<15; i++)
-        cs += buf[i];
-
-    if((cs & 0xFF) != buf[15])
-    {
+    ret = longRead(fd, HOST_CMD_BATTVOLTAGE, HOST_REPLY_BATTVOLTAGE, 14, &cmd);
+    if(ret == SB_BADCC)
         printf("bad cs in voltages!\n");
-        return SB_BADCC;
-    }
+    else if(cmd.rxLen > 0 && buf[0] != HOST_REPLY_BATTVOLTAGE)
+        printf("\nbad reply!\n");
+    if(ret != SB_OK)
+        return ret;
 
     for(i=0; i<6; i++)
         info->battVoltages[i] = ((buf[i*2+1] << 8) | (buf[i*2+2])) / 1000.0;
@@ -768,38 +925,20 @@ int readBatteryVoltages(int fd, struct powerInfo * info)
 
 int readBatteryCurrents(int fd, struct powerInfo * info)
 {
-    unsigned char buf[14] = {HOST_CMD_BATTCURRENT, HOST_CMD_BATTCURRENT};
-    int i=0, cs=0;
+    struct sbCommand cmd;
+    unsigned char * buf = cmd.rx;
+    int i, ret;
 
     if(info == NULL)
         return SB_ERROR;
 
-    writeData(fd, buf, 2);
-    readData(fd, buf, 1);
-
-    if(buf[0] != HOST_REPLY_BATTCURRENT)
-    {
-
-        printf("\nbad reply!\n");
-
-        if(buf[0] == 0xCC)
-            return SB_BADCC;
-        if(buf[0] == 0xDF)
-            return SB_HWFAIL;
-
-        return SB_ERROR;
-    }
-
-    readData(fd, buf+1, 13);
-
-    for(i=0; i<13; i++)
-        cs += buf[i];
-
-    if((cs & 0xFF) != buf[13])
-    {
+    ret = longRead(fd, HOST_CMD_BATTCURRENT, HOST_REPLY_BATTCURRENT, 12, &cmd);
+    if(ret == SB_BADCC)
         printf("bad cc in currents!\n");
-        return SB_BADCC;
-    }
+    else if(cmd.rxLen > 0 && buf[0] != HOST_REPLY_BATTCURRENT)
+        printf("\nbad reply!\n");
+    if(ret != SB_OK)
+        return ret;
 
     for(i=0; i<6; i++)
         info->battCurrents[i] = ((buf[i*2+1] << 8) | (buf[i*2+2])) / 1000.0;
@@ -817,29 +956,21 @@ int setDiagnostics(int fd, int state)
 
 int readOvrParams(int fd, int * a, int * b)
 {
-    unsigned char buf[4];
+    struct sbCommand cmd;
+    int ret;
 
     if(a == NULL || b == NULL)
         return SB_ERROR;
 
-    buf[0] = HOST_CMD_READ_OVRLIMIT;
-    buf[1] = buf[0];
+    ret = longRead(fd, HOST_CMD_READ_OVRLIMIT, HOST_REPLY_OVRLIMIT, 2, &cmd);
+    if(ret == SB_BADCC)
+        printf("got cs: %02x, read: %02x\n",
+               (cmd.rx[0] + cmd.rx[1] + cmd.rx[2]) & 0xFF, cmd.rx[3]);
+    if(ret != SB_OK)
+        return ret;
 
-    writeData(fd, buf, 2);
-    readData(fd, buf, 1);
-
-    if(buf[0] != HOST_REPLY_OVRLIMIT)
-        return SB_ERROR;
-
-    readData(fd, buf+1, 3);
-
-    if(((buf[0] + buf[1] + buf[2]) & 0xFF) != buf[3])
-	{
-		printf("got cs: %02x, read: %02x\n", (buf[0] + buf[1] + buf[2]) & 0xFF, buf[3]);
-        return SB_BADCC;
-	}
-    *a = buf[1];
-    *b = buf[2];
+    *a = cmd.rx[1];
+    *b = cmd.rx[2];
 
     return SB_OK;
 }
@@ -850,44 +981,23 @@ int setOvrParams(int fd, int a, int b)
     if(a < 0 || a > 255 || b < 0 || b > 255)
         return -255;
 
-    unsigned char buf[4];
+    unsigned char buf[3];
     buf[0] = HOST_CMD_SET_OVRLIMIT;
     buf[1] = a;
 	buf[2] = b;
-    buf[3] = buf[0] + buf[1] + buf[2];
-
-    writeData(fd, buf, 4);
-    readData(fd, buf, 1);
-
-    if(buf[0] == 0xBC)
-        return SB_OK;
 
-    if(buf[0] == 0xCC)
-        return SB_BADCC;
-
-    if(buf[0] == 0xDF)
-        return SB_HWFAIL;
-
-    return SB_ERROR;
+    return sendCommand(fd, buf, 3);
 }
 
 
-int partialRead(int fd, struct boardInfo * info)
+/* Reads one item into info, returns the read's result code */
+static int readItem(int fd, enum partialUpdateType_ item,
+                    struct boardInfo * info)
 {
-    int retCode=0;
-    if(info == NULL)
-        return SB_ERROR;
-
-    // Increment to find out what we are updating this time
-    info->updateState++;
-
-    // Roll over based upon end of enum marker
-    if (END_OF_UPDATES == info->updateState)
-        info->updateState = STATUS;
+    int retCode=SB_ERROR;
 
-    switch(info->updateState)
+    switch(item)
     {
-        // Note STATUS == 1
         case STATUS:
         {
             info->status = retCode = readStatus(fd);
@@ -960,15 +1070,46 @@ int partialRead(int fd, struct boardInfo * info)
             break;
         }
 
-        default:
+        case DEPTH:
         {
-            printf("ERROR: update rolled over");
-            info->updateState = STATUS;
-            return SB_OK;
+            retCode = readDepth(fd);
+            // Keep the last good reading
+            if(retCode >= 0)
+                info->depth = retCode;
+            break;
         }
 
+        default:
+            break;
     }
 
+    return retCode;
+}
+
+
+int partialRead(int fd, struct boardInfo * info)
+{
+    int retCode=0;
+    if(info == NULL)
+        return SB_ERROR;
+
+    // Increment to find out what we are updating this time
+    info->updateState++;
+
+    // Roll over based upon end of enum marker
+    if (END_OF_UPDATES == info->updateState)
+        info->updateState = STATUS;
+
+    // Note STATUS == 1
+    if (info->updateState < STATUS || info->updateState >= END_OF_UPDATES)
+    {
+        printf("ERROR: update rolled over");
+        info->updateState = STATUS;
+        return SB_OK;
+    }
+
+    retCode = readItem(fd, info->updateState, info);
+
     // If we just updated the last item, we have finished an update cycle
     if((END_OF_UPDATES - 1) == info->updateState)
     {
@@ -985,11 +1126,171 @@ int partialRead(int fd, struct boardInfo * info)
 }
 
 
+static int isPollItem(int item)
+{
+    return (item >= STATUS && item < END_OF_UPDATES) || item == DEPTH;
+}
+
+void initPollSchedule(struct pollSchedule * sched)
+{
+    memset(sched, 0, sizeof(*sched));
+    sched->linkBudget = 1.0;
+    sched->lastItem = NO_UPDATE;
+    sched->statsStart = sched->linkFreeAt = monotonicTime();
+}
+
+int setPollRate(struct pollSchedule * sched, enum partialUpdateType_ item,
+                double rate)
+{
+    int i;
+    struct pollItem * p;
+
+    if(sched == NULL || !isPollItem(item) || rate < 0)
+        return SB_ERROR;
+
+    p = &(sched->items[item]);
+    if(p->targetRate == 0 && rate > 0)
+    {
+        // Start level with the rest, so nothing waits while it catches up
+        p->pass = -1;
+        for(i = 0; i < NUM_POLL_ITEMS; i++)
+        {
+            if(i != (int)item && sched->items[i].targetRate > 0 &&
+               (p->pass < 0 || sched->items[i].pass < p->pass))
+                p->pass = sched->items[i].pass;
+        }
+        if(p->pass < 0)
+            p->pass = 0;
+        p->nextDue = monotonicTime();
+    }
+    p->targetRate = rate;
+    return SB_OK;
+}
+
+/* Index of the item to read at time now, or NO_UPDATE if nothing is due */
+static int nextPollItem(const struct pollSchedule * sched, double now)
+{
+    int i, best = NO_UPDATE;
+
+    if(now < sched->linkFreeAt)
+        return NO_UPDATE;
+
+    for(i = 0; i < NUM_POLL_ITEMS; i++)
+    {
+        const struct pollItem * p = &(sched->items[i]);
+        if(p->targetRate <= 0 || p->nextDue > now)
+            continue;
+        if(best == NO_UPDATE || p->pass < sched->items[best].pass)
+            best = i;
+    }
+    return best;
+}
+
+int scheduledRead(int fd, struct pollSchedule * sched, struct boardInfo * info)
+{
+    int item, retCode;
+    double start, end, period;
+    struct pollItem * p;
+
+    if(sched == NULL || info == NULL)
+        return SB_ERROR;
+
+    start = monotonicTime();
+    item = nextPollItem(sched, start);
+    if(item == NO_UPDATE)
+        return SB_NOTDUE;
+
+    p = &(sched->items[item]);
+    retCode = readItem(fd, item, info);
+    end = monotonicTime();
+
+    sched->lastItem = item;
+    p->reads++;
+    if(retCode < 0)
+        p->errors++;
+    p->busyTime += end - start;
+
+    // A failed read still used its turn, retrying at once could starve the rest
+    period = 1.0 / p->targetRate;
+    p->pass += period;
+    p->nextDue += period;
+    // Fallen behind, what was missed is dropped rather than read in a burst
+    if(p->nextDue < end)
+        p->nextDue = end;
+
+    if(sched->linkBudget > 0 && sched->linkBudget < 1)
+        sched->linkFreeAt = end + (end - start) * (1 / sched->linkBudget - 1);
+
+    if(retCode < 0)
+        return retCode;
+    return SB_OK;
+}
+
+double pollWaitTime(const struct pollSchedule * sched)
+{
+    int i, scheduled = 0;
+    double due = 0, now = monotonicTime();
+
+    for(i = 0; i < NUM_POLL_ITEMS; i++)
+    {
+        const struct pollItem * p = &(sched->items[i]);
+        if(p->targetRate <= 0)
+            continue;
+        if(!scheduled || p->nextDue < due)
+            due = p->nextDue;
+        scheduled = 1;
+    }
+
+    if(!scheduled)
+        return -1;
+    if(due < sched->linkFreeAt)
+        due = sched->linkFreeAt;
+    return (due > now) ? due - now : 0;
+}
+
+void getPollStats(const struct pollSchedule * sched,
+                  enum partialUpdateType_ item, struct pollStats * stats)
+{
+    const struct pollItem * p;
+    double elapsed;
+
+    memset(stats, 0, sizeof(*stats));
+    if(sched == NULL || !isPollItem(item))
+        return;
+
+    p = &(sched->items[item]);
+    elapsed = monotonicTime() - sched->statsStart;
+    stats->targetRate = p->targetRate;
+    if(elapsed > 0)
+    {
+        stats->achievedRate = (p->reads - p->errors) / elapsed;
+        stats->errorRate = p->errors / elapsed;
+        stats->linkShare = p->busyTime / elapsed;
+    }
+    if(p->reads > 0)
+        stats->readTime = p->busyTime / p->reads;
+}
+
+void resetPollStats(struct pollSchedule * sched)
+{
+    int i;
+
+    for(i = 0; i < NUM_POLL_ITEMS; i++)
+    {
+        sched->items[i].reads = 0;
+        sched->items[i].errors = 0;
+        sched->items[i].busyTime = 0;
+    }
+    sched->statsStart = monotonicTime();
+}
+
+
 /* Some code from cutecom, which in turn may have come from minicom */
 /* FUGLY but it does what I want */
 int openSensorBoard(const char * devName)
 {
-   int fd = open(devName, O_RDWR, O_ASYNC); // | O_ASYNC); //, O_RDWR, O_NONBLOCK);
+   /* Non-blocking, every command waits on poll() with a deadline instead */
+   int fd = open(devName, O_RDWR | O_NONBLOCK);
 
     if(fd == -1)
         return -1;
@@ -1018,8 +1319,8 @@ int openSensorBoard(const char * devName)
     newtio.c_oflag=0;
 
 
-    newtio.c_cc[VTIME]=1;
-    newtio.c_cc[VMIN]=60;
+    newtio.c_cc[VTIME]=0;
+    newtio.c_cc[VMIN]=0;
 
 //   tcflush(m_fd, TCIFLUSH);
     if (tcsetattr(fd, TCSANOW, &newtio)!=0)
@@ -1049,10 +1350,12 @@ char* sbErrorToText(int ret)
         "Bad CRC",
         "Hardware failure",
         "Error",
-        "OK"
+        "OK",
+        "Update done",
+        "Nothing due"
     };
 
-    if ((ret >= -4) && (ret <= 0))
+    if ((ret >= -4) && (ret <= SB_NOTDUE))
         return toText[ret + 4];
     else
         return "Unknown";
@@ -1167,258 +1470,81 @@ int setServoPosition(int fd, unsigned char servoNumber, unsigned short position)
 
 int DVLOn(int fd, unsigned char power)
 {
-    unsigned char buf[2];
-    if(power) {
-        buf[0]= buf[1]= HOST_CMD_DVL_ON;
-    } else {
-        buf[0]= buf[1]= HOST_CMD_DVL_OFF;
-    }
-    writeData(fd, buf, 2);
-    readData(fd, buf, 1);
-
-    if(buf[0] == HOST_REPLY_SUCCESS)
-        return SB_OK;
-
-    if(buf[0] == HOST_REPLY_BADCHKSUM)
-        return SB_BADCC;
-
-    if(buf[0] == HOST_REPLY_FAILURE)
-        return SB_HWFAIL;
-
-    return SB_ERROR;
+    return simpleCommand(fd, power ? HOST_CMD_DVL_ON : HOST_CMD_DVL_OFF);
 }
 
 int fireTorpedo(int fd, unsigned char torpnum)
 {
-    unsigned char buf[2];
-    if(torpnum == 1) {
-        buf[0]= buf[1]= HOST_CMD_FIRE_TORP_1;
-    } else if(torpnum == 2) {
-        buf[0]= buf[1]= HOST_CMD_FIRE_TORP_2;
-    } else {
-        return SB_ERROR;
-    }
-
-    writeData(fd, buf, 2);
-    readData(fd, buf, 1);
-
-    if(buf[0] == HOST_REPLY_SUCCESS)
-        return SB_OK;
-
-    if(buf[0] == HOST_REPLY_BADCHKSUM)
-        return SB_BADCC;
-
-    if(buf[0] == HOST_REPLY_FAILURE)
-        return SB_HWFAIL;
-
+    if(torpnum == 1)
+        return simpleCommand(fd, HOST_CMD_FIRE_TORP_1);
+    if(torpnum == 2)
+        return simpleCommand(fd, HOST_CMD_FIRE_TORP_2);
     return SB_ERROR;
 }
 
 int voidTorpedo(int fd, unsigned char torpnum)
 {
-    unsigned char buf[2];
-    if(torpnum == 1) {
-        buf[0]= buf[1]= HOST_CMD_VOID_TORP_1;
-    } else if(torpnum == 2) {
-        buf[0]= buf[1]= HOST_CMD_VOID_TORP_2;
-    } else {
-        return SB_ERROR;
-    }
-
-    writeData(fd, buf, 2);
-    readData(fd, buf, 1);
-
-    if(buf[0] == HOST_REPLY_SUCCESS)
-        return SB_OK;
-
-    if(buf[0] == HOST_REPLY_BADCHKSUM)
-        return SB_BADCC;
-
-    if(buf[0] == HOST_REPLY_FAILURE)
-        return SB_HWFAIL;
-
+    if(torpnum == 1)
+        return simpleCommand(fd, HOST_CMD_VOID_TORP_1);
+    if(torpnum == 2)
+        return simpleCommand(fd, HOST_CMD_VOID_TORP_2);
     return SB_ERROR;
 }
 
 int armTorpedo(int fd, unsigned char torpnum)
 {
-    unsigned char buf[2];
-    if(torpnum == 1) {
-        buf[0]= buf[1]= HOST_CMD_ARM_TORP_1;
-    } else if(torpnum == 2) {
-        buf[0]= buf[1]= HOST_CMD_ARM_TORP_2;
-    } else {
-        return SB_ERROR;
-    }
-
-    writeData(fd, buf, 2);
-    readData(fd, buf, 1);
-
-    if(buf[0] == HOST_REPLY_SUCCESS)
-        return SB_OK;
-
-    if(buf[0] == HOST_REPLY_BADCHKSUM)
-        return SB_BADCC;
-
-    if(buf[0] == HOST_REPLY_FAILURE)
-        return SB_HWFAIL;
-
+    if(torpnum == 1)
+        return simpleCommand(fd, HOST_CMD_ARM_TORP_1);
+    if(torpnum == 2)
+        return simpleCommand(fd, HOST_CMD_ARM_TORP_2);
     return SB_ERROR;
 }
 
 //Kanga - Allowing for separate grabber extension
 int extendGrabber(int fd, int param)
 {
-    unsigned char buf[2];
-
     switch(param)
     {
-        case 0: 
-        {
-            buf[0]= buf[1]= HOST_CMD_EXT_GRABBER; 
-            break;
-        }
-        case 1: 
-        {
-            buf[0]= buf[1]= HOST_CMD_EXT_GRABBER_1; 
-            break;
-        }
-        case 2: 
-        {
-            buf[0]= buf[1]= HOST_CMD_EXT_GRABBER_2; 
-            break;
-        }
+        case 0:
+            return simpleCommand(fd, HOST_CMD_EXT_GRABBER);
+        case 1:
+            return simpleCommand(fd, HOST_CMD_EXT_GRABBER_1);
+        case 2:
+            return simpleCommand(fd, HOST_CMD_EXT_GRABBER_2);
     }
 
-    writeData(fd, buf, 2);
-    readData(fd, buf, 1);
-
-    if(buf[0] == HOST_REPLY_SUCCESS)
-        return SB_OK;
-
-    if(buf[0] == HOST_REPLY_BADCHKSUM)
-        return SB_BADCC;
-
-    if(buf[0] == HOST_REPLY_FAILURE)
-        return SB_HWFAIL;
-
     return SB_ERROR;
 }
 
 int retractGrabber(int fd)
 {
-    unsigned char buf[2];
-
-    buf[0]= buf[1]= HOST_CMD_RET_GRABBER;
-
-    writeData(fd, buf, 2);
-    readData(fd, buf, 1);
-
-    if(buf[0] == HOST_REPLY_SUCCESS)
-        return SB_OK;
-
-    if(buf[0] == HOST_REPLY_BADCHKSUM)
-        return SB_BADCC;
-
-    if(buf[0] == HOST_REPLY_FAILURE)
-        return SB_HWFAIL;
-
-    return SB_ERROR;
+    return simpleCommand(fd, HOST_CMD_RET_GRABBER);
 }
 
 int voidGrabber(int fd)
 {
-    unsigned char buf[2];
-
-    buf[0]= buf[1]= HOST_CMD_VOID_GRABBER;
-
-    writeData(fd, buf, 2);
-    readData(fd, buf, 1);
-
-    if(buf[0] == HOST_REPLY_SUCCESS)
-        return SB_OK;
-
-    if(buf[0] == HOST_REPLY_BADCHKSUM)
-        return SB_BADCC;
-
-    if(buf[0] == HOST_REPLY_FAILURE)
-        return SB_HWFAIL;
-
-    return SB_ERROR;
+    return simpleCommand(fd, HOST_CMD_VOID_GRABBER);
 }
 
 int voidSystem(int fd)
 {
-    unsigned char buf[2];
-
-    buf[0]= buf[1]= HOST_CMD_VOID_PNEU;
-
-    writeData(fd, buf, 2);
-    readData(fd, buf, 1);
-
-    if(buf[0] == HOST_REPLY_SUCCESS)
-        return SB_OK;
-
-    if(buf[0] == HOST_REPLY_BADCHKSUM)
-        return SB_BADCC;
-
-    if(buf[0] == HOST_REPLY_FAILURE)
-        return SB_HWFAIL;
-
-    return SB_ERROR;
+    return simpleCommand(fd, HOST_CMD_VOID_PNEU);
 }
 
 int pneumaticsOff(int fd)
 {
-    unsigned char buf[2];
-
-    buf[0]= buf[1]= HOST_CMD_OFF_PNEU;
-
-    writeData(fd, buf, 2);
-    readData(fd, buf, 1);
-
-    if(buf[0] == HOST_REPLY_SUCCESS)
-        return SB_OK;
-
-    if(buf[0] == HOST_REPLY_BADCHKSUM)
-        return SB_BADCC;
-
-    if(buf[0] == HOST_REPLY_FAILURE)
-        return SB_HWFAIL;
-
-    return SB_ERROR;
+    return simpleCommand(fd, HOST_CMD_OFF_PNEU);
 }
 
 /* if (on == 1) it will turn derpy on, otherwise it will turn derpy off */
 int setDerpyPower(int fd, unsigned char on)
 {
-    unsigned char buf[2];
-
-    if(on == 1) {
-        buf[0]= buf[1]= HOST_CMD_DERPY_ON;
-    } else {
-        buf[0]= buf[1]= HOST_CMD_DERPY_OFF;
-    }
-
-    writeData(fd, buf, 2);
-    readData(fd, buf, 1);
-
-    if(buf[0] == HOST_REPLY_SUCCESS)
-        return SB_OK;
-
-    if(buf[0] == HOST_REPLY_BADCHKSUM)
-        return SB_BADCC;
-
-    if(buf[0] == HOST_REPLY_FAILURE)
-        return SB_HWFAIL;
-
-    return SB_ERROR;
+    return simpleCommand(fd, (on == 1) ? HOST_CMD_DERPY_ON : HOST_CMD_DERPY_OFF);
 }
 
 int setDerpySpeed(int fd, int speed)
 {
-    int i;
-    unsigned char buf[8];
+    unsigned char buf[7];
 
     buf[0]= HOST_CMD_SET_DERPY;
     buf[1]= (speed >> 8);
@@ -1427,85 +1553,22 @@ int setDerpySpeed(int fd, int speed)
     buf[4]= 'E';
     buf[5]= 'R';
     buf[6]= 'P';
-    buf[7]= 0; // zero out the checksum
-
-    for(i= 0;i < 7;++i)
-        buf[7]+= buf[i];
-
-    writeData(fd, buf, 8);
-    readData(fd, buf, 1);
-
-    if(buf[0] == HOST_REPLY_SUCCESS)
-        return SB_OK;
-
-    if(buf[0] == HOST_REPLY_BADCHKSUM)
-        return SB_BADCC;
-
-    if(buf[0] == HOST_REPLY_FAILURE)
-        return SB_HWFAIL;
 
-    return SB_ERROR;
+    return sendCommand(fd, buf, 7);
 }
 
 int stopDerpy(int fd)
 {
-    unsigned char buf[2];
-
-    buf[0]= buf[1]= HOST_CMD_STOP_DERPY;
-
-    writeData(fd, buf, 2);
-    readData(fd, buf, 1);
-
-    if(buf[0] == HOST_REPLY_SUCCESS)
-        return SB_OK;
-
-    if(buf[0] == HOST_REPLY_BADCHKSUM)
-        return SB_BADCC;
-
-    if(buf[0] == HOST_REPLY_FAILURE)
-        return SB_HWFAIL;
-
-    return SB_ERROR;
+    return simpleCommand(fd, HOST_CMD_STOP_DERPY);
 }
 
 /*Turn the camera connection on or off.
   kanga 7/2/2013*/
 
 int camConnect(int fd){
-    unsigned char buf [2];
-
-    buf[0] = buf[1] = HOST_CMD_CAM_RELAY_ON;
-    writeData(fd, buf, 2);
-    readData(fd, buf, 1);
-
-    if(buf[0] == HOST_REPLY_SUCCESS)
-        return SB_OK;
-
-    if(buf[0] == HOST_REPLY_BADCHKSUM)
-        return SB_BADCC;
-
-    if(buf[0] == HOST_REPLY_FAILURE)
-        return SB_HWFAIL;
-
-    return SB_ERROR;
+    return simpleCommand(fd, HOST_CMD_CAM_RELAY_ON);
 }
 
 int camDisconnect(int fd){
-    unsigned char buf[2];
-    
-    buf[0]=buf[1]= HOST_CMD_CAM_RELAY_OFF;
-
-    writeData(fd, buf, 2);
-    readData(fd, buf, 1);
-
-    if(buf[0] == HOST_REPLY_SUCCESS)
-        return SB_OK;
-
-    if(buf[0] == HOST_REPLY_BADCHKSUM)
-        return SB_BADCC;
-
-    if(buf[0] == HOST_REPLY_FAILURE)
-        return SB_HWFAIL;
-
-    return SB_ERROR;
-} 
+    return simpleCommand(fd, HOST_CMD_CAM_RELAY_OFF);
+}
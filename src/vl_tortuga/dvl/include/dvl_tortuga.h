@@ -13,6 +13,8 @@ class DVLTortugaNode : public RamNode {
     DVLTortugaNode(std::shared_ptr<ros::NodeHandle>, int rate, int fd ,  std::string file_name);
     ~DVLTortugaNode();
 
+	// publishes every frame that has arrived, without waiting for more.
+	// main waits on the fd and calls this when there is something to read
 	void update();
 	bool checkError(int e);
 
@@ -25,6 +27,9 @@ protected:
   // What the dvl api gives
 	RawDVLData raw;
 	CompleteDVLPacket *pkt;
+	DVLReader reader;
+
+	void publish();
 };
 
 #endif
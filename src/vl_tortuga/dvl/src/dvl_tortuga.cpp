@@ -4,8 +4,10 @@ DVLTortugaNode::DVLTortugaNode(std::shared_ptr<ros::NodeHandle> n, int rate, int
     
     publisher = n->advertise<geometry_msgs::TwistWithCovarianceStamped>("tortuga/dvl", 1000);
 	ROS_DEBUG("Set up publisher");
+    setRate(rate);
     fd = board_fd;
     file = board_file;
+    initDVLReader(&reader, fd);
     
     //intitialize all the message fields so no one gets upset if we send a message before getting good data. 
     msg.header.frame_id = "base_link";
@@ -30,8 +32,19 @@ DVLTortugaNode::~DVLTortugaNode(){}
 void DVLTortugaNode::update(){
 //	ros::spinOnce();
 
-    checkError(readDVLData(fd, &raw));
-	ROS_DEBUG("Read DVL Data");
+    // Keep going until the reader runs out of whole frames, a bad frame
+    // doesn't mean there isn't a good one behind it
+    int ret;
+    while((ret = readDVLData(&reader, &raw)) != ERR_NOFRAME && ret != ERR_IO){
+        if(!checkError(ret)){
+            ROS_DEBUG("Read DVL Data");
+            publish();
+        }
+    }
+    checkError(ret);
+}
+
+void DVLTortugaNode::publish(){
     // Raw data has a pointer to complete packet
     pkt = raw.privDbgInf;
     if(raw.xvel_btm == DVL_BAD_DATA || raw.yvel_btm == DVL_BAD_DATA || raw.zvel_btm == DVL_BAD_DATA){
@@ -71,9 +84,17 @@ bool DVLTortugaNode::checkError(int e) {
     case ERR_TOOBIG:
         ROS_ERROR("TOOBIG ERROR in node %s", file.c_str());
       return true;
+    case ERR_TOOSMALL:
+        ROS_ERROR("TOOSMALL ERROR in node %s", file.c_str());
+        return true;
     case ERR_CHKSUM:
         ROS_ERROR("CHKSUM ERROR in node %s", file.c_str());
         return true;
+    case ERR_IO:
+        ROS_ERROR("IO ERROR in node %s", file.c_str());
+        return true;
+    case ERR_NOFRAME:
+        return true;
     default:
         return false;
     }
@@ -1,5 +1,7 @@
 #include "dvl_tortuga.h"
 
+#include <poll.h>
+
 int main(int argc, char **argv){
 
   // initialize ros node for the DVL
@@ -27,9 +29,19 @@ int main(int argc, char **argv){
       exit(1);
     }
 
+    // Publish as each frame arrives rather than on a timer, the timeout
+    // just keeps checking ros::ok() if the DVL goes quiet
+    struct pollfd pfd = {fd, POLLIN, 0};
     while (ros::ok()) {
-      
-	ros::Duration(.1).sleep();
+	if (poll(&pfd, 1, 100) <= 0) {
+	    continue;
+	}
+	// A hung up tty polls readable with nothing to read, forever. Nothing
+	// more is coming, so give up and let the node be respawned
+	if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+	    ROS_ERROR("Lost the DVL on %s (revents 0x%x)", dvl_file.c_str(), pfd.revents);
+	    return 1;
+	}
 	ROS_DEBUG("DVLMAIN: calling update");
 	dvl_node->update();
     }
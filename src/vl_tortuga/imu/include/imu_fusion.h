@@ -0,0 +1,92 @@
+#ifndef IMU_FUSION_HEADER
+#define IMU_FUSION_HEADER
+
+#include "imuapi.h"
+
+#include "ros/ros.h"
+#include "sensor_msgs/Imu.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+/* Fuses every IMU on the vehicle into one attitude estimate on tortuga/imu/fused.
+   It runs in the IMU node's process, the nodes hand it each frame they read.
+
+   Each IMU's sampleTimer is mapped onto ROS time, and readings from different IMUs
+   taken within half a sample of each other are combined axis by axis, weighted by
+   the inverse of each one's noise. A reading far outside its recent spread is left
+   out of that axis. The combined gyro, accel and mag then drive a Kalman filter on
+   each of roll, pitch and yaw, which is where the covariances come from.
+
+   The IMUs are assumed to be mounted with their axes lined up.
+*/
+class ImuFusion {
+
+public:
+	//frame_id is the frame the fused messages are stamped in, the vehicle body
+	ImuFusion(std::shared_ptr<ros::NodeHandle> n, int num_imus, std::string frame_id);
+
+	//takes a frame from IMU number imu, arrival is when the node read it
+	void addSample(int imu, const RawIMUData &data, ros::Time arrival);
+
+protected:
+	//gyro xyz, accel xyz, mag xyz
+	static const int AXES = 9;
+	typedef std::array<double, AXES> Axes;
+
+	//maps an IMU's 16 bit sampleTimer onto ROS time
+	struct SampleClock {
+		bool started = false;
+		int last_raw = 0;
+		long long ticks = 0;        //sampleTimer, unwrapped
+		double first_arrival = 0;
+		double last_arrival = 0;
+		double period = 0;          //seconds per tick, 0 until there's a second of frames
+		double bias = 0;            //the least delayed arrival's offset from the tick clock
+
+		//the time the sample was taken, as near as the timer says
+		double stamp(int raw, double arrival);
+	};
+
+	struct Source {
+		SampleClock clock;
+		double last_arrival = -1;
+		double last_stamp = 0;
+		double interval = 0;        //average time between samples
+
+		bool pending = false;       //a reading waiting for the other IMUs'
+		double pending_time = 0;
+		Axes pending_values;
+
+		//noise per axis, half the average squared step between accepted readings
+		bool have_accepted = false;
+		Axes accepted;
+		Axes noise_var;
+		std::array<int, AXES> rejected_run;
+	};
+
+	std::vector<Source> sources;
+
+	//last combined reading
+	bool have_fused = false;
+	Axes fused, fused_var;
+
+	//attitude filter, roll pitch yaw in radians
+	bool have_attitude = false;
+	double attitude_time = 0;
+	std::array<double, 3> angle, angle_var;
+
+	sensor_msgs::Imu msg;
+	unsigned int id = 0;
+	ros::Publisher fusedPub;
+
+	double alignWindow() const;
+	void fuse(const std::vector<int> &group);
+	void combine(const std::vector<int> &group);
+	void updateAttitude(double time);
+	void correct(int axis, double measured, double measured_var);
+	void publish(double time);
+};
+
+#endif
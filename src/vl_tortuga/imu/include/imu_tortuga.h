@@ -3,6 +3,7 @@
 
 #include "ram_node.h"
 #include "imuapi.h"
+#include "imu_fusion.h"
 
 #include "sensor_msgs/Imu.h"
 #include "std_msgs/Float64MultiArray.h"
@@ -24,9 +25,20 @@ public:
 	ImuTortugaNode(std::shared_ptr<ros::NodeHandle>, int, std::string name, std::string device);
 	~ImuTortugaNode();
 
+	// publishes every frame that has arrived, without waiting for more.
+	// main waits on fd() and calls this when there is something to read
 	void update();
 	void imuCallBack(const sensor_msgs::Imu sim_msg);
 
+	int getFd() const { return fd; }
+	const std::string &getName() const { return name; }
+
+	// closes the IMU, update() stops reading it from then on
+	void closeDevice();
+
+	//also hands every frame to fusion, as IMU number index
+	void setFusion(std::shared_ptr<ImuFusion> fusion, int index);
+
 protected:
 
 	unsigned int id = 0;
@@ -35,6 +47,14 @@ protected:
 
 	//struct used to retrieve data from IMU
 	RawIMUData data;
+	IMUReader reader;
+
+	//when the last good frame came in, and the counts last reported
+	ros::Time last_frame;
+	unsigned long reported_bad = 0, reported_lost = 0;
+
+	std::shared_ptr<ImuFusion> fusion;
+	int fusion_index = 0;
 
 	//messages
 	sensor_msgs::Imu msg;
@@ -49,12 +69,16 @@ protected:
 	ros::Subscriber subscriberPub;
 	ros::Publisher magnetsPub;
 
+	void publish();
+
 	// JW: the read method only seems to return a bool
 	// telling us whether the  checksum is valid
 	bool checkError(int e) {
-        if(!e){
+        if(e < 0){
 			ROS_DEBUG("IO ERROR in IMU node %s", name.c_str());
+			return true;
 		}
+		return false;
     }
 };
 
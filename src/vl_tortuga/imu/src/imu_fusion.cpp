@@ -0,0 +1,327 @@
+#include "imu_fusion.h"
+
+#include "tf/transform_datatypes.h"
+
+#include <algorithm>
+#include <cmath>
+
+#define G_IN_MS2 9.80665
+
+//a reading further than this many standard deviations from the last combined
+//one is left out, unless it has been left out this many times in a row, then
+//it is more likely the vehicle really moved
+static const double OUTLIER_SIGMAS = 5.0;
+static const int MAX_REJECTED_RUN = 5;
+
+//lower bounds on the noise estimates, so a quiet sensor can't take all the weight
+static const double NOISE_FLOOR[3] = {
+	1e-6,   //gyro, (rad/s)^2
+	1e-6,   //accel, g^2
+	1e-6    //mag, gauss^2
+};
+
+//an IMU that hasn't sent anything in this long isn't waited for
+static const double STALE_TIME = 0.5;
+
+//how quickly the averages follow new samples
+static const double AVERAGE_WEIGHT = 0.02;
+
+//extra attitude uncertainty per second, for gyro bias and the model
+static const double ATTITUDE_PROCESS_VAR = 1e-4;
+
+//how much less the accelerometer is trusted per g^2 it is away from 1 g,
+//anything else means the vehicle is accelerating
+static const double ACCEL_DYNAMIC_VAR = 1.0;
+
+static double wrapAngle(double a) {
+	return atan2(sin(a), cos(a));
+}
+
+static void toAxes(const RawIMUData &d, std::array<double, 9> &axes) {
+	axes = {{d.gyroX, d.gyroY, d.gyroZ, d.accelX, d.accelY, d.accelZ, d.magX, d.magY, d.magZ}};
+}
+
+double ImuFusion::SampleClock::stamp(int raw, double arrival) {
+	//a gap long enough to hide a timer wrap, start over
+	if (started && period > 0 && arrival - last_arrival > 0.5 * 65536 * period) {
+		started = false;
+	}
+	if (!started) {
+		started = true;
+		last_raw = raw;
+		ticks = 0;
+		first_arrival = last_arrival = arrival;
+		period = 0;
+		bias = 0;
+		return arrival;
+	}
+
+	ticks += (raw - last_raw) & 0xFFFF;
+	last_raw = raw;
+	last_arrival = arrival;
+
+	//the latency in the arrival times averages out over the span
+	double span = arrival - first_arrival;
+	if (span < 1.0 || ticks == 0) {
+		return arrival;
+	}
+	bool calibrated = period > 0;
+	period = span / ticks;
+
+	//the frame that got here quickest is closest to the truth, let the
+	//bias creep back up so it follows the timer if it drifts
+	double offset = arrival - (first_arrival + ticks * period);
+	if (!calibrated || offset < bias) {
+		bias = offset;
+	} else {
+		bias += (offset - bias) * AVERAGE_WEIGHT;
+	}
+	return first_arrival + ticks * period + bias;
+}
+
+ImuFusion::ImuFusion(std::shared_ptr<ros::NodeHandle> n, int num_imus, std::string frame_id) : sources(num_imus) {
+	fusedPub = n->advertise<sensor_msgs::Imu>("tortuga/imu/fused", 1000);
+
+	for (Source &s : sources) {
+		s.noise_var.fill(0);
+		s.rejected_run.fill(0);
+	}
+	angle.fill(0);
+	angle_var.fill(0);
+	msg.header.frame_id = frame_id;
+}
+
+void ImuFusion::addSample(int imu, const RawIMUData &data, ros::Time arrival) {
+	if (imu < 0 || imu >= (int) sources.size() || !data.checksumValid) {
+		return;
+	}
+	Source &s = sources[imu];
+	double now = arrival.toSec();
+	double time = s.clock.stamp(data.sampleTimer, now);
+
+	if (s.last_arrival >= 0 && time > s.last_stamp) {
+		double step = time - s.last_stamp;
+		s.interval = (s.interval > 0) ? s.interval + (step - s.interval) * AVERAGE_WEIGHT : step;
+	}
+	s.last_arrival = now;
+	s.last_stamp = time;
+
+	//the last one never found a partner
+	if (s.pending) {
+		fuse({imu});
+	}
+	s.pending = true;
+	s.pending_time = time;
+	toAxes(data, s.pending_values);
+
+	//nor will anything this far behind
+	double window = alignWindow();
+	for (int i = 0; i < (int) sources.size(); i++) {
+		if (i != imu && sources[i].pending && sources[i].pending_time < time - window) {
+			fuse({i});
+		}
+	}
+
+	//once every IMU that is still talking has a reading in, combine them
+	std::vector<int> group;
+	for (int i = 0; i < (int) sources.size(); i++) {
+		if (sources[i].pending) {
+			group.push_back(i);
+		} else if (sources[i].last_arrival >= 0 && now - sources[i].last_arrival < STALE_TIME) {
+			return;
+		}
+	}
+	fuse(group);
+}
+
+double ImuFusion::alignWindow() const {
+	double interval = 0;
+	for (const Source &s : sources) {
+		if (s.interval > 0 && (interval == 0 || s.interval < interval)) {
+			interval = s.interval;
+		}
+	}
+	return (interval > 0) ? interval / 2 : 0.005;
+}
+
+void ImuFusion::fuse(const std::vector<int> &group) {
+	if (group.empty()) {
+		return;
+	}
+	double time = 0;
+	for (int i : group) {
+		time += sources[i].pending_time;
+	}
+	time /= group.size();
+
+	combine(group);
+	for (int i : group) {
+		sources[i].pending = false;
+	}
+	updateAttitude(time);
+	publish(time);
+}
+
+void ImuFusion::combine(const std::vector<int> &group) {
+	Axes combined, combined_var;
+
+	for (int axis = 0; axis < AXES; axis++) {
+		double floor = NOISE_FLOOR[axis / 3];
+		double weight_sum = 0, sum = 0;
+		int closest = -1;
+		double closest_dist = 0;
+		std::vector<int> accepted;
+
+		for (int i : group) {
+			Source &s = sources[i];
+			double value = s.pending_values[axis];
+			double var = std::max(s.noise_var[axis], floor);
+			double dist = have_fused ? fabs(value - fused[axis]) : 0;
+
+			if (closest < 0 || dist < closest_dist) {
+				closest = i;
+				closest_dist = dist;
+			}
+			//until there is a spread to judge by, take everything
+			if (!have_fused || !s.have_accepted || dist <= OUTLIER_SIGMAS * sqrt(2 * var + fused_var[axis])
+					|| s.rejected_run[axis] >= MAX_REJECTED_RUN) {
+				accepted.push_back(i);
+			} else {
+				s.rejected_run[axis]++;
+			}
+		}
+		//never leave an axis empty
+		if (accepted.empty()) {
+			accepted.push_back(closest);
+		}
+
+		for (int i : accepted) {
+			Source &s = sources[i];
+			double value = s.pending_values[axis];
+			if (s.have_accepted) {
+				double step = value - s.accepted[axis];
+				s.noise_var[axis] += (step * step / 2 - s.noise_var[axis]) * AVERAGE_WEIGHT;
+			}
+			s.rejected_run[axis] = 0;
+
+			double weight = 1 / std::max(s.noise_var[axis], floor);
+			weight_sum += weight;
+			sum += weight * value;
+		}
+		combined[axis] = sum / weight_sum;
+		combined_var[axis] = 1 / weight_sum;
+	}
+
+	for (int i : group) {
+		Source &s = sources[i];
+		for (int axis = 0; axis < AXES; axis++) {
+			if (s.rejected_run[axis] == 0) {
+				s.accepted[axis] = s.pending_values[axis];
+			}
+		}
+		s.have_accepted = true;
+	}
+	fused = combined;
+	fused_var = combined_var;
+	have_fused = true;
+}
+
+void ImuFusion::updateAttitude(double time) {
+	double ax = fused[3], ay = fused[4], az = fused[5];
+	double mx = fused[6], my = fused[7], mz = fused[8];
+
+	if (have_attitude) {
+		double dt = time - attitude_time;
+		if (dt > 0 && dt < STALE_TIME) {
+			//body rates to euler angle rates
+			double r = angle[0], p = angle[1];
+			double gx = fused[0], gy = fused[1], gz = fused[2];
+			double cp = std::max(cos(p), 1e-3);
+			double rates[3] = {
+				gx + (sin(r) * gy + cos(r) * gz) * tan(p),
+				cos(r) * gy - sin(r) * gz,
+				(sin(r) * gy + cos(r) * gz) / cp
+			};
+			for (int i = 0; i < 3; i++) {
+				angle[i] = wrapAngle(angle[i] + rates[i] * dt);
+				angle_var[i] += fused_var[i] * dt * dt + ATTITUDE_PROCESS_VAR * dt;
+			}
+		}
+	}
+	attitude_time = std::max(attitude_time, time);
+
+	//roll and pitch from gravity, trusted less the further it is from 1 g
+	double horizontal = ay * ay + az * az;
+	double norm = sqrt(ax * ax + horizontal);
+	if (horizontal > 1e-6 && norm > 1e-3) {
+		double dynamic = ACCEL_DYNAMIC_VAR * (norm - 1) * (norm - 1);
+		double roll = atan2(ay, az);
+		double pitch = atan2(-ax, sqrt(horizontal));
+		double roll_var = (fused_var[4] + fused_var[5]) / horizontal + dynamic;
+		double pitch_var = (fused_var[3] + fused_var[4] + fused_var[5]) / (norm * norm) + dynamic;
+		if (!have_attitude) {
+			angle[0] = roll;
+			angle[1] = pitch;
+			angle_var[0] = roll_var;
+			angle_var[1] = pitch_var;
+		} else {
+			correct(0, roll, roll_var);
+			correct(1, pitch, pitch_var);
+		}
+	}
+
+	//yaw from the field, levelled with the current roll and pitch
+	double r = angle[0], p = angle[1];
+	double hx = mx * cos(p) + my * sin(r) * sin(p) + mz * cos(r) * sin(p);
+	double hy = my * cos(r) - mz * sin(r);
+	double field = hx * hx + hy * hy;
+	if (field > 1e-6) {
+		double yaw = atan2(-hy, hx);
+		double yaw_var = (fused_var[6] + fused_var[7] + fused_var[8]) / field;
+		if (!have_attitude) {
+			angle[2] = yaw;
+			angle_var[2] = yaw_var;
+		} else {
+			correct(2, yaw, yaw_var);
+		}
+	}
+
+	if (!have_attitude && horizontal > 1e-6 && field > 1e-6) {
+		have_attitude = true;
+	}
+}
+
+void ImuFusion::correct(int axis, double measured, double measured_var) {
+	double gain = angle_var[axis] / (angle_var[axis] + measured_var);
+	angle[axis] = wrapAngle(angle[axis] + gain * wrapAngle(measured - angle[axis]));
+	angle_var[axis] *= 1 - gain;
+}
+
+void ImuFusion::publish(double time) {
+	if (!have_attitude) {
+		return;
+	}
+	msg.header.stamp = ros::Time(time);
+	msg.header.seq = ++id;
+
+	msg.orientation = tf::createQuaternionMsgFromRollPitchYaw(angle[0], angle[1], angle[2]);
+	msg.angular_velocity.x = fused[0];
+	msg.angular_velocity.y = fused[1];
+	msg.angular_velocity.z = fused[2];
+	// Our IMU returns values in G's, but we should be publishing in m/s^2
+	msg.linear_acceleration.x = fused[3] * G_IN_MS2;
+	msg.linear_acceleration.y = fused[4] * G_IN_MS2;
+	msg.linear_acceleration.z = fused[5] * G_IN_MS2;
+
+	//diagonal, the axes are combined independently
+	msg.orientation_covariance.fill(0);
+	msg.angular_velocity_covariance.fill(0);
+	msg.linear_acceleration_covariance.fill(0);
+	for (int i = 0; i < 3; i++) {
+		msg.orientation_covariance[i * 4] = angle_var[i];
+		msg.angular_velocity_covariance[i * 4] = fused_var[i];
+		msg.linear_acceleration_covariance[i * 4] = fused_var[3 + i] * G_IN_MS2 * G_IN_MS2;
+	}
+
+	fusedPub.publish(msg);
+}
@@ -12,6 +12,7 @@ ImuTortugaNode::ImuTortugaNode(std::shared_ptr<ros::NodeHandle> n, int rate, std
 	// JW: do I need this here?
 	// SG: I think we do actually. could be completely wrong though.
 	ros::Rate loop_rate(rate);
+	setRate(rate);
 
 	imuPub = n->advertise<sensor_msgs::Imu>("tortuga/imu/" + name, 1000);
 	tempPub = n->advertise<std_msgs::Float64MultiArray>("tortuga/imu/"+ name + "/temperature", 1000);
@@ -25,6 +26,8 @@ ImuTortugaNode::ImuTortugaNode(std::shared_ptr<ros::NodeHandle> n, int rate, std
 	if(this->fd <= 0){
             ROS_ERROR("(%s) Unable to open IMU board at: %s", name.c_str(), device.c_str());
 	}
+	initIMUReader(&reader, fd);
+	last_frame = ros::Time::now();
 
 
 
@@ -46,17 +49,52 @@ ImuTortugaNode::ImuTortugaNode(std::shared_ptr<ros::NodeHandle> n, int rate, std
 }
 
 ImuTortugaNode::~ImuTortugaNode(){
-	close(fd);
+	closeDevice();
+}
+
+void ImuTortugaNode::closeDevice(){
+	if(fd >= 0){
+		close(fd);
+	}
+	fd = -1;
 }
 
 void ImuTortugaNode::update(){
 
 	ROS_DEBUG("updating imu method on %s", name.c_str());
 
+	int ret = 0;
+	//0 timeout, only what is already here. Nothing to read once it's closed
+	while(fd >= 0 && (ret = readIMUFrame(&reader, &data, 0)) > 0){
+		last_frame = ros::Time::now();
+		publish();
+		if(fusion){
+			fusion->addSample(fusion_index, data, last_frame);
+		}
+	}
+	checkError(ret);
+
+	if(reader.badFrames != reported_bad || reader.lostSyncs != reported_lost){
+		ROS_WARN("(%s) %lu bad frames, lost sync %lu times (%lu bytes skipped), %lu good frames",
+			name.c_str(), reader.badFrames, reader.lostSyncs, reader.skippedBytes, reader.frames);
+		reported_bad = reader.badFrames;
+		reported_lost = reader.lostSyncs;
+	}
+	if((ros::Time::now() - last_frame).toSec() > 1.0){
+		ROS_WARN_THROTTLE(5, "(%s) no IMU frames for %.1f seconds", name.c_str(), (ros::Time::now() - last_frame).toSec());
+	}
+
+	ros::spinOnce();
+}
+
+void ImuTortugaNode::setFusion(std::shared_ptr<ImuFusion> fusion, int index){
+	this->fusion = fusion;
+	fusion_index = index;
+}
+
+void ImuTortugaNode::publish(){
+
 	static double roll = 0, pitch = 0, yaw = 0, time_last = 0;
-	ROS_DEBUG("does read hang?, FD: %i", fd);
-	checkError(readIMUData(this->fd, &data));
-	ROS_DEBUG("nope");
 	double time_current = ros::Time::now().toSec();
 
 	msg.header.stamp = ros::Time::now();
@@ -117,6 +155,4 @@ void ImuTortugaNode::update(){
 	tempPub.publish(temperature);
 	quaternionPub.publish(quaternion);
 	magnetsPub.publish(mag);
-
-	ros::spinOnce();
 }
@@ -1,5 +1,9 @@
 #include "imu_tortuga.h"
 
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+
 /* Main method for the imu node
  * Follows the style initally defined in the main.cpp of the thrusters
  */
@@ -23,8 +27,8 @@ int main(int argc, char **argv){
 	// IMU, but there are two on tortuga, one in the center and another
 	// offset from the robot (for various reasons I'm currently forgetting)
 	// I'm not sure how or *if* we need to fix this
-	std::unique_ptr<RamNode> node0;
-	std::unique_ptr<RamNode> node1;
+	std::unique_ptr<ImuTortugaNode> node0;
+	std::unique_ptr<ImuTortugaNode> node1;
 
 	// JW: because we have two IMUs, we could split this up into
 	// two different class/mains if we want each IMU to do different
@@ -34,10 +38,37 @@ int main(int argc, char **argv){
 	node0.reset(new ImuTortugaNode(n, 10, "IMU_0", IMU_0_FILE));
 	node1.reset(new ImuTortugaNode(n, 10, "MAGBOOM_IMU_1", IMU_1_FILE));
 
+	//both IMUs combined into one attitude, done here so the frames
+	//never have to go through ROS messages first. It describes the vehicle
+	//body, so it goes out in base_link unless ~fused_frame_id says otherwise
+	std::string fused_frame;
+	ros::NodeHandle("~").param<std::string>("fused_frame_id", fused_frame, "base_link");
+	std::shared_ptr<ImuFusion> fusion(new ImuFusion(n, 2, fused_frame));
+	node0->setFusion(fusion, 0);
+	node1->setFusion(fusion, 1);
+
 
+	//sleep until either IMU has sent something, the timeout keeps ROS
+	//callbacks and the no frames warning going if both go quiet.
+	//poll skips an IMU that didn't open, or has been closed, its fd is negative
+	ImuTortugaNode *nodes[2] = {node0.get(), node1.get()};
+	struct pollfd fds[2] = {{node0->getFd(), POLLIN, 0}, {node1->getFd(), POLLIN, 0}};
 	while (ros::ok()){
+		if (poll(fds, 2, 100) < 0 && errno != EINTR){
+			ROS_ERROR_THROTTLE(5, "Waiting on the IMUs failed: %s", strerror(errno));
+			ros::Duration(0.1).sleep();
+		}
 		node0->update();
 		node1->update();
+
+		//whatever arrived before the hangup has been read, so it can go now
+		for (int i = 0; i < 2; i++){
+			if (fds[i].fd >= 0 && (fds[i].revents & (POLLHUP | POLLERR | POLLNVAL))){
+				ROS_ERROR("(%s) IMU hung up (revents 0x%x), closing it", nodes[i]->getName().c_str(), fds[i].revents);
+				nodes[i]->closeDevice();
+				fds[i].fd = -1;
+			}
+		}
 	}
 
 }
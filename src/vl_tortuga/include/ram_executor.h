@@ -0,0 +1,264 @@
+//!  Runs a set of RamNodes at their own rates on a pool of threads
+
+/*!
+ * Every node gets its update() called once per period(), on whichever pool thread is free. When more nodes are
+ * due than there are threads, the one with the earliest deadline (end of its period) goes first. Nodes that name
+ * the same sharedDevice() never run at the same time.
+ *
+ * A run that finishes after its deadline is an overrun. If a node falls a whole period or more behind, the periods it
+ * missed are skipped rather than run back to back. How late each run started is its jitter, and all of it is reported
+ * per node every report period, so every node's rate is one we actually measured.
+ */
+
+#ifndef RAMEXECUTOR_HEADER
+#define RAMEXECUTOR_HEADER
+
+#include "ram_node.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+class RamExecutor {
+    public:
+    typedef std::chrono::steady_clock Clock;
+
+    /**< What a node has managed since the last report */
+    struct Stats {
+        std::string name;
+        double target_rate;    /**< Hz */
+        double achieved_rate;  /**< Hz */
+        double mean_jitter;    /**< seconds late starting */
+        double max_jitter;
+        double mean_run_time;  /**< seconds in update() */
+        unsigned long runs;
+        unsigned long overruns;  /**< runs that finished after their deadline */
+        unsigned long skipped;   /**< periods dropped because the node was too far behind */
+    };
+
+    /**< threads is the size of the pool, 0 gives one per node (up to the number of cores).
+       report_period is in seconds, 0 never reports */
+    RamExecutor(unsigned threads = 0, double report_period = 30) : threads(threads), report_period(report_period) {}
+
+    ~RamExecutor() { stop(); }
+
+    /**< The node has to outlive the executor, or at least run(). Nodes can only be added before run(), the workers hold
+       on to tasks while it runs, so this returns false and leaves the node out once it has started */
+    bool add(std::string name, RamNode *node) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (started) {
+            ROS_ERROR("Can't add %s to the executor while it is running", name.c_str());
+            return false;
+        }
+        Task task;
+        task.name = name;
+        task.node = node;
+        task.release = Clock::now();
+        tasks.push_back(task);
+        return true;
+    }
+
+    /**< Runs the nodes until ros::ok() fails or stop() is called. The calling thread handles ROS callbacks and the reports */
+    void run() {
+        unsigned pool = threads;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (pool == 0) {
+                pool = std::min<unsigned>(tasks.size(), std::max(2u, std::thread::hardware_concurrency()));
+            }
+            running = true;
+            started = true;
+            Clock::time_point now = Clock::now();
+            stats_start = now;
+            for (Task &t : tasks) {
+                t.release = now;
+                t.clear();
+            }
+        }
+        for (unsigned i = 0; i < pool; i++) {
+            workers.push_back(std::thread(&RamExecutor::worker, this));
+        }
+
+        Clock::time_point next_report = Clock::now() + toDuration(report_period);
+        while (ros::ok() && isRunning()) {
+            ros::spinOnce();
+            if (report_period > 0 && Clock::now() >= next_report) {
+                report();
+                next_report += toDuration(report_period);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        stop();
+        for (std::thread &w : workers) {
+            w.join();
+        }
+        workers.clear();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        started = false;
+    }
+
+    /**< Makes run() return once the updates in progress finish, safe to call from any thread */
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        wake.notify_all();
+    }
+
+    /**< Per node numbers since the last reset, reset starts them over */
+    std::vector<Stats> stats(bool reset = false) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Clock::time_point now = Clock::now();
+        double elapsed = std::chrono::duration<double>(now - stats_start).count();
+        std::vector<Stats> result;
+        for (Task &t : tasks) {
+            Stats s;
+            s.name = t.name;
+            s.target_rate = t.node->period().count() > 0 ? 1e9 / t.node->period().count() : 0;
+            s.achieved_rate = elapsed > 0 ? t.runs / elapsed : 0;
+            s.mean_jitter = t.runs ? t.jitter_sum / t.runs : 0;
+            s.max_jitter = t.jitter_max;
+            s.mean_run_time = t.runs ? t.run_time_sum / t.runs : 0;
+            s.runs = t.runs;
+            s.overruns = t.overruns;
+            s.skipped = t.skipped;
+            result.push_back(s);
+            if (reset) {
+                t.clear();
+            }
+        }
+        if (reset) {
+            stats_start = now;
+        }
+        return result;
+    }
+
+    /**< Logs stats() and starts them over */
+    void report() {
+        for (const Stats &s : stats(true)) {
+            ROS_INFO("%s: %.1f of %.1f Hz, started %.2f ms late on average (%.2f ms worst), update takes %.2f ms, "
+                     "%lu overruns, %lu periods skipped",
+                     s.name.c_str(), s.achieved_rate, s.target_rate, s.mean_jitter * 1e3, s.max_jitter * 1e3,
+                     s.mean_run_time * 1e3, s.overruns, s.skipped);
+        }
+    }
+
+    protected:
+    struct Task {
+        std::string name;
+        RamNode *node = NULL;
+        Clock::time_point release;  /**< when the current period started */
+        bool running = false;
+
+        unsigned long runs = 0, overruns = 0, skipped = 0;
+        double jitter_sum = 0, jitter_max = 0, run_time_sum = 0;
+
+        void clear() {
+            runs = overruns = skipped = 0;
+            jitter_sum = jitter_max = run_time_sum = 0;
+        }
+    };
+
+    unsigned threads;
+    double report_period;
+
+    //guards everything below it
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<Task> tasks;
+    std::set<std::string> busy_devices;
+    bool running = false;
+    bool started = false;  //from run() starting until its workers have finished, tasks can't change
+    Clock::time_point stats_start;
+
+    std::vector<std::thread> workers;
+
+    static Clock::duration toDuration(double seconds) {
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    }
+
+    bool isRunning() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return running;
+    }
+
+    //the due task with the earliest deadline, or NULL and when to look again
+    Task *nextReady(Clock::time_point now, Clock::time_point &next) {
+        Task *best = NULL;
+        next = Clock::time_point::max();
+        for (Task &t : tasks) {
+            if (t.running || (!t.node->sharedDevice().empty() && busy_devices.count(t.node->sharedDevice()))) {
+                continue;
+            }
+            if (t.release > now) {
+                next = std::min(next, t.release);
+            } else if (!best || t.release + t.node->period() < best->release + best->node->period()) {
+                best = &t;
+            }
+        }
+        return best;
+    }
+
+    void worker() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (running) {
+            Clock::time_point next;
+            Task *t = nextReady(Clock::now(), next);
+            if (!t) {
+                if (next == Clock::time_point::max()) {
+                    wake.wait(lock);
+                } else {
+                    wake.wait_until(lock, next);
+                }
+                continue;
+            }
+
+            const std::string &device = t->node->sharedDevice();
+            t->running = true;
+            if (!device.empty()) {
+                busy_devices.insert(device);
+            }
+            Clock::time_point release = t->release;
+            Clock::duration period = t->node->period();
+            lock.unlock();
+
+            Clock::time_point start = Clock::now();
+            t->node->update();
+            Clock::time_point end = Clock::now();
+
+            lock.lock();
+            double jitter = std::chrono::duration<double>(start - release).count();
+            t->runs++;
+            t->jitter_sum += jitter;
+            t->jitter_max = std::max(t->jitter_max, jitter);
+            t->run_time_sum += std::chrono::duration<double>(end - start).count();
+            if (end > release + period) {
+                t->overruns++;
+            }
+
+            //a node that has fallen a period or more behind starts again from the latest period it missed
+            if (period.count() > 0 && end >= release + 2 * period) {
+                long long behind = (end - release) / period;
+                t->skipped += behind - 1;
+                t->release = release + behind * period;
+            } else {
+                t->release = release + period;
+            }
+
+            t->running = false;
+            if (!device.empty()) {
+                busy_devices.erase(device);
+            }
+            wake.notify_all();
+        }
+    }
+};
+
+#endif
@@ -20,6 +20,8 @@
 #include "std_msgs/String.h"
 #include <sstream>
 #include <thread>
+#include <chrono>
+#include <memory>
 
 class RamNode {
     public:
@@ -29,26 +31,46 @@ class RamNode {
         this->n = n; 
     }; 
     
-    ~RamNode(){}; //Destructor 
+    virtual ~RamNode(){}; //Destructor, virtual since nodes are held as RamNode pointers
     
     
     virtual void update() = 0;
     
+    /**< How often update() should be called, in Hz. Nodes set this from their constructor's rate */
+    void setRate(int rate) {
+        this->rate = rate;
+        loop_rate.reset();
+    }
+    
+    /**< Time between calls to update() */
+    std::chrono::nanoseconds period() const {
+        return std::chrono::nanoseconds(rate > 0 ? 1000000000LL / rate : 0);
+    }
+    
+    /**< Nodes that return the same non-empty name here talk to the same device themselves, and RamExecutor never
+       runs two of them at once. Nodes that go through something that already takes turns, like SensorBoard, leave it empty */
+    const std::string &sharedDevice() const { return shared_device; }
+    
+    /**< Sleeps out the rest of this period. The rate is kept between calls, a fresh one would only ever sleep a whole period */
     void sleep() {
-        ros::Rate loop_rate(rate);
-        loop_rate.sleep();
+        if (!loop_rate) {
+            loop_rate.reset(new ros::Rate(rate));
+        }
+        loop_rate->sleep();
     }
     
     static void runThread(RamNode *node) {
         while (ros::ok()) {
             node->update();
-                    node->sleep();
+            node->sleep();
         }
     }
     
     protected:
     std::shared_ptr<ros::NodeHandle> n; /**< the handle for the whole node */
-    int rate; 
+    int rate = 10; 
+    std::string shared_device;
+    std::unique_ptr<ros::Rate> loop_rate;
     
 };
 
@@ -9,18 +9,14 @@
 class DepthTortugaNode : public SensorBoardTortugaNode {
 	
     public:
-    DepthTortugaNode(std::shared_ptr<ros::NodeHandle> n, int rate, int fd, std::string file_name);
+    DepthTortugaNode(std::shared_ptr<ros::NodeHandle> n, int rate, std::shared_ptr<SensorBoard> board);
     ~DepthTortugaNode();
 
-	void update();
 	void depthCallBack(const std_msgs::Float32 msg);
 	
 	protected:
 	std_msgs::Float32 msg;
 	ros::Publisher publisher;
-    int fd;
-  std::string sensor_file;
-	//int fd; //the file descriptor, established by the a call to openSensorBoard
 	
 };
 
@@ -0,0 +1,50 @@
+#ifndef LCD_TORTUGA_H
+#define LCD_TORTUGA_H
+
+/* Shows whatever is published on tortuga/lcd on the sensor board's LCD, the
+   first line of the message on the top line and the second on the bottom.
+
+   Only lines that differ from what the screen already shows are written, at
+   most BYTE_BUDGET bytes a second, and always at the lowest priority on the
+   board, so the status display never holds up thruster or depth traffic.
+*/
+
+#include "sensorapi.h"
+#include "sensor_board_tortuga.h"
+#include "std_msgs/String.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+class LcdTortugaNode : public SensorBoardTortugaNode {
+
+    public:
+        LcdTortugaNode(std::shared_ptr<ros::NodeHandle>, int rate, std::shared_ptr<SensorBoard> board);
+        ~LcdTortugaNode();
+
+        //hands the board the next line that needs writing, if there is one
+        void update();
+        void textCallBack(const std_msgs::String msg);
+
+    protected:
+        //bytes a second the display may take off the link, a line is 20 with its ack
+        static constexpr double BYTE_BUDGET = 200;
+
+        //the text we were last asked to show, shared with the board thread
+        std::mutex text_mutex;
+        std::string lines[LCD_LINES];
+
+        //set when the screen may not match the text yet
+        std::atomic<bool> dirty;
+
+        //only touched from the board thread
+        struct lcdDisplay lcd;
+
+        ros::Subscriber subscriber;
+
+        //writes at most one line, runs on the board thread
+        void refresh(int fd);
+};
+
+#endif
@@ -13,19 +13,15 @@
 class PowerNodeTortuga : public SensorBoardTortugaNode {
 
     public:
-      PowerNodeTortuga(std::shared_ptr<ros::NodeHandle>, int rate, int fd ,  std::string file_name);
+      PowerNodeTortuga(std::shared_ptr<ros::NodeHandle>, int rate, std::shared_ptr<SensorBoard> board);
       ~PowerNodeTortuga();
 
-      void update();
-
     protected:
   /* Tortuga has 6 Batteries, so this node will have 6 publishers and 6 messages
      instead of the single publisher and message
    */
-      int fd;
       ros::Publisher publisher[6];
       ram_msgs::PowerSource msg;
-      struct powerInfo info;
 };
 
 #endif
@@ -0,0 +1,135 @@
+#ifndef SENSOR_BOARD_H
+#define SENSOR_BOARD_H
+
+/* Owner of the sensor board's serial port. Every command to the board runs on
+   one thread, taken off a queue in priority order, so commands from different
+   nodes can never interleave on the wire. Nodes hand it work instead of
+   touching the fd themselves.
+
+   A command that has started runs to the end, the board's protocol has no way
+   to interrupt one, so priorities only decide what goes next. Work that has
+   no use for the reply can start() its command and return, the board thread
+   collects the reply before anything else goes out.
+
+   Regular readings go on the board's poll schedule (see scheduledRead in
+   sensorapi.h) rather than the queue. A due reading goes ahead of everything
+   but CONTROL work, and the schedule leaves part of the link free so queued
+   work still gets a turn.
+*/
+
+#include "sensorapi.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+
+class SensorBoard {
+
+    public:
+    //earlier in the list goes first, the same priority goes in the order it was posted
+    enum Priority {
+        CONTROL,      //thruster commands, the vehicle is waiting on these
+        SENSOR,       //depth and other readings the controls use
+        HOUSEKEEPING, //power and temperature, nothing suffers if these are late
+        DISPLAY       //the LCD, only gets the board when nothing else wants it
+    };
+
+    //opens and syncs the board and starts the thread that talks to it,
+    //throws std::runtime_error if it can't be opened
+    SensorBoard(std::string sensor_file);
+
+    //stops the board thread and closes the board
+    ~SensorBoard();
+
+    //queues work to run on the board thread, it is passed the fd and has the board to itself until it returns.
+    //work posted after stop() is dropped
+    void post(Priority priority, std::function<void(int)> work);
+
+    //same as post, with a future for what work returns (or throws)
+    template <typename F>
+    auto submit(Priority priority, F work) -> std::future<decltype(work(0))> {
+        typedef decltype(work(0)) Result;
+        std::shared_ptr<std::packaged_task<Result(int)>> task(new std::packaged_task<Result(int)>(work));
+        std::future<Result> result = task->get_future();
+        post(priority, [task](int fd) { (*task)(fd); });
+        return result;
+    }
+
+    //has the board thread read item rate times a second, 0 to stop. After every good read callback is
+    //called on the board thread with everything read so far, it can be empty for items another one's
+    //callback uses
+    void schedule(enum partialUpdateType_ item, double rate, std::function<void(const struct boardInfo &)> callback);
+
+    //only for work running on the board thread: sends cmd, which must already be encoded, and returns
+    //without waiting for the reply. The board thread reads the reply as it comes in, then calls done
+    //with the result. Nothing else goes to the board in between
+    void start(std::shared_ptr<struct sbCommand> cmd, std::function<void(int)> done);
+
+    //lets the command in progress finish and drops the rest. Work usually points back at the node
+    //that posted it, so call this before those nodes are destroyed
+    void stop();
+
+    const std::string &file() const { return sensor_file; }
+
+    protected:
+    struct Request {
+        Priority priority;
+        unsigned long sequence;
+        std::function<void(int)> work;
+
+        //std::priority_queue takes the largest first
+        bool operator<(const Request &other) const {
+            if (priority != other.priority) {
+                return priority > other.priority;
+            }
+            return sequence > other.sequence;
+        }
+    };
+
+    std::string sensor_file;
+    int fd;
+
+    //guards everything below it
+    std::mutex queue_mutex;
+    std::condition_variable queue_changed;
+    std::priority_queue<Request> requests;
+    unsigned long next_sequence = 0;
+    bool running = true;
+
+    std::thread worker;
+
+    //fraction of the link the poll schedule may use, the rest is kept for queued work
+    static constexpr double POLL_LINK_BUDGET = 0.5;
+    //how often to check the schedule is keeping up
+    static constexpr double POLL_STATS_PERIOD = 10.0;
+
+    //only the board thread touches these
+    struct pollSchedule poll_schedule;
+    struct boardInfo info;
+    std::function<void(const struct boardInfo &)> poll_callbacks[NUM_POLL_ITEMS];
+    std::chrono::steady_clock::time_point poll_stats_start;
+    //the command start() sent, until its reply is in
+    std::shared_ptr<struct sbCommand> command;
+    std::function<void(int)> command_done;
+
+    //body of the board thread
+    void run();
+
+    //moves the started command along, waiting on the port no later than its deadline,
+    //and hands the result to its callback once it's over
+    void pollCommand();
+
+    //reads whatever is due on the schedule and hands it to its callback
+    void pollOnce();
+
+    //warns about scheduled items that aren't getting their rate, then starts the stats over
+    void checkPollStats();
+};
+
+#endif
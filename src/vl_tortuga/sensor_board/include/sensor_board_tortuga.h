@@ -3,11 +3,14 @@
 
 #include "ram_node.h"
 #include "sensorapi.h"
+#include "sensor_board.h"
+
+#include <atomic>
 
 
 class SensorBoardTortugaNode : public RamNode {
     public:
-    SensorBoardTortugaNode(std::shared_ptr<ros::NodeHandle>, int , int, std::string);
+    SensorBoardTortugaNode(std::shared_ptr<ros::NodeHandle>, int, std::shared_ptr<SensorBoard>);
     ~SensorBoardTortugaNode();
    
 
@@ -15,9 +18,14 @@ class SensorBoardTortugaNode : public RamNode {
         
 
     protected:
-    int fd; //File descriptor for sensor board
-    std::string sensor_file; // Serial port/system location for sensor board
+    std::shared_ptr<SensorBoard> board; //everything that talks to the board goes through here
+
+    //true from when postOnce queues work until the board thread picks it up
+    std::atomic<bool> request_pending;
 
+    //queues work on the board unless this node's last request is still waiting,
+    //so a busy board never builds up a backlog of stale requests. returns false if it was skipped
+    bool postOnce(SensorBoard::Priority priority, std::function<void(int)> work);
 
     //SG: should we try and handle some of there errors here?
     //we should look into how sensor api handles some of these,
@@ -12,7 +12,7 @@
 class SonarClientNode : public SensorBoardTortugaNode {
     
     public:
-    SonarClientNode(std::shared_ptr<ros::NodeHandle>, int rate, int fd ,  std::string file_name);
+    SonarClientNode(std::shared_ptr<ros::NodeHandle>, int rate, std::shared_ptr<SensorBoard> board);
     ~SonarClientNode();
     
     //void update();
@@ -25,7 +25,6 @@ class SonarClientNode : public SensorBoardTortugaNode {
     //std_msgs::Int64MultiArray thruster_powers;
     //int fd;
     ram_msgs::sonar_data srv;
-    std::string sensor_file;
     ros::ServiceClient client; 
 };
 
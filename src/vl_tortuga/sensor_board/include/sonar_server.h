@@ -12,7 +12,7 @@
 class SonarServerNode : public SensorBoardTortugaNode {
     
     public:
-    SonarServerNode(std::shared_ptr<ros::NodeHandle>, int rate, int fd ,  std::string file_name);
+    SonarServerNode(std::shared_ptr<ros::NodeHandle>, int rate, std::shared_ptr<SensorBoard> board);
     ~SonarServerNode();
     
     void update();
@@ -23,10 +23,9 @@ class SonarServerNode : public SensorBoardTortugaNode {
     //this is the DESIRED relative power, since our thrusters our nonlinear
     //we'll need to map these to another vector eventually.
     //std_msgs::Int64MultiArray thruster_powers;
-    sonarData sd;
-    int fd;
-    std::string sensor_file;
     ros::ServiceServer service; 
+
+    bool sonar(ram_msgs::sonar_data::Request &req, ram_msgs::sonar_data::Response &res);
 };
 
 #endif
@@ -0,0 +1,66 @@
+#ifndef SONAR_TORTUGA_H
+#define SONAR_TORTUGA_H
+
+/* Streams pings from the sonar board on tortuga/sonar, for homing on a pinger.
+
+   The board is asked for the latest ping every period, and each new one is
+   published once, stamped with when the board says it was heard. The board's
+   clock is mapped onto ROS time by the least delayed reply, the same way the
+   IMU fusion maps sampleTimer. A few recent pings are kept so the message can
+   carry a median bearing and elevation that one bad ping won't throw off.
+*/
+
+#include "sensorapi.h"
+#include "sensor_board_tortuga.h"
+#include "ram_msgs/SonarPing.h"
+
+#include <array>
+
+class SonarTortugaNode : public SensorBoardTortugaNode {
+
+    public:
+        SonarTortugaNode(std::shared_ptr<ros::NodeHandle>, int rate, std::shared_ptr<SensorBoard> board);
+        ~SonarTortugaNode();
+
+        //asks the board for the latest ping, unless the last request is still waiting
+        void update();
+
+    protected:
+        //how many pings the medians are taken over
+        static const int PING_HISTORY = 5;
+
+        struct Ping {
+            double bearing;
+            double elevation;
+        };
+
+        //everything below is only touched from the board thread
+
+        //maps the board's clock onto ROS time
+        struct BoardClock {
+            bool started = false;
+            double last_board = 0;
+            double offset = 0;      //ROS time minus board time, from the quickest reply
+
+            double stamp(double board, double arrival);
+        };
+        BoardClock clock;
+
+        //the board keeps answering with the last ping until it hears another
+        unsigned int last_sec = 0;
+        unsigned int last_usec = 0;
+
+        std::array<Ping, PING_HISTORY> history;
+        int history_next = 0;
+        int history_count = 0;
+
+        ram_msgs::SonarPing msg;
+        unsigned int id = 0;
+        ros::Publisher publisher;
+
+        //reads the latest ping and publishes it if it's new, runs on the board thread
+        void poll(int fd);
+        void median(double &bearing, double &elevation) const;
+};
+
+#endif
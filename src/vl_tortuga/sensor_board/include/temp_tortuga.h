@@ -13,16 +13,11 @@ class TempTortugaNode : public SensorBoardTortugaNode {
 
     public: //public methods
 
-        TempTortugaNode(std::shared_ptr<ros::NodeHandle>, int rate, int fd, std::string file_name);
+        TempTortugaNode(std::shared_ptr<ros::NodeHandle>, int rate, std::shared_ptr<SensorBoard> board);
         ~TempTortugaNode();
 
-        //update: retrieves data from any other node needed for operation.
-        void update();
-
     protected: //fields 
         std_msgs::Char msg; //always include this, used to create specific message file for this node
-        int fd;
-        std::string sensor_file;
         ros::Publisher publishers[NUM_TEMP_SENSORS];
 };
 
@@ -3,33 +3,69 @@
 
 /* Thruster Node class to be run on tortuga, requires someone else to open up the sensor board and pass it in, this is
    meant to make sharing said sensor board much easier
-*/
 
-#define NUM_THRUSTERS 6
+   Speeds only go to the board when they change, or every KEEPALIVE so the motor controllers know we're still here.
+   The board wants the responses to the last speeds read before the next ones and they're ready 15 ms after it, so
+   they're read on the next trip to the board instead of waiting for them, and tracked per thruster. The speeds
+   themselves go out without waiting for the ack, the board thread collects it.
+*/
 
 #include "sensor_board_tortuga.h"
 #include "std_msgs/Int64MultiArray.h"
 #include "sensorapi.h"
 
+#include <array>
+#include <chrono>
+#include <mutex>
+
+//largest speed setSpeeds takes either way
+#define MAX_THRUSTER_SPEED 1023
+
 
 class ThrusterTortugaNode : public SensorBoardTortugaNode {
     
     public:
-    ThrusterTortugaNode(std::shared_ptr<ros::NodeHandle>, int rate, int fd ,  std::string file_name);
+    ThrusterTortugaNode(std::shared_ptr<ros::NodeHandle>, int rate, std::shared_ptr<SensorBoard> board);
     ~ThrusterTortugaNode();
     
     void update();
     void thrusterCallBack(const std_msgs::Int64MultiArray msg);
     
     protected:
+    typedef std::chrono::steady_clock Clock;
+    typedef std::array<int, NUM_THRUSTERS> Speeds;
+
+    //resend unchanged speeds this often
+    static constexpr std::chrono::milliseconds KEEPALIVE{500};
+    //how long the motor controllers take to answer a speed
+    static constexpr std::chrono::milliseconds RESPONSE_DELAY{15};
+    //warn once a thruster has missed this many acks in a row
+    static const int MISSED_ACK_WARNING = 3;
+
+    //everything below is shared between the callback, update and the board thread
+    std::mutex powers_mutex;
+
     //contains the current powers we want the thrusters to be operating at
     //this is the DESIRED relative power, since our thrusters our nonlinear
     //we'll need to map these to another vector eventually.
-    std_msgs::Int64MultiArray thruster_powers;
-    int fd;
-    std::string sensor_file;
+    Speeds setpoint;
+
+    //what the board was last sent and when, and whether the responses to it are still to be read
+    Speeds sent;
+    bool sent_once = false;
+    Clock::time_point sent_at;
+    bool responses_pending = false;
+
+    //acks each thruster has missed in a row
+    std::array<int, NUM_THRUSTERS> missed_acks;
+
     ros::Subscriber subscriber;
-    
+
+    //runs on the board thread, reads the last responses if they're in and sends the setpoint if it needs to go
+    void sendSpeeds(int fd);
+    //runs on the board thread once the board has acked (or not) the speeds s
+    void speedsSent(const Speeds &s, int ret);
+    void readResponses(int fd);
 };
 
 #endif
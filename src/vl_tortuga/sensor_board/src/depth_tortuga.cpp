@@ -2,19 +2,15 @@
 
 
 //we pass argv and argc so in the future we can pass in command line arguments.
-DepthTortugaNode::DepthTortugaNode(std::shared_ptr<ros::NodeHandle> n,  int rate, int board_fd, std::string board_file):
-	SensorBoardTortugaNode(n, rate, board_fd, board_file){
-	ros::Rate  loop_rate(rate);
+DepthTortugaNode::DepthTortugaNode(std::shared_ptr<ros::NodeHandle> n,  int rate, std::shared_ptr<SensorBoard> board):
+	SensorBoardTortugaNode(n, rate, board){
 	publisher = n->advertise<std_msgs::Float32>("tortuga/depth", 1000);
+
+	//published from the board thread as soon as the reading is back
+	board->schedule(DEPTH, rate, [this](const struct boardInfo &info) {
+		msg.data = info.depth;
+		publisher.publish(msg);
+	});
 }
 
 DepthTortugaNode::~DepthTortugaNode(){};
-
-void DepthTortugaNode::update(){
-  //SG: I don't think we need this spinOnce here
-    ros::spinOnce();
-	ROS_DEBUG("READING DEPTH");
-
-	msg.data = readDepth(fd);
-	publisher.publish(msg);
-}
@@ -0,0 +1,46 @@
+#include "lcd_tortuga.h"
+
+#include <sstream>
+
+LcdTortugaNode::LcdTortugaNode(std::shared_ptr<ros::NodeHandle> n, int rate, std::shared_ptr<SensorBoard> board):
+    SensorBoardTortugaNode(n, rate, board), dirty(true) {
+    initLCDDisplay(&lcd, BYTE_BUDGET);
+    subscriber = n->subscribe("/tortuga/lcd", 10, &LcdTortugaNode::textCallBack, this);
+}
+
+LcdTortugaNode::~LcdTortugaNode() {}
+
+void LcdTortugaNode::textCallBack(const std_msgs::String msg) {
+    std::lock_guard<std::mutex> lock(text_mutex);
+    std::istringstream text(msg.data);
+    for (int i = 0; i < LCD_LINES; i++) {
+        if (!std::getline(text, lines[i])) {
+            lines[i].clear();
+        }
+    }
+    dirty = true;
+}
+
+void LcdTortugaNode::update() {
+    if (dirty) {
+        postOnce(SensorBoard::DISPLAY, [this](int fd) { refresh(fd); });
+    }
+}
+
+void LcdTortugaNode::refresh(int fd) {
+    //cleared before the text is copied, so text that comes in after this still gets shown
+    dirty = false;
+    {
+        std::lock_guard<std::mutex> lock(text_mutex);
+        for (int i = 0; i < LCD_LINES; i++) {
+            lcdSetLine(&lcd, i, lines[i].c_str());
+        }
+    }
+
+    //one line per trip, anything more important queued behind us goes next
+    int ret = lcdUpdate(fd, &lcd);
+    if (ret != SB_UPDATEDONE) {
+        dirty = true;
+    }
+    checkError(ret);
+}
@@ -6,14 +6,20 @@
     for them to all communicate with the sensor board directly, 
     as opposed to having to share a serial port between processes, 
     which makes our life a lot easier. 
+
+    Only the SensorBoard actually touches the serial port, the nodes
+    hand it their commands and it runs them one at a time.
 **/
 
 #include "sensor_board_tortuga.h"
+#include "ram_executor.h"
 
 #include "thruster_tortuga.h"
 #include "depth_tortuga.h"
 #include "power_sensor_tortuga.h"
 #include "temp_tortuga.h"
+#include "sonar_tortuga.h"
+#include "lcd_tortuga.h"
 #include "sonar_server.h"
 #include "sonar_client.h"
 //include your header here, no need to relocate it.
@@ -30,16 +36,20 @@ int main(int argc, char **argv) {
     
     //open the sensor board
     std::string sensor_file = "/dev/sensor";
-    int fd = openSensorBoard(sensor_file.c_str());
-    
-    //todo make a static reference to checkerror and call it here
-    syncBoard(fd);
+    std::shared_ptr<SensorBoard> board;
+    try {
+        board.reset(new SensorBoard(sensor_file));
+    }
+    catch (std::exception &e) {
+        ROS_ERROR("%s", e.what());
+        return 1;
+    }
 
     //todo, turn these off at some point. NOTE the cameras do not actually talk to us right now.
-    camConnect(fd);
-    DVLOn(fd, 1);
-    
-    ROS_DEBUG("opened the sensor board, fd  =  %i" ,fd );
+    board->post(SensorBoard::CONTROL, [](int fd) {
+        camConnect(fd);
+        DVLOn(fd, 1);
+    });
     
  
     //SG:when you're integrating a new node add a unique_ptr to your node here as well
@@ -47,6 +57,8 @@ int main(int argc, char **argv) {
     std::unique_ptr<SensorBoardTortugaNode> depth_sensor;
     std::unique_ptr<SensorBoardTortugaNode> power_sensor;
     std::unique_ptr<SensorBoardTortugaNode> temp_sensor;
+    std::unique_ptr<SensorBoardTortugaNode> sonar;
+    std::unique_ptr<SensorBoardTortugaNode> lcd;
     //  std::unique_ptr<SensorBoardTortugaNode> sonar_client;
     //  std::unique_ptr<SensorBoardTortugaNode> sonar_server;
  
@@ -64,27 +76,40 @@ int main(int argc, char **argv) {
     //launch file... 
     
     
+    //how often the board reads each of these, in Hz. depth feeds the controls, the rest
+    //change slowly, so they get a smaller share of the link
+    ros::NodeHandle private_nh("~");
+    int depth_rate, power_rate, temp_rate;
+    private_nh.param("depth_rate", depth_rate, 50);
+    private_nh.param("power_rate", power_rate, 10);
+    private_nh.param("temp_rate", temp_rate, 1);
+
     ROS_DEBUG("attempting to initialize nodes\n");
-    thrusters.reset(new ThrusterTortugaNode(n, 10, fd, sensor_file));
-    depth_sensor.reset(new DepthTortugaNode(n, 10, fd, sensor_file));
-    power_sensor.reset(new PowerNodeTortuga(n,10,fd,sensor_file));
-    temp_sensor.reset(new TempTortugaNode(n,10,fd,sensor_file));
-//    sonar_client.reset(new SonarClientNode(n,10,fd,sensor_file));
-//    sonar_server.reset(new SonarServerNode(n,10,fd,sensor_file));
+    thrusters.reset(new ThrusterTortugaNode(n, 10, board));
+    depth_sensor.reset(new DepthTortugaNode(n, depth_rate, board));
+    power_sensor.reset(new PowerNodeTortuga(n, power_rate, board));
+    temp_sensor.reset(new TempTortugaNode(n, temp_rate, board));
+    //polled faster than the pinger pings, only new pings get published
+    sonar.reset(new SonarTortugaNode(n, 20, board));
+    lcd.reset(new LcdTortugaNode(n, 10, board));
+//    sonar_client.reset(new SonarClientNode(n,10,board));
+//    sonar_server.reset(new SonarServerNode(n,10,board));
     ROS_DEBUG("nodes initialized, nice!\n");
-    //copy the above with your node, just make sure n, fd and sensor_file are the same, not sure if we need rate honestly and I'd like to remove it if possible
+    //copy the above with your node, just make sure n and board are the same, not sure if we need rate honestly and I'd like to remove it if possible
  
      
     //this is the main loop for the program, it will continously update the relavent nodes until ros::ok fails.
-   while (ros::ok()) {
-        thrusters->update();
-        ROS_ERROR("thrusters UPDATED");
-        depth_sensor->update();
-        ROS_ERROR("depth updated");
-        //power_sensor->update();
-        //temp_sensor->update();
-        ros::spinOnce();   //this might be spelled wrong
-        //make sure you run your nodes update here.
-    }
+    //each node runs at its own rate on the executor's threads. updates only queue up work for the board,
+    //which takes turns itself, so none of them needs the device to itself.
+    //depth, power and temperature aren't on here, the board reads them on its poll schedule at their rates
+    RamExecutor executor;
+    executor.add("thrusters", thrusters.get());
+    executor.add("sonar", sonar.get());
+    executor.add("lcd", lcd.get());
+    //make sure you add your node here.
+    executor.run();
+
+    //the queued work points at the nodes, so the board has to stop before they go away
+    board->stop();
 }
 
@@ -1,28 +1,24 @@
 #include "power_sensor_tortuga.h"
 
-PowerNodeTortuga::PowerNodeTortuga(std::shared_ptr<ros::NodeHandle> n, int rate, int board_fd, std::string board_file):
-  SensorBoardTortugaNode(n, rate, board_fd, board_file) {
+PowerNodeTortuga::PowerNodeTortuga(std::shared_ptr<ros::NodeHandle> n, int rate, std::shared_ptr<SensorBoard> board):
+  SensorBoardTortugaNode(n, rate, board) {
     for ( int i = 0; i < 6; i ++ ) {
         publisher[i] = n->advertise<ram_msgs::PowerSource>(("tortuga/power_source/" + std::to_string(i)), 1000);
     }
+
+    //nothing suffers if these are late, the board fits them in around everything else.
+    //published once the currents are in, with the latest of the rest
+    board->schedule(BATTERY_VOLTAGES, rate, nullptr);
+    board->schedule(BATTERY_USED, rate, nullptr);
+    board->schedule(BATTERY_CURRENTS, rate, [this](const struct boardInfo &info) {
+      /* Not sure which battery the usage bits are for, so for now I'm just setting all them to this value */
+      for ( int i = 0; i < 6; i++ ) {
+        msg.voltage = info.powerInfo.battVoltages[i];
+        msg.current = info.powerInfo.battCurrents[i];
+        msg.life = info.battUsed;
+        publisher[i].publish(msg);
+      }
+    });
 }
 
 PowerNodeTortuga::~PowerNodeTortuga() {}
-
-void PowerNodeTortuga::update() {
-  checkError(readBatteryVoltages(fd, &info));
-  checkError(readBatteryCurrents(fd, &info));
-
-  /* This doesn't return an error code, it bitmasks part of readStatus()
-    Not sure which battery this actually is, so for now I'm just setting all them to this value
-  */
-  int life = readBatteryUsage(fd);
-  for ( int i = 0; i < 6; i++ ) {
-    msg.voltage = info.battVoltages[i];
-    msg.current = info.battCurrents[i];
-    msg.life = life;
-    publisher[i].publish(msg);
-  }
-  ros::spinOnce();
-
-}
@@ -0,0 +1,195 @@
+#include "sensor_board.h"
+
+#include "ros/ros.h"
+
+#include <cmath>
+#include <cstring>
+#include <poll.h>
+#include <stdexcept>
+#include <unistd.h>
+
+SensorBoard::SensorBoard(std::string sensor_file): sensor_file(sensor_file) {
+    fd = openSensorBoard(sensor_file.c_str());
+    if (fd < 0) {
+        throw std::runtime_error("Unable to open the sensor board on " + sensor_file);
+    }
+
+    //nothing else has the fd yet, so this doesn't need the queue
+    if (syncBoard(fd) != SB_OK) {
+        ROS_WARN("Couldn't sync with the sensor board on %s", sensor_file.c_str());
+    }
+    ROS_DEBUG("opened the sensor board, fd  =  %i", fd);
+
+    initPollSchedule(&poll_schedule);
+    poll_schedule.linkBudget = POLL_LINK_BUDGET;
+    memset(&info, 0, sizeof(info));
+    poll_stats_start = std::chrono::steady_clock::now();
+
+    worker = std::thread(&SensorBoard::run, this);
+}
+
+SensorBoard::~SensorBoard() {
+    stop();
+    close(fd);
+}
+
+void SensorBoard::post(Priority priority, std::function<void(int)> work) {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        if (!running) {
+            return;
+        }
+        requests.push(Request{priority, next_sequence++, work});
+    }
+    queue_changed.notify_one();
+}
+
+void SensorBoard::schedule(enum partialUpdateType_ item, double rate,
+                           std::function<void(const struct boardInfo &)> callback) {
+    //the schedule belongs to the board thread, so the change is made there
+    post(CONTROL, [this, item, rate, callback](int) {
+        if (setPollRate(&poll_schedule, item, rate) != SB_OK) {
+            ROS_ERROR("Can't schedule sensor board item %d at %f Hz", item, rate);
+            return;
+        }
+        poll_callbacks[item] = callback;
+    });
+}
+
+void SensorBoard::start(std::shared_ptr<struct sbCommand> cmd, std::function<void(int)> done) {
+    command = cmd;
+    command_done = done;
+    sbStart(fd, command.get(), IO_TIMEOUT);
+}
+
+void SensorBoard::stop() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        running = false;
+        requests = std::priority_queue<Request>();
+    }
+    queue_changed.notify_one();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void SensorBoard::run() {
+    while (true) {
+        //the board answers one command at a time, so the last one has to be over before anything else goes
+        if (command) {
+            pollCommand();
+            continue;
+        }
+
+        std::function<void(int)> work;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            while (running) {
+                double wait = pollWaitTime(&poll_schedule);
+                bool control = !requests.empty() && requests.top().priority == CONTROL;
+                if (control || (wait != 0 && !requests.empty())) {
+                    work = requests.top().work;
+                    requests.pop();
+                    break;
+                }
+                if (wait == 0) {
+                    break;
+                }
+                if (wait < 0) {
+                    queue_changed.wait(lock);
+                }
+                else {
+                    queue_changed.wait_for(lock, std::chrono::duration<double>(wait));
+                }
+            }
+            if (!running) {
+                return;
+            }
+        }
+
+        if (!work) {
+            pollOnce();
+            continue;
+        }
+
+        //one bad request shouldn't take the board away from everyone else
+        try {
+            work(fd);
+        }
+        catch (std::exception &e) {
+            ROS_ERROR("Sensor board request failed: %s", e.what());
+        }
+    }
+}
+
+void SensorBoard::pollCommand() {
+    int ret = sbPoll(fd, command.get());
+    if (ret == SB_INPROGRESS) {
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = (command->txSent < command->txLen) ? POLLOUT : POLLIN;
+        pfd.revents = 0;
+        poll(&pfd, 1, (int) std::ceil(sbWaitTime(command.get()) * 1000));
+        return;
+    }
+
+    std::function<void(int)> done = command_done;
+    command.reset();
+    command_done = nullptr;
+    try {
+        done(ret);
+    }
+    catch (std::exception &e) {
+        ROS_ERROR("Sensor board command callback failed: %s", e.what());
+    }
+}
+
+void SensorBoard::pollOnce() {
+    int ret = scheduledRead(fd, &poll_schedule, &info);
+    if (ret == SB_NOTDUE) {
+        return;
+    }
+
+    enum partialUpdateType_ item = poll_schedule.lastItem;
+    if (ret != SB_OK) {
+        ROS_WARN_THROTTLE(1, "Scheduled read of sensor board item %d failed, error %d", item, ret);
+    }
+    else if (poll_callbacks[item]) {
+        try {
+            poll_callbacks[item](info);
+        }
+        catch (std::exception &e) {
+            ROS_ERROR("Sensor board item %d callback failed: %s", item, e.what());
+        }
+    }
+
+    checkPollStats();
+}
+
+void SensorBoard::checkPollStats() {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (std::chrono::duration<double>(now - poll_stats_start).count() < POLL_STATS_PERIOD) {
+        return;
+    }
+
+    for (int i = 0; i < NUM_POLL_ITEMS; i++) {
+        struct pollStats stats;
+        getPollStats(&poll_schedule, (enum partialUpdateType_)i, &stats);
+        if (stats.targetRate <= 0) {
+            continue;
+        }
+        //a read or two short is just where the period ended
+        if (stats.achievedRate < 0.9 * stats.targetRate) {
+            ROS_WARN("Sensor board item %d read at %.1f of %.1f Hz, %.1f errors/s, %.1f ms a read",
+                     i, stats.achievedRate, stats.targetRate, stats.errorRate, stats.readTime * 1000);
+        }
+        else {
+            ROS_DEBUG("Sensor board item %d read at %.1f Hz, %.0f%% of the link",
+                      i, stats.achievedRate, stats.linkShare * 100);
+        }
+    }
+
+    resetPollStats(&poll_schedule);
+    poll_stats_start = now;
+}
@@ -1,18 +1,14 @@
 #include "sensor_board_tortuga.h"
 
 
-//construtor for sensor board, you need to open the sensor board before making an instance of this class. This is to allow multiple instances to talk to the same board. 
-SensorBoardTortugaNode::SensorBoardTortugaNode(std::shared_ptr<ros::NodeHandle> n , int rate, int fd, std::string sensor_file): RamNode(n) {
-    ros::Rate loop_rate(rate);
-    ROS_DEBUG("sensor board: passed in  fd = %i, this->fd =%i" , fd, this->fd);
-
-    this->fd = fd;
-    this->sensor_file = sensor_file;
+//construtor for sensor board nodes, every node on the board is handed the same SensorBoard, which does all the talking to it.
+SensorBoardTortugaNode::SensorBoardTortugaNode(std::shared_ptr<ros::NodeHandle> n , int rate, std::shared_ptr<SensorBoard> board): RamNode(n), board(board), request_pending(false) {
+    setRate(rate);
+    ROS_DEBUG("sensor board: sharing the board on %s", board->file().c_str());
 }
 
 SensorBoardTortugaNode::~SensorBoardTortugaNode() {
-    // Close the sensor board
-    // close(fd);
+    // The board closes itself once the last node lets go of it
 
 }
 
@@ -20,19 +16,33 @@ void SensorBoardTortugaNode::update() {
     //ros::spinOnce();
 } 
 
+bool SensorBoardTortugaNode::postOnce(SensorBoard::Priority priority, std::function<void(int)> work) {
+    if (request_pending.exchange(true)) {
+        return false;
+    }
+    //cleared before the work runs, so the next request can queue up behind it
+    board->post(priority, [this, work](int fd) {
+        request_pending = false;
+        work(fd);
+    });
+    return true;
+}
+
 //This function just checks if the return value from a sensor board call is one of the errors, and prints the error
 bool SensorBoardTortugaNode::checkError(int e) {
     switch(e) {
     case SB_IOERROR:
-        ROS_DEBUG("IO ERROR in node %s", sensor_file.c_str());
+        ROS_DEBUG("IO ERROR in node %s", board->file().c_str());
         return true;
     case SB_BADCC:
-        ROS_DEBUG("BAD CC ERROR in node %s", sensor_file.c_str());
+        ROS_DEBUG("BAD CC ERROR in node %s", board->file().c_str());
         return true;
     case SB_HWFAIL:
-        ROS_DEBUG("HW FAILURE ERROR in node %s", sensor_file.c_str());
+        ROS_DEBUG("HW FAILURE ERROR in node %s", board->file().c_str());
         return true;
     case SB_ERROR:
-        ROS_DEBUG("SB ERROR in node %s", sensor_file.c_str());
+        ROS_DEBUG("SB ERROR in node %s", board->file().c_str());
+        return true;
     }
+    return false;
 }
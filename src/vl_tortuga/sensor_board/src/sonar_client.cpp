@@ -1,12 +1,12 @@
 #include "sonar_client.h"
   
-SonarClientNode::SonarClientNode(std::shared_ptr<ros::NodeHandle> n, int rate, int board_fd, std::string board_file):
-  SensorBoardTortugaNode(n, rate, board_fd, board_file){
+SonarClientNode::SonarClientNode(std::shared_ptr<ros::NodeHandle> n, int rate, std::shared_ptr<SensorBoard> board):
+  SensorBoardTortugaNode(n, rate, board){
 /*  std::map<std::string, std::string> header;
   header["val1"] = " ";
   header["val2"] = " ";
   ros::ServiceClient client = n.serviceClient<ram_msgs::sonar_data>("sonar_data", false, header);*/
-    client = n.serviceClient<ram_msgs::sonar_data>("sonar_data", false);
+    client = n->serviceClient<ram_msgs::sonar_data>("sonar_data", false);
     srv.request.req = "data";
     if (client.call(srv))
     {
@@ -1,11 +1,16 @@
 #include "sonar_server.h"
 
-bool sonar(ram_msgs::sonar_data::Request &req, ram_msgs::sonar_data::Response &res){
+bool SonarServerNode::sonar(ram_msgs::sonar_data::Request &req, ram_msgs::sonar_data::Response &res){
   struct sonarData sd;
-  int fd = openSensorBoard("/dev/ttyUSB0");
 
   if(req.req == "data"){
-    getSonarData(fd, &sd);
+    //the service call waits for its turn on the board, instead of opening it a second time
+    std::future<int> ret = board->submit(SensorBoard::SENSOR, [&sd](int fd) {
+      return getSonarData(fd, &sd);
+    });
+    if(checkError(ret.get())){
+      return false;
+    }
     res.vectorXYZ[0] = sd.vectorX;
     res.vectorXYZ[1] = sd.vectorY;
     res.vectorXYZ[2] = sd.vectorZ;
@@ -21,9 +26,9 @@ bool sonar(ram_msgs::sonar_data::Request &req, ram_msgs::sonar_data::Response &r
   return true;
 }
 
-SonarServerNode::SonarServerNode(std::shared_ptr<ros::NodeHandle> n, int rate, int board_fd, std::string board_file):
+SonarServerNode::SonarServerNode(std::shared_ptr<ros::NodeHandle> n, int rate, std::shared_ptr<SensorBoard> board):
   
-  SensorBoardTortugaNode(n, rate, board_fd, board_file){
-    service = n.adverticeService("sonar_data", sonar);
+  SensorBoardTortugaNode(n, rate, board){
+    service = n->advertiseService("sonar_data", &SonarServerNode::sonar, this);
     ROS_DEBUG("Ready to get sonar data.");
   }
@@ -0,0 +1,110 @@
+#include "sonar_tortuga.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+//how quickly the clock offset creeps back up after a quick reply, so it can follow drift
+static const double OFFSET_WEIGHT = 0.02;
+
+//a board clock this far out from the mapping means the sonar board restarted
+static const double CLOCK_JUMP = 5.0;
+
+//the direction vector is good to 4 decimal places, anything shorter than this has no direction
+static const double MIN_VECTOR = 0.1;
+
+static double wrapAngle(double a) {
+    return atan2(sin(a), cos(a));
+}
+
+double SonarTortugaNode::BoardClock::stamp(double board, double arrival) {
+    double measured = arrival - board;
+    if (!started || board < last_board || fabs(measured - offset) > CLOCK_JUMP) {
+        started = true;
+        offset = measured;
+    } else if (measured < offset) {
+        //every reply is late by at least the trip over the wire, the least late is closest to the truth
+        offset = measured;
+    } else {
+        offset += (measured - offset) * OFFSET_WEIGHT;
+    }
+    last_board = board;
+    return board + offset;
+}
+
+SonarTortugaNode::SonarTortugaNode(std::shared_ptr<ros::NodeHandle> n, int rate, std::shared_ptr<SensorBoard> board):
+    SensorBoardTortugaNode(n, rate, board) {
+    publisher = n->advertise<ram_msgs::SonarPing>("tortuga/sonar", 1000);
+    msg.header.frame_id = "sonar";
+}
+
+SonarTortugaNode::~SonarTortugaNode() {}
+
+void SonarTortugaNode::update() {
+    //pings steer the vehicle, so they go with the other readings the controls use
+    postOnce(SensorBoard::SENSOR, [this](int fd) { poll(fd); });
+}
+
+void SonarTortugaNode::poll(int fd) {
+    struct sonarData sd;
+    if (checkError(getSonarData(fd, &sd))) {
+        return;
+    }
+    ros::Time arrival = ros::Time::now();
+
+    //nothing heard yet, or the same ping as last time
+    if ((sd.timeStampSec == 0 && sd.timeStampUSec == 0)
+            || (sd.timeStampSec == last_sec && sd.timeStampUSec == last_usec)) {
+        return;
+    }
+    last_sec = sd.timeStampSec;
+    last_usec = sd.timeStampUSec;
+
+    double board_time = sd.timeStampSec + sd.timeStampUSec * 1e-6;
+    double time = clock.stamp(board_time, arrival.toSec());
+
+    double horizontal = sqrt(sd.vectorX * sd.vectorX + sd.vectorY * sd.vectorY);
+    if (sqrt(horizontal * horizontal + sd.vectorZ * sd.vectorZ) < MIN_VECTOR) {
+        ROS_DEBUG("sonar: ping with no direction, status %i", sd.status);
+        return;
+    }
+
+    Ping ping;
+    ping.bearing = atan2(sd.vectorY, sd.vectorX);
+    ping.elevation = atan2(sd.vectorZ, horizontal);
+    history[history_next] = ping;
+    history_next = (history_next + 1) % PING_HISTORY;
+    if (history_count < PING_HISTORY) {
+        history_count++;
+    }
+
+    msg.header.stamp = ros::Time(time);
+    msg.header.seq = ++id;
+    msg.vectorXYZ[0] = sd.vectorX;
+    msg.vectorXYZ[1] = sd.vectorY;
+    msg.vectorXYZ[2] = sd.vectorZ;
+    msg.bearing = ping.bearing;
+    msg.elevation = ping.elevation;
+    median(msg.median_bearing, msg.median_elevation);
+    msg.range = sd.range;
+    msg.status = sd.status;
+    msg.pinger_id = sd.pingerID;
+    msg.board_sec = sd.timeStampSec;
+    msg.board_usec = sd.timeStampUSec;
+    publisher.publish(msg);
+}
+
+void SonarTortugaNode::median(double &bearing, double &elevation) const {
+    //bearings are taken relative to the newest so the median doesn't split across +-pi
+    const Ping &newest = history[(history_next + PING_HISTORY - 1) % PING_HISTORY];
+    std::vector<double> bearings, elevations;
+    for (int i = 0; i < history_count; i++) {
+        bearings.push_back(wrapAngle(history[i].bearing - newest.bearing));
+        elevations.push_back(history[i].elevation);
+    }
+    int middle = history_count / 2;
+    std::nth_element(bearings.begin(), bearings.begin() + middle, bearings.end());
+    std::nth_element(elevations.begin(), elevations.begin() + middle, elevations.end());
+    bearing = wrapAngle(newest.bearing + bearings[middle]);
+    elevation = elevations[middle];
+}
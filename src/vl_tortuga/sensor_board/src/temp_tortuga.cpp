@@ -1,7 +1,7 @@
 #include "temp_tortuga.h"
 
-TempTortugaNode::TempTortugaNode(std::shared_ptr<ros::NodeHandle> n, int rate, int board_fd, std::string board_file):
-  SensorBoardTortugaNode(n, rate, board_fd, board_file) {
+TempTortugaNode::TempTortugaNode(std::shared_ptr<ros::NodeHandle> n, int rate, std::shared_ptr<SensorBoard> board):
+  SensorBoardTortugaNode(n, rate, board) {
 
   /*    ROS_DEBUG("Opening sensorboard for temperature");
     sensor_file = "/dev/sensor";
@@ -15,6 +15,14 @@ TempTortugaNode::TempTortugaNode(std::shared_ptr<ros::NodeHandle> n, int rate, i
         publishers[i] = n->advertise<std_msgs::Char>("tortuga/temp" + std::to_string(i), 1000);
     }
 
+    //nothing is waiting on temperatures, the board fits them in around everything else
+    board->schedule(TEMP, rate, [this](const struct boardInfo &info) {
+      for(int i = 0; i < NUM_TEMP_SENSORS; i++) {
+        msg.data = info.temperature[i];
+        publishers[i].publish(msg);
+      }
+    });
+
 } 
 
 /* TempTortugaNode::TempTortugaNode(int argc, char **argv, int rate, int board_fd, std::string board_file) : TortugaNode() {
@@ -25,16 +33,3 @@ x
 */
 
 TempTortugaNode::~TempTortugaNode() {}
-
-void TempTortugaNode::update() {
-  ros::spinOnce();
-
-  unsigned char temps[NUM_TEMP_SENSORS];
-  ROS_DEBUG("Reading temperatures");
-  checkError(readTemp(fd, temps));
-  for(int i = 0; i < NUM_TEMP_SENSORS; i++) {
-    	msg.data = temps[i];
-        publishers[i].publish(msg);
-  }
-  
-}
@@ -4,54 +4,136 @@
 
  #include "thruster_tortuga.h"
 
-ThrusterTortugaNode::ThrusterTortugaNode(std::shared_ptr<ros::NodeHandle> n, int rate, int board_fd, std::string board_file):
-    SensorBoardTortugaNode(n, rate, board_fd, board_file) {
+#include <algorithm>
+
+constexpr std::chrono::milliseconds ThrusterTortugaNode::KEEPALIVE;
+constexpr std::chrono::milliseconds ThrusterTortugaNode::RESPONSE_DELAY;
+
+ThrusterTortugaNode::ThrusterTortugaNode(std::shared_ptr<ros::NodeHandle> n, int rate, std::shared_ptr<SensorBoard> board):
+    SensorBoardTortugaNode(n, rate, board) {
 
     ros::Rate loop_rate(rate);
     
     subscriber = n->subscribe("/tortuga/thruster_input", 1000, &ThrusterTortugaNode::thrusterCallBack, this);
     
-    ROS_DEBUG("Unsafing all thrusters");
-    for(int i = 6; i <= 11; i++) {
-        checkError(setThrusterSafety(fd, i));
-    }
-	
-    ROS_DEBUG("Unsafed all thrusters");
-    thruster_powers.layout.dim.push_back(std_msgs::MultiArrayDimension());
-    thruster_powers.layout.dim[0].size = 6;
-    thruster_powers.data.reserve(thruster_powers.layout.dim[0].size);
-    
-    for(int i = 0; i < NUM_THRUSTERS; i++){
-        thruster_powers.data[i] = 0;
-    }
+    setpoint.fill(0);
+    sent.fill(0);
+    missed_acks.fill(0);
+
+    //queued ahead of any speeds, which go at the same priority
+    board->post(SensorBoard::CONTROL, [this](int fd) {
+        ROS_DEBUG("Unsafing all thrusters");
+        for(int i = 6; i <= 11; i++) {
+            checkError(setThrusterSafety(fd, i));
+        }
+        ROS_DEBUG("Unsafed all thrusters");
+    });
 
 }
 
+ThrusterTortugaNode::~ThrusterTortugaNode() {}
+
 void ThrusterTortugaNode::update(){
-    //I think we need to initialize thrusters and stuff before this will work
-    ros::spinOnce();
-   
+    //only go to the board if there is something to send or read
+    bool needed;
+    {
+        std::lock_guard<std::mutex> lock(powers_mutex);
+        Clock::time_point now = Clock::now();
+        //nothing can go until the responses to the last speeds are read, and they aren't ready before RESPONSE_DELAY
+        if (responses_pending) {
+            needed = now - sent_at >= RESPONSE_DELAY;
+        }
+        else {
+            needed = !sent_once || setpoint != sent || now - sent_at >= KEEPALIVE;
+        }
+    }
+
+    //if the last command is still waiting it'll send the newest powers when it goes out, no need for another
+    if (needed) {
+        postOnce(SensorBoard::CONTROL, [this](int fd) { sendSpeeds(fd); });
+    }
+}
+
+void ThrusterTortugaNode::sendSpeeds(int fd) {
+    Speeds s;
+    bool send, read;
+    Clock::time_point now = Clock::now();
+    {
+        std::lock_guard<std::mutex> lock(powers_mutex);
+        s = setpoint;
+        send = !sent_once || s != sent || now - sent_at >= KEEPALIVE;
+        read = responses_pending;
+
+        //too early for the responses, and the speeds can't go ahead of them.
+        //update posts this again once they're ready
+        if (read && now - sent_at < RESPONSE_DELAY) {
+            return;
+        }
+    }
+
+    if (read) {
+        readResponses(fd);
+    }
+    if (!send) {
+        return;
+    }
+
     ROS_DEBUG("Setting thruster speeds");
-    //   int retR = readSpeedResponses(fd);
-    
+    std::shared_ptr<struct sbCommand> cmd(new struct sbCommand);
+    sbEncodeSpeeds(cmd.get(), s[0], s[1], s[2], s[3], s[4], s[5]);
+    //the board thread collects the ack, the node has no need to wait on it
+    board->start(cmd, [this, s](int ret) { speedsSent(s, ret); });
+}
 
-    int retS = setSpeeds(fd, thruster_powers.data[0], thruster_powers.data[1], thruster_powers.data[2], thruster_powers.data[3], thruster_powers.data[4], thruster_powers.data[5]);
-    ROS_DEBUG("Set speed status: %x", retS);
+void ThrusterTortugaNode::speedsSent(const Speeds &s, int ret) {
+    ROS_DEBUG("Set speed status: %x", ret);
 
+    std::lock_guard<std::mutex> lock(powers_mutex);
+    sent_at = Clock::now();
+    if (!checkError(ret)) {
+        sent = s;
+        sent_once = true;
+        responses_pending = true;
+    }
+}
 
-    //   usleep(20*1000);
-    //    int retA = readSpeedResponses(fd);
-    //    ROS_DEBUG("Read speed after: %x", retA);
+void ThrusterTortugaNode::readResponses(int fd) {
+    unsigned char codes[NUM_THRUSTERS];
+    int ret = readSpeedResponseCodes(fd, codes);
 
-    //    ROS_DEBUG("thruster state = %x", readThrusterState(fd));
-    //    ROS_DEBUG("set speed returns %x", retS);
-    //    ROS_DEBUG("read speed returns %x", retR);
-   
+    std::lock_guard<std::mutex> lock(powers_mutex);
+    responses_pending = false;
+    if (checkError(ret)) {
+        return;
+    }
+    for (int i = 0; i < NUM_THRUSTERS; i++) {
+        if (codes[i] == SPEED_RESPONSE_ACK) {
+            if (missed_acks[i] >= MISSED_ACK_WARNING) {
+                ROS_INFO("Thruster %d is answering again", i + 1);
+            }
+            missed_acks[i] = 0;
+        } else if (++missed_acks[i] == MISSED_ACK_WARNING) {
+            ROS_WARN("Thruster %d hasn't acked its last %d speeds (got %02x)", i + 1, missed_acks[i], codes[i]);
+        }
+    }
 }
 
 void ThrusterTortugaNode::thrusterCallBack(const std_msgs::Int64MultiArray new_powers){
-	ros::Rate loop_rate(10);
+  if (new_powers.data.size() != NUM_THRUSTERS) {
+    ROS_WARN("Ignoring thruster input with %zu powers, expected %d", new_powers.data.size(), NUM_THRUSTERS);
+    return;
+  }
+
+  Speeds s;
   for(int i = 0 ;i < NUM_THRUSTERS; i++){
-    thruster_powers.data[i] = new_powers.data[i];
+    int64_t p = std::max<int64_t>(-MAX_THRUSTER_SPEED, std::min<int64_t>(MAX_THRUSTER_SPEED, new_powers.data[i]));
+    if (p != new_powers.data[i]) {
+      ROS_WARN_THROTTLE(1, "Thruster %d power %lld is out of range, using %lld", i + 1,
+                        (long long) new_powers.data[i], (long long) p);
+    }
+    s[i] = p;
   }
+
+  std::lock_guard<std::mutex> lock(powers_mutex);
+  setpoint = s;
 }